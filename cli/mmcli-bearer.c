@@ -272,6 +272,17 @@ print_bearer_info (MMBearer *bearer)
             g_print ("                     | Bytes transmitted: '%" G_GUINT64_FORMAT "'\n", val);
         else
             g_print ("                     | Bytes transmitted: 'N/A'\n");
+
+        if (mm_bearer_stats_get_rates_available (stats)) {
+            g_print ("                     |     Rx rate (B/s): '%" G_GUINT64_FORMAT "' (peak '%" G_GUINT64_FORMAT "', average '%" G_GUINT64_FORMAT "')\n",
+                     mm_bearer_stats_get_rx_rate (stats),
+                     mm_bearer_stats_get_rx_peak_rate (stats),
+                     mm_bearer_stats_get_rx_average_rate (stats));
+            g_print ("                     |     Tx rate (B/s): '%" G_GUINT64_FORMAT "' (peak '%" G_GUINT64_FORMAT "', average '%" G_GUINT64_FORMAT "')\n",
+                     mm_bearer_stats_get_tx_rate (stats),
+                     mm_bearer_stats_get_tx_peak_rate (stats),
+                     mm_bearer_stats_get_tx_average_rate (stats));
+        }
     }
 
     g_clear_object (&stats);
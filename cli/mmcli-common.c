@@ -1502,3 +1502,168 @@ mmcli_prefix_newlines (const gchar *prefix,
             g_string_free (prefixed_string, FALSE) :
             g_strdup (str));
 }
+
+static void
+append_json_string (GString     *str,
+                    const gchar *value)
+{
+    const gchar *p;
+
+    g_string_append_c (str, '"');
+    for (p = value; *p; p++) {
+        switch (*p) {
+        case '"':
+            g_string_append (str, "\\\"");
+            break;
+        case '\\':
+            g_string_append (str, "\\\\");
+            break;
+        case '\n':
+            g_string_append (str, "\\n");
+            break;
+        case '\r':
+            g_string_append (str, "\\r");
+            break;
+        case '\t':
+            g_string_append (str, "\\t");
+            break;
+        default:
+            if ((guchar)*p < 0x20)
+                g_string_append_printf (str, "\\u%04x", (guchar)*p);
+            else
+                g_string_append_c (str, *p);
+            break;
+        }
+    }
+    g_string_append_c (str, '"');
+}
+
+static void
+append_json_value (GString  *str,
+                   GVariant *value)
+{
+    GVariantIter iter;
+    GVariant *child;
+    gboolean first = TRUE;
+
+    switch (g_variant_classify (value)) {
+    case G_VARIANT_CLASS_BOOLEAN:
+        g_string_append (str, g_variant_get_boolean (value) ? "true" : "false");
+        break;
+    case G_VARIANT_CLASS_BYTE:
+        g_string_append_printf (str, "%u", (guint)g_variant_get_byte (value));
+        break;
+    case G_VARIANT_CLASS_INT16:
+        g_string_append_printf (str, "%d", (gint)g_variant_get_int16 (value));
+        break;
+    case G_VARIANT_CLASS_UINT16:
+        g_string_append_printf (str, "%u", (guint)g_variant_get_uint16 (value));
+        break;
+    case G_VARIANT_CLASS_INT32:
+        g_string_append_printf (str, "%d", g_variant_get_int32 (value));
+        break;
+    case G_VARIANT_CLASS_UINT32:
+        g_string_append_printf (str, "%u", g_variant_get_uint32 (value));
+        break;
+    case G_VARIANT_CLASS_INT64:
+        g_string_append_printf (str, "%" G_GINT64_FORMAT, g_variant_get_int64 (value));
+        break;
+    case G_VARIANT_CLASS_UINT64:
+        g_string_append_printf (str, "%" G_GUINT64_FORMAT, g_variant_get_uint64 (value));
+        break;
+    case G_VARIANT_CLASS_HANDLE:
+        g_string_append_printf (str, "%d", g_variant_get_handle (value));
+        break;
+    case G_VARIANT_CLASS_DOUBLE: {
+        gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+        gdouble d;
+
+        /* NaN and infinity are not valid JSON numbers */
+        d = g_variant_get_double (value);
+        if (d != d || d > G_MAXDOUBLE || d < -G_MAXDOUBLE)
+            g_string_append (str, "null");
+        else
+            g_string_append (str, g_ascii_dtostr (buffer, sizeof (buffer), d));
+        break;
+    }
+    case G_VARIANT_CLASS_STRING:
+    case G_VARIANT_CLASS_OBJECT_PATH:
+    case G_VARIANT_CLASS_SIGNATURE:
+        append_json_string (str, g_variant_get_string (value, NULL));
+        break;
+    case G_VARIANT_CLASS_VARIANT:
+        child = g_variant_get_variant (value);
+        append_json_value (str, child);
+        g_variant_unref (child);
+        break;
+    case G_VARIANT_CLASS_MAYBE:
+        child = g_variant_get_maybe (value);
+        if (child) {
+            append_json_value (str, child);
+            g_variant_unref (child);
+        } else
+            g_string_append (str, "null");
+        break;
+    case G_VARIANT_CLASS_ARRAY:
+        /* Dictionaries are printed as objects, with non-string keys printed
+         * as strings */
+        if (g_variant_type_is_dict_entry (g_variant_type_element (g_variant_get_type (value)))) {
+            g_string_append_c (str, '{');
+            g_variant_iter_init (&iter, value);
+            while ((child = g_variant_iter_next_value (&iter))) {
+                GVariant *key;
+                GVariant *item;
+
+                key = g_variant_get_child_value (child, 0);
+                item = g_variant_get_child_value (child, 1);
+                if (!first)
+                    g_string_append_c (str, ',');
+                if (g_variant_is_of_type (key, G_VARIANT_TYPE_STRING) ||
+                    g_variant_is_of_type (key, G_VARIANT_TYPE_OBJECT_PATH))
+                    append_json_string (str, g_variant_get_string (key, NULL));
+                else {
+                    gchar *aux;
+
+                    aux = g_variant_print (key, FALSE);
+                    append_json_string (str, aux);
+                    g_free (aux);
+                }
+                g_string_append_c (str, ':');
+                append_json_value (str, item);
+                g_variant_unref (key);
+                g_variant_unref (item);
+                g_variant_unref (child);
+                first = FALSE;
+            }
+            g_string_append_c (str, '}');
+            break;
+        }
+        /* fall through */
+    case G_VARIANT_CLASS_TUPLE:
+    case G_VARIANT_CLASS_DICT_ENTRY:
+        g_string_append_c (str, '[');
+        g_variant_iter_init (&iter, value);
+        while ((child = g_variant_iter_next_value (&iter))) {
+            if (!first)
+                g_string_append_c (str, ',');
+            append_json_value (str, child);
+            g_variant_unref (child);
+            first = FALSE;
+        }
+        g_string_append_c (str, ']');
+        break;
+    default:
+        g_string_append (str, "null");
+        break;
+    }
+}
+
+gchar *
+mmcli_variant_to_json (GVariant *value)
+{
+    GString *str;
+
+    str = g_string_new (NULL);
+    append_json_value (str, value);
+    return g_string_free (str, FALSE);
+}
@@ -110,4 +110,6 @@ const gchar  *mmcli_get_common_call_string (void);
 gchar *mmcli_prefix_newlines (const gchar *prefix,
                               const gchar *str);
 
+gchar *mmcli_variant_to_json (GVariant *value);
+
 #endif /* _MMCLI_COMMON_H_ */
@@ -25,8 +25,11 @@
 #include <stdlib.h>
 #include <locale.h>
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
 
 #include <glib.h>
+#include <glib-unix.h>
 #include <gio/gio.h>
 
 #if defined WITH_UDEV
@@ -46,12 +49,22 @@ typedef struct {
 #if defined WITH_UDEV
     GUdevClient *udev;
 #endif
+    /* Event monitoring */
+    GHashTable *monitored;
+    GHashTable *rate_limits;
+    GQueue output;
+    gsize output_offset;
+    guint output_source_id;
+    guint output_dropped;
 } Context;
 static Context *ctx;
 
 /* Options */
 static gboolean list_modems_flag;
 static gboolean monitor_modems_flag;
+static gboolean monitor_events_flag;
+static gint monitor_events_max_queue_int = 1000;
+static gint monitor_events_interval_int;
 static gboolean scan_modems_flag;
 static gchar *set_logging_str;
 static gchar *report_kernel_event_str;
@@ -73,6 +86,18 @@ static GOptionEntry entries[] = {
       "List available modems and monitor additions and removals",
       NULL
     },
+    { "monitor-events", 0, 0, G_OPTION_ARG_NONE, &monitor_events_flag,
+      "Monitor state, signal, registration, location, bearer and SMS events in all modems, printed as JSON lines",
+      NULL
+    },
+    { "monitor-events-max-queue", 0, 0, G_OPTION_ARG_INT, &monitor_events_max_queue_int,
+      "Maximum number of events waiting to be printed before dropping the oldest ones (default 1000)",
+      "[N]"
+    },
+    { "monitor-events-interval", 0, 0, G_OPTION_ARG_INT, &monitor_events_interval_int,
+      "Minimum time between signal, registration, location and bearer stats events of the same source, in milliseconds",
+      "[MS]"
+    },
     { "scan-modems", 'S', 0, G_OPTION_ARG_NONE, &scan_modems_flag,
       "Request to re-scan looking for modems",
       NULL
@@ -117,6 +142,7 @@ mmcli_manager_options_enabled (void)
 
     n_actions = (list_modems_flag +
                  monitor_modems_flag +
+                 monitor_events_flag +
                  scan_modems_flag +
                  !!set_logging_str +
                  !!report_kernel_event_str);
@@ -133,6 +159,20 @@ mmcli_manager_options_enabled (void)
     if (monitor_modems_flag)
         mmcli_force_async_operation ();
 
+    if (monitor_events_flag) {
+        if (monitor_events_max_queue_int <= 0) {
+            g_printerr ("error: invalid maximum number of queued events: '%d'\n",
+                        monitor_events_max_queue_int);
+            exit (EXIT_FAILURE);
+        }
+        if (monitor_events_interval_int < 0) {
+            g_printerr ("error: invalid minimum interval between events: '%d'\n",
+                        monitor_events_interval_int);
+            exit (EXIT_FAILURE);
+        }
+        mmcli_force_async_operation ();
+    }
+
 #if defined WITH_UDEV
     if (report_kernel_event_auto_scan)
         mmcli_force_async_operation ();
@@ -142,12 +182,26 @@ mmcli_manager_options_enabled (void)
     return !!n_actions;
 }
 
+static void monitored_modem_free (gpointer data);
+static void rate_limit_free      (gpointer data);
+
 static void
 context_free (Context *ctx)
 {
     if (!ctx)
         return;
 
+    if (ctx->output_source_id)
+        g_source_remove (ctx->output_source_id);
+    if (monitor_events_flag)
+        g_unix_set_fd_nonblocking (STDOUT_FILENO, FALSE, NULL);
+    g_queue_foreach (&ctx->output, (GFunc)g_free, NULL);
+    g_queue_clear (&ctx->output);
+    if (ctx->monitored)
+        g_hash_table_unref (ctx->monitored);
+    if (ctx->rate_limits)
+        g_hash_table_unref (ctx->rate_limits);
+
 #if defined WITH_UDEV
     if (ctx->udev)
         g_object_unref (ctx->udev);
@@ -345,6 +399,700 @@ handle_uevent (GUdevClient *client,
 
 #endif
 
+/******************************************************************************/
+/* Event monitoring
+ *
+ * Events are printed as one JSON object per line. Lines are queued and written
+ * to a non-blocking stdout, so that a slow reader never blocks the processing
+ * of D-Bus signals; if the queue grows too much the oldest lines are dropped,
+ * and a 'dropped' event reports how many once the reader catches up. */
+
+typedef struct {
+    gchar *path;
+    MMObject *object;
+    MMModem *modem;
+    MMModem3gpp *modem_3gpp;
+    MMModemLocation *modem_location;
+    MMModemMessaging *modem_messaging;
+    /* Bearer path -> MMBearer */
+    GHashTable *bearers;
+} MonitoredModem;
+
+/* Latest event held back until the minimum interval elapses */
+typedef struct {
+    gchar *key;
+    gchar *modem_path;
+    gchar *event;
+    gint64 last_time;
+    GVariant *pending;
+    guint timeout_id;
+} RateLimit;
+
+static void output_flush (void);
+
+static gboolean
+output_ready (gint         fd,
+              GIOCondition condition,
+              gpointer     none)
+{
+    ctx->output_source_id = 0;
+    output_flush ();
+    return G_SOURCE_REMOVE;
+}
+
+static gchar *
+build_event_line (const gchar *modem_path,
+                  const gchar *event,
+                  GVariant    *data)
+{
+    GVariantBuilder builder;
+    GVariant *variant;
+    gchar *json;
+    gchar *line;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&builder, "{sv}", "time", g_variant_new_int64 (g_get_real_time () / 1000));
+    g_variant_builder_add (&builder, "{sv}", "event", g_variant_new_string (event));
+    if (modem_path)
+        g_variant_builder_add (&builder, "{sv}", "modem", g_variant_new_object_path (modem_path));
+    if (data)
+        g_variant_builder_add (&builder, "{sv}", "data", data);
+    variant = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+    json = mmcli_variant_to_json (variant);
+    line = g_strdup_printf ("%s\n", json);
+    g_free (json);
+    g_variant_unref (variant);
+    return line;
+}
+
+static void
+output_flush (void)
+{
+    while (!g_queue_is_empty (&ctx->output)) {
+        const gchar *line;
+        gsize len;
+        gssize written;
+
+        line = g_queue_peek_head (&ctx->output);
+        len = strlen (line);
+        written = write (STDOUT_FILENO, line + ctx->output_offset, len - ctx->output_offset);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!ctx->output_source_id)
+                    ctx->output_source_id = g_unix_fd_add (STDOUT_FILENO,
+                                                           G_IO_OUT,
+                                                           (GUnixFDSourceFunc)output_ready,
+                                                           NULL);
+                return;
+            }
+            g_printerr ("error: couldn't write event: '%s'\n", g_strerror (errno));
+            exit (EXIT_FAILURE);
+        }
+
+        ctx->output_offset += written;
+        if (ctx->output_offset == len) {
+            g_free (g_queue_pop_head (&ctx->output));
+            ctx->output_offset = 0;
+        }
+    }
+
+    /* All written; report what was lost meanwhile */
+    if (ctx->output_dropped) {
+        GVariantBuilder builder;
+
+        g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+        g_variant_builder_add (&builder, "{sv}", "count", g_variant_new_uint32 (ctx->output_dropped));
+        g_queue_push_tail (&ctx->output, build_event_line (NULL, "dropped", g_variant_builder_end (&builder)));
+        ctx->output_dropped = 0;
+        output_flush ();
+    }
+}
+
+static void
+output_push (gchar *line)
+{
+    if (g_queue_get_length (&ctx->output) >= (guint)monitor_events_max_queue_int) {
+        gchar *oldest;
+
+        /* Drop the oldest line, unless it's already being written */
+        oldest = (ctx->output_offset > 0 ?
+                  g_queue_pop_nth (&ctx->output, 1) :
+                  g_queue_pop_head (&ctx->output));
+        if (oldest) {
+            g_free (oldest);
+            ctx->output_dropped++;
+        }
+    }
+
+    g_queue_push_tail (&ctx->output, line);
+
+    /* If waiting for stdout to be writable, the line goes out with the rest */
+    if (!ctx->output_source_id)
+        output_flush ();
+}
+
+static void
+rate_limit_free (gpointer data)
+{
+    RateLimit *limit = data;
+
+    if (limit->timeout_id)
+        g_source_remove (limit->timeout_id);
+    if (limit->pending)
+        g_variant_unref (limit->pending);
+    g_free (limit->key);
+    g_free (limit->modem_path);
+    g_free (limit->event);
+    g_free (limit);
+}
+
+static void
+rate_limit_emit_pending (RateLimit *limit)
+{
+    output_push (build_event_line (limit->modem_path, limit->event, limit->pending));
+    if (limit->pending) {
+        g_variant_unref (limit->pending);
+        limit->pending = NULL;
+    }
+    limit->last_time = g_get_monotonic_time ();
+}
+
+static gboolean
+rate_limit_timeout (RateLimit *limit)
+{
+    limit->timeout_id = 0;
+    rate_limit_emit_pending (limit);
+    return G_SOURCE_REMOVE;
+}
+
+/* Emits the event; if @limit_source is given and a minimum interval was
+ * requested, events with the same name and source are coalesced so that only
+ * the latest one within each interval gets printed. */
+static void
+emit_event (const gchar *modem_path,
+            const gchar *event,
+            const gchar *limit_source,
+            GVariant    *data)
+{
+    RateLimit *limit;
+    gchar *key;
+    gint64 now;
+    gint64 next;
+
+    if (data)
+        g_variant_ref_sink (data);
+
+    if (!limit_source || monitor_events_interval_int == 0) {
+        output_push (build_event_line (modem_path, event, data));
+        goto out;
+    }
+
+    key = g_strdup_printf ("%s %s", limit_source, event);
+    limit = g_hash_table_lookup (ctx->rate_limits, key);
+    if (!limit) {
+        limit = g_new0 (RateLimit, 1);
+        limit->key = key;
+        limit->modem_path = g_strdup (modem_path);
+        limit->event = g_strdup (event);
+        g_hash_table_insert (ctx->rate_limits, limit->key, limit);
+    } else
+        g_free (key);
+
+    if (limit->pending)
+        g_variant_unref (limit->pending);
+    limit->pending = data ? g_variant_ref (data) : NULL;
+
+    /* Already scheduled; the latest data will be printed */
+    if (limit->timeout_id)
+        goto out;
+
+    now = g_get_monotonic_time ();
+    next = limit->last_time + ((gint64)monitor_events_interval_int * 1000);
+    if (limit->last_time == 0 || now >= next) {
+        rate_limit_emit_pending (limit);
+        goto out;
+    }
+
+    limit->timeout_id = g_timeout_add ((guint)((next - now + 999) / 1000),
+                                       (GSourceFunc)rate_limit_timeout,
+                                       limit);
+
+out:
+    if (data)
+        g_variant_unref (data);
+}
+
+/* Prints whatever is held back for the given modem, and forgets it */
+static void
+flush_rate_limits (const gchar *modem_path)
+{
+    GHashTableIter iter;
+    RateLimit *limit;
+
+    g_hash_table_iter_init (&iter, ctx->rate_limits);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&limit)) {
+        if (g_strcmp0 (limit->modem_path, modem_path) != 0)
+            continue;
+        if (limit->timeout_id)
+            rate_limit_emit_pending (limit);
+        g_hash_table_iter_remove (&iter);
+    }
+}
+
+/* Prints whatever is held back for the given event and source, and forgets
+ * it */
+static void
+flush_rate_limit (const gchar *limit_source,
+                  const gchar *event)
+{
+    RateLimit *limit;
+    gchar *key;
+
+    key = g_strdup_printf ("%s %s", limit_source, event);
+    limit = g_hash_table_lookup (ctx->rate_limits, key);
+    if (limit) {
+        if (limit->timeout_id)
+            rate_limit_emit_pending (limit);
+        g_hash_table_remove (ctx->rate_limits, key);
+    }
+    g_free (key);
+}
+
+static void
+emit_modem_state (MonitoredModem           *monitored,
+                  MMModemState              old_state,
+                  MMModemState              new_state,
+                  MMModemStateChangeReason  reason)
+{
+    GVariantBuilder builder;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&builder, "{sv}", "old", g_variant_new_string (mm_modem_state_get_string (old_state)));
+    g_variant_builder_add (&builder, "{sv}", "new", g_variant_new_string (mm_modem_state_get_string (new_state)));
+    g_variant_builder_add (&builder, "{sv}", "reason", g_variant_new_string (mmcli_get_state_reason_string (reason)));
+    emit_event (monitored->path, "state", NULL, g_variant_builder_end (&builder));
+}
+
+static void
+modem_state_changed (MMModem                  *modem,
+                     MMModemState              old_state,
+                     MMModemState              new_state,
+                     MMModemStateChangeReason  reason,
+                     MonitoredModem           *monitored)
+{
+    emit_modem_state (monitored, old_state, new_state, reason);
+}
+
+static void
+modem_signal_quality_updated (MMModem        *modem,
+                              GParamSpec     *pspec,
+                              MonitoredModem *monitored)
+{
+    GVariantBuilder builder;
+    gboolean recent = FALSE;
+    guint quality;
+
+    quality = mm_modem_get_signal_quality (modem, &recent);
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&builder, "{sv}", "quality", g_variant_new_uint32 (quality));
+    g_variant_builder_add (&builder, "{sv}", "recent", g_variant_new_boolean (recent));
+    emit_event (monitored->path, "signal", monitored->path, g_variant_builder_end (&builder));
+}
+
+static void
+modem_access_technologies_updated (MMModem        *modem,
+                                   GParamSpec     *pspec,
+                                   MonitoredModem *monitored)
+{
+    GVariantBuilder builder;
+    gchar *str;
+
+    str = mm_modem_access_technology_build_string_from_mask (mm_modem_get_access_technologies (modem));
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&builder, "{sv}", "access-technologies", g_variant_new_string (str));
+    emit_event (monitored->path, "access-technologies", monitored->path, g_variant_builder_end (&builder));
+    g_free (str);
+}
+
+static void
+modem_3gpp_registration_updated (MMModem3gpp    *modem_3gpp,
+                                 GParamSpec     *pspec,
+                                 MonitoredModem *monitored)
+{
+    GVariantBuilder builder;
+    const gchar *str;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&builder, "{sv}", "state",
+                           g_variant_new_string (mm_modem_3gpp_registration_state_get_string (
+                                                     mm_modem_3gpp_get_registration_state (modem_3gpp))));
+    str = mm_modem_3gpp_get_operator_code (modem_3gpp);
+    if (str)
+        g_variant_builder_add (&builder, "{sv}", "operator-code", g_variant_new_string (str));
+    str = mm_modem_3gpp_get_operator_name (modem_3gpp);
+    if (str)
+        g_variant_builder_add (&builder, "{sv}", "operator-name", g_variant_new_string (str));
+    emit_event (monitored->path, "registration", monitored->path, g_variant_builder_end (&builder));
+}
+
+static void
+modem_location_updated (MMModemLocation *modem_location,
+                        GParamSpec      *pspec,
+                        MonitoredModem  *monitored)
+{
+    GVariantBuilder builder;
+    GVariantIter iter;
+    GVariant *location;
+    GVariant *value;
+    guint source;
+
+    location = mm_gdbus_modem_location_dup_location (MM_GDBUS_MODEM_LOCATION (modem_location));
+    if (!location)
+        return;
+
+    /* Location sources are given by name */
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_iter_init (&iter, location);
+    while (g_variant_iter_next (&iter, "{uv}", &source, &value)) {
+        gchar *str;
+
+        str = mm_modem_location_source_build_string_from_mask (source);
+        g_variant_builder_add (&builder, "{sv}", str, value);
+        g_variant_unref (value);
+        g_free (str);
+    }
+    g_variant_unref (location);
+
+    emit_event (monitored->path, "location", monitored->path, g_variant_builder_end (&builder));
+}
+
+static void
+modem_messaging_added (MMModemMessaging *modem_messaging,
+                       const gchar      *sms_path,
+                       gboolean          received,
+                       MonitoredModem   *monitored)
+{
+    GVariantBuilder builder;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&builder, "{sv}", "path", g_variant_new_object_path (sms_path));
+    g_variant_builder_add (&builder, "{sv}", "received", g_variant_new_boolean (received));
+    emit_event (monitored->path, "sms-added", NULL, g_variant_builder_end (&builder));
+}
+
+static void
+modem_messaging_deleted (MMModemMessaging *modem_messaging,
+                         const gchar      *sms_path,
+                         MonitoredModem   *monitored)
+{
+    GVariantBuilder builder;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&builder, "{sv}", "path", g_variant_new_object_path (sms_path));
+    emit_event (monitored->path, "sms-deleted", NULL, g_variant_builder_end (&builder));
+}
+
+static void
+bearer_status_updated (MMBearer       *bearer,
+                       GParamSpec     *pspec,
+                       MonitoredModem *monitored)
+{
+    GVariantBuilder builder;
+    const gchar *interface;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&builder, "{sv}", "path", g_variant_new_object_path (mm_bearer_get_path (bearer)));
+    g_variant_builder_add (&builder, "{sv}", "connected", g_variant_new_boolean (mm_bearer_get_connected (bearer)));
+    interface = mm_bearer_get_interface (bearer);
+    if (interface)
+        g_variant_builder_add (&builder, "{sv}", "interface", g_variant_new_string (interface));
+    emit_event (monitored->path, "bearer", NULL, g_variant_builder_end (&builder));
+}
+
+static void
+bearer_stats_updated (MMBearer       *bearer,
+                      GParamSpec     *pspec,
+                      MonitoredModem *monitored)
+{
+    GVariantBuilder builder;
+    MMBearerStats *stats;
+
+    stats = mm_bearer_peek_stats (bearer);
+    if (!stats)
+        return;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&builder, "{sv}", "path", g_variant_new_object_path (mm_bearer_get_path (bearer)));
+    g_variant_builder_add (&builder, "{sv}", "duration", g_variant_new_uint32 (mm_bearer_stats_get_duration (stats)));
+    g_variant_builder_add (&builder, "{sv}", "rx-bytes", g_variant_new_uint64 (mm_bearer_stats_get_rx_bytes (stats)));
+    g_variant_builder_add (&builder, "{sv}", "tx-bytes", g_variant_new_uint64 (mm_bearer_stats_get_tx_bytes (stats)));
+    emit_event (monitored->path, "bearer-stats", mm_bearer_get_path (bearer), g_variant_builder_end (&builder));
+}
+
+static void
+untrack_bearer (MonitoredModem *monitored,
+                MMBearer       *bearer)
+{
+    g_signal_handlers_disconnect_by_data (bearer, monitored);
+}
+
+static void
+list_bearers_ready (MMModem      *modem,
+                    GAsyncResult *result,
+                    gchar        *modem_path)
+{
+    MonitoredModem *monitored;
+    GHashTable *bearers;
+    GHashTableIter iter;
+    GList *list;
+    GList *l;
+    MMBearer *bearer;
+    GError *error = NULL;
+
+    list = mm_modem_list_bearers_finish (modem, result, &error);
+
+    /* Modem may be gone already */
+    monitored = ctx->monitored ? g_hash_table_lookup (ctx->monitored, modem_path) : NULL;
+    if (!monitored)
+        goto out;
+
+    if (error) {
+        g_printerr ("warning: couldn't list bearers in modem '%s': '%s'\n",
+                    modem_path, error->message);
+        goto out;
+    }
+
+    bearers = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+    for (l = list; l; l = g_list_next (l)) {
+        const gchar *path;
+
+        path = mm_bearer_get_path (MM_BEARER (l->data));
+        bearer = g_hash_table_lookup (monitored->bearers, path);
+        if (bearer) {
+            g_hash_table_insert (bearers, g_strdup (path), g_object_ref (bearer));
+            g_hash_table_remove (monitored->bearers, path);
+            continue;
+        }
+
+        bearer = MM_BEARER (l->data);
+        g_hash_table_insert (bearers, g_strdup (path), g_object_ref (bearer));
+        g_signal_connect (bearer, "notify::connected", G_CALLBACK (bearer_status_updated), monitored);
+        g_signal_connect (bearer, "notify::interface", G_CALLBACK (bearer_status_updated), monitored);
+        g_signal_connect (bearer, "notify::stats",     G_CALLBACK (bearer_stats_updated),  monitored);
+        bearer_status_updated (bearer, NULL, monitored);
+    }
+
+    /* Whatever is left is gone */
+    g_hash_table_iter_init (&iter, monitored->bearers);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&bearer)) {
+        GVariantBuilder builder;
+
+        untrack_bearer (monitored, bearer);
+        flush_rate_limit (mm_bearer_get_path (bearer), "bearer-stats");
+        g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+        g_variant_builder_add (&builder, "{sv}", "path", g_variant_new_object_path (mm_bearer_get_path (bearer)));
+        emit_event (monitored->path, "bearer-removed", NULL, g_variant_builder_end (&builder));
+    }
+    g_hash_table_unref (monitored->bearers);
+    monitored->bearers = bearers;
+
+out:
+    if (error)
+        g_error_free (error);
+    g_list_free_full (list, g_object_unref);
+    g_free (modem_path);
+}
+
+static void
+modem_bearers_updated (MMModem        *modem,
+                       GParamSpec     *pspec,
+                       MonitoredModem *monitored)
+{
+    mm_modem_list_bearers (modem,
+                           ctx->cancellable,
+                           (GAsyncReadyCallback)list_bearers_ready,
+                           g_strdup (monitored->path));
+}
+
+static void
+monitored_modem_update_interfaces (MonitoredModem *monitored)
+{
+    MMModem3gpp *modem_3gpp;
+    MMModemLocation *modem_location;
+    MMModemMessaging *modem_messaging;
+
+    modem_3gpp = mm_object_peek_modem_3gpp (monitored->object);
+    if (modem_3gpp != monitored->modem_3gpp) {
+        if (monitored->modem_3gpp) {
+            g_signal_handlers_disconnect_by_data (monitored->modem_3gpp, monitored);
+            g_clear_object (&monitored->modem_3gpp);
+        }
+        if (modem_3gpp) {
+            monitored->modem_3gpp = g_object_ref (modem_3gpp);
+            g_signal_connect (modem_3gpp, "notify::registration-state", G_CALLBACK (modem_3gpp_registration_updated), monitored);
+            g_signal_connect (modem_3gpp, "notify::operator-code",      G_CALLBACK (modem_3gpp_registration_updated), monitored);
+            g_signal_connect (modem_3gpp, "notify::operator-name",      G_CALLBACK (modem_3gpp_registration_updated), monitored);
+            modem_3gpp_registration_updated (modem_3gpp, NULL, monitored);
+        }
+    }
+
+    modem_location = mm_object_peek_modem_location (monitored->object);
+    if (modem_location != monitored->modem_location) {
+        if (monitored->modem_location) {
+            g_signal_handlers_disconnect_by_data (monitored->modem_location, monitored);
+            g_clear_object (&monitored->modem_location);
+        }
+        if (modem_location) {
+            monitored->modem_location = g_object_ref (modem_location);
+            g_signal_connect (modem_location, "notify::location", G_CALLBACK (modem_location_updated), monitored);
+        }
+    }
+
+    modem_messaging = mm_object_peek_modem_messaging (monitored->object);
+    if (modem_messaging != monitored->modem_messaging) {
+        if (monitored->modem_messaging) {
+            g_signal_handlers_disconnect_by_data (monitored->modem_messaging, monitored);
+            g_clear_object (&monitored->modem_messaging);
+        }
+        if (modem_messaging) {
+            monitored->modem_messaging = g_object_ref (modem_messaging);
+            g_signal_connect (modem_messaging, "added",   G_CALLBACK (modem_messaging_added),   monitored);
+            g_signal_connect (modem_messaging, "deleted", G_CALLBACK (modem_messaging_deleted), monitored);
+        }
+    }
+}
+
+static void
+object_interfaces_updated (MMObject       *object,
+                           GDBusInterface *interface,
+                           MonitoredModem *monitored)
+{
+    monitored_modem_update_interfaces (monitored);
+}
+
+static void
+monitored_modem_free (gpointer data)
+{
+    MonitoredModem *monitored = data;
+    GHashTableIter iter;
+    MMBearer *bearer;
+
+    g_hash_table_iter_init (&iter, monitored->bearers);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&bearer))
+        untrack_bearer (monitored, bearer);
+    g_hash_table_unref (monitored->bearers);
+
+    if (monitored->modem_3gpp) {
+        g_signal_handlers_disconnect_by_data (monitored->modem_3gpp, monitored);
+        g_object_unref (monitored->modem_3gpp);
+    }
+    if (monitored->modem_location) {
+        g_signal_handlers_disconnect_by_data (monitored->modem_location, monitored);
+        g_object_unref (monitored->modem_location);
+    }
+    if (monitored->modem_messaging) {
+        g_signal_handlers_disconnect_by_data (monitored->modem_messaging, monitored);
+        g_object_unref (monitored->modem_messaging);
+    }
+    g_signal_handlers_disconnect_by_data (monitored->modem, monitored);
+    g_object_unref (monitored->modem);
+    g_signal_handlers_disconnect_by_data (monitored->object, monitored);
+    g_object_unref (monitored->object);
+    g_free (monitored->path);
+    g_free (monitored);
+}
+
+static void
+monitor_events_modem_added (MMManager *manager,
+                            MMObject  *object)
+{
+    MonitoredModem *monitored;
+    GVariantBuilder builder;
+    const gchar *str;
+
+    if (g_hash_table_lookup (ctx->monitored, mm_object_get_path (object)))
+        return;
+
+    monitored = g_new0 (MonitoredModem, 1);
+    monitored->path = g_strdup (mm_object_get_path (object));
+    monitored->object = g_object_ref (object);
+    monitored->modem = mm_object_get_modem (object);
+    monitored->bearers = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+    g_hash_table_insert (ctx->monitored, monitored->path, monitored);
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    str = mm_modem_get_manufacturer (monitored->modem);
+    if (str)
+        g_variant_builder_add (&builder, "{sv}", "manufacturer", g_variant_new_string (str));
+    str = mm_modem_get_model (monitored->modem);
+    if (str)
+        g_variant_builder_add (&builder, "{sv}", "model", g_variant_new_string (str));
+    g_variant_builder_add (&builder, "{sv}", "state",
+                           g_variant_new_string (mm_modem_state_get_string (mm_modem_get_state (monitored->modem))));
+    emit_event (monitored->path, "modem-added", NULL, g_variant_builder_end (&builder));
+
+    g_signal_connect (monitored->modem, "state-changed",                G_CALLBACK (modem_state_changed),               monitored);
+    g_signal_connect (monitored->modem, "notify::signal-quality",       G_CALLBACK (modem_signal_quality_updated),      monitored);
+    g_signal_connect (monitored->modem, "notify::access-technologies",  G_CALLBACK (modem_access_technologies_updated), monitored);
+    g_signal_connect (monitored->modem, "notify::bearers",              G_CALLBACK (modem_bearers_updated),             monitored);
+    g_signal_connect (object, "interface-added",   G_CALLBACK (object_interfaces_updated), monitored);
+    g_signal_connect (object, "interface-removed", G_CALLBACK (object_interfaces_updated), monitored);
+
+    modem_signal_quality_updated (monitored->modem, NULL, monitored);
+    modem_access_technologies_updated (monitored->modem, NULL, monitored);
+    monitored_modem_update_interfaces (monitored);
+    modem_bearers_updated (monitored->modem, NULL, monitored);
+}
+
+static void
+monitor_events_modem_removed (MMManager *manager,
+                              MMObject  *object)
+{
+    const gchar *path;
+
+    path = mm_object_get_path (object);
+    if (!g_hash_table_lookup (ctx->monitored, path))
+        return;
+
+    flush_rate_limits (path);
+    emit_event (path, "modem-removed", NULL, NULL);
+    g_hash_table_remove (ctx->monitored, path);
+}
+
+static void
+monitor_events_start (void)
+{
+    GList *modems;
+    GList *l;
+    GError *error = NULL;
+
+    if (!g_unix_set_fd_nonblocking (STDOUT_FILENO, TRUE, &error)) {
+        g_printerr ("error: couldn't setup output: '%s'\n", error->message);
+        exit (EXIT_FAILURE);
+    }
+
+    g_queue_init (&ctx->output);
+    ctx->monitored = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, monitored_modem_free);
+    ctx->rate_limits = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, rate_limit_free);
+
+    g_signal_connect (ctx->manager,
+                      "object-added",
+                      G_CALLBACK (monitor_events_modem_added),
+                      NULL);
+    g_signal_connect (ctx->manager,
+                      "object-removed",
+                      G_CALLBACK (monitor_events_modem_removed),
+                      NULL);
+
+    modems = g_dbus_object_manager_get_objects (G_DBUS_OBJECT_MANAGER (ctx->manager));
+    for (l = modems; l; l = g_list_next (l))
+        monitor_events_modem_added (ctx->manager, MM_OBJECT (l->data));
+    g_list_free_full (modems, g_object_unref);
+}
+
 static void
 get_manager_ready (GObject      *source,
                    GAsyncResult *result,
@@ -444,6 +1192,18 @@ get_manager_ready (GObject      *source,
         return;
     }
 
+    /* Request to monitor events? */
+    if (monitor_events_flag) {
+        monitor_events_start ();
+
+        /* If we get cancelled, operation done */
+        g_cancellable_connect (ctx->cancellable,
+                               G_CALLBACK (cancelled),
+                               NULL,
+                               NULL);
+        return;
+    }
+
     /* Request to list modems? */
     if (list_modems_flag) {
         list_current_modems (ctx->manager);
@@ -480,6 +1240,11 @@ mmcli_manager_run_synchronous (GDBusConnection *connection)
         exit (EXIT_FAILURE);
     }
 
+    if (monitor_events_flag) {
+        g_printerr ("error: monitoring events cannot be done synchronously\n");
+        exit (EXIT_FAILURE);
+    }
+
 #if defined WITH_UDEV
     if (report_kernel_event_auto_scan) {
         g_printerr ("error: monitoring udev events cannot be done synchronously\n");
@@ -37,11 +37,25 @@ G_DEFINE_TYPE (MMBearerStats, mm_bearer_stats, G_TYPE_OBJECT)
 #define PROPERTY_DURATION "duration"
 #define PROPERTY_RX_BYTES "rx-bytes"
 #define PROPERTY_TX_BYTES "tx-bytes"
+#define PROPERTY_RX_RATE "rx-rate"
+#define PROPERTY_TX_RATE "tx-rate"
+#define PROPERTY_RX_PEAK_RATE "rx-peak-rate"
+#define PROPERTY_TX_PEAK_RATE "tx-peak-rate"
+#define PROPERTY_RX_AVERAGE_RATE "rx-average-rate"
+#define PROPERTY_TX_AVERAGE_RATE "tx-average-rate"
 
 struct _MMBearerStatsPrivate {
     guint   duration;
     guint64 rx_bytes;
     guint64 tx_bytes;
+    /* Throughput rates, only given when available */
+    gboolean rates_available;
+    guint64 rx_rate;
+    guint64 tx_rate;
+    guint64 rx_peak_rate;
+    guint64 tx_peak_rate;
+    guint64 rx_average_rate;
+    guint64 tx_average_rate;
 };
 
 /*****************************************************************************/
@@ -127,6 +141,200 @@ mm_bearer_stats_set_tx_bytes (MMBearerStats *self,
 
 /*****************************************************************************/
 
+/**
+ * mm_bearer_stats_get_rates_available:
+ * @self: a #MMBearerStats.
+ *
+ * Checks whether throughput rates are reported in the stats. Rates are only
+ * available when the daemon samples the kernel counters of the data
+ * interface.
+ *
+ * Returns: %TRUE if the rate values are available, %FALSE otherwise.
+ */
+gboolean
+mm_bearer_stats_get_rates_available (MMBearerStats *self)
+{
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), FALSE);
+
+    return self->priv->rates_available;
+}
+
+/*****************************************************************************/
+
+/**
+ * mm_bearer_stats_get_rx_rate:
+ * @self: a #MMBearerStats.
+ *
+ * Gets the current throughput of received data, in bytes per second, as
+ * computed in the last sampling interval.
+ *
+ * Returns: a #guint64.
+ */
+guint64
+mm_bearer_stats_get_rx_rate (MMBearerStats *self)
+{
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), 0);
+
+    return self->priv->rx_rate;
+}
+
+void
+mm_bearer_stats_set_rx_rate (MMBearerStats *self,
+                             guint64 rate)
+{
+    g_return_if_fail (MM_IS_BEARER_STATS (self));
+
+    self->priv->rates_available = TRUE;
+    self->priv->rx_rate = rate;
+}
+
+/*****************************************************************************/
+
+/**
+ * mm_bearer_stats_get_tx_rate:
+ * @self: a #MMBearerStats.
+ *
+ * Gets the current throughput of transmitted data, in bytes per second, as
+ * computed in the last sampling interval.
+ *
+ * Returns: a #guint64.
+ */
+guint64
+mm_bearer_stats_get_tx_rate (MMBearerStats *self)
+{
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), 0);
+
+    return self->priv->tx_rate;
+}
+
+void
+mm_bearer_stats_set_tx_rate (MMBearerStats *self,
+                             guint64 rate)
+{
+    g_return_if_fail (MM_IS_BEARER_STATS (self));
+
+    self->priv->rates_available = TRUE;
+    self->priv->tx_rate = rate;
+}
+
+/*****************************************************************************/
+
+/**
+ * mm_bearer_stats_get_rx_peak_rate:
+ * @self: a #MMBearerStats.
+ *
+ * Gets the highest throughput of received data seen in the connection, in
+ * bytes per second.
+ *
+ * Returns: a #guint64.
+ */
+guint64
+mm_bearer_stats_get_rx_peak_rate (MMBearerStats *self)
+{
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), 0);
+
+    return self->priv->rx_peak_rate;
+}
+
+void
+mm_bearer_stats_set_rx_peak_rate (MMBearerStats *self,
+                                  guint64 rate)
+{
+    g_return_if_fail (MM_IS_BEARER_STATS (self));
+
+    self->priv->rates_available = TRUE;
+    self->priv->rx_peak_rate = rate;
+}
+
+/*****************************************************************************/
+
+/**
+ * mm_bearer_stats_get_tx_peak_rate:
+ * @self: a #MMBearerStats.
+ *
+ * Gets the highest throughput of transmitted data seen in the connection, in
+ * bytes per second.
+ *
+ * Returns: a #guint64.
+ */
+guint64
+mm_bearer_stats_get_tx_peak_rate (MMBearerStats *self)
+{
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), 0);
+
+    return self->priv->tx_peak_rate;
+}
+
+void
+mm_bearer_stats_set_tx_peak_rate (MMBearerStats *self,
+                                  guint64 rate)
+{
+    g_return_if_fail (MM_IS_BEARER_STATS (self));
+
+    self->priv->rates_available = TRUE;
+    self->priv->tx_peak_rate = rate;
+}
+
+/*****************************************************************************/
+
+/**
+ * mm_bearer_stats_get_rx_average_rate:
+ * @self: a #MMBearerStats.
+ *
+ * Gets the moving average of the throughput of received data, in bytes per
+ * second.
+ *
+ * Returns: a #guint64.
+ */
+guint64
+mm_bearer_stats_get_rx_average_rate (MMBearerStats *self)
+{
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), 0);
+
+    return self->priv->rx_average_rate;
+}
+
+void
+mm_bearer_stats_set_rx_average_rate (MMBearerStats *self,
+                                     guint64 rate)
+{
+    g_return_if_fail (MM_IS_BEARER_STATS (self));
+
+    self->priv->rates_available = TRUE;
+    self->priv->rx_average_rate = rate;
+}
+
+/*****************************************************************************/
+
+/**
+ * mm_bearer_stats_get_tx_average_rate:
+ * @self: a #MMBearerStats.
+ *
+ * Gets the moving average of the throughput of transmitted data, in bytes per
+ * second.
+ *
+ * Returns: a #guint64.
+ */
+guint64
+mm_bearer_stats_get_tx_average_rate (MMBearerStats *self)
+{
+    g_return_val_if_fail (MM_IS_BEARER_STATS (self), 0);
+
+    return self->priv->tx_average_rate;
+}
+
+void
+mm_bearer_stats_set_tx_average_rate (MMBearerStats *self,
+                                     guint64 rate)
+{
+    g_return_if_fail (MM_IS_BEARER_STATS (self));
+
+    self->priv->rates_available = TRUE;
+    self->priv->tx_average_rate = rate;
+}
+
+/*****************************************************************************/
+
 GVariant *
 mm_bearer_stats_get_dictionary (MMBearerStats *self)
 {
@@ -149,6 +357,34 @@ mm_bearer_stats_get_dictionary (MMBearerStats *self)
                             "{sv}",
                             PROPERTY_TX_BYTES,
                             g_variant_new_uint64 (self->priv->tx_bytes));
+
+    if (self->priv->rates_available) {
+        g_variant_builder_add  (&builder,
+                                "{sv}",
+                                PROPERTY_RX_RATE,
+                                g_variant_new_uint64 (self->priv->rx_rate));
+        g_variant_builder_add  (&builder,
+                                "{sv}",
+                                PROPERTY_TX_RATE,
+                                g_variant_new_uint64 (self->priv->tx_rate));
+        g_variant_builder_add  (&builder,
+                                "{sv}",
+                                PROPERTY_RX_PEAK_RATE,
+                                g_variant_new_uint64 (self->priv->rx_peak_rate));
+        g_variant_builder_add  (&builder,
+                                "{sv}",
+                                PROPERTY_TX_PEAK_RATE,
+                                g_variant_new_uint64 (self->priv->tx_peak_rate));
+        g_variant_builder_add  (&builder,
+                                "{sv}",
+                                PROPERTY_RX_AVERAGE_RATE,
+                                g_variant_new_uint64 (self->priv->rx_average_rate));
+        g_variant_builder_add  (&builder,
+                                "{sv}",
+                                PROPERTY_TX_AVERAGE_RATE,
+                                g_variant_new_uint64 (self->priv->tx_average_rate));
+    }
+
     return g_variant_builder_end (&builder);
 }
 
@@ -191,6 +427,30 @@ mm_bearer_stats_new_from_dictionary (GVariant *dictionary,
             mm_bearer_stats_set_tx_bytes (
                 self,
                 g_variant_get_uint64 (value));
+        } else if (g_str_equal (key, PROPERTY_RX_RATE)) {
+            mm_bearer_stats_set_rx_rate (
+                self,
+                g_variant_get_uint64 (value));
+        } else if (g_str_equal (key, PROPERTY_TX_RATE)) {
+            mm_bearer_stats_set_tx_rate (
+                self,
+                g_variant_get_uint64 (value));
+        } else if (g_str_equal (key, PROPERTY_RX_PEAK_RATE)) {
+            mm_bearer_stats_set_rx_peak_rate (
+                self,
+                g_variant_get_uint64 (value));
+        } else if (g_str_equal (key, PROPERTY_TX_PEAK_RATE)) {
+            mm_bearer_stats_set_tx_peak_rate (
+                self,
+                g_variant_get_uint64 (value));
+        } else if (g_str_equal (key, PROPERTY_RX_AVERAGE_RATE)) {
+            mm_bearer_stats_set_rx_average_rate (
+                self,
+                g_variant_get_uint64 (value));
+        } else if (g_str_equal (key, PROPERTY_TX_AVERAGE_RATE)) {
+            mm_bearer_stats_set_tx_average_rate (
+                self,
+                g_variant_get_uint64 (value));
         }
         g_free (key);
         g_variant_unref (value);
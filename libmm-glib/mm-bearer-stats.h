@@ -61,6 +61,14 @@ guint   mm_bearer_stats_get_duration (MMBearerStats *self);
 guint64 mm_bearer_stats_get_rx_bytes (MMBearerStats *self);
 guint64 mm_bearer_stats_get_tx_bytes (MMBearerStats *self);
 
+gboolean mm_bearer_stats_get_rates_available (MMBearerStats *self);
+guint64  mm_bearer_stats_get_rx_rate         (MMBearerStats *self);
+guint64  mm_bearer_stats_get_tx_rate         (MMBearerStats *self);
+guint64  mm_bearer_stats_get_rx_peak_rate    (MMBearerStats *self);
+guint64  mm_bearer_stats_get_tx_peak_rate    (MMBearerStats *self);
+guint64  mm_bearer_stats_get_rx_average_rate (MMBearerStats *self);
+guint64  mm_bearer_stats_get_tx_average_rate (MMBearerStats *self);
+
 /*****************************************************************************/
 /* ModemManager/libmm-glib/mmcli specific methods */
 
@@ -76,6 +84,13 @@ void mm_bearer_stats_set_duration (MMBearerStats *self, guint duration);
 void mm_bearer_stats_set_rx_bytes (MMBearerStats *self, guint64 rx_bytes);
 void mm_bearer_stats_set_tx_bytes (MMBearerStats *self, guint64 tx_bytes);
 
+void mm_bearer_stats_set_rx_rate         (MMBearerStats *self, guint64 rate);
+void mm_bearer_stats_set_tx_rate         (MMBearerStats *self, guint64 rate);
+void mm_bearer_stats_set_rx_peak_rate    (MMBearerStats *self, guint64 rate);
+void mm_bearer_stats_set_tx_peak_rate    (MMBearerStats *self, guint64 rate);
+void mm_bearer_stats_set_rx_average_rate (MMBearerStats *self, guint64 rate);
+void mm_bearer_stats_set_tx_average_rate (MMBearerStats *self, guint64 rate);
+
 GVariant *mm_bearer_stats_get_dictionary (MMBearerStats *self);
 
 #endif
@@ -1695,3 +1695,155 @@ mm_utils_check_for_single_value (guint32 value)
 
     return TRUE;
 }
+
+/*****************************************************************************/
+/* NMEA traces */
+
+gboolean
+mm_nmea_trace_find (const gchar *buffer,
+                    gsize buffer_len,
+                    gsize *start,
+                    gsize *end)
+{
+    const gchar *dollar;
+    const gchar *lf;
+    const gchar *buffer_end;
+
+    buffer_end = buffer + buffer_len;
+    dollar = memchr (buffer, '$', buffer_len);
+    while (dollar) {
+        lf = memchr (dollar, '\n', buffer_end - dollar);
+        if (!lf)
+            return FALSE;
+
+        /* Traces always end with <CR><LF>; skip lines ending just in <LF> */
+        if (lf > dollar && lf[-1] == '\r') {
+            *start = dollar - buffer;
+            *end = lf + 1 - buffer;
+            return TRUE;
+        }
+
+        dollar = memchr (lf + 1, '$', buffer_end - (lf + 1));
+    }
+
+    return FALSE;
+}
+
+gboolean
+mm_nmea_trace_validate (const gchar *trace,
+                        gsize trace_len)
+{
+    guint8 checksum = 0;
+    gint expected;
+    gsize i;
+
+    /* Ignore trailing <CR><LF> */
+    while (trace_len > 0 && (trace[trace_len - 1] == '\r' || trace[trace_len - 1] == '\n'))
+        trace_len--;
+
+    if (trace_len < 2 || trace[0] != '$')
+        return FALSE;
+
+    for (i = 1; i < trace_len && trace[i] != '*'; i++)
+        checksum ^= (guint8) trace[i];
+
+    /* The checksum is optional */
+    if (i == trace_len)
+        return TRUE;
+
+    /* If given, it must be the last thing in the trace */
+    if (trace_len - i != 3)
+        return FALSE;
+
+    expected = mm_utils_hex2byte (&trace[i + 1]);
+    return (expected >= 0 && (guint8) expected == checksum);
+}
+
+guint
+mm_nmea_trace_tokenize (const gchar *trace,
+                        gsize trace_len,
+                        MMNmeaField *fields,
+                        guint max_fields)
+{
+    const gchar *p;
+    const gchar *trace_end;
+    guint n_fields = 0;
+
+    if (!trace_len || trace[0] != '$' || !max_fields)
+        return 0;
+
+    /* Fields end at the checksum delimiter or at the end of line */
+    trace_end = trace;
+    while ((gsize) (trace_end - trace) < trace_len &&
+           *trace_end != '*' && *trace_end != '\r' && *trace_end != '\n')
+        trace_end++;
+
+    p = trace;
+    while (n_fields < max_fields) {
+        const gchar *comma;
+
+        comma = memchr (p, ',', trace_end - p);
+        fields[n_fields].str = p;
+        fields[n_fields].len = (comma ? comma : trace_end) - p;
+        n_fields++;
+        if (!comma)
+            break;
+        p = comma + 1;
+    }
+
+    return n_fields;
+}
+
+gboolean
+mm_nmea_field_is_sentence (const MMNmeaField *field,
+                           const gchar *sentence)
+{
+    static const gchar *talkers[] = { "GP", "GN", "GL", "GA" };
+    gsize sentence_len;
+    guint i;
+
+    sentence_len = strlen (sentence);
+    if (field->len != 3 + sentence_len ||
+        field->str[0] != '$' ||
+        memcmp (&field->str[3], sentence, sentence_len) != 0)
+        return FALSE;
+
+    for (i = 0; i < G_N_ELEMENTS (talkers); i++) {
+        if (field->str[1] == talkers[i][0] && field->str[2] == talkers[i][1])
+            return TRUE;
+    }
+    return FALSE;
+}
+
+gboolean
+mm_nmea_field_copy (const MMNmeaField *field,
+                    gchar *buffer,
+                    gsize buffer_size)
+{
+    if (field->len >= buffer_size)
+        return FALSE;
+
+    memcpy (buffer, field->str, field->len);
+    buffer[field->len] = '\0';
+    return TRUE;
+}
+
+gboolean
+mm_nmea_field_get_uint (const MMNmeaField *field,
+                        guint *out)
+{
+    gchar buffer[16];
+
+    return (mm_nmea_field_copy (field, buffer, sizeof (buffer)) &&
+            mm_get_uint_from_str (buffer, out));
+}
+
+gboolean
+mm_nmea_field_get_double (const MMNmeaField *field,
+                          gdouble *out)
+{
+    gchar buffer[32];
+
+    return (mm_nmea_field_copy (field, buffer, sizeof (buffer)) &&
+            mm_get_double_from_str (buffer, out));
+}
@@ -166,4 +166,32 @@ gboolean  mm_utils_ishexstr   (const gchar *hex);
 
 gboolean  mm_utils_check_for_single_value (guint32 value);
 
+/* NMEA traces; fields point into the parsed trace, nothing is allocated */
+typedef struct {
+    const gchar *str;
+    gsize        len;
+} MMNmeaField;
+
+#define MM_NMEA_MAX_FIELDS 32
+
+gboolean mm_nmea_trace_find        (const gchar *buffer,
+                                    gsize        buffer_len,
+                                    gsize       *start,
+                                    gsize       *end);
+gboolean mm_nmea_trace_validate    (const gchar *trace,
+                                    gsize        trace_len);
+guint    mm_nmea_trace_tokenize    (const gchar *trace,
+                                    gsize        trace_len,
+                                    MMNmeaField *fields,
+                                    guint        max_fields);
+gboolean mm_nmea_field_is_sentence (const MMNmeaField *field,
+                                    const gchar       *sentence);
+gboolean mm_nmea_field_copy        (const MMNmeaField *field,
+                                    gchar             *buffer,
+                                    gsize              buffer_size);
+gboolean mm_nmea_field_get_uint    (const MMNmeaField *field,
+                                    guint             *out);
+gboolean mm_nmea_field_get_double  (const MMNmeaField *field,
+                                    gdouble           *out);
+
 #endif /* MM_COMMON_HELPERS_H */
@@ -38,7 +38,6 @@ G_DEFINE_TYPE (MMLocationGpsNmea, mm_location_gps_nmea, G_TYPE_OBJECT);
 
 struct _MMLocationGpsNmeaPrivate {
     GHashTable *traces;
-    GRegex *sequence_regex;
 };
 
 /*****************************************************************************/
@@ -47,26 +46,15 @@ static gboolean
 check_append_or_replace (MMLocationGpsNmea *self,
                          const gchar *trace)
 {
-    /* By default, replace */
-    gboolean append_or_replace = FALSE;
-    GMatchInfo *match_info = NULL;
-
-    if (G_UNLIKELY (!self->priv->sequence_regex))
-        self->priv->sequence_regex = g_regex_new ("\\$GPGSV,(\\d),(\\d).*",
-                                                  G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                                                  0,
-                                                  NULL);
-
-    if (g_regex_match (self->priv->sequence_regex, trace, 0, &match_info)) {
-        guint index;
-
-        /* If we don't have the first element of a sequence, append */
-        if (mm_get_uint_from_match_info (match_info, 2, &index) && index != 1)
-            append_or_replace = TRUE;
-    }
-    g_match_info_free (match_info);
-
-    return append_or_replace;
+    MMNmeaField fields[3];
+    guint index;
+
+    /* GSV traces are part of a sequence; if we don't have the first element
+     * of a sequence, append. Otherwise, replace. */
+    return (mm_nmea_trace_tokenize (trace, strlen (trace), fields, G_N_ELEMENTS (fields)) == G_N_ELEMENTS (fields) &&
+            mm_nmea_field_is_sentence (&fields[0], "GSV") &&
+            mm_nmea_field_get_uint (&fields[2], &index) &&
+            index != 1);
 }
 
 static gboolean
@@ -261,9 +249,6 @@ finalize (GObject *object)
     MMLocationGpsNmea *self = MM_LOCATION_GPS_NMEA (object);
 
     g_hash_table_destroy (self->priv->traces);
-    if (self->priv->sequence_regex)
-        g_regex_unref (self->priv->sequence_regex);
-
     G_OBJECT_CLASS (mm_location_gps_nmea_parent_class)->finalize (object);
 }
 
@@ -42,8 +42,6 @@ G_DEFINE_TYPE (MMLocationGpsRaw, mm_location_gps_raw, G_TYPE_OBJECT);
 #define PROPERTY_ALTITUDE  "altitude"
 
 struct _MMLocationGpsRawPrivate {
-    GRegex *gpgga_regex;
-
     gchar   *utc_time;
     gdouble  latitude;
     gdouble  longitude;
@@ -128,52 +126,48 @@ mm_location_gps_raw_get_altitude (MMLocationGpsRaw *self)
 /*****************************************************************************/
 
 static gboolean
-get_longitude_or_latitude_from_match_info (GMatchInfo *match_info,
-                                           guint32 match_index,
-                                           gdouble *out)
+get_longitude_or_latitude_from_field (const MMNmeaField *field,
+                                      gdouble *out)
 {
+    gchar s[32];
     gchar *aux;
-    gchar *s;
-    gboolean ret = FALSE;
     gdouble minutes;
     gdouble degrees;
 
-    s = g_match_info_fetch (match_info, match_index);
-    if (!s)
-        goto out;
+    if (!mm_nmea_field_copy (field, s, sizeof (s)))
+        return FALSE;
 
     /* 4533.35 is 45 degrees and 33.35 minutes */
 
     aux = strchr (s, '.');
     if (!aux || ((aux - s) < 3))
-        goto out;
+        return FALSE;
 
     aux -= 2;
     if (!mm_get_double_from_str (aux, &minutes))
-        goto out;
+        return FALSE;
 
     aux[0] = '\0';
     if (!mm_get_double_from_str (s, &degrees))
-        goto out;
+        return FALSE;
 
     /* Include the minutes as part of the degrees */
     *out = degrees + (minutes / 60.0);
-    ret = TRUE;
-
-out:
-    g_free (s);
-
-    return ret;
+    return TRUE;
 }
 
 gboolean
 mm_location_gps_raw_add_trace (MMLocationGpsRaw *self,
                                const gchar *trace)
 {
-    GMatchInfo *match_info = NULL;
+    MMNmeaField fields[MM_NMEA_MAX_FIELDS];
+    guint n_fields;
+
+    n_fields = mm_nmea_trace_tokenize (trace, strlen (trace), fields, G_N_ELEMENTS (fields));
 
-    /* Current implementation works only with $GPGGA traces */
-    if (!g_str_has_prefix (trace, "$GPGGA"))
+    /* Current implementation works only with GGA traces, from any of the
+     * known talkers ($GPGGA, $GNGGA...) */
+    if (!n_fields || !mm_nmea_field_is_sentence (&fields[0], "GGA"))
         return FALSE;
 
     /*
@@ -193,50 +187,33 @@ mm_location_gps_raw_add_trace (MMLocationGpsRaw *self,
      * 12   = Meters  (Units of geoidal separation)
      * 13   = Age in seconds since last update from diff. reference station
      * 14   = Diff. reference station ID#
-     * 15   = Checksum
      */
-    if (G_UNLIKELY (!self->priv->gpgga_regex))
-        self->priv->gpgga_regex = g_regex_new ("\\$GPGGA,(.*),(.*),(.*),(.*),(.*),(.*),(.*),(.*),(.*),(.*),(.*),(.*),(.*),(.*)\\*(.*).*",
-                                               G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                                               0,
-                                               NULL);
-
-    if (g_regex_match (self->priv->gpgga_regex, trace, 0, &match_info)) {
-        /* UTC time */
-        if (self->priv->utc_time)
-            g_free (self->priv->utc_time);
-        self->priv->utc_time = g_match_info_fetch (match_info, 1);
-
-        /* Latitude */
-        self->priv->latitude = MM_LOCATION_LATITUDE_UNKNOWN;
-        if (get_longitude_or_latitude_from_match_info (match_info, 2, &self->priv->latitude)) {
-            gchar *str;
-
-            /* N/S */
-            str = g_match_info_fetch (match_info, 3);
-            if (str && str[0] == 'S')
-                self->priv->latitude *= -1;
-            g_free (str);
-        }
-
-        /* Longitude */
-        self->priv->longitude = MM_LOCATION_LONGITUDE_UNKNOWN;
-        if (get_longitude_or_latitude_from_match_info (match_info, 4, &self->priv->longitude)) {
-            gchar *str;
-
-            /* N/S */
-            str = g_match_info_fetch (match_info, 5);
-            if (str && str[0] == 'W')
-                self->priv->longitude *= -1;
-            g_free (str);
-        }
-
-        /* Altitude */
-        self->priv->altitude = MM_LOCATION_ALTITUDE_UNKNOWN;
-        mm_get_double_from_match_info (match_info, 9, &self->priv->altitude);
+    if (n_fields < 15)
+        return TRUE;
+
+    /* UTC time */
+    g_free (self->priv->utc_time);
+    self->priv->utc_time = g_strndup (fields[1].str, fields[1].len);
+
+    /* Latitude */
+    self->priv->latitude = MM_LOCATION_LATITUDE_UNKNOWN;
+    if (get_longitude_or_latitude_from_field (&fields[2], &self->priv->latitude)) {
+        /* N/S */
+        if (fields[3].len && fields[3].str[0] == 'S')
+            self->priv->latitude *= -1;
+    }
+
+    /* Longitude */
+    self->priv->longitude = MM_LOCATION_LONGITUDE_UNKNOWN;
+    if (get_longitude_or_latitude_from_field (&fields[4], &self->priv->longitude)) {
+        /* E/W */
+        if (fields[5].len && fields[5].str[0] == 'W')
+            self->priv->longitude *= -1;
     }
 
-    g_match_info_free (match_info);
+    /* Altitude */
+    self->priv->altitude = MM_LOCATION_ALTITUDE_UNKNOWN;
+    mm_nmea_field_get_double (&fields[9], &self->priv->altitude);
 
     return TRUE;
 }
@@ -371,9 +348,6 @@ finalize (GObject *object)
 {
     MMLocationGpsRaw *self = MM_LOCATION_GPS_RAW (object);
 
-    if (self->priv->gpgga_regex)
-        g_regex_unref (self->priv->gpgga_regex);
-
     G_OBJECT_CLASS (mm_location_gps_raw_parent_class)->finalize (object);
 }
 
@@ -14,6 +14,7 @@
  */
 
 #include <glib-object.h>
+#include <string.h>
 
 #include <libmm-glib.h>
 
@@ -486,6 +487,92 @@ field_parser_double (void)
     g_free (str);
 }
 
+/********************* NMEA TESTS *********************/
+
+#define GGA_TRACE "$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,*76\r\n"
+
+static void
+nmea_test_find (void)
+{
+    const gchar *buffer = "garbage$GPGGA,1\n" GGA_TRACE "$GPGSV,3,2,11\r\n$GPRMC,0925";
+    const gchar *p;
+    gsize start;
+    gsize end;
+
+    /* Lines not ending in <CR><LF> are skipped */
+    g_assert (mm_nmea_trace_find (buffer, strlen (buffer), &start, &end));
+    g_assert_cmpuint (end - start, ==, strlen (GGA_TRACE));
+    g_assert (strncmp (&buffer[start], GGA_TRACE, end - start) == 0);
+
+    p = &buffer[end];
+    g_assert (mm_nmea_trace_find (p, strlen (p), &start, &end));
+    g_assert_cmpuint (start, ==, 0);
+    g_assert (strncmp (p, "$GPGSV,3,2,11\r\n", end) == 0);
+
+    /* The last one is incomplete */
+    p = &p[end];
+    g_assert (!mm_nmea_trace_find (p, strlen (p), &start, &end));
+}
+
+static void
+nmea_test_validate (void)
+{
+    g_assert (mm_nmea_trace_validate (GGA_TRACE, strlen (GGA_TRACE)));
+    g_assert (mm_nmea_trace_validate ("$GPGSV,3,2,11\r\n", strlen ("$GPGSV,3,2,11\r\n")));
+
+    /* Wrong checksum */
+    g_assert (!mm_nmea_trace_validate ("$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,*77",
+                                       strlen ("$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,*77")));
+    /* Truncated checksum */
+    g_assert (!mm_nmea_trace_validate ("$GPGSV,3,2,11*4", strlen ("$GPGSV,3,2,11*4")));
+    /* Not a trace */
+    g_assert (!mm_nmea_trace_validate ("GPGSV,3,2,11", strlen ("GPGSV,3,2,11")));
+}
+
+static void
+nmea_test_tokenize (void)
+{
+    MMNmeaField fields[MM_NMEA_MAX_FIELDS];
+    gdouble altitude;
+    guint n_fields;
+
+    n_fields = mm_nmea_trace_tokenize (GGA_TRACE, strlen (GGA_TRACE), fields, G_N_ELEMENTS (fields));
+    g_assert_cmpuint (n_fields, ==, 15);
+    g_assert (mm_nmea_field_is_sentence (&fields[0], "GGA"));
+    g_assert (!mm_nmea_field_is_sentence (&fields[0], "GSV"));
+    g_assert_cmpuint (fields[1].len, ==, strlen ("092750.000"));
+    g_assert (strncmp (fields[1].str, "092750.000", fields[1].len) == 0);
+    g_assert (mm_nmea_field_get_double (&fields[9], &altitude));
+    g_assert_cmpfloat (altitude - 61.7, <, 0.0001);
+    g_assert_cmpfloat (altitude - 61.7, >, -0.0001);
+    /* The checksum is not part of the last field */
+    g_assert_cmpuint (fields[14].len, ==, 0);
+
+    /* Fields beyond the given ones are ignored */
+    n_fields = mm_nmea_trace_tokenize (GGA_TRACE, strlen (GGA_TRACE), fields, 3);
+    g_assert_cmpuint (n_fields, ==, 3);
+}
+
+static void
+nmea_test_talkers (void)
+{
+    MMNmeaField field;
+
+    field.len = 6;
+    field.str = "$GPGGA";
+    g_assert (mm_nmea_field_is_sentence (&field, "GGA"));
+    field.str = "$GNGGA";
+    g_assert (mm_nmea_field_is_sentence (&field, "GGA"));
+    field.str = "$GLGGA";
+    g_assert (mm_nmea_field_is_sentence (&field, "GGA"));
+    field.str = "$GAGGA";
+    g_assert (mm_nmea_field_is_sentence (&field, "GGA"));
+    field.str = "$XXGGA";
+    g_assert (!mm_nmea_field_is_sentence (&field, "GGA"));
+    field.len = 5;
+    g_assert (!mm_nmea_field_is_sentence (&field, "GGA"));
+}
+
 /**************************************************************/
 
 int main (int argc, char **argv)
@@ -524,5 +611,10 @@ int main (int argc, char **argv)
     g_test_add_func ("/MM/Common/FieldParsers/Uint", field_parser_uint);
     g_test_add_func ("/MM/Common/FieldParsers/Double", field_parser_double);
 
+    g_test_add_func ("/MM/Common/NMEA/find", nmea_test_find);
+    g_test_add_func ("/MM/Common/NMEA/validate", nmea_test_validate);
+    g_test_add_func ("/MM/Common/NMEA/tokenize", nmea_test_tokenize);
+    g_test_add_func ("/MM/Common/NMEA/talkers", nmea_test_talkers);
+
     return g_test_run ();
 }
@@ -1374,6 +1374,8 @@ mm_broadband_modem_telit_new (const gchar *device,
                          MM_BASE_MODEM_PRODUCT_ID, product_id,
                          MM_IFACE_MODEM_SIM_HOT_SWAP_SUPPORTED, TRUE,
                          MM_IFACE_MODEM_SIM_HOT_SWAP_CONFIGURED, FALSE,
+                         /* Telit modules accept compound V.250 command lines */
+                         MM_BROADBAND_MODEM_COMPOUND_AT_COMMANDS, TRUE,
                          NULL);
 }
 
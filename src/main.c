@@ -40,6 +40,13 @@
 static GMainLoop *loop;
 static MMBaseManager *manager;
 
+static gboolean
+shutdown_timeout_cb (gboolean *timed_out)
+{
+    *timed_out = TRUE;
+    return G_SOURCE_REMOVE;
+}
+
 static gboolean
 quit_cb (gpointer user_data)
 {
@@ -185,29 +192,32 @@ main (int argc, char *argv[])
     loop = NULL;
 
     if (manager) {
-        GTimer *timer;
+        gboolean timed_out = FALSE;
+        guint    timeout_id;
 
         mm_base_manager_shutdown (manager, TRUE);
 
         /* Wait for all modems to be disabled and removed, but don't wait
          * forever: if disabling the modems takes longer than 20s, just
          * shutdown anyway. */
-        timer = g_timer_new ();
-        while (mm_base_manager_num_modems (manager) &&
-               g_timer_elapsed (timer, NULL) < (gdouble)MAX_SHUTDOWN_TIME_SECS) {
-            GMainContext *ctx = g_main_loop_get_context (inner);
+        timeout_id = g_timeout_add_seconds (MAX_SHUTDOWN_TIME_SECS,
+                                            (GSourceFunc) shutdown_timeout_cb,
+                                            &timed_out);
+        while (mm_base_manager_num_modems (manager) && !timed_out)
+            g_main_context_iteration (g_main_loop_get_context (inner), TRUE);
 
-            g_main_context_iteration (ctx, FALSE);
-            g_usleep (50);
-        }
+        if (!timed_out)
+            g_source_remove (timeout_id);
 
-        if (mm_base_manager_num_modems (manager))
+        if (mm_base_manager_num_modems (manager)) {
             mm_warn ("Disabling modems took too long, "
                      "shutting down with '%u' modems around",
                      mm_base_manager_num_modems (manager));
+            /* Cancel whatever is still ongoing and remove the modems */
+            mm_base_manager_shutdown (manager, FALSE);
+        }
 
         g_object_unref (manager);
-        g_timer_destroy (timer);
     }
 
     g_main_loop_unref (inner);
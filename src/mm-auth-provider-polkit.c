@@ -26,10 +26,214 @@
 
 G_DEFINE_TYPE (MMAuthProviderPolkit, mm_auth_provider_polkit, MM_TYPE_AUTH_PROVIDER)
 
+/* How long a positive authorization result is reused */
+#define CACHE_TTL_SECS 5
+
 struct _MMAuthProviderPolkitPrivate {
     PolkitAuthority *authority;
+    /* Sender unique name -> CacheSender */
+    GHashTable *cache;
+    guint cache_hits;
+    guint cache_misses;
 };
 
+/*****************************************************************************/
+/* Authorization cache
+ *
+ * Positive results are cached per sender and action for CACHE_TTL_SECS. The
+ * whole sender entry is dropped as soon as the sender goes away from the bus,
+ * so that a new client never gets an old result (unique names are not reused
+ * by the bus daemon anyway). Negative results are never cached, so that a
+ * client which just got the privilege doesn't need to wait.
+ *
+ * A sender may go away while being authorized, before we subscribe to its
+ * NameOwnerChanged signal; so once subscribed, the bus is asked whether the
+ * sender is still there. */
+
+typedef struct {
+    GDBusConnection *connection;
+    guint name_owner_changed_id;
+    /* Action -> expiration time (monotonic, in us) */
+    GHashTable *actions;
+} CacheSender;
+
+static void
+cache_sender_free (CacheSender *sender)
+{
+    g_dbus_connection_signal_unsubscribe (sender->connection, sender->name_owner_changed_id);
+    g_object_unref (sender->connection);
+    g_hash_table_unref (sender->actions);
+    g_free (sender);
+}
+
+static void
+name_owner_changed_cb (GDBusConnection *connection,
+                       const gchar *sender_name,
+                       const gchar *object_path,
+                       const gchar *interface_name,
+                       const gchar *signal_name,
+                       GVariant *parameters,
+                       MMAuthProviderPolkit *self)
+{
+    const gchar *name;
+    const gchar *new_owner;
+
+    g_variant_get (parameters, "(&s&s&s)", &name, NULL, &new_owner);
+    if (new_owner[0] != '\0')
+        return;
+
+    mm_dbg ("PolicyKit cache: sender '%s' gone (%u hits, %u misses)",
+            name, self->priv->cache_hits, self->priv->cache_misses);
+    /* Unsubscribes this very callback, which is fine within GDBus */
+    g_hash_table_remove (self->priv->cache, name);
+}
+
+typedef struct {
+    MMAuthProviderPolkit *self;
+    gchar *sender_name;
+    CacheSender *sender;
+} CheckSenderContext;
+
+static void
+check_sender_context_free (CheckSenderContext *ctx)
+{
+    g_object_unref (ctx->self);
+    g_free (ctx->sender_name);
+    g_free (ctx);
+}
+
+static void
+get_name_owner_ready (GDBusConnection *connection,
+                      GAsyncResult *res,
+                      CheckSenderContext *ctx)
+{
+    GVariant *reply;
+    GError *error = NULL;
+
+    reply = g_dbus_connection_call_finish (connection, res, &error);
+    if (reply)
+        g_variant_unref (reply);
+    else {
+        /* Only drop the entry if it's still the one we checked */
+        if (g_dbus_error_is_remote_error (error) &&
+            ctx->self->priv->cache &&
+            g_hash_table_lookup (ctx->self->priv->cache, ctx->sender_name) == ctx->sender) {
+            mm_dbg ("PolicyKit cache: sender '%s' already gone", ctx->sender_name);
+            g_hash_table_remove (ctx->self->priv->cache, ctx->sender_name);
+        }
+        g_error_free (error);
+    }
+
+    check_sender_context_free (ctx);
+}
+
+static void
+check_sender (MMAuthProviderPolkit *self,
+              GDBusConnection *connection,
+              const gchar *sender_name,
+              CacheSender *sender)
+{
+    CheckSenderContext *ctx;
+
+    ctx = g_new (CheckSenderContext, 1);
+    ctx->self = g_object_ref (self);
+    ctx->sender_name = g_strdup (sender_name);
+    ctx->sender = sender;
+
+    g_dbus_connection_call (connection,
+                            "org.freedesktop.DBus",
+                            "/org/freedesktop/DBus",
+                            "org.freedesktop.DBus",
+                            "GetNameOwner",
+                            g_variant_new ("(s)", sender_name),
+                            G_VARIANT_TYPE ("(s)"),
+                            G_DBUS_CALL_FLAGS_NONE,
+                            -1,
+                            NULL,
+                            (GAsyncReadyCallback)get_name_owner_ready,
+                            ctx);
+}
+
+static gboolean
+cache_lookup (MMAuthProviderPolkit *self,
+              const gchar *sender_name,
+              const gchar *authorization)
+{
+    CacheSender *sender;
+    gpointer expiration;
+
+    /* Peer-to-peer connections have no sender */
+    if (!sender_name)
+        return FALSE;
+
+    sender = g_hash_table_lookup (self->priv->cache, sender_name);
+    if (sender && g_hash_table_lookup_extended (sender->actions, authorization, NULL, &expiration)) {
+        if (g_get_monotonic_time () < *((gint64 *)expiration)) {
+            self->priv->cache_hits++;
+            return TRUE;
+        }
+        g_hash_table_remove (sender->actions, authorization);
+    }
+
+    self->priv->cache_misses++;
+    mm_dbg ("PolicyKit cache miss for '%s' from '%s' (%u hits, %u misses)",
+            authorization,
+            sender_name,
+            self->priv->cache_hits,
+            self->priv->cache_misses);
+    return FALSE;
+}
+
+static void
+cache_add (MMAuthProviderPolkit *self,
+           GDBusConnection *connection,
+           const gchar *sender_name,
+           const gchar *authorization)
+{
+    CacheSender *sender;
+    gint64 *expiration;
+
+    if (!sender_name)
+        return;
+
+    sender = g_hash_table_lookup (self->priv->cache, sender_name);
+    if (!sender) {
+        sender = g_new0 (CacheSender, 1);
+        sender->connection = g_object_ref (connection);
+        sender->actions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+        sender->name_owner_changed_id =
+            g_dbus_connection_signal_subscribe (connection,
+                                                "org.freedesktop.DBus",
+                                                "org.freedesktop.DBus",
+                                                "NameOwnerChanged",
+                                                "/org/freedesktop/DBus",
+                                                sender_name, /* arg0 */
+                                                G_DBUS_SIGNAL_FLAGS_NONE,
+                                                (GDBusSignalCallback)name_owner_changed_cb,
+                                                self,
+                                                NULL);
+        g_hash_table_insert (self->priv->cache, g_strdup (sender_name), sender);
+        check_sender (self, connection, sender_name, sender);
+    }
+
+    expiration = g_new (gint64, 1);
+    *expiration = g_get_monotonic_time () + (CACHE_TTL_SECS * G_USEC_PER_SEC);
+    g_hash_table_replace (sender->actions, g_strdup (authorization), expiration);
+}
+
+void
+mm_auth_provider_polkit_get_cache_stats (MMAuthProviderPolkit *self,
+                                         guint *hits,
+                                         guint *misses)
+{
+    g_return_if_fail (MM_IS_AUTH_PROVIDER_POLKIT (self));
+
+    if (hits)
+        *hits = self->priv->cache_hits;
+    if (misses)
+        *misses = self->priv->cache_misses;
+}
+
 /*****************************************************************************/
 
 MMAuthProvider *
@@ -41,6 +245,7 @@ mm_auth_provider_polkit_new (void)
 /*****************************************************************************/
 
 typedef struct {
+    MMAuthProviderPolkit *self;
     PolkitSubject *subject;
     gchar *authorization;
     GDBusMethodInvocation *invocation;
@@ -49,6 +254,7 @@ typedef struct {
 static void
 authorize_context_free (AuthorizeContext *ctx)
 {
+    g_object_unref (ctx->self);
     g_object_unref (ctx->invocation);
     g_object_unref (ctx->subject);
     g_free (ctx->authorization);
@@ -87,10 +293,14 @@ check_authorization_ready (PolkitAuthority *authority,
                                  error->message);
         g_error_free (error);
     } else {
-        if (polkit_authorization_result_get_is_authorized (pk_result))
+        if (polkit_authorization_result_get_is_authorized (pk_result)) {
             /* Good! */
+            cache_add (ctx->self,
+                       g_dbus_method_invocation_get_connection (ctx->invocation),
+                       g_dbus_method_invocation_get_sender (ctx->invocation),
+                       ctx->authorization);
             g_task_return_boolean (task, TRUE);
-        else if (polkit_authorization_result_get_is_challenge (pk_result))
+        } else if (polkit_authorization_result_get_is_challenge (pk_result))
             g_task_return_new_error (task,
                                      MM_CORE_ERROR,
                                      MM_CORE_ERROR_UNAUTHORIZED,
@@ -135,12 +345,19 @@ authorize (MMAuthProvider *self,
         return;
     }
 
+    task = g_task_new (self, cancellable, callback, user_data);
+
+    if (cache_lookup (polkit, g_dbus_method_invocation_get_sender (invocation), authorization)) {
+        g_task_return_boolean (task, TRUE);
+        g_object_unref (task);
+        return;
+    }
+
     ctx = g_new (AuthorizeContext, 1);
+    ctx->self = g_object_ref (polkit);
     ctx->invocation = g_object_ref (invocation);
     ctx->authorization = g_strdup (authorization);
     ctx->subject = polkit_system_bus_name_new (g_dbus_method_invocation_get_sender (ctx->invocation));
-
-    task = g_task_new (self, cancellable, callback, user_data);
     g_task_set_task_data (task, ctx, (GDestroyNotify)authorize_context_free);
 
     polkit_authority_check_authorization (polkit->priv->authority,
@@ -164,6 +381,11 @@ mm_auth_provider_polkit_init (MMAuthProviderPolkit *self)
                                               MM_TYPE_AUTH_PROVIDER_POLKIT,
                                               MMAuthProviderPolkitPrivate);
 
+    self->priv->cache = g_hash_table_new_full (g_str_hash,
+                                               g_str_equal,
+                                               g_free,
+                                               (GDestroyNotify)cache_sender_free);
+
     self->priv->authority = polkit_authority_get_sync (NULL, &error);
     if (!self->priv->authority) {
         /* NOTE: we failed to create the polkit authority, but we still create
@@ -177,7 +399,13 @@ mm_auth_provider_polkit_init (MMAuthProviderPolkit *self)
 static void
 dispose (GObject *object)
 {
-    g_clear_object (&(MM_AUTH_PROVIDER_POLKIT (object)->priv->authority));
+    MMAuthProviderPolkit *self = MM_AUTH_PROVIDER_POLKIT (object);
+
+    if (self->priv->cache) {
+        g_hash_table_unref (self->priv->cache);
+        self->priv->cache = NULL;
+    }
+    g_clear_object (&self->priv->authority);
 
     G_OBJECT_CLASS (mm_auth_provider_polkit_parent_class)->dispose (object);
 }
@@ -43,4 +43,8 @@ GType mm_auth_provider_polkit_get_type (void);
 
 MMAuthProvider *mm_auth_provider_polkit_new (void);
 
+void mm_auth_provider_polkit_get_cache_stats (MMAuthProviderPolkit *self,
+                                              guint *hits,
+                                              guint *misses);
+
 #endif /* MM_AUTH_PROVIDER_POLKIT_H */
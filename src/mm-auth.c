@@ -20,6 +20,7 @@
 
 #include "mm-auth.h"
 #include "mm-auth-provider.h"
+#include "mm-log.h"
 
 #if defined WITH_POLKIT
 # include "mm-auth-provider-polkit.h"
@@ -48,6 +49,16 @@ mm_auth_get_provider (void)
 void
 mm_auth_shutdown (void)
 {
+#if defined WITH_POLKIT
+    if (authp) {
+        guint hits;
+        guint misses;
+
+        mm_auth_provider_polkit_get_cache_stats (MM_AUTH_PROVIDER_POLKIT (authp), &hits, &misses);
+        mm_dbg ("PolicyKit authorization cache: %u hits, %u misses", hits, misses);
+    }
+#endif
+
     /* Clear the last reference of the auth provider if it was ever set */
     g_clear_object (&authp);
 }
@@ -38,6 +38,7 @@
 #include "mm-log.h"
 #include "mm-modem-helpers.h"
 #include "mm-bearer-stats.h"
+#include "mm-context.h"
 
 /* We require up to 20s to get a proper IP when using PPP */
 #define BEARER_IP_TIMEOUT_DEFAULT 20
@@ -46,12 +47,23 @@
 
 #define BEARER_STATS_UPDATE_TIMEOUT 30
 
-/* Initial connectivity check after 30s, then each 5s */
-#define BEARER_CONNECTION_MONITOR_INITIAL_TIMEOUT 30
-#define BEARER_CONNECTION_MONITOR_TIMEOUT          5
+/* Weight (in %) of the newest sample in the moving average of the throughput
+ * computed from the kernel counters */
+#define BEARER_KERNEL_STATS_AVERAGE_WEIGHT 20
+
+/* Initial connectivity check after 30s, then each 5s. The polling interval is
+ * doubled every time the connection is found to be stable, up to a maximum
+ * which is larger if the modem also reports connection status changes via
+ * unsolicited messages. Any hint of connection loss resets the interval. */
+#define BEARER_CONNECTION_MONITOR_INITIAL_TIMEOUT             30
+#define BEARER_CONNECTION_MONITOR_TIMEOUT                      5
+#define BEARER_CONNECTION_MONITOR_MAX_TIMEOUT                 60
+#define BEARER_CONNECTION_MONITOR_MAX_TIMEOUT_WITH_INDICATIONS 300
 
 G_DEFINE_TYPE (MMBaseBearer, mm_base_bearer, MM_GDBUS_TYPE_BEARER_SKELETON)
 
+typedef struct _KernelStats KernelStats;
+
 typedef enum {
     CONNECTION_FORBIDDEN_REASON_NONE,
     CONNECTION_FORBIDDEN_REASON_UNREGISTERED,
@@ -94,8 +106,14 @@ struct _MMBaseBearerPrivate {
 
     /* Connection status monitoring */
     guint connection_monitor_id;
+    /* Current connection monitoring polling interval */
+    guint connection_monitor_timeout;
+    /* Whether a check was requested while another one was ongoing */
+    gboolean connection_monitor_check_requested;
     /* Flag to specify whether connection monitoring is supported or not */
     gboolean load_connection_status_unsupported;
+    /* Flag to specify whether connection loss is reported via indications */
+    gboolean connection_status_indications;
 
     /*-- 3GPP specific --*/
     guint deferred_3gpp_unregistration_id;
@@ -120,6 +138,8 @@ struct _MMBaseBearerPrivate {
     GTimer *duration_timer;
     /* Flag to specify whether reloading stats is supported or not */
     gboolean reload_stats_unsupported;
+    /* Stats sampled from the kernel counters of the data interface */
+    KernelStats *kernel_stats;
 };
 
 /*****************************************************************************/
@@ -148,15 +168,54 @@ mm_base_bearer_export (MMBaseBearer *self)
 
 /*****************************************************************************/
 
+static gboolean connection_monitor_cb (MMBaseBearer *self);
+
 static void
 connection_monitor_stop (MMBaseBearer *self)
 {
     if (self->priv->connection_monitor_id) {
-        g_source_remove (self->priv->connection_monitor_id);
+        mm_base_modem_poll_remove (self->priv->modem, self->priv->connection_monitor_id);
         self->priv->connection_monitor_id = 0;
     }
 }
 
+static void
+connection_monitor_schedule (MMBaseBearer *self,
+                             guint         timeout)
+{
+    connection_monitor_stop (self);
+    self->priv->connection_monitor_id = mm_base_modem_poll_add (self->priv->modem,
+                                                                MM_BASE_MODEM_POLL_CONNECTION_MONITOR,
+                                                                timeout,
+                                                                (GSourceFunc) connection_monitor_cb,
+                                                                self);
+}
+
+static void
+connection_monitor_reschedule (MMBaseBearer *self,
+                               gboolean      stable)
+{
+    guint max_timeout;
+
+    /* Only if still connected and nothing else already scheduled */
+    if (self->priv->status != MM_BEARER_STATUS_CONNECTED ||
+        self->priv->load_connection_status_unsupported ||
+        self->priv->connection_monitor_id)
+        return;
+
+    /* Don't back off right after an explicit check request */
+    if (stable && !self->priv->connection_monitor_check_requested) {
+        max_timeout = (self->priv->connection_status_indications ?
+                       BEARER_CONNECTION_MONITOR_MAX_TIMEOUT_WITH_INDICATIONS :
+                       BEARER_CONNECTION_MONITOR_MAX_TIMEOUT);
+        self->priv->connection_monitor_timeout = MIN (self->priv->connection_monitor_timeout * 2, max_timeout);
+    } else
+        self->priv->connection_monitor_timeout = BEARER_CONNECTION_MONITOR_TIMEOUT;
+    self->priv->connection_monitor_check_requested = FALSE;
+
+    connection_monitor_schedule (self, self->priv->connection_monitor_timeout);
+}
+
 static void
 load_connection_status_ready (MMBaseBearer *self,
                               GAsyncResult *res)
@@ -170,6 +229,8 @@ load_connection_status_ready (MMBaseBearer *self,
         if (!g_error_matches (error, MM_CORE_ERROR, MM_CORE_ERROR_UNSUPPORTED)) {
             mm_warn ("checking if connected failed: %s", error->message);
             g_error_free (error);
+            /* Check again soon */
+            connection_monitor_reschedule (self, FALSE);
             return;
         }
 
@@ -186,33 +247,21 @@ load_connection_status_ready (MMBaseBearer *self,
     g_assert (status == MM_BEARER_CONNECTION_STATUS_CONNECTED || status == MM_BEARER_CONNECTION_STATUS_DISCONNECTED);
     mm_dbg ("connection status loaded: %s", mm_bearer_connection_status_get_string (status));
     mm_base_bearer_report_connection_status (self, status);
+
+    /* Back off if the connection is stable */
+    connection_monitor_reschedule (self, status == MM_BEARER_CONNECTION_STATUS_CONNECTED);
 }
 
 static gboolean
 connection_monitor_cb (MMBaseBearer *self)
 {
-    /* If the implementation knows how to load connection status, run it */
-    MM_BASE_BEARER_GET_CLASS (self)->load_connection_status (
-        self,
-        (GAsyncReadyCallback)load_connection_status_ready,
-        NULL);
-    return G_SOURCE_CONTINUE;
-}
+    /* The next check is scheduled once this one is finished */
+    self->priv->connection_monitor_id = 0;
 
-static gboolean
-initial_connection_monitor_cb (MMBaseBearer *self)
-{
     MM_BASE_BEARER_GET_CLASS (self)->load_connection_status (
         self,
         (GAsyncReadyCallback)load_connection_status_ready,
         NULL);
-
-    /* Add new monitor timeout at a higher rate */
-    self->priv->connection_monitor_id = g_timeout_add_seconds (BEARER_CONNECTION_MONITOR_TIMEOUT,
-                                                               (GSourceFunc) connection_monitor_cb,
-                                                               self);
-
-    /* Remove the initial connection monitor timeout as we added a new one */
     return G_SOURCE_REMOVE;
 }
 
@@ -229,9 +278,214 @@ connection_monitor_start (MMBaseBearer *self)
 
     /* Schedule initial check */
     g_assert (!self->priv->connection_monitor_id);
-    self->priv->connection_monitor_id = g_timeout_add_seconds (BEARER_CONNECTION_MONITOR_INITIAL_TIMEOUT,
-                                                               (GSourceFunc) initial_connection_monitor_cb,
-                                                               self);
+    self->priv->connection_monitor_timeout = BEARER_CONNECTION_MONITOR_TIMEOUT;
+    self->priv->connection_monitor_check_requested = FALSE;
+    connection_monitor_schedule (self, BEARER_CONNECTION_MONITOR_INITIAL_TIMEOUT);
+}
+
+void
+mm_base_bearer_check_connection_status (MMBaseBearer *self)
+{
+    /* Only if connection monitoring is running */
+    if (self->priv->status != MM_BEARER_STATUS_CONNECTED ||
+        self->priv->load_connection_status_unsupported ||
+        !MM_BASE_BEARER_GET_CLASS (self)->load_connection_status ||
+        !MM_BASE_BEARER_GET_CLASS (self)->load_connection_status_finish)
+        return;
+
+    mm_dbg ("Connection status check requested, polling at fast rate");
+    self->priv->connection_monitor_timeout = BEARER_CONNECTION_MONITOR_TIMEOUT;
+
+    /* If a check is ongoing, the next one will be scheduled at the fast rate */
+    if (self->priv->connection_monitor_id)
+        connection_monitor_schedule (self, BEARER_CONNECTION_MONITOR_TIMEOUT);
+    else
+        self->priv->connection_monitor_check_requested = TRUE;
+}
+
+void
+mm_base_bearer_set_connection_status_indications (MMBaseBearer *self,
+                                                  gboolean      supported)
+{
+    self->priv->connection_status_indications = supported;
+}
+
+/*****************************************************************************/
+/* Kernel counters based stats
+ *
+ * When the bearer exposes a network interface, the rx/tx byte counters are
+ * read from sysfs, which is cheap enough to be done at sub-second rates and
+ * doesn't require any modem round-trip. The high rate samples are used to
+ * compute the current, peak and average throughput. */
+
+struct _KernelStats {
+    gchar   *interface;
+    guint    sample_id;
+    guint    n_samples;
+    gint64   timestamp;
+    guint64  rx_last;
+    guint64  tx_last;
+    /* Totals accumulated during the connection */
+    guint64  rx_bytes;
+    guint64  tx_bytes;
+    /* Rates, in bytes per second */
+    guint64  rx_rate;
+    guint64  tx_rate;
+    guint64  rx_peak_rate;
+    guint64  tx_peak_rate;
+    gdouble  rx_average_rate;
+    gdouble  tx_average_rate;
+};
+
+static gboolean
+read_kernel_counter (const gchar *interface,
+                     const gchar *counter,
+                     guint64     *value)
+{
+    gchar    *path;
+    gchar    *contents = NULL;
+    gchar    *end = NULL;
+    gboolean  ret = FALSE;
+
+    path = g_strdup_printf ("/sys/class/net/%s/statistics/%s", interface, counter);
+    if (g_file_get_contents (path, &contents, NULL, NULL)) {
+        *value = g_ascii_strtoull (contents, &end, 10);
+        ret = (end && end != contents);
+        g_free (contents);
+    }
+    g_free (path);
+    return ret;
+}
+
+static gboolean
+read_kernel_counters (const gchar *interface,
+                      guint64     *rx_bytes,
+                      guint64     *tx_bytes)
+{
+    return (read_kernel_counter (interface, "rx_bytes", rx_bytes) &&
+            read_kernel_counter (interface, "tx_bytes", tx_bytes));
+}
+
+static void
+kernel_stats_update_direction (guint64  current,
+                               guint64 *last,
+                               guint64 *total,
+                               guint64 *rate,
+                               guint64 *peak_rate,
+                               gdouble *average_rate,
+                               gdouble  elapsed,
+                               gboolean first_sample)
+{
+    guint64 delta;
+
+    /* If the counter went backwards, the interface was re-created and the
+     * kernel started counting again from 0 */
+    delta = (current >= *last) ? (current - *last) : current;
+    *last = current;
+    *total += delta;
+
+    *rate = (guint64) (delta / elapsed);
+    if (*rate > *peak_rate)
+        *peak_rate = *rate;
+
+    if (first_sample)
+        *average_rate = *rate;
+    else
+        *average_rate += (((gdouble) *rate - *average_rate) * BEARER_KERNEL_STATS_AVERAGE_WEIGHT) / 100.0;
+}
+
+static gboolean
+kernel_stats_sample_cb (MMBaseBearer *self)
+{
+    KernelStats *ks = self->priv->kernel_stats;
+    guint64      rx_bytes;
+    guint64      tx_bytes;
+    gint64       now;
+    gdouble      elapsed;
+
+    if (!read_kernel_counters (ks->interface, &rx_bytes, &tx_bytes)) {
+        mm_dbg ("Couldn't read kernel counters of interface '%s'", ks->interface);
+        return G_SOURCE_CONTINUE;
+    }
+
+    now = g_get_monotonic_time ();
+    elapsed = (gdouble) (now - ks->timestamp) / G_USEC_PER_SEC;
+    if (elapsed <= 0.0)
+        return G_SOURCE_CONTINUE;
+    ks->timestamp = now;
+
+    kernel_stats_update_direction (rx_bytes, &ks->rx_last, &ks->rx_bytes,
+                                   &ks->rx_rate, &ks->rx_peak_rate, &ks->rx_average_rate,
+                                   elapsed, ks->n_samples == 0);
+    kernel_stats_update_direction (tx_bytes, &ks->tx_last, &ks->tx_bytes,
+                                   &ks->tx_rate, &ks->tx_peak_rate, &ks->tx_average_rate,
+                                   elapsed, ks->n_samples == 0);
+    ks->n_samples++;
+
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+kernel_stats_stop (MMBaseBearer *self)
+{
+    KernelStats *ks = self->priv->kernel_stats;
+
+    if (!ks)
+        return;
+
+    if (ks->sample_id)
+        g_source_remove (ks->sample_id);
+    g_free (ks->interface);
+    g_slice_free (KernelStats, ks);
+    self->priv->kernel_stats = NULL;
+}
+
+static void
+kernel_stats_start (MMBaseBearer *self)
+{
+    KernelStats *ks;
+    const gchar *interface;
+    guint        interval;
+    guint64      rx_bytes;
+    guint64      tx_bytes;
+
+    g_assert (!self->priv->kernel_stats);
+
+    interval = mm_context_get_bearer_stats_sampling_interval ();
+    if (!interval)
+        return;
+
+    /* Only network interfaces have kernel counters; e.g. PPP over a TTY won't
+     * have any, and the stats reported by the modem will be used instead */
+    interface = mm_gdbus_bearer_get_interface (MM_GDBUS_BEARER (self));
+    if (!interface || !read_kernel_counters (interface, &rx_bytes, &tx_bytes)) {
+        mm_dbg ("Kernel counters unavailable in interface '%s'", interface ? interface : "unknown");
+        return;
+    }
+
+    mm_dbg ("Sampling kernel counters of interface '%s' every %ums", interface, interval);
+    ks = g_slice_new0 (KernelStats);
+    ks->interface = g_strdup (interface);
+    ks->timestamp = g_get_monotonic_time ();
+    ks->rx_last = rx_bytes;
+    ks->tx_last = tx_bytes;
+    ks->sample_id = g_timeout_add (interval, (GSourceFunc) kernel_stats_sample_cb, self);
+    self->priv->kernel_stats = ks;
+}
+
+static void
+kernel_stats_apply (MMBaseBearer *self)
+{
+    KernelStats *ks = self->priv->kernel_stats;
+
+    mm_bearer_stats_set_rx_bytes        (self->priv->stats, ks->rx_bytes);
+    mm_bearer_stats_set_tx_bytes        (self->priv->stats, ks->tx_bytes);
+    mm_bearer_stats_set_rx_rate         (self->priv->stats, ks->rx_rate);
+    mm_bearer_stats_set_tx_rate         (self->priv->stats, ks->tx_rate);
+    mm_bearer_stats_set_rx_peak_rate    (self->priv->stats, ks->rx_peak_rate);
+    mm_bearer_stats_set_tx_peak_rate    (self->priv->stats, ks->tx_peak_rate);
+    mm_bearer_stats_set_rx_average_rate (self->priv->stats, (guint64) ks->rx_average_rate);
+    mm_bearer_stats_set_tx_average_rate (self->priv->stats, (guint64) ks->tx_average_rate);
 }
 
 /*****************************************************************************/
@@ -254,6 +508,12 @@ bearer_reset_interface_stats (MMBaseBearer *self)
 static void
 bearer_stats_stop (MMBaseBearer *self)
 {
+    if (self->priv->kernel_stats) {
+        if (self->priv->stats)
+            kernel_stats_apply (self);
+        kernel_stats_stop (self);
+    }
+
     if (self->priv->duration_timer) {
         if (self->priv->stats)
             mm_bearer_stats_set_duration (self->priv->stats, (guint64) g_timer_elapsed (self->priv->duration_timer, NULL));
@@ -262,7 +522,7 @@ bearer_stats_stop (MMBaseBearer *self)
     }
 
     if (self->priv->stats_update_id) {
-        g_source_remove (self->priv->stats_update_id);
+        mm_base_modem_poll_remove (self->priv->modem, self->priv->stats_update_id);
         self->priv->stats_update_id = 0;
     }
 }
@@ -302,6 +562,14 @@ reload_stats_ready (MMBaseBearer *self,
 static gboolean
 stats_update_cb (MMBaseBearer *self)
 {
+    /* If the kernel counters are being sampled, prefer them */
+    if (self->priv->kernel_stats) {
+        mm_bearer_stats_set_duration (self->priv->stats, (guint32) g_timer_elapsed (self->priv->duration_timer, NULL));
+        kernel_stats_apply (self);
+        bearer_update_interface_stats (self);
+        return G_SOURCE_CONTINUE;
+    }
+
     /* If the implementation knows how to update stat values, run it */
     if (!self->priv->reload_stats_unsupported &&
         MM_BASE_BEARER_GET_CLASS (self)->reload_stats &&
@@ -333,11 +601,16 @@ bearer_stats_start (MMBaseBearer *self)
     g_assert (!self->priv->duration_timer);
     self->priv->duration_timer = g_timer_new ();
 
+    /* Start sampling kernel counters, if requested and available */
+    kernel_stats_start (self);
+
     /* Schedule */
     g_assert (!self->priv->stats_update_id);
-    self->priv->stats_update_id = g_timeout_add_seconds (BEARER_STATS_UPDATE_TIMEOUT,
-                                                         (GSourceFunc) stats_update_cb,
-                                                         self);
+    self->priv->stats_update_id = mm_base_modem_poll_add (self->priv->modem,
+                                                          MM_BASE_MODEM_POLL_BEARER_STATS,
+                                                          BEARER_STATS_UPDATE_TIMEOUT,
+                                                          (GSourceFunc) stats_update_cb,
+                                                          self);
     /* Load initial values */
     stats_update_cb (self);
 }
@@ -508,8 +781,10 @@ modem_3gpp_registration_state_changed (MMIfaceModem3gpp *modem,
             return;
         }
 
-        /* Otherwise, setup the new timeout */
+        /* Otherwise, setup the new timeout, and check the connection
+         * status more often meanwhile */
         mm_dbg ("Connected bearer not registered in 3GPP network");
+        mm_base_bearer_check_connection_status (self);
         self->priv->deferred_3gpp_unregistration_id =
             g_timeout_add_seconds (BEARER_DEFERRED_UNREGISTRATION_TIMEOUT,
                                    (GSourceFunc) deferred_3gpp_unregistration_cb,
@@ -587,8 +862,10 @@ modem_cdma_registration_state_changed (MMIfaceModemCdma *modem,
             return;
         }
 
-        /* Otherwise, setup the new timeout */
+        /* Otherwise, setup the new timeout, and check the connection
+         * status more often meanwhile */
         mm_dbg ("Connected bearer not registered in CDMA network");
+        mm_base_bearer_check_connection_status (self);
         self->priv->deferred_cdma_unregistration_id =
             g_timeout_add_seconds (BEARER_DEFERRED_UNREGISTRATION_TIMEOUT,
                                    (GSourceFunc) deferred_cdma_unregistration_cb,
@@ -157,4 +157,13 @@ void mm_base_bearer_disconnect_force (MMBaseBearer *self);
 void mm_base_bearer_report_connection_status (MMBaseBearer *self,
                                               MMBearerConnectionStatus status);
 
+/* Request the connection monitor to poll at fast rate, e.g. when there is
+ * a hint of connection loss */
+void mm_base_bearer_check_connection_status (MMBaseBearer *self);
+
+/* Let the connection monitor know whether connection loss is reported via
+ * unsolicited indications, so that polling may back off further */
+void mm_base_bearer_set_connection_status_indications (MMBaseBearer *self,
+                                                       gboolean      supported);
+
 #endif /* MM_BASE_BEARER_H */
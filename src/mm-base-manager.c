@@ -36,11 +36,18 @@
 
 #include "mm-base-manager.h"
 #include "mm-device.h"
+#include "mm-iface-modem.h"
+#include "mm-bearer-list.h"
+#include "mm-base-bearer.h"
+#include "mm-modem-status-tracker.h"
 #include "mm-plugin-manager.h"
 #include "mm-auth.h"
 #include "mm-plugin.h"
 #include "mm-log.h"
 
+/* Maximum number of modems being disabled at the same time during shutdown */
+#define MAX_PARALLEL_DISABLE_OPERATIONS 4
+
 static void initable_iface_init (GInitableIface *iface);
 
 G_DEFINE_TYPE_EXTENDED (MMBaseManager, mm_base_manager, MM_GDBUS_TYPE_ORG_FREEDESKTOP_MODEM_MANAGER1_SKELETON, 0,
@@ -77,6 +84,11 @@ struct _MMBaseManagerPrivate {
     GHashTable *devices;
     /* The Object Manager server */
     GDBusObjectManagerServer *object_manager;
+    /* Modems waiting to be disabled during shutdown */
+    GList *disable_pending;
+    guint n_disable_ongoing;
+    /* Change tracking for GetModemStatus() */
+    MMModemStatusTracker *status_tracker;
 
     /* The Test interface support */
     MmGdbusTest *test_skeleton;
@@ -580,6 +592,8 @@ mm_base_manager_start (MMBaseManager *self,
 
 /*****************************************************************************/
 
+static void disable_next_modems (MMBaseManager *self);
+
 static void
 remove_disable_ready (MMBaseModem *modem,
                       GAsyncResult *res,
@@ -596,6 +610,30 @@ remove_disable_ready (MMBaseModem *modem,
         mm_device_remove_modem (device);
         g_hash_table_remove (self->priv->devices, device);
     }
+
+    g_assert (self->priv->n_disable_ongoing > 0);
+    self->priv->n_disable_ongoing--;
+    disable_next_modems (self);
+}
+
+static void
+disable_next_modems (MMBaseManager *self)
+{
+    while (self->priv->disable_pending &&
+           self->priv->n_disable_ongoing < MAX_PARALLEL_DISABLE_OPERATIONS) {
+        MMBaseModem *modem;
+
+        modem = MM_BASE_MODEM (self->priv->disable_pending->data);
+        self->priv->disable_pending = g_list_delete_link (self->priv->disable_pending,
+                                                          self->priv->disable_pending);
+
+        /* The modem may have been removed while waiting */
+        if (find_device_by_modem (self, modem)) {
+            self->priv->n_disable_ongoing++;
+            mm_base_modem_disable (modem, (GAsyncReadyCallback)remove_disable_ready, self);
+        }
+        g_object_unref (modem);
+    }
 }
 
 static void
@@ -607,7 +645,8 @@ foreach_disable (gpointer key,
 
     modem = mm_device_peek_modem (device);
     if (modem)
-        mm_base_modem_disable (modem, (GAsyncReadyCallback)remove_disable_ready, self);
+        self->priv->disable_pending = g_list_prepend (self->priv->disable_pending,
+                                                      g_object_ref (modem));
 }
 
 static gboolean
@@ -635,7 +674,10 @@ mm_base_manager_shutdown (MMBaseManager *self,
     g_cancellable_cancel (self->priv->authp_cancellable);
 
     if (disable) {
+        /* Modems are disabled in parallel, but only a few at a time, so
+         * that the system doesn't get flooded with requests */
         g_hash_table_foreach (self->priv->devices, (GHFunc)foreach_disable, self);
+        disable_next_modems (self);
 
         /* Disabling may take a few iterations of the mainloop, so the caller
          * has to iterate the mainloop until all devices have been disabled and
@@ -644,7 +686,10 @@ mm_base_manager_shutdown (MMBaseManager *self,
         return;
     }
 
-    /* Otherwise, just remove directly */
+    /* Otherwise, just remove directly, including those modems that were
+     * still waiting to be disabled */
+    g_list_free_full (self->priv->disable_pending, g_object_unref);
+    self->priv->disable_pending = NULL;
     g_hash_table_foreach_remove (self->priv->devices, (GHRFunc)foreach_remove, self);
 }
 
@@ -865,6 +910,155 @@ handle_report_kernel_event (MmGdbusOrgFreedesktopModemManager1 *manager,
     return TRUE;
 }
 
+/*****************************************************************************/
+/* Modem status */
+
+typedef struct {
+    gboolean connected;
+    guint64 rx_bytes;
+    guint64 tx_bytes;
+} BearerStatus;
+
+static void
+collect_bearer_status (MMBaseBearer *bearer,
+                       BearerStatus *status)
+{
+    GVariant *stats;
+
+    if (!mm_gdbus_bearer_get_connected (MM_GDBUS_BEARER (bearer)))
+        return;
+
+    status->connected = TRUE;
+    stats = mm_gdbus_bearer_get_stats (MM_GDBUS_BEARER (bearer));
+    if (stats) {
+        guint64 value;
+
+        if (g_variant_lookup (stats, "rx-bytes", "t", &value))
+            status->rx_bytes += value;
+        if (g_variant_lookup (stats, "tx-bytes", "t", &value))
+            status->tx_bytes += value;
+    }
+}
+
+/* Built only from the values already exposed in the modem interfaces, the
+ * modem itself is never queried here. */
+static GVariant *
+build_modem_status (MMBaseModem *modem)
+{
+    GVariantBuilder builder;
+    MmGdbusModem *modem_iface;
+    MmGdbusModem3gpp *modem_3gpp_iface;
+    MMBearerList *bearer_list = NULL;
+    BearerStatus bearer_status = { 0 };
+    GVariant *signal_quality;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+
+    modem_iface = mm_gdbus_object_peek_modem (MM_GDBUS_OBJECT (modem));
+    if (modem_iface) {
+        g_variant_builder_add (&builder, "{sv}", "state",
+                               g_variant_new_int32 (mm_gdbus_modem_get_state (modem_iface)));
+        g_variant_builder_add (&builder, "{sv}", "access-technologies",
+                               g_variant_new_uint32 (mm_gdbus_modem_get_access_technologies (modem_iface)));
+        signal_quality = mm_gdbus_modem_get_signal_quality (modem_iface);
+        if (signal_quality) {
+            guint quality = 0;
+
+            g_variant_get (signal_quality, "(ub)", &quality, NULL);
+            g_variant_builder_add (&builder, "{sv}", "signal-quality", g_variant_new_uint32 (quality));
+        }
+    }
+
+    modem_3gpp_iface = mm_gdbus_object_peek_modem3gpp (MM_GDBUS_OBJECT (modem));
+    if (modem_3gpp_iface) {
+        const gchar *str;
+
+        g_variant_builder_add (&builder, "{sv}", "registration-state",
+                               g_variant_new_uint32 (mm_gdbus_modem3gpp_get_registration_state (modem_3gpp_iface)));
+        str = mm_gdbus_modem3gpp_get_operator_code (modem_3gpp_iface);
+        if (str)
+            g_variant_builder_add (&builder, "{sv}", "operator-code", g_variant_new_string (str));
+        str = mm_gdbus_modem3gpp_get_operator_name (modem_3gpp_iface);
+        if (str)
+            g_variant_builder_add (&builder, "{sv}", "operator-name", g_variant_new_string (str));
+    }
+
+    if (MM_IS_IFACE_MODEM (modem))
+        g_object_get (modem,
+                      MM_IFACE_MODEM_BEARER_LIST, &bearer_list,
+                      NULL);
+    if (bearer_list) {
+        mm_bearer_list_foreach (bearer_list,
+                                (MMBearerListForeachFunc)collect_bearer_status,
+                                &bearer_status);
+        g_object_unref (bearer_list);
+    }
+    g_variant_builder_add (&builder, "{sv}", "bearer-connected", g_variant_new_boolean (bearer_status.connected));
+    g_variant_builder_add (&builder, "{sv}", "rx-bytes", g_variant_new_uint64 (bearer_status.rx_bytes));
+    g_variant_builder_add (&builder, "{sv}", "tx-bytes", g_variant_new_uint64 (bearer_status.tx_bytes));
+
+    return g_variant_builder_end (&builder);
+}
+
+static void
+refresh_modem_status (MMBaseManager *self)
+{
+    GVariantBuilder builder;
+    GHashTableIter iter;
+    MMDevice *device;
+    GVariant *records;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{oa{sv}}"));
+    g_hash_table_iter_init (&iter, self->priv->devices);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&device)) {
+        MMBaseModem *modem;
+        const gchar *path;
+
+        /* Only modems already exported */
+        modem = mm_device_peek_modem (device);
+        if (!modem)
+            continue;
+        path = g_dbus_object_get_object_path (G_DBUS_OBJECT (modem));
+        if (!path)
+            continue;
+        g_variant_builder_add (&builder, "{o@a{sv}}", path, build_modem_status (modem));
+    }
+
+    records = g_variant_ref_sink (g_variant_builder_end (&builder));
+    mm_modem_status_tracker_refresh (self->priv->status_tracker, records);
+    g_variant_unref (records);
+}
+
+static gboolean
+handle_get_modem_status (MmGdbusOrgFreedesktopModemManager1 *manager,
+                         GDBusMethodInvocation *invocation,
+                         GVariant *options)
+{
+    MMBaseManager *self = MM_BASE_MANAGER (manager);
+    GVariant *since_variant;
+    GVariant *changes;
+    GVariant *removed = NULL;
+    guint64 since = 0;
+    gboolean complete = FALSE;
+
+    since_variant = g_variant_lookup_value (options, "since-generation", G_VARIANT_TYPE_UINT64);
+    if (since_variant) {
+        since = g_variant_get_uint64 (since_variant);
+        g_variant_unref (since_variant);
+    }
+
+    refresh_modem_status (self);
+    changes = mm_modem_status_tracker_get_changes (self->priv->status_tracker, since, &complete, &removed);
+    mm_gdbus_org_freedesktop_modem_manager1_complete_get_modem_status (
+        manager,
+        invocation,
+        mm_modem_status_tracker_get_generation (self->priv->status_tracker),
+        complete,
+        changes,
+        removed);
+    return TRUE;
+}
+
 /*****************************************************************************/
 /* Test profile setup */
 
@@ -1050,6 +1244,8 @@ mm_base_manager_init (MMBaseManager *manager)
     /* Setup internal lists of device objects */
     priv->devices = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
 
+    priv->status_tracker = mm_modem_status_tracker_new ();
+
 #if defined WITH_UDEV
     {
         const gchar *subsys[5] = { "tty", "net", "usb", "usbmisc", NULL };
@@ -1081,6 +1277,10 @@ mm_base_manager_init (MMBaseManager *manager)
                       "handle-report-kernel-event",
                       G_CALLBACK (handle_report_kernel_event),
                       NULL);
+    g_signal_connect (manager,
+                      "handle-get-modem-status",
+                      G_CALLBACK (handle_get_modem_status),
+                      NULL);
 }
 
 static gboolean
@@ -1138,7 +1338,9 @@ finalize (GObject *object)
     g_free (priv->initial_kernel_events);
     g_free (priv->plugin_dir);
 
+    g_list_free_full (priv->disable_pending, g_object_unref);
     g_hash_table_destroy (priv->devices);
+    mm_modem_status_tracker_free (priv->status_tracker);
 
 #if defined WITH_UDEV
     if (priv->udev)
@@ -20,6 +20,7 @@
 
 #include "mm-base-modem-at.h"
 #include "mm-errors-types.h"
+#include "mm-modem-helpers.h"
 
 static gboolean
 abort_async_if_port_unusable (MMBaseModem *self,
@@ -620,3 +621,102 @@ mm_base_modem_at_command_raw (MMBaseModem *self,
 {
     _at_command (self, command, timeout, allow_cached, TRUE, callback, user_data);
 }
+
+/*****************************************************************************/
+
+typedef struct {
+    MMPortSerialAt *port;
+    gchar **commands;
+    GSimpleAsyncResult *result;
+} AtCompoundContext;
+
+static void
+at_compound_context_complete_and_free (AtCompoundContext *ctx)
+{
+    g_simple_async_result_complete (ctx->result);
+    g_object_unref (ctx->result);
+    g_object_unref (ctx->port);
+    g_strfreev (ctx->commands);
+    g_slice_free (AtCompoundContext, ctx);
+}
+
+gboolean
+mm_base_modem_at_command_compound_finish (MMBaseModem *self,
+                                          GAsyncResult *res,
+                                          GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+static void
+at_compound_ready (MMBaseModem *self,
+                   GAsyncResult *res,
+                   AtCompoundContext *ctx)
+{
+    const gchar *response;
+    GError *error = NULL;
+    gchar **split;
+    guint i;
+
+    response = mm_base_modem_at_command_full_finish (self, res, &error);
+    if (!response) {
+        g_simple_async_result_take_error (ctx->result, error);
+        at_compound_context_complete_and_free (ctx);
+        return;
+    }
+
+    split = mm_split_compound_response (response, g_strv_length (ctx->commands));
+    if (!split) {
+        g_simple_async_result_set_error (ctx->result,
+                                         MM_CORE_ERROR,
+                                         MM_CORE_ERROR_FAILED,
+                                         "Couldn't split compound command response");
+        at_compound_context_complete_and_free (ctx);
+        return;
+    }
+
+    /* Store each reply as if each command had been sent on its own */
+    for (i = 0; split[i]; i++)
+        mm_port_serial_at_set_cached_reply (ctx->port, ctx->commands[i], split[i]);
+    g_strfreev (split);
+
+    g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
+    at_compound_context_complete_and_free (ctx);
+}
+
+void
+mm_base_modem_at_command_compound (MMBaseModem *self,
+                                   MMPortSerialAt *port,
+                                   const gchar **commands,
+                                   guint timeout,
+                                   GCancellable *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data)
+{
+    AtCompoundContext *ctx;
+    gchar *line;
+
+    g_return_if_fail (commands != NULL && commands[0] != NULL);
+
+    ctx = g_slice_new0 (AtCompoundContext);
+    ctx->port = g_object_ref (port);
+    ctx->commands = g_strdupv ((gchar **)commands);
+    ctx->result = g_simple_async_result_new (G_OBJECT (self),
+                                             callback,
+                                             user_data,
+                                             mm_base_modem_at_command_compound);
+
+    /* Extended commands are concatenated with ';', without repeating the
+     * AT prefix (V.250 5.4.1) */
+    line = g_strjoinv (";", ctx->commands);
+    mm_base_modem_at_command_full (self,
+                                   port,
+                                   line,
+                                   timeout,
+                                   FALSE,
+                                   FALSE,
+                                   cancellable,
+                                   (GAsyncReadyCallback)at_compound_ready,
+                                   ctx);
+    g_free (line);
+}
@@ -164,4 +164,20 @@ const gchar *mm_base_modem_at_command_full_finish (MMBaseModem *self,
                                                    GAsyncResult *res,
                                                    GError **error);
 
+/* Send several independent read-only commands (e.g. "+CGMI", "+CGMM") in a
+ * single command line. On success the reply to each command is stored in the
+ * port reply cache, so that any later command on the same port allowing
+ * cached replies completes without a new round-trip. On error, nothing is
+ * cached and the commands need to be sent separately. */
+void     mm_base_modem_at_command_compound        (MMBaseModem *self,
+                                                   MMPortSerialAt *port,
+                                                   const gchar **commands,
+                                                   guint timeout,
+                                                   GCancellable *cancellable,
+                                                   GAsyncReadyCallback callback,
+                                                   gpointer user_data);
+gboolean mm_base_modem_at_command_compound_finish (MMBaseModem *self,
+                                                   GAsyncResult *res,
+                                                   GError **error);
+
 #endif /* MM_BASE_MODEM_AT_H */
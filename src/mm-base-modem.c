@@ -28,6 +28,7 @@
 
 #include "mm-context.h"
 #include "mm-base-modem.h"
+#include "mm-properties-coalescer.h"
 
 #include "mm-log.h"
 #include "mm-port-enums-types.h"
@@ -78,6 +79,22 @@ struct _MMBaseModemPrivate {
     MMAuthProvider *authp;
     GCancellable *authp_cancellable;
 
+    /* Periodic tasks, sorted by deadline, and the single timeout used
+     * to run them */
+    GList *polls;
+    guint polls_next_id;
+    guint polls_timeout_id;
+    gint64 polls_timeout_deadline;
+    gboolean polls_disabled;
+    /* Task being run, not in the list meanwhile */
+    gpointer polls_running;
+    /* Task name -> interval requested over D-Bus */
+    GHashTable *poll_intervals;
+
+    /* Coalescing of PropertiesChanged signals, created on first use */
+    MMPropertiesCoalescer *properties_coalescer;
+    guint property_updates_depth;
+
     GHashTable *ports;
     MMPortSerialAt *primary;
     MMPortSerialAt *secondary;
@@ -445,6 +462,329 @@ mm_base_modem_get_cancellable  (MMBaseModem *self)
     return g_object_ref (self->priv->cancellable);
 }
 
+/*****************************************************************************/
+/* Polling scheduler
+ *
+ * All periodic tasks of the modem (signal quality checks, registration checks,
+ * bearer stats and connection monitoring...) are scheduled here instead of
+ * each one running its own timeout. A task may be run up to a quarter of its
+ * interval earlier or later than requested, so that it shares the modem
+ * wakeup with other tasks due around the same time. Due tasks are run back to
+ * back, so that the commands they issue get queued together in the ports. */
+
+#define POLL_SLACK_DIVISOR 4
+
+/* Tasks due within this time are run in the same wakeup */
+#define POLL_DUE_TOLERANCE_USEC (G_USEC_PER_SEC / 2)
+
+typedef struct {
+    guint id;
+    const gchar *name;
+    guint interval;
+    gint64 deadline;
+    GSourceFunc callback;
+    gpointer user_data;
+    gboolean removed;
+} PollEntry;
+
+static const gchar *poll_names[] = {
+    MM_BASE_MODEM_POLL_SIGNAL_QUALITY,
+    MM_BASE_MODEM_POLL_REGISTRATION,
+    MM_BASE_MODEM_POLL_TIMEZONE,
+    MM_BASE_MODEM_POLL_BEARER_STATS,
+    MM_BASE_MODEM_POLL_CONNECTION_MONITOR,
+};
+
+static void polls_reschedule (MMBaseModem *self);
+
+static gint
+poll_cmp_deadline (const PollEntry *a,
+                   const PollEntry *b)
+{
+    return (a->deadline < b->deadline ? -1 : (a->deadline > b->deadline ? 1 : 0));
+}
+
+static void
+poll_insert (MMBaseModem *self,
+             PollEntry *entry)
+{
+    gint64 target;
+    gint64 slack;
+    gint64 best_distance = G_MAXINT64;
+    guint interval;
+    GList *l;
+
+    /* An interval given over D-Bus overrides the one of the task */
+    interval = GPOINTER_TO_UINT (g_hash_table_lookup (self->priv->poll_intervals, entry->name));
+    if (!interval)
+        interval = entry->interval;
+
+    target = g_get_monotonic_time () + (gint64)interval * G_USEC_PER_SEC;
+    slack = (gint64)interval * G_USEC_PER_SEC / POLL_SLACK_DIVISOR;
+    entry->deadline = target;
+
+    /* Look for the closest wakeup already scheduled within the slack */
+    for (l = self->priv->polls; l; l = g_list_next (l)) {
+        PollEntry *other = l->data;
+        gint64 distance;
+
+        distance = ABS (other->deadline - target);
+        if (distance <= slack && distance < best_distance) {
+            best_distance = distance;
+            entry->deadline = other->deadline;
+        }
+    }
+
+    self->priv->polls = g_list_insert_sorted (self->priv->polls,
+                                              entry,
+                                              (GCompareFunc)poll_cmp_deadline);
+}
+
+static gboolean
+polls_timeout_cb (MMBaseModem *self)
+{
+    gint64 limit;
+
+    self->priv->polls_timeout_id = 0;
+
+    /* Tasks may remove other tasks or even drop the last reference to the
+     * modem while running */
+    g_object_ref (self);
+
+    limit = g_get_monotonic_time () + POLL_DUE_TOLERANCE_USEC;
+    while (self->priv->polls && ((PollEntry *)self->priv->polls->data)->deadline <= limit) {
+        PollEntry *entry;
+
+        entry = self->priv->polls->data;
+        self->priv->polls = g_list_delete_link (self->priv->polls, self->priv->polls);
+
+        /* The task may remove itself while running */
+        self->priv->polls_running = entry;
+        if (entry->callback (entry->user_data) == G_SOURCE_CONTINUE &&
+            !entry->removed &&
+            !self->priv->polls_disabled) {
+            /* Not disposed meanwhile, schedule again */
+            self->priv->polls_running = NULL;
+            poll_insert (self, entry);
+            continue;
+        }
+        self->priv->polls_running = NULL;
+        g_slice_free (PollEntry, entry);
+    }
+
+    polls_reschedule (self);
+    g_object_unref (self);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+polls_reschedule (MMBaseModem *self)
+{
+    gint64 deadline;
+    gint64 now;
+
+    deadline = (self->priv->polls ? ((PollEntry *)self->priv->polls->data)->deadline : 0);
+    if (self->priv->polls_timeout_id && self->priv->polls_timeout_deadline == deadline)
+        return;
+
+    if (self->priv->polls_timeout_id) {
+        g_source_remove (self->priv->polls_timeout_id);
+        self->priv->polls_timeout_id = 0;
+    }
+    self->priv->polls_timeout_deadline = 0;
+
+    if (!deadline)
+        return;
+
+    /* Seconds based timeouts, so that wakeups get also aligned with other
+     * timeouts in the process */
+    now = g_get_monotonic_time ();
+    self->priv->polls_timeout_deadline = deadline;
+    self->priv->polls_timeout_id = g_timeout_add_seconds ((deadline > now ?
+                                                           (guint)((deadline - now + G_USEC_PER_SEC - 1) / G_USEC_PER_SEC) :
+                                                           0),
+                                                          (GSourceFunc)polls_timeout_cb,
+                                                          self);
+}
+
+guint
+mm_base_modem_poll_add (MMBaseModem *self,
+                        const gchar *name,
+                        guint interval,
+                        GSourceFunc callback,
+                        gpointer user_data)
+{
+    PollEntry *entry;
+
+    g_return_val_if_fail (MM_IS_BASE_MODEM (self), 0);
+    g_return_val_if_fail (name != NULL, 0);
+    g_return_val_if_fail (interval > 0, 0);
+    g_return_val_if_fail (callback != NULL, 0);
+
+    if (self->priv->polls_disabled)
+        return 0;
+
+    entry = g_slice_new0 (PollEntry);
+    entry->id = ++self->priv->polls_next_id;
+    if (G_UNLIKELY (!entry->id))
+        entry->id = ++self->priv->polls_next_id;
+    entry->name = g_intern_string (name);
+    entry->interval = interval;
+    entry->callback = callback;
+    entry->user_data = user_data;
+
+    poll_insert (self, entry);
+    polls_reschedule (self);
+    return entry->id;
+}
+
+void
+mm_base_modem_poll_remove (MMBaseModem *self,
+                           guint id)
+{
+    GList *l;
+
+    g_return_if_fail (MM_IS_BASE_MODEM (self));
+
+    /* Removed from its own callback */
+    if (self->priv->polls_running && ((PollEntry *)self->priv->polls_running)->id == id) {
+        ((PollEntry *)self->priv->polls_running)->removed = TRUE;
+        return;
+    }
+
+    for (l = self->priv->polls; l; l = g_list_next (l)) {
+        if (((PollEntry *)l->data)->id == id) {
+            g_slice_free (PollEntry, l->data);
+            self->priv->polls = g_list_delete_link (self->priv->polls, l);
+            polls_reschedule (self);
+            return;
+        }
+    }
+}
+
+static const gchar *
+poll_name_lookup (const gchar *name)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (poll_names); i++) {
+        if (g_str_equal (name, poll_names[i]))
+            return poll_names[i];
+    }
+    return NULL;
+}
+
+static void
+poll_set_interval (MMBaseModem *self,
+                   const gchar *name,
+                   guint interval)
+{
+    GList *affected = NULL;
+    GList *l;
+
+    mm_dbg ("Periodic task '%s' interval set to %u seconds%s",
+            name, interval, interval ? "" : " (default)");
+    if (interval)
+        g_hash_table_insert (self->priv->poll_intervals, (gpointer)name, GUINT_TO_POINTER (interval));
+    else
+        g_hash_table_remove (self->priv->poll_intervals, name);
+
+    /* Reschedule the tasks already waiting */
+    for (l = self->priv->polls; l; ) {
+        GList *next = g_list_next (l);
+
+        if (g_str_equal (((PollEntry *)l->data)->name, name)) {
+            affected = g_list_prepend (affected, l->data);
+            self->priv->polls = g_list_delete_link (self->priv->polls, l);
+        }
+        l = next;
+    }
+    for (l = affected; l; l = g_list_next (l))
+        poll_insert (self, (PollEntry *)l->data);
+    g_list_free (affected);
+}
+
+gboolean
+mm_base_modem_set_poll_intervals (MMBaseModem *self,
+                                  GVariant *intervals,
+                                  GError **error)
+{
+    GVariantIter iter;
+    const gchar *name;
+    GVariant *value;
+
+    g_return_val_if_fail (MM_IS_BASE_MODEM (self), FALSE);
+    g_return_val_if_fail (g_variant_is_of_type (intervals, G_VARIANT_TYPE ("a{sv}")), FALSE);
+
+    /* Validate everything before applying anything */
+    g_variant_iter_init (&iter, intervals);
+    while (g_variant_iter_next (&iter, "{&sv}", &name, &value)) {
+        gboolean valid;
+
+        valid = g_variant_is_of_type (value, G_VARIANT_TYPE_UINT32);
+        g_variant_unref (value);
+
+        if (!poll_name_lookup (name)) {
+            g_set_error (error,
+                         MM_CORE_ERROR,
+                         MM_CORE_ERROR_INVALID_ARGS,
+                         "Unknown periodic task: '%s'", name);
+            return FALSE;
+        }
+        if (!valid) {
+            g_set_error (error,
+                         MM_CORE_ERROR,
+                         MM_CORE_ERROR_INVALID_ARGS,
+                         "Invalid interval for periodic task '%s': expected an unsigned integer",
+                         name);
+            return FALSE;
+        }
+    }
+
+    g_variant_iter_init (&iter, intervals);
+    while (g_variant_iter_next (&iter, "{&sv}", &name, &value)) {
+        poll_set_interval (self, poll_name_lookup (name), g_variant_get_uint32 (value));
+        g_variant_unref (value);
+    }
+
+    polls_reschedule (self);
+    return TRUE;
+}
+
+GVariant *
+mm_base_modem_get_poll_intervals (MMBaseModem *self)
+{
+    GVariantBuilder builder;
+    guint i;
+
+    g_return_val_if_fail (MM_IS_BASE_MODEM (self), NULL);
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{su}"));
+    for (i = 0; i < G_N_ELEMENTS (poll_names); i++) {
+        guint interval;
+
+        interval = GPOINTER_TO_UINT (g_hash_table_lookup (self->priv->poll_intervals, poll_names[i]));
+        if (interval)
+            g_variant_builder_add (&builder, "{su}", poll_names[i], interval);
+    }
+    return g_variant_builder_end (&builder);
+}
+
+static void
+polls_clear (MMBaseModem *self)
+{
+    GList *l;
+
+    for (l = self->priv->polls; l; l = g_list_next (l))
+        g_slice_free (PollEntry, l->data);
+    g_list_free (self->priv->polls);
+    self->priv->polls = NULL;
+    self->priv->polls_disabled = TRUE;
+    polls_reschedule (self);
+}
+
+/*****************************************************************************/
+
 MMPortSerialAt *
 mm_base_modem_get_port_primary (MMBaseModem *self)
 {
@@ -1214,6 +1554,47 @@ mm_base_modem_authorize (MMBaseModem *self,
 
 /*****************************************************************************/
 
+void
+mm_base_modem_begin_property_updates (MMBaseModem *self)
+{
+    if (self->priv->property_updates_depth++ > 0)
+        return;
+
+    /* Nothing to hold back until exported */
+    if (!self->priv->properties_coalescer) {
+        const gchar *path;
+
+        path = g_dbus_object_get_object_path (G_DBUS_OBJECT (self));
+        if (!self->priv->connection || !path)
+            return;
+        self->priv->properties_coalescer = mm_properties_coalescer_new (self->priv->connection, path);
+    }
+
+    mm_properties_coalescer_hold (self->priv->properties_coalescer);
+}
+
+void
+mm_base_modem_end_property_updates (MMBaseModem *self)
+{
+    guint n_received;
+    guint n_emitted;
+
+    g_return_if_fail (self->priv->property_updates_depth > 0);
+
+    if (--self->priv->property_updates_depth > 0 || !self->priv->properties_coalescer)
+        return;
+
+    mm_properties_coalescer_release (self->priv->properties_coalescer);
+
+    mm_properties_coalescer_get_stats (self->priv->properties_coalescer, &n_received, &n_emitted);
+    mm_dbg ("Modem %s: %u PropertiesChanged signals emitted as %u so far",
+            g_dbus_object_get_object_path (G_DBUS_OBJECT (self)),
+            n_received,
+            n_emitted);
+}
+
+/*****************************************************************************/
+
 const gchar *
 mm_base_modem_get_device (MMBaseModem *self)
 {
@@ -1301,6 +1682,8 @@ mm_base_modem_init (MMBaseModem *self)
                                                g_str_equal,
                                                g_free,
                                                g_object_unref);
+
+    self->priv->poll_intervals = g_hash_table_new (g_str_hash, g_str_equal);
 }
 
 static void
@@ -1407,6 +1790,7 @@ finalize (GObject *object)
     g_free (self->priv->device);
     g_strfreev (self->priv->drivers);
     g_free (self->priv->plugin);
+    g_hash_table_unref (self->priv->poll_intervals);
 
     G_OBJECT_CLASS (mm_base_modem_parent_class)->finalize (object);
 }
@@ -1429,6 +1813,14 @@ dispose (GObject *object)
     g_cancellable_cancel (self->priv->cancellable);
     g_clear_object (&self->priv->cancellable);
 
+    /* Periodic tasks may only be removed (not added) from now on */
+    polls_clear (self);
+
+    if (self->priv->properties_coalescer) {
+        mm_properties_coalescer_free (self->priv->properties_coalescer);
+        self->priv->properties_coalescer = NULL;
+    }
+
     g_clear_object (&self->priv->primary);
     g_clear_object (&self->priv->secondary);
     g_list_free_full (self->priv->data, g_object_unref);
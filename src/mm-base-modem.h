@@ -180,6 +180,32 @@ guint mm_base_modem_get_product_id (MMBaseModem *self);
 GCancellable *mm_base_modem_peek_cancellable (MMBaseModem *self);
 GCancellable *mm_base_modem_get_cancellable  (MMBaseModem *self);
 
+/* Periodic tasks, run in wakeups shared with other tasks of the same modem.
+ * Same semantics as g_timeout_add_seconds() and g_source_remove(). The
+ * interval of all the tasks with the same name may be overridden with
+ * mm_base_modem_set_poll_intervals(). */
+#define MM_BASE_MODEM_POLL_SIGNAL_QUALITY     "signal-quality"
+#define MM_BASE_MODEM_POLL_REGISTRATION       "registration"
+#define MM_BASE_MODEM_POLL_TIMEZONE           "timezone"
+#define MM_BASE_MODEM_POLL_BEARER_STATS       "bearer-stats"
+#define MM_BASE_MODEM_POLL_CONNECTION_MONITOR "connection-monitor"
+
+guint mm_base_modem_poll_add    (MMBaseModem *self,
+                                 const gchar *name,
+                                 guint interval,
+                                 GSourceFunc callback,
+                                 gpointer user_data);
+void  mm_base_modem_poll_remove (MMBaseModem *self,
+                                 guint id);
+
+/* @intervals is a{sv} of task names and 'u' intervals; a zero interval goes
+ * back to the one requested by the task. Nothing is applied on error. */
+gboolean  mm_base_modem_set_poll_intervals (MMBaseModem *self,
+                                            GVariant *intervals,
+                                            GError **error);
+/* a{su} with the intervals currently overridden */
+GVariant *mm_base_modem_get_poll_intervals (MMBaseModem *self);
+
 void     mm_base_modem_authorize        (MMBaseModem *self,
                                          GDBusMethodInvocation *invocation,
                                          const gchar *authorization,
@@ -189,6 +215,13 @@ gboolean mm_base_modem_authorize_finish (MMBaseModem *self,
                                          GAsyncResult *res,
                                          GError **error);
 
+/* Property update transactions: the PropertiesChanged signals of all the
+ * modem interfaces are held back while open, and merged into one signal per
+ * interface when the last one is closed. Properties themselves are updated
+ * right away. */
+void mm_base_modem_begin_property_updates (MMBaseModem *self);
+void mm_base_modem_end_property_updates   (MMBaseModem *self);
+
 void     mm_base_modem_initialize        (MMBaseModem *self,
                                           GAsyncReadyCallback callback,
                                           gpointer user_data);
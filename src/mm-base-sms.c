@@ -35,9 +35,14 @@
 #include "mm-base-modem.h"
 #include "mm-log.h"
 #include "mm-modem-helpers.h"
+#include "mm-sms-send-sequence.h"
 
 G_DEFINE_TYPE (MMBaseSms, mm_base_sms, MM_GDBUS_TYPE_SMS_SKELETON)
 
+/* Lazily exported SMS objects are unexported after this time without
+ * being requested */
+#define SMS_EXPORT_IDLE_TIMEOUT_SECS 300
+
 enum {
     PROP_0,
     PROP_PATH,
@@ -70,6 +75,14 @@ struct _MMBaseSmsPrivate {
     /* Set to true when all needed parts were received,
      * parsed and assembled */
     gboolean is_assembled;
+
+    /* Set while being sent as part of a batch which already asked the
+     * modem to keep the link open */
+    gboolean in_batch;
+
+    /* When set, the object is only exported in DBus on demand */
+    gboolean lazy_export;
+    guint unexport_id;
 };
 
 /*****************************************************************************/
@@ -467,6 +480,9 @@ handle_store (MMBaseSms *self,
 {
     HandleStoreContext *ctx;
 
+    /* Keep it exported while being used */
+    mm_base_sms_ensure_exported (self);
+
     ctx = g_new0 (HandleStoreContext, 1);
     ctx->self = g_object_ref (self);
     ctx->invocation = g_object_ref (invocation);
@@ -516,26 +532,10 @@ handle_send_ready (MMBaseSms *self,
 {
     GError *error = NULL;
 
-    if (!MM_BASE_SMS_GET_CLASS (self)->send_finish (self, res, &error)) {
-        /* On error, clear up the parts we generated */
-        g_list_free_full (self->priv->parts, (GDestroyNotify)mm_sms_part_free);
-        self->priv->parts = NULL;
+    if (!mm_base_sms_send_finish (self, res, &error))
         g_dbus_method_invocation_take_error (ctx->invocation, error);
-    } else {
-        /* Transition from Unknown->Sent or Stored->Sent */
-        if (mm_gdbus_sms_get_state (MM_GDBUS_SMS (ctx->self)) == MM_SMS_STATE_UNKNOWN ||
-            mm_gdbus_sms_get_state (MM_GDBUS_SMS (ctx->self)) == MM_SMS_STATE_STORED) {
-            GList *l;
-
-            /* Update state */
-            mm_gdbus_sms_set_state (MM_GDBUS_SMS (ctx->self), MM_SMS_STATE_SENT);
-            /* Grab last message reference */
-            l = g_list_last (mm_base_sms_get_parts (ctx->self));
-            mm_gdbus_sms_set_message_reference (MM_GDBUS_SMS (ctx->self),
-                                                mm_sms_part_get_message_reference ((MMSmsPart *)l->data));
-        }
+    else
         mm_gdbus_sms_complete_send (MM_GDBUS_SMS (ctx->self), ctx->invocation);
-    }
 
     handle_send_context_free (ctx);
 }
@@ -573,7 +573,6 @@ handle_send_auth_ready (MMBaseModem *modem,
                         GAsyncResult *res,
                         HandleSendContext *ctx)
 {
-    MMSmsState state;
     GError *error = NULL;
 
     if (!mm_base_modem_authorize_finish (modem, res, &error)) {
@@ -582,49 +581,9 @@ handle_send_auth_ready (MMBaseModem *modem,
         return;
     }
 
-    /* We can only send SMS created by the user */
-    state = mm_gdbus_sms_get_state (MM_GDBUS_SMS (ctx->self));
-    if (state == MM_SMS_STATE_RECEIVED ||
-        state == MM_SMS_STATE_RECEIVING) {
-        g_dbus_method_invocation_return_error (ctx->invocation,
-                                               MM_CORE_ERROR,
-                                               MM_CORE_ERROR_FAILED,
-                                               "This SMS was received, cannot send it");
-        handle_send_context_free (ctx);
-        return;
-    }
-
-    /* Don't allow sending the same SMS multiple times, we would lose the message reference */
-    if (state == MM_SMS_STATE_SENT) {
-        g_dbus_method_invocation_return_error (ctx->invocation,
-                                               MM_CORE_ERROR,
-                                               MM_CORE_ERROR_FAILED,
-                                               "This SMS was already sent, cannot send it again");
-        handle_send_context_free (ctx);
-        return;
-    }
-
-    /* Prepare the SMS to be sent, creating the PDU list if required */
-    if (!prepare_sms_to_be_sent (ctx->self, &error)) {
-        g_dbus_method_invocation_take_error (ctx->invocation, error);
-        handle_send_context_free (ctx);
-        return;
-    }
-
-    /* Check if we do support doing it */
-    if (!MM_BASE_SMS_GET_CLASS (ctx->self)->send ||
-        !MM_BASE_SMS_GET_CLASS (ctx->self)->send_finish) {
-        g_dbus_method_invocation_return_error (ctx->invocation,
-                                               MM_CORE_ERROR,
-                                               MM_CORE_ERROR_UNSUPPORTED,
-                                               "Sending SMS is not supported by this modem");
-        handle_send_context_free (ctx);
-        return;
-    }
-
-    MM_BASE_SMS_GET_CLASS (ctx->self)->send (ctx->self,
-                                             (GAsyncReadyCallback)handle_send_ready,
-                                             ctx);
+    mm_base_sms_send (ctx->self,
+                      (GAsyncReadyCallback)handle_send_ready,
+                      ctx);
 }
 
 static gboolean
@@ -633,6 +592,9 @@ handle_send (MMBaseSms *self,
 {
     HandleSendContext *ctx;
 
+    /* Keep it exported while being used */
+    mm_base_sms_ensure_exported (self);
+
     ctx = g_new0 (HandleSendContext, 1);
     ctx->self = g_object_ref (self);
     ctx->invocation = g_object_ref (invocation);
@@ -678,16 +640,6 @@ sms_dbus_export (MMBaseSms *self)
 {
     GError *error = NULL;
 
-    /* Handle method invocations */
-    g_signal_connect (self,
-                      "handle-store",
-                      G_CALLBACK (handle_store),
-                      NULL);
-    g_signal_connect (self,
-                      "handle-send",
-                      G_CALLBACK (handle_send),
-                      NULL);
-
     if (!g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (self),
                                            self->priv->connection,
                                            self->priv->path,
@@ -702,11 +654,67 @@ sms_dbus_export (MMBaseSms *self)
 static void
 sms_dbus_unexport (MMBaseSms *self)
 {
+    if (self->priv->unexport_id) {
+        g_source_remove (self->priv->unexport_id);
+        self->priv->unexport_id = 0;
+    }
+
     /* Only unexport if currently exported */
     if (g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (self)))
         g_dbus_interface_skeleton_unexport (G_DBUS_INTERFACE_SKELETON (self));
 }
 
+static gboolean
+unexport_idle_cb (MMBaseSms *self)
+{
+    self->priv->unexport_id = 0;
+    mm_dbg ("Unexporting idle SMS at '%s'", self->priv->path);
+    sms_dbus_unexport (self);
+    return G_SOURCE_REMOVE;
+}
+
+void
+mm_base_sms_ensure_exported (MMBaseSms *self)
+{
+    /* Need both DBus connection and path */
+    if (!self->priv->path || !self->priv->connection)
+        return;
+
+    if (!g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (self)))
+        sms_dbus_export (self);
+
+    if (!self->priv->lazy_export)
+        return;
+
+    /* Restart the inactivity timeout */
+    if (self->priv->unexport_id)
+        g_source_remove (self->priv->unexport_id);
+    self->priv->unexport_id = g_timeout_add_seconds (SMS_EXPORT_IDLE_TIMEOUT_SECS,
+                                                     (GSourceFunc)unexport_idle_cb,
+                                                     self);
+}
+
+void
+mm_base_sms_set_lazy_export (MMBaseSms *self,
+                             gboolean lazy)
+{
+    self->priv->lazy_export = lazy;
+
+    if (!lazy) {
+        if (self->priv->unexport_id) {
+            g_source_remove (self->priv->unexport_id);
+            self->priv->unexport_id = 0;
+        }
+        mm_base_sms_ensure_exported (self);
+    }
+}
+
+gboolean
+mm_base_sms_get_lazy_export (MMBaseSms *self)
+{
+    return self->priv->lazy_export;
+}
+
 /*****************************************************************************/
 
 const gchar *
@@ -1037,8 +1045,14 @@ typedef struct {
     gboolean need_unlock;
     gboolean from_storage;
     gboolean use_pdu_mode;
+    /* Parts sent, holding the link between them if needed */
+    MMSmsSendSequence *sequence;
     GList *current;
     gchar *msg_data;
+    /* Command for the next part, prepared while the current one is sent */
+    gchar *next_cmd;
+    gchar *next_msg_data;
+    GError *saved_error;
 } SmsSendContext;
 
 static void
@@ -1047,8 +1061,12 @@ sms_send_context_free (SmsSendContext *ctx)
     /* Unlock mem2 storage if we had the lock */
     if (ctx->need_unlock)
         mm_broadband_modem_unlock_sms_storages (MM_BROADBAND_MODEM (ctx->modem), FALSE, TRUE);
+    if (ctx->sequence)
+        mm_sms_send_sequence_free (ctx->sequence);
     g_object_unref (ctx->modem);
     g_free (ctx->msg_data);
+    g_free (ctx->next_cmd);
+    g_free (ctx->next_msg_data);
     g_free (ctx);
 }
 
@@ -1061,6 +1079,37 @@ sms_send_finish (MMBaseSms *self,
 }
 
 static void sms_send_next_part (GTask *task);
+static void sms_send_step      (GTask *task);
+
+static void
+sms_send_return (GTask *task,
+                 GError *error)
+{
+    if (error)
+        g_task_return_error (task, error);
+    else
+        g_task_return_boolean (task, TRUE);
+    g_object_unref (task);
+}
+
+/* The current part was sent, or failed and no more parts are sent */
+static void
+sms_send_part_done (GTask *task,
+                    GError *error)
+{
+    SmsSendContext *ctx;
+
+    ctx = g_task_get_task_data (task);
+
+    if (error) {
+        g_assert (!ctx->saved_error);
+        ctx->saved_error = error;
+    } else
+        ctx->current = g_list_next (ctx->current);
+
+    mm_sms_send_sequence_step_done (ctx->sequence, !error);
+    sms_send_step (task);
+}
 
 static gint
 read_message_reference_from_reply (const gchar *response,
@@ -1099,15 +1148,13 @@ send_generic_msg_data_ready (MMBaseModem *modem,
 
     response = mm_base_modem_at_command_finish (modem, res, &error);
     if (error) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        sms_send_part_done (task, error);
         return;
     }
 
     message_reference = read_message_reference_from_reply (response, &error);
     if (error) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        sms_send_part_done (task, error);
         return;
     }
 
@@ -1115,9 +1162,7 @@ send_generic_msg_data_ready (MMBaseModem *modem,
 
     mm_sms_part_set_message_reference ((MMSmsPart *)ctx->current->data,
                                        (guint)message_reference);
-
-    ctx->current = g_list_next (ctx->current);
-    sms_send_next_part (task);
+    sms_send_part_done (task, NULL);
 }
 
 static void
@@ -1130,8 +1175,7 @@ send_generic_ready (MMBaseModem *modem,
 
     mm_base_modem_at_command_finish (modem, res, &error);
     if (error) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        sms_send_part_done (task, error);
         return;
     }
 
@@ -1144,6 +1188,19 @@ send_generic_ready (MMBaseModem *modem,
                                   FALSE,
                                   (GAsyncReadyCallback)send_generic_msg_data_ready,
                                   task);
+
+    /* Build the command for the next part while the modem transmits this
+     * one. On failure we just retry (and report) when sending that part. */
+    if (ctx->current->next &&
+        !sms_get_store_or_send_command ((MMSmsPart *)ctx->current->next->data,
+                                        ctx->use_pdu_mode,
+                                        TRUE,
+                                        &ctx->next_cmd,
+                                        &ctx->next_msg_data,
+                                        NULL)) {
+        ctx->next_cmd = NULL;
+        ctx->next_msg_data = NULL;
+    }
 }
 
 static void
@@ -1161,8 +1218,7 @@ send_from_storage_ready (MMBaseModem *modem,
     response = mm_base_modem_at_command_finish (modem, res, &error);
     if (error) {
         if (g_error_matches (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_RESPONSE_TIMEOUT)) {
-            g_task_return_error (task, error);
-            g_object_unref (task);
+            sms_send_part_done (task, error);
             return;
         }
 
@@ -1177,16 +1233,13 @@ send_from_storage_ready (MMBaseModem *modem,
 
     message_reference = read_message_reference_from_reply (response, &error);
     if (error) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        sms_send_part_done (task, error);
         return;
     }
 
     mm_sms_part_set_message_reference ((MMSmsPart *)ctx->current->data,
                                        (guint)message_reference);
-
-    ctx->current = g_list_next (ctx->current);
-    sms_send_next_part (task);
+    sms_send_part_done (task, NULL);
 }
 
 static void
@@ -1197,13 +1250,7 @@ sms_send_next_part (GTask *task)
     gchar *cmd;
 
     ctx = g_task_get_task_data (task);
-
-    if (!ctx->current) {
-        /* Done we are */
-        g_task_return_boolean (task, TRUE);
-        g_object_unref (task);
-        return;
-    }
+    g_assert (ctx->current);
 
     /* Send from storage */
     if (ctx->from_storage) {
@@ -1226,14 +1273,19 @@ sms_send_next_part (GTask *task)
         ctx->msg_data = NULL;
     }
 
-    if (!sms_get_store_or_send_command ((MMSmsPart *)ctx->current->data,
-                                        ctx->use_pdu_mode,
-                                        TRUE,
-                                        &cmd,
-                                        &ctx->msg_data,
-                                        &error)) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
+    if (ctx->next_cmd) {
+        /* Already prepared while sending the previous part */
+        cmd = ctx->next_cmd;
+        ctx->msg_data = ctx->next_msg_data;
+        ctx->next_cmd = NULL;
+        ctx->next_msg_data = NULL;
+    } else if (!sms_get_store_or_send_command ((MMSmsPart *)ctx->current->data,
+                                               ctx->use_pdu_mode,
+                                               TRUE,
+                                               &cmd,
+                                               &ctx->msg_data,
+                                               &error)) {
+        sms_send_part_done (task, error);
         return;
     }
 
@@ -1248,22 +1300,101 @@ sms_send_next_part (GTask *task)
     g_free (cmd);
 }
 
+static void
+more_messages_ready (MMBaseModem *modem,
+                     GAsyncResult *res,
+                     GTask *task)
+{
+    SmsSendContext *ctx;
+    GError *error = NULL;
+
+    ctx = g_task_get_task_data (task);
+
+    /* Not critical, parts are sent anyway */
+    if (!mm_base_modem_at_command_finish (modem, res, &error)) {
+        mm_dbg ("Couldn't change more messages mode: '%s'", error->message);
+        g_error_free (error);
+        mm_sms_send_sequence_step_done (ctx->sequence, FALSE);
+    } else
+        mm_sms_send_sequence_step_done (ctx->sequence, TRUE);
+
+    sms_send_step (task);
+}
+
+static void
+sms_send_step (GTask *task)
+{
+    SmsSendContext *ctx;
+    GError *error;
+
+    ctx = g_task_get_task_data (task);
+
+    switch (mm_sms_send_sequence_next (ctx->sequence, NULL)) {
+    case MM_SMS_SEND_STEP_MORE_MESSAGES_ENABLE:
+        mm_base_modem_at_command (ctx->modem,
+                                  "+CMMS=1",
+                                  3,
+                                  FALSE,
+                                  (GAsyncReadyCallback)more_messages_ready,
+                                  task);
+        return;
+
+    case MM_SMS_SEND_STEP_ITEM:
+        sms_send_next_part (task);
+        return;
+
+    case MM_SMS_SEND_STEP_MORE_MESSAGES_DISABLE:
+        mm_base_modem_at_command (ctx->modem,
+                                  "+CMMS=0",
+                                  3,
+                                  FALSE,
+                                  (GAsyncReadyCallback)more_messages_ready,
+                                  task);
+        return;
+
+    case MM_SMS_SEND_STEP_DONE:
+        error = ctx->saved_error;
+        ctx->saved_error = NULL;
+        sms_send_return (task, error);
+        return;
+    }
+
+    g_assert_not_reached ();
+}
+
+static void
+sms_send_start (GTask *task)
+{
+    MMBaseSms *self;
+    SmsSendContext *ctx;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    ctx->current = self->priv->parts;
+
+    /* When sending several parts, ask the network to keep the link open
+     * between them (AT+CMMS=1), unless already done for the whole batch.
+     * No more parts are sent after a failed one. */
+    ctx->sequence = mm_sms_send_sequence_new (g_list_length (ctx->current),
+                                              !self->priv->in_batch,
+                                              TRUE);
+    sms_send_step (task);
+}
+
 static void
 send_lock_sms_storages_ready (MMBroadbandModem *modem,
                               GAsyncResult *res,
                               GTask *task)
 {
-    MMBaseSms *self;
     SmsSendContext *ctx;
     GError *error = NULL;
 
     if (!mm_broadband_modem_lock_sms_storages_finish (modem, res, &error)) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        sms_send_return (task, error);
         return;
     }
 
-    self = g_task_get_source_object (task);
     ctx = g_task_get_task_data (task);
 
     /* We are now locked. Whatever result we have here, we need to make sure
@@ -1271,8 +1402,7 @@ send_lock_sms_storages_ready (MMBroadbandModem *modem,
     ctx->need_unlock = TRUE;
 
     /* Go on to send the parts */
-    ctx->current = self->priv->parts;
-    sms_send_next_part (task);
+    sms_send_start (task);
 }
 
 static void
@@ -1308,8 +1438,7 @@ sms_send (MMBaseSms *self,
     g_object_get (self->priv->modem,
                   MM_IFACE_MODEM_MESSAGING_SMS_PDU_MODE, &ctx->use_pdu_mode,
                   NULL);
-    ctx->current = self->priv->parts;
-    sms_send_next_part (task);
+    sms_send_start (task);
 }
 
 /*****************************************************************************/
@@ -1507,6 +1636,397 @@ mm_base_sms_delete (MMBaseSms *self,
 
 /*****************************************************************************/
 
+gboolean
+mm_base_sms_delete_stored_part_finish (MMBaseModem *modem,
+                                       GAsyncResult *res,
+                                       GError **error)
+{
+    return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+static void
+delete_stored_part_ready (MMBaseSms *sms,
+                          GAsyncResult *res,
+                          GTask *task)
+{
+    GError *error = NULL;
+
+    if (!MM_BASE_SMS_GET_CLASS (sms)->delete_finish (sms, res, &error))
+        g_task_return_error (task, error);
+    else
+        g_task_return_boolean (task, TRUE);
+    g_object_unref (task);
+    g_object_unref (sms);
+}
+
+void
+mm_base_sms_delete_stored_part (MMBaseModem *modem,
+                                MMSmsStorage storage,
+                                guint index,
+                                GAsyncReadyCallback callback,
+                                gpointer user_data)
+{
+    MMBaseSms *sms;
+    GTask *task;
+
+    task = g_task_new (modem, NULL, callback, user_data);
+
+    /* A temporary, never exported, SMS object holding just the part index
+     * lets us reuse the modem-specific delete implementation */
+    sms = mm_iface_modem_messaging_create_sms (MM_IFACE_MODEM_MESSAGING (modem));
+    if (!MM_BASE_SMS_GET_CLASS (sms)->delete ||
+        !MM_BASE_SMS_GET_CLASS (sms)->delete_finish) {
+        g_task_return_new_error (task,
+                                 MM_CORE_ERROR,
+                                 MM_CORE_ERROR_UNSUPPORTED,
+                                 "Deleting SMS is not supported by this modem");
+        g_object_unref (task);
+        g_object_unref (sms);
+        return;
+    }
+
+    g_object_set (sms,
+                  "storage", storage,
+                  NULL);
+    sms->priv->parts = g_list_prepend (NULL, mm_sms_part_new (index, MM_SMS_PDU_TYPE_DELIVER));
+
+    MM_BASE_SMS_GET_CLASS (sms)->delete (sms,
+                                         (GAsyncReadyCallback)delete_stored_part_ready,
+                                         task);
+}
+
+/*****************************************************************************/
+
+gboolean
+mm_base_sms_send_finish (MMBaseSms *self,
+                         GAsyncResult *res,
+                         GError **error)
+{
+    return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+static void
+send_ready (MMBaseSms *self,
+            GAsyncResult *res,
+            GTask *task)
+{
+    GError *error = NULL;
+
+    if (!MM_BASE_SMS_GET_CLASS (self)->send_finish (self, res, &error)) {
+        /* On error, clear up the parts we generated */
+        g_list_free_full (self->priv->parts, (GDestroyNotify)mm_sms_part_free);
+        self->priv->parts = NULL;
+        g_task_return_error (task, error);
+        g_object_unref (task);
+        return;
+    }
+
+    /* Transition from Unknown->Sent or Stored->Sent */
+    if (mm_gdbus_sms_get_state (MM_GDBUS_SMS (self)) == MM_SMS_STATE_UNKNOWN ||
+        mm_gdbus_sms_get_state (MM_GDBUS_SMS (self)) == MM_SMS_STATE_STORED) {
+        GList *l;
+
+        /* Update state */
+        mm_gdbus_sms_set_state (MM_GDBUS_SMS (self), MM_SMS_STATE_SENT);
+        /* Grab last message reference */
+        l = g_list_last (mm_base_sms_get_parts (self));
+        mm_gdbus_sms_set_message_reference (MM_GDBUS_SMS (self),
+                                            mm_sms_part_get_message_reference ((MMSmsPart *)l->data));
+    }
+
+    g_task_return_boolean (task, TRUE);
+    g_object_unref (task);
+}
+
+void
+mm_base_sms_send (MMBaseSms *self,
+                  GAsyncReadyCallback callback,
+                  gpointer user_data)
+{
+    GTask *task;
+    MMSmsState state;
+    GError *error = NULL;
+
+    task = g_task_new (self, NULL, callback, user_data);
+
+    /* We can only send SMS created by the user */
+    state = mm_gdbus_sms_get_state (MM_GDBUS_SMS (self));
+    if (state == MM_SMS_STATE_RECEIVED ||
+        state == MM_SMS_STATE_RECEIVING) {
+        g_task_return_new_error (task,
+                                 MM_CORE_ERROR,
+                                 MM_CORE_ERROR_FAILED,
+                                 "This SMS was received, cannot send it");
+        g_object_unref (task);
+        return;
+    }
+
+    /* Don't allow sending the same SMS multiple times, we would lose the message reference */
+    if (state == MM_SMS_STATE_SENT) {
+        g_task_return_new_error (task,
+                                 MM_CORE_ERROR,
+                                 MM_CORE_ERROR_FAILED,
+                                 "This SMS was already sent, cannot send it again");
+        g_object_unref (task);
+        return;
+    }
+
+    /* Prepare the SMS to be sent, creating the PDU list if required */
+    if (!prepare_sms_to_be_sent (self, &error)) {
+        g_task_return_error (task, error);
+        g_object_unref (task);
+        return;
+    }
+
+    /* Check if we do support doing it */
+    if (!MM_BASE_SMS_GET_CLASS (self)->send ||
+        !MM_BASE_SMS_GET_CLASS (self)->send_finish) {
+        g_task_return_new_error (task,
+                                 MM_CORE_ERROR,
+                                 MM_CORE_ERROR_UNSUPPORTED,
+                                 "Sending SMS is not supported by this modem");
+        g_object_unref (task);
+        return;
+    }
+
+    MM_BASE_SMS_GET_CLASS (self)->send (self,
+                                        (GAsyncReadyCallback)send_ready,
+                                        task);
+}
+
+/*****************************************************************************/
+/* Send a batch of SMS */
+
+typedef struct {
+    MMBaseModem *modem;
+    GList *sms_list;
+    GList *current;
+    /* Messages sent, holding the link between them if possible */
+    MMSmsSendSequence *sequence;
+    GVariantBuilder results;
+    guint n_parts;
+    GTimer *timer;
+} SendBatchContext;
+
+static void
+send_batch_context_free (SendBatchContext *ctx)
+{
+    GList *l;
+
+    for (l = ctx->sms_list; l; l = g_list_next (l))
+        MM_BASE_SMS (l->data)->priv->in_batch = FALSE;
+    g_list_free_full (ctx->sms_list, g_object_unref);
+    mm_sms_send_sequence_free (ctx->sequence);
+    g_variant_builder_clear (&ctx->results);
+    g_timer_destroy (ctx->timer);
+    g_object_unref (ctx->modem);
+    g_free (ctx);
+}
+
+gboolean
+mm_base_sms_send_batch_finish (MMBaseModem *modem,
+                               GAsyncResult *res,
+                               GVariant **results,
+                               GVariant **stats,
+                               GError **error)
+{
+    GVariant *tuple;
+
+    tuple = g_task_propagate_pointer (G_TASK (res), error);
+    if (!tuple)
+        return FALSE;
+
+    if (results)
+        *results = g_variant_get_child_value (tuple, 0);
+    if (stats)
+        *stats = g_variant_get_child_value (tuple, 1);
+    g_variant_unref (tuple);
+    return TRUE;
+}
+
+static void
+send_batch_complete (GTask *task)
+{
+    SendBatchContext *ctx;
+    GVariantBuilder stats;
+    guint n_messages;
+    guint n_failed;
+    gdouble elapsed;
+
+    ctx = g_task_get_task_data (task);
+
+    n_messages = g_list_length (ctx->sms_list);
+    n_failed = mm_sms_send_sequence_get_n_failed (ctx->sequence);
+    elapsed = g_timer_elapsed (ctx->timer, NULL);
+
+    g_variant_builder_init (&stats, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&stats, "{sv}", "messages", g_variant_new_uint32 (n_messages));
+    g_variant_builder_add (&stats, "{sv}", "failed", g_variant_new_uint32 (n_failed));
+    g_variant_builder_add (&stats, "{sv}", "parts", g_variant_new_uint32 (ctx->n_parts));
+    g_variant_builder_add (&stats, "{sv}", "duration", g_variant_new_double (elapsed));
+    g_variant_builder_add (&stats, "{sv}", "parts-per-second",
+                           g_variant_new_double (elapsed > 0.0 ? ctx->n_parts / elapsed : 0.0));
+
+    mm_dbg ("SMS batch finished: %u/%u messages sent (%u parts) in %.2fs",
+            n_messages - n_failed, n_messages, ctx->n_parts, elapsed);
+
+    g_task_return_pointer (task,
+                           g_variant_ref_sink (g_variant_new ("(@a(obus)@a{sv})",
+                                                              g_variant_builder_end (&ctx->results),
+                                                              g_variant_builder_end (&stats))),
+                           (GDestroyNotify)g_variant_unref);
+    g_object_unref (task);
+}
+
+static void send_batch_step (GTask *task);
+
+static void
+batch_more_messages_ready (MMBaseModem *modem,
+                           GAsyncResult *res,
+                           GTask *task)
+{
+    SendBatchContext *ctx;
+    GError *error = NULL;
+    GList *l;
+
+    ctx = g_task_get_task_data (task);
+
+    /* Not critical, messages are sent anyway */
+    if (!mm_base_modem_at_command_finish (modem, res, &error)) {
+        mm_dbg ("Couldn't change more messages mode: '%s'", error->message);
+        g_error_free (error);
+        mm_sms_send_sequence_step_done (ctx->sequence, FALSE);
+    } else
+        mm_sms_send_sequence_step_done (ctx->sequence, TRUE);
+
+    /* While the link is kept open for the whole batch, don't toggle it per
+     * message */
+    for (l = ctx->sms_list; l; l = g_list_next (l))
+        MM_BASE_SMS (l->data)->priv->in_batch = mm_sms_send_sequence_get_link_held (ctx->sequence);
+
+    send_batch_step (task);
+}
+
+static void
+send_batch_sms_ready (MMBaseSms *sms,
+                      GAsyncResult *res,
+                      GTask *task)
+{
+    SendBatchContext *ctx;
+    GError *error = NULL;
+    const gchar *path;
+
+    ctx = g_task_get_task_data (task);
+
+    path = mm_base_sms_get_path (sms);
+    if (!path)
+        path = "/";
+
+    if (!mm_base_sms_send_finish (sms, res, &error)) {
+        mm_dbg ("Couldn't send SMS '%s' in batch: %s", path, error->message);
+        g_variant_builder_add (&ctx->results, "(obus)", path, FALSE, 0, error->message);
+        g_error_free (error);
+        mm_sms_send_sequence_step_done (ctx->sequence, FALSE);
+    } else {
+        g_variant_builder_add (&ctx->results, "(obus)",
+                               path,
+                               TRUE,
+                               mm_gdbus_sms_get_message_reference (MM_GDBUS_SMS (sms)),
+                               "");
+        ctx->n_parts += g_list_length (sms->priv->parts);
+        mm_sms_send_sequence_step_done (ctx->sequence, TRUE);
+    }
+
+    ctx->current = g_list_next (ctx->current);
+    send_batch_step (task);
+}
+
+static void
+send_batch_step (GTask *task)
+{
+    SendBatchContext *ctx;
+    GList *next;
+
+    ctx = g_task_get_task_data (task);
+
+    switch (mm_sms_send_sequence_next (ctx->sequence, NULL)) {
+    case MM_SMS_SEND_STEP_MORE_MESSAGES_ENABLE:
+        mm_base_modem_at_command (ctx->modem,
+                                  "+CMMS=1",
+                                  3,
+                                  FALSE,
+                                  (GAsyncReadyCallback)batch_more_messages_ready,
+                                  task);
+        return;
+
+    case MM_SMS_SEND_STEP_MORE_MESSAGES_DISABLE:
+        mm_base_modem_at_command (ctx->modem,
+                                  "+CMMS=0",
+                                  3,
+                                  FALSE,
+                                  (GAsyncReadyCallback)batch_more_messages_ready,
+                                  task);
+        return;
+
+    case MM_SMS_SEND_STEP_DONE:
+        send_batch_complete (task);
+        return;
+
+    case MM_SMS_SEND_STEP_ITEM:
+        break;
+    }
+
+    g_assert (ctx->current);
+    next = g_list_next (ctx->current);
+    mm_base_sms_send (MM_BASE_SMS (ctx->current->data),
+                      (GAsyncReadyCallback)send_batch_sms_ready,
+                      task);
+
+    /* Generate the PDUs of the next message while this one is being
+     * transmitted; errors are reported when actually sending it */
+    if (next) {
+        MMBaseSms *next_sms = MM_BASE_SMS (next->data);
+        MMSmsState state;
+
+        state = mm_gdbus_sms_get_state (MM_GDBUS_SMS (next_sms));
+        if (state == MM_SMS_STATE_UNKNOWN || state == MM_SMS_STATE_STORED)
+            prepare_sms_to_be_sent (next_sms, NULL);
+    }
+}
+
+void
+mm_base_sms_send_batch (MMBaseModem *modem,
+                        GList *sms_list,
+                        GAsyncReadyCallback callback,
+                        gpointer user_data)
+{
+    SendBatchContext *ctx;
+    GTask *task;
+    gboolean uses_at = FALSE;
+    GList *l;
+
+    ctx = g_new0 (SendBatchContext, 1);
+    ctx->modem = g_object_ref (modem);
+    ctx->sms_list = g_list_copy (sms_list);
+    g_list_foreach (ctx->sms_list, (GFunc)g_object_ref, NULL);
+    ctx->current = ctx->sms_list;
+    ctx->timer = g_timer_new ();
+    g_variant_builder_init (&ctx->results, G_VARIANT_TYPE ("a(obus)"));
+
+    task = g_task_new (modem, NULL, callback, user_data);
+    g_task_set_task_data (task, ctx, (GDestroyNotify)send_batch_context_free);
+
+    /* The link can only be held when messages are sent with AT commands */
+    for (l = ctx->sms_list; l && !uses_at; l = g_list_next (l))
+        uses_at = (MM_BASE_SMS_GET_CLASS (l->data)->send == sms_send);
+
+    /* Failed messages don't stop the batch */
+    ctx->sequence = mm_sms_send_sequence_new (g_list_length (ctx->sms_list), uses_at, FALSE);
+    send_batch_step (task);
+}
+
+/*****************************************************************************/
+
 static gboolean
 assemble_sms (MMBaseSms *self,
               GError **error)
@@ -1754,10 +2274,9 @@ mm_base_sms_singlepart_new (MMBaseModem *modem,
          * take it, and therefore the caller is responsible for freeing it. */
         self->priv->parts = g_list_remove (self->priv->parts, part);
         g_clear_object (&self);
-    } else
-        /* Only export once properly created */
-        mm_base_sms_export (self);
+    }
 
+    /* The caller exports it, once it decides how */
     return self;
 }
 
@@ -1795,14 +2314,7 @@ mm_base_sms_multipart_new (MMBaseModem *modem,
     if (!mm_base_sms_multipart_take_part (self, first_part, error))
         g_clear_object (&self);
 
-    /* We do export uncomplete multipart messages, in order to be able to
-     *  request removal of all parts of those multipart SMS that will never
-     *  get completed.
-     * Only the STATE of the SMS object will be valid in the exported DBus
-     *  interface.*/
-    if (self)
-        mm_base_sms_export (self);
-
+    /* The caller exports it, once it decides how */
     return self;
 }
 
@@ -1891,20 +2403,22 @@ set_property (GObject *object,
         g_free (self->priv->path);
         self->priv->path = g_value_dup_string (value);
 
-        /* Export when we get a DBus connection AND we have a path */
+        /* Export when we get a DBus connection AND we have a path,
+         * unless exported on demand */
         if (!self->priv->path)
             sms_dbus_unexport (self);
-        else if (self->priv->connection)
+        else if (self->priv->connection && !self->priv->lazy_export)
             sms_dbus_export (self);
         break;
     case PROP_CONNECTION:
         g_clear_object (&self->priv->connection);
         self->priv->connection = g_value_dup_object (value);
 
-        /* Export when we get a DBus connection AND we have a path */
+        /* Export when we get a DBus connection AND we have a path,
+         * unless exported on demand */
         if (!self->priv->connection)
             sms_dbus_unexport (self);
-        else if (self->priv->path)
+        else if (self->priv->path && !self->priv->lazy_export)
             sms_dbus_export (self);
         break;
     case PROP_MODEM:
@@ -1973,6 +2487,16 @@ mm_base_sms_init (MMBaseSms *self)
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, MM_TYPE_BASE_SMS, MMBaseSmsPrivate);
     /* Defaults */
     self->priv->max_parts = 1;
+
+    /* Handle method invocations */
+    g_signal_connect (self,
+                      "handle-store",
+                      G_CALLBACK (handle_store),
+                      NULL);
+    g_signal_connect (self,
+                      "handle-send",
+                      G_CALLBACK (handle_send),
+                      NULL);
 }
 
 static void
@@ -1998,6 +2522,11 @@ dispose (GObject *object)
         g_clear_object (&self->priv->connection);
     }
 
+    if (self->priv->unexport_id) {
+        g_source_remove (self->priv->unexport_id);
+        self->priv->unexport_id = 0;
+    }
+
     g_clear_object (&self->priv->modem);
 
     G_OBJECT_CLASS (mm_base_sms_parent_class)->dispose (object);
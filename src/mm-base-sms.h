@@ -104,6 +104,13 @@ gboolean   mm_base_sms_multipart_take_part (MMBaseSms *self,
 
 void          mm_base_sms_export      (MMBaseSms *self);
 void          mm_base_sms_unexport    (MMBaseSms *self);
+
+/* Lazily exported objects get a path as usual, but are only exported in
+ * DBus when ensured, and unexported again after some inactivity */
+void          mm_base_sms_set_lazy_export (MMBaseSms *self,
+                                           gboolean lazy);
+gboolean      mm_base_sms_get_lazy_export (MMBaseSms *self);
+void          mm_base_sms_ensure_exported (MMBaseSms *self);
 const gchar  *mm_base_sms_get_path    (MMBaseSms *self);
 MMSmsStorage  mm_base_sms_get_storage (MMBaseSms *self);
 
@@ -123,4 +130,35 @@ gboolean mm_base_sms_delete_finish (MMBaseSms *self,
                                     GAsyncResult *res,
                                     GError **error);
 
+/* Removes a single part from the modem storage, e.g. once it's kept
+ * somewhere else */
+void     mm_base_sms_delete_stored_part        (MMBaseModem *modem,
+                                                MMSmsStorage storage,
+                                                guint index,
+                                                GAsyncReadyCallback callback,
+                                                gpointer user_data);
+gboolean mm_base_sms_delete_stored_part_finish (MMBaseModem *modem,
+                                                GAsyncResult *res,
+                                                GError **error);
+
+void     mm_base_sms_send        (MMBaseSms *self,
+                                  GAsyncReadyCallback callback,
+                                  gpointer user_data);
+gboolean mm_base_sms_send_finish (MMBaseSms *self,
+                                  GAsyncResult *res,
+                                  GError **error);
+
+/* Sends all given SMS in order, holding the radio link between them when
+ * possible. Per-message results are given as an a(obus) variant (path,
+ * sent, message reference, error) and overall statistics as a{sv}. */
+void     mm_base_sms_send_batch        (MMBaseModem *modem,
+                                        GList *sms_list,
+                                        GAsyncReadyCallback callback,
+                                        gpointer user_data);
+gboolean mm_base_sms_send_batch_finish (MMBaseModem *modem,
+                                        GAsyncResult *res,
+                                        GVariant **results,
+                                        GVariant **stats,
+                                        GError **error);
+
 #endif /* MM_BASE_SMS_H */
@@ -176,17 +176,36 @@ mm_bearer_list_find_by_path (MMBearerList *self,
 
 /*****************************************************************************/
 
+/* Bearers are disconnected in parallel, except for those sharing the same
+ * data interface, which are disconnected one after the other (e.g. AT bearers
+ * using the same serial port). */
+
 typedef struct {
     GList *pending;
     MMBaseBearer *current;
+} DisconnectChain;
+
+typedef struct {
+    GList *chains;
+    guint n_running;
+    GError *saved_error;
 } DisconnectAllContext;
 
+static void
+disconnect_chain_free (DisconnectChain *chain)
+{
+    if (chain->current)
+        g_object_unref (chain->current);
+    g_list_free_full (chain->pending, g_object_unref);
+    g_slice_free (DisconnectChain, chain);
+}
+
 static void
 disconnect_all_context_free (DisconnectAllContext *ctx)
 {
-    if (ctx->current)
-        g_object_unref (ctx->current);
-    g_list_free_full (ctx->pending, g_object_unref);
+    g_list_free_full (ctx->chains, (GDestroyNotify)disconnect_chain_free);
+    if (ctx->saved_error)
+        g_error_free (ctx->saved_error);
     g_free (ctx);
 }
 
@@ -198,44 +217,71 @@ mm_bearer_list_disconnect_all_bearers_finish (MMBearerList *self,
     return g_task_propagate_boolean (G_TASK (res), error);
 }
 
-static void disconnect_next_bearer (GTask *task);
+static void disconnect_next_bearer (GTask *task,
+                                    DisconnectChain *chain);
 
 static void
 disconnect_ready (MMBaseBearer *bearer,
                   GAsyncResult *res,
                   GTask *task)
 {
+    DisconnectAllContext *ctx;
+    DisconnectChain *chain = NULL;
     GError *error = NULL;
+    GList *l;
+
+    ctx = g_task_get_task_data (task);
 
+    /* Keep the first error, but go on disconnecting the remaining bearers */
     if (!mm_base_bearer_disconnect_finish (bearer, res, &error)) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
-        return;
+        if (!ctx->saved_error)
+            ctx->saved_error = error;
+        else
+            g_error_free (error);
+    }
+
+    for (l = ctx->chains; l; l = g_list_next (l)) {
+        if (((DisconnectChain *)l->data)->current == bearer) {
+            chain = l->data;
+            break;
+        }
     }
+    g_assert (chain);
 
-    disconnect_next_bearer (task);
+    disconnect_next_bearer (task, chain);
 }
 
 static void
-disconnect_next_bearer (GTask *task)
+disconnect_next_bearer (GTask *task,
+                        DisconnectChain *chain)
 {
     DisconnectAllContext *ctx;
 
     ctx = g_task_get_task_data (task);
-    if (ctx->current)
-        g_clear_object (&ctx->current);
-
-    /* No more bearers? all done! */
-    if (!ctx->pending) {
-        g_task_return_boolean (task, TRUE);
-        g_object_unref (task);
+    if (chain->current)
+        g_clear_object (&chain->current);
+
+    /* No more bearers in this chain? */
+    if (!chain->pending) {
+        g_assert (ctx->n_running > 0);
+        ctx->n_running--;
+
+        /* All chains done? */
+        if (!ctx->n_running) {
+            if (ctx->saved_error) {
+                g_task_return_error (task, ctx->saved_error);
+                ctx->saved_error = NULL;
+            } else
+                g_task_return_boolean (task, TRUE);
+            g_object_unref (task);
+        }
         return;
     }
 
-    ctx->current = MM_BASE_BEARER (ctx->pending->data);
-    ctx->pending = g_list_delete_link (ctx->pending, ctx->pending);
+    chain->current = MM_BASE_BEARER (chain->pending->data);
+    chain->pending = g_list_delete_link (chain->pending, chain->pending);
 
-    mm_base_bearer_disconnect (ctx->current,
+    mm_base_bearer_disconnect (chain->current,
                                (GAsyncReadyCallback)disconnect_ready,
                                task);
 }
@@ -246,20 +292,55 @@ mm_bearer_list_disconnect_all_bearers (MMBearerList *self,
                                        gpointer user_data)
 {
     DisconnectAllContext *ctx;
+    GHashTable *chains_by_iface;
     GTask *task;
+    GList *l;
 
     ctx = g_new0 (DisconnectAllContext, 1);
-    /* Get a copy of the list */
-    ctx->pending = g_list_copy_deep (self->priv->bearers,
-                                     (GCopyFunc)g_object_ref,
-                                     NULL);
+    chains_by_iface = g_hash_table_new (g_str_hash, g_str_equal);
+
+    /* Group bearers by data interface; bearers without one (i.e. not
+     * connected) get their own chain each */
+    for (l = self->priv->bearers; l; l = g_list_next (l)) {
+        MMBaseBearer *bearer = MM_BASE_BEARER (l->data);
+        DisconnectChain *chain = NULL;
+        const gchar *iface;
+
+        iface = mm_gdbus_bearer_get_interface (MM_GDBUS_BEARER (bearer));
+        if (iface)
+            chain = g_hash_table_lookup (chains_by_iface, iface);
+
+        if (!chain) {
+            chain = g_slice_new0 (DisconnectChain);
+            ctx->chains = g_list_append (ctx->chains, chain);
+            if (iface)
+                g_hash_table_insert (chains_by_iface, (gpointer)iface, chain);
+        }
+
+        chain->pending = g_list_append (chain->pending, g_object_ref (bearer));
+    }
+
+    g_hash_table_unref (chains_by_iface);
 
     task = g_task_new (self, NULL, callback, user_data);
     g_task_set_task_data (task,
                           ctx,
                           (GDestroyNotify)disconnect_all_context_free);
 
-    disconnect_next_bearer (task);
+    /* No bearers? all done! */
+    if (!ctx->chains) {
+        g_task_return_boolean (task, TRUE);
+        g_object_unref (task);
+        return;
+    }
+
+    /* Launch all chains; keep an extra reference while doing so, as the task
+     * may get completed before we're done iterating */
+    ctx->n_running = g_list_length (ctx->chains);
+    g_object_ref (task);
+    for (l = ctx->chains; l; l = g_list_next (l))
+        disconnect_next_bearer (task, (DisconnectChain *)l->data);
+    g_object_unref (task);
 }
 
 /*****************************************************************************/
@@ -726,32 +726,29 @@ initialize_pdp_context_ready (MMBaseModem  *modem,
     if (error) {
         mm_warn ("Couldn't initialize PDP context with our APN: '%s'", error->message);
         g_task_return_error (task, error);
-    } else
+    } else {
+        /* Keep the cached PDP context table in sync with what we just wrote */
+        if (MM_IS_BROADBAND_MODEM (modem))
+            mm_broadband_modem_update_cached_pdp_context (
+                MM_BROADBAND_MODEM (modem),
+                ctx->cid,
+                ctx->ip_family,
+                mm_bearer_properties_get_apn (mm_base_bearer_peek_config (MM_BASE_BEARER (ctx->self))));
         g_task_return_int (task, (gssize) ctx->cid);
+    }
     g_object_unref (task);
 }
 
 static void
-find_cid_ready (MMBaseModem  *modem,
-                GAsyncResult *res,
-                GTask        *task)
+cid_selection_3gpp_complete (GTask *task)
 {
     gchar                   *apn;
     gchar                   *command;
-    GError                  *error = NULL;
     const gchar             *pdp_type;
     CidSelection3gppContext *ctx;
 
     ctx = (CidSelection3gppContext *) g_task_get_task_data (task);
 
-    mm_base_modem_at_sequence_full_finish (modem, res, NULL, &error);
-    if (error) {
-        mm_warn ("Couldn't find best CID to use: '%s'", error->message);
-        g_task_return_error (task, error);
-        g_object_unref (task);
-        return;
-    }
-
     /* Validate requested PDP type */
     pdp_type = mm_3gpp_get_pdp_type_from_ip_family (ctx->ip_family);
     if (!pdp_type) {
@@ -792,42 +789,30 @@ find_cid_ready (MMBaseModem  *modem,
     g_free (command);
 }
 
-static gboolean
-parse_cid_range (MMBaseModem              *modem,
-                 CidSelection3gppContext  *ctx,
-                 const gchar              *command,
-                 const gchar              *response,
-                 gboolean                  last_command,
-                 const GError             *error,
-                 GVariant                **result,
-                 GError                  **result_error)
+static void
+find_cid_ready (MMBaseModem  *modem,
+                GAsyncResult *res,
+                GTask        *task)
 {
-    GError *inner_error = NULL;
-    GList  *formats, *l;
-    guint   cid;
-
-    /* If cancelled, set result error */
-    if (g_cancellable_is_cancelled (ctx->cancellable)) {
-        g_set_error (result_error, MM_CORE_ERROR, MM_CORE_ERROR_CANCELLED,
-                     "Connection setup operation has been cancelled");
-        return FALSE;
-    }
+    GError *error = NULL;
 
+    mm_base_modem_at_sequence_full_finish (modem, res, NULL, &error);
     if (error) {
-        mm_dbg ("Unexpected +CGDCONT error: '%s'", error->message);
-        mm_dbg ("Defaulting to CID=1");
-        ctx->cid = 1;
-        return TRUE;
+        mm_warn ("Couldn't find best CID to use: '%s'", error->message);
+        g_task_return_error (task, error);
+        g_object_unref (task);
+        return;
     }
 
-    formats = mm_3gpp_parse_cgdcont_test_response (response, &inner_error);
-    if (inner_error) {
-        mm_dbg ("Error parsing +CGDCONT test response: '%s'", inner_error->message);
-        mm_dbg ("Defaulting to CID=1");
-        g_error_free (inner_error);
-        ctx->cid = 1;
-        return TRUE;
-    }
+    cid_selection_3gpp_complete (task);
+}
+
+static void
+select_cid_from_format_list (CidSelection3gppContext *ctx,
+                             const GList             *formats)
+{
+    const GList *l;
+    guint        cid;
 
     cid = 0;
     for (l = formats; l; l = g_list_next (l)) {
@@ -850,31 +835,26 @@ parse_cid_range (MMBaseModem              *modem,
         }
     }
 
-    mm_3gpp_pdp_context_format_list_free (formats);
-
     if (cid == 0) {
         mm_dbg ("Defaulting to CID=1");
         cid = 1;
     }
 
     ctx->cid = cid;
-    return TRUE;
 }
 
 static gboolean
-parse_pdp_list (MMBaseModem             *modem,
-                CidSelection3gppContext *ctx,
-                const gchar             *command,
-                const gchar             *response,
-                gboolean                 last_command,
-                const GError            *error,
-                GVariant               **result,
-                GError                 **result_error)
+parse_cid_range (MMBaseModem              *modem,
+                 CidSelection3gppContext  *ctx,
+                 const gchar              *command,
+                 const gchar              *response,
+                 gboolean                  last_command,
+                 const GError             *error,
+                 GVariant                **result,
+                 GError                  **result_error)
 {
     GError *inner_error = NULL;
-    GList *pdp_list;
-    GList *l;
-    guint cid;
+    GList  *formats;
 
     /* If cancelled, set result error */
     if (g_cancellable_is_cancelled (ctx->cancellable)) {
@@ -883,38 +863,50 @@ parse_pdp_list (MMBaseModem             *modem,
         return FALSE;
     }
 
-    /* Some Android phones don't support querying existing PDP contexts,
-     * but will accept setting the APN.  So if CGDCONT? isn't supported,
-     * just ignore that error and hope for the best. (bgo #637327)
-     */
-    if (g_error_matches (error,
-                         MM_MOBILE_EQUIPMENT_ERROR,
-                         MM_MOBILE_EQUIPMENT_ERROR_NOT_SUPPORTED)) {
-        mm_dbg ("Querying PDP context list is unsupported");
-        return FALSE;
+    if (error) {
+        mm_dbg ("Unexpected +CGDCONT error: '%s'", error->message);
+        mm_dbg ("Defaulting to CID=1");
+        ctx->cid = 1;
+        return TRUE;
     }
 
-    if (error) {
-        mm_dbg ("Unexpected +CGDCONT? error: '%s'", error->message);
-        return FALSE;
+    formats = mm_3gpp_parse_cgdcont_test_response (response, &inner_error);
+    if (inner_error) {
+        mm_dbg ("Error parsing +CGDCONT test response: '%s'", inner_error->message);
+        mm_dbg ("Defaulting to CID=1");
+        g_error_free (inner_error);
+        ctx->cid = 1;
+        return TRUE;
     }
 
-    pdp_list = mm_3gpp_parse_cgdcont_read_response (response, &inner_error);
+    select_cid_from_format_list (ctx, formats);
+
+    /* The supported CID ranges won't change, keep them cached in the modem */
+    if (MM_IS_BROADBAND_MODEM (modem))
+        mm_broadband_modem_take_cached_pdp_context_format_list (MM_BROADBAND_MODEM (modem), formats);
+    else
+        mm_3gpp_pdp_context_format_list_free (formats);
+
+    return TRUE;
+}
+
+static gboolean
+select_cid_from_pdp_list (CidSelection3gppContext *ctx,
+                          const GList             *pdp_list)
+{
+    const GList *l;
+    guint        cid;
+
     if (!pdp_list) {
-        if (inner_error) {
-            mm_dbg ("%s", inner_error->message);
-            g_error_free (inner_error);
-        } else {
-            /* No predefined PDP contexts found */
-            mm_dbg ("No PDP contexts found");
-        }
+        /* No predefined PDP contexts found */
+        mm_dbg ("No PDP contexts found");
         return FALSE;
     }
 
     cid = 0;
 
     /* Show all found PDP contexts in debug log */
-    mm_dbg ("Found '%u' PDP contexts", g_list_length (pdp_list));
+    mm_dbg ("Found '%u' PDP contexts", g_list_length ((GList *) pdp_list));
     for (l = pdp_list; l; l = g_list_next (l)) {
         MM3gppPdpContext *pdp = l->data;
         gchar *ip_family_str;
@@ -961,7 +953,6 @@ parse_pdp_list (MMBaseModem             *modem,
         if (ctx->max_cid < pdp->cid)
             ctx->max_cid = pdp->cid;
     }
-    mm_3gpp_pdp_context_list_free (pdp_list);
 
     if (cid > 0) {
         ctx->cid = cid;
@@ -971,12 +962,75 @@ parse_pdp_list (MMBaseModem             *modem,
     return FALSE;
 }
 
+static gboolean
+parse_pdp_list (MMBaseModem             *modem,
+                CidSelection3gppContext *ctx,
+                const gchar             *command,
+                const gchar             *response,
+                gboolean                 last_command,
+                const GError            *error,
+                GVariant               **result,
+                GError                 **result_error)
+{
+    GError   *inner_error = NULL;
+    GList    *pdp_list;
+    gboolean  found;
+
+    /* If cancelled, set result error */
+    if (g_cancellable_is_cancelled (ctx->cancellable)) {
+        g_set_error (result_error, MM_CORE_ERROR, MM_CORE_ERROR_CANCELLED,
+                     "Connection setup operation has been cancelled");
+        return FALSE;
+    }
+
+    /* Some Android phones don't support querying existing PDP contexts,
+     * but will accept setting the APN.  So if CGDCONT? isn't supported,
+     * just ignore that error and hope for the best. (bgo #637327)
+     */
+    if (g_error_matches (error,
+                         MM_MOBILE_EQUIPMENT_ERROR,
+                         MM_MOBILE_EQUIPMENT_ERROR_NOT_SUPPORTED)) {
+        mm_dbg ("Querying PDP context list is unsupported");
+        /* Cache an empty list so that we don't retry the query */
+        if (MM_IS_BROADBAND_MODEM (modem))
+            mm_broadband_modem_take_cached_pdp_context_list (MM_BROADBAND_MODEM (modem), NULL);
+        return FALSE;
+    }
+
+    if (error) {
+        mm_dbg ("Unexpected +CGDCONT? error: '%s'", error->message);
+        return FALSE;
+    }
+
+    pdp_list = mm_3gpp_parse_cgdcont_read_response (response, &inner_error);
+    if (inner_error) {
+        mm_dbg ("%s", inner_error->message);
+        g_error_free (inner_error);
+        return FALSE;
+    }
+
+    found = select_cid_from_pdp_list (ctx, pdp_list);
+
+    if (MM_IS_BROADBAND_MODEM (modem))
+        mm_broadband_modem_take_cached_pdp_context_list (MM_BROADBAND_MODEM (modem), pdp_list);
+    else
+        mm_3gpp_pdp_context_list_free (pdp_list);
+
+    return found;
+}
+
 static const MMBaseModemAtCommand find_cid_sequence[] = {
     { "+CGDCONT?",  3, FALSE, (MMBaseModemAtResponseProcessor) parse_pdp_list  },
     { "+CGDCONT=?", 3, TRUE,  (MMBaseModemAtResponseProcessor) parse_cid_range },
     { NULL }
 };
 
+/* Used when the PDP context list is already cached */
+static const MMBaseModemAtCommand find_cid_range_sequence[] = {
+    { "+CGDCONT=?", 3, TRUE,  (MMBaseModemAtResponseProcessor) parse_cid_range },
+    { NULL }
+};
+
 static void
 cid_selection_3gpp (MMBroadbandBearer   *self,
                     MMBaseModem         *modem,
@@ -985,8 +1039,9 @@ cid_selection_3gpp (MMBroadbandBearer   *self,
                     GAsyncReadyCallback  callback,
                     gpointer             user_data)
 {
-    GTask                   *task;
-    CidSelection3gppContext *ctx;
+    GTask                      *task;
+    CidSelection3gppContext    *ctx;
+    const MMBaseModemAtCommand *sequence = find_cid_sequence;
 
     ctx = g_slice_new0 (CidSelection3gppContext);
     ctx->self        = g_object_ref (self);
@@ -998,10 +1053,33 @@ cid_selection_3gpp (MMBroadbandBearer   *self,
     task = g_task_new (self, cancellable, callback, user_data);
     g_task_set_task_data (task, ctx, (GDestroyNotify) cid_selection_3gpp_context_free);
 
+    /* If we already know the PDP context table of the modem, try to avoid
+     * querying it again */
+    if (MM_IS_BROADBAND_MODEM (modem)) {
+        const GList *pdp_list;
+        const GList *pdp_format_list;
+
+        if (mm_broadband_modem_peek_cached_pdp_context_list (MM_BROADBAND_MODEM (modem), &pdp_list)) {
+            mm_dbg ("Looking for best CID in cached PDP context list...");
+            if (select_cid_from_pdp_list (ctx, pdp_list)) {
+                cid_selection_3gpp_complete (task);
+                return;
+            }
+
+            if (mm_broadband_modem_peek_cached_pdp_context_format_list (MM_BROADBAND_MODEM (modem), &pdp_format_list)) {
+                select_cid_from_format_list (ctx, pdp_format_list);
+                cid_selection_3gpp_complete (task);
+                return;
+            }
+
+            sequence = find_cid_range_sequence;
+        }
+    }
+
     mm_dbg ("Looking for best CID...");
     mm_base_modem_at_sequence_full (ctx->modem,
                                     ctx->primary,
-                                    find_cid_sequence,
+                                    sequence,
                                     ctx, /* also passed as response processor context */
                                     NULL, /* response_processor_context_free */
                                     NULL, /* cancellable */
@@ -1073,6 +1151,10 @@ dial_3gpp_ready (MMBroadbandModem *modem,
     if (!ctx->data) {
         /* Clear CID when it failed to connect. */
         ctx->self->priv->cid = 0;
+        /* The cached PDP context table may be out of sync with the modem,
+         * so reload it on the next attempt */
+        if (!g_error_matches (error, MM_CORE_ERROR, MM_CORE_ERROR_CANCELLED))
+            mm_broadband_modem_invalidate_pdp_context_cache (modem);
         g_simple_async_result_take_error (ctx->result, error);
         detailed_connect_context_complete_and_free (ctx);
         return;
@@ -1231,6 +1313,22 @@ connect_succeeded (ConnectContext *ctx,
      * may already be set as connected, but no big deal. */
     mm_port_set_connected (ctx->self->priv->port, TRUE);
 
+    /* If packet domain events are reported, network initiated disconnections
+     * of the context will be detected right away, so the connection monitor
+     * doesn't need to poll that often. */
+    if (connection_type == CONNECTION_TYPE_3GPP && ctx->self->priv->cid) {
+        MMBaseModem *modem = NULL;
+
+        g_object_get (ctx->self,
+                      MM_BASE_BEARER_MODEM, &modem,
+                      NULL);
+        mm_base_bearer_set_connection_status_indications (
+            MM_BASE_BEARER (ctx->self),
+            MM_IS_BROADBAND_MODEM (modem) && mm_broadband_modem_get_cgev_enabled (MM_BROADBAND_MODEM (modem)));
+        g_clear_object (&modem);
+    } else
+        mm_base_bearer_set_connection_status_indications (MM_BASE_BEARER (ctx->self), FALSE);
+
     /* Set operation result */
     g_simple_async_result_set_op_res_gpointer (ctx->result,
                                                result,
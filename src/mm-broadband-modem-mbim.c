@@ -2350,9 +2350,12 @@ subscribe_list_set_ready_cb (MbimDevice *device,
                              GAsyncResult *res,
                              GTask *task)
 {
+    MMBroadbandModemMbim *self;
     MbimMessage *response;
     GError *error = NULL;
 
+    self = g_task_get_source_object (task);
+
     response = mbim_device_command_finish (device, res, &error);
     if (response) {
         mbim_message_response_get_result (response, MBIM_MESSAGE_TYPE_COMMAND_DONE, &error);
@@ -2361,8 +2364,13 @@ subscribe_list_set_ready_cb (MbimDevice *device,
 
     if (error)
         g_task_return_error (task, error);
-    else
+    else {
+        /* Signal quality updates come in signal state notifications */
+        mm_iface_modem_set_signal_quality_indications (
+            MM_IFACE_MODEM (self),
+            !!(self->priv->enable_flags & PROCESS_NOTIFICATION_FLAG_SIGNAL_QUALITY));
         g_task_return_boolean (task, TRUE);
+    }
     g_object_unref (task);
 }
 
@@ -3138,6 +3146,252 @@ messaging_create_sms (MMIfaceModemMessaging *self)
     return mm_sms_mbim_new (MM_BASE_MODEM (self));
 }
 
+/*****************************************************************************/
+/* Check support (Signal interface) */
+
+static gboolean
+signal_check_support_finish (MMIfaceModemSignal *self,
+                             GAsyncResult *res,
+                             GError **error)
+{
+    return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+static void
+signal_check_support_ready (MbimDevice *device,
+                            GAsyncResult *res,
+                            GTask *task)
+{
+    MbimMessage *response;
+    GError *error = NULL;
+
+    response = mbim_device_command_finish (device, res, &error);
+    if (response &&
+        mbim_message_response_get_result (response, MBIM_MESSAGE_TYPE_COMMAND_DONE, &error))
+        g_task_return_boolean (task, TRUE);
+    else
+        g_task_return_error (task, error);
+    g_object_unref (task);
+
+    if (response)
+        mbim_message_unref (response);
+}
+
+static void
+signal_check_support (MMIfaceModemSignal *self,
+                      GAsyncReadyCallback callback,
+                      gpointer user_data)
+{
+    MbimDevice *device;
+    MbimMessage *message;
+    GTask *task;
+
+    if (!peek_device (self, &device, callback, user_data))
+        return;
+
+    task = g_task_new (self, NULL, callback, user_data);
+
+    /* The RSSI in the signal state is all the extended information we get */
+    message = mbim_message_signal_state_query_new (NULL);
+    mbim_device_command (device,
+                         message,
+                         5,
+                         NULL,
+                         (GAsyncReadyCallback)signal_check_support_ready,
+                         task);
+    mbim_message_unref (message);
+}
+
+/*****************************************************************************/
+/* Load extended signal information (Signal interface) */
+
+static gboolean
+signal_load_values_finish (MMIfaceModemSignal *_self,
+                           GAsyncResult *res,
+                           MMSignal **cdma,
+                           MMSignal **evdo,
+                           MMSignal **gsm,
+                           MMSignal **umts,
+                           MMSignal **lte,
+                           GError **error)
+{
+    MMBroadbandModemMbim *self = MM_BROADBAND_MODEM_MBIM (_self);
+    MMModemAccessTechnology act;
+    MMSignal *signal;
+    gssize rssi;
+
+    rssi = g_task_propagate_int (G_TASK (res), error);
+    if (rssi < 0)
+        return FALSE;
+
+    if (cdma)
+        *cdma = NULL;
+    if (evdo)
+        *evdo = NULL;
+    if (gsm)
+        *gsm = NULL;
+    if (umts)
+        *umts = NULL;
+    if (lte)
+        *lte = NULL;
+
+    /* 99 means unknown */
+    if (rssi == 99)
+        return TRUE;
+
+    /* The value applies to the technology currently in use */
+    act = mm_modem_access_technology_from_mbim_data_class (self->priv->highest_available_data_class);
+    if (act == MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN)
+        act = mm_modem_access_technology_from_mbim_data_class (self->priv->available_data_classes);
+
+    signal = mm_signal_new ();
+    /* Coded as in AT+CSQ, 2 dBm steps from -113 dBm */
+    mm_signal_set_rssi (signal, -113.0 + 2.0 * MIN (rssi, 31));
+
+    if (act & MM_MODEM_ACCESS_TECHNOLOGY_LTE) {
+        if (lte)
+            *lte = g_object_ref (signal);
+    } else if (act & (MM_MODEM_ACCESS_TECHNOLOGY_UMTS |
+                      MM_MODEM_ACCESS_TECHNOLOGY_HSDPA |
+                      MM_MODEM_ACCESS_TECHNOLOGY_HSUPA)) {
+        if (umts)
+            *umts = g_object_ref (signal);
+    } else if (act & (MM_MODEM_ACCESS_TECHNOLOGY_GPRS |
+                      MM_MODEM_ACCESS_TECHNOLOGY_EDGE)) {
+        if (gsm)
+            *gsm = g_object_ref (signal);
+    } else if (act & (MM_MODEM_ACCESS_TECHNOLOGY_EVDO0 |
+                      MM_MODEM_ACCESS_TECHNOLOGY_EVDOA |
+                      MM_MODEM_ACCESS_TECHNOLOGY_EVDOB)) {
+        if (evdo)
+            *evdo = g_object_ref (signal);
+    } else if (act & MM_MODEM_ACCESS_TECHNOLOGY_1XRTT) {
+        if (cdma)
+            *cdma = g_object_ref (signal);
+    }
+
+    g_object_unref (signal);
+    return TRUE;
+}
+
+static void
+signal_state_query_ready (MbimDevice *device,
+                          GAsyncResult *res,
+                          GTask *task)
+{
+    MbimMessage *response;
+    GError *error = NULL;
+    guint32 rssi;
+
+    response = mbim_device_command_finish (device, res, &error);
+    if (response &&
+        mbim_message_response_get_result (response, MBIM_MESSAGE_TYPE_COMMAND_DONE, &error) &&
+        mbim_message_signal_state_response_parse (
+            response,
+            &rssi,
+            NULL, /* error_rate */
+            NULL, /* signal_strength_interval */
+            NULL, /* rssi_threshold */
+            NULL, /* error_rate_threshold */
+            &error))
+        g_task_return_int (task, rssi);
+    else
+        g_task_return_error (task, error);
+    g_object_unref (task);
+
+    if (response)
+        mbim_message_unref (response);
+}
+
+static void
+signal_load_values (MMIfaceModemSignal *self,
+                    GCancellable *cancellable,
+                    GAsyncReadyCallback callback,
+                    gpointer user_data)
+{
+    MbimDevice *device;
+    MbimMessage *message;
+    GTask *task;
+
+    if (!peek_device (self, &device, callback, user_data))
+        return;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+
+    message = mbim_message_signal_state_query_new (NULL);
+    mbim_device_command (device,
+                         message,
+                         5,
+                         NULL,
+                         (GAsyncReadyCallback)signal_state_query_ready,
+                         task);
+    mbim_message_unref (message);
+}
+
+/*****************************************************************************/
+/* Setup thresholds (Signal interface) */
+
+static gboolean
+signal_setup_thresholds_finish (MMIfaceModemSignal *self,
+                                GAsyncResult *res,
+                                GError **error)
+{
+    return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+static void
+signal_state_set_ready (MbimDevice *device,
+                        GAsyncResult *res,
+                        GTask *task)
+{
+    MbimMessage *response;
+    GError *error = NULL;
+
+    response = mbim_device_command_finish (device, res, &error);
+    if (response &&
+        mbim_message_response_get_result (response, MBIM_MESSAGE_TYPE_COMMAND_DONE, &error))
+        g_task_return_boolean (task, TRUE);
+    else {
+        g_prefix_error (&error, "Couldn't set signal state: ");
+        g_task_return_error (task, error);
+    }
+    g_object_unref (task);
+
+    if (response)
+        mbim_message_unref (response);
+}
+
+static void
+signal_setup_thresholds (MMIfaceModemSignal *self,
+                         guint rssi_threshold,
+                         GAsyncReadyCallback callback,
+                         gpointer user_data)
+{
+    MbimDevice *device;
+    MbimMessage *message;
+    GTask *task;
+
+    if (!peek_device (self, &device, callback, user_data))
+        return;
+
+    task = g_task_new (self, NULL, callback, user_data);
+
+    /* The threshold is given in coded RSSI units, 2 dBm each; rounded up so
+     * that the modem doesn't report smaller changes than requested. 0 keeps
+     * the modem default, and so do the interval and error rate threshold. */
+    message = mbim_message_signal_state_set_new (0, /* signal_strength_interval */
+                                                 (rssi_threshold + 1) / 2,
+                                                 0, /* error_rate_threshold */
+                                                 NULL);
+    mbim_device_command (device,
+                         message,
+                         5,
+                         NULL,
+                         (GAsyncReadyCallback)signal_state_set_ready,
+                         task);
+    mbim_message_unref (message);
+}
+
 /*****************************************************************************/
 
 MMBroadbandModemMbim *
@@ -3319,10 +3573,12 @@ iface_modem_messaging_init (MMIfaceModemMessaging *iface)
 static void
 iface_modem_signal_init (MMIfaceModemSignal *iface)
 {
-    iface->check_support = NULL;
-    iface->check_support_finish = NULL;
-    iface->load_values = NULL;
-    iface->load_values_finish = NULL;
+    iface->check_support = signal_check_support;
+    iface->check_support_finish = signal_check_support_finish;
+    iface->load_values = signal_load_values;
+    iface->load_values_finish = signal_load_values_finish;
+    iface->setup_thresholds = signal_setup_thresholds;
+    iface->setup_thresholds_finish = signal_setup_thresholds_finish;
 }
 
 static void
@@ -89,6 +89,7 @@ struct _MMBroadbandModemQmiPrivate {
 #if defined WITH_NEWEST_QMI_COMMANDS
     guint signal_info_indication_id;
 #endif /* WITH_NEWEST_QMI_COMMANDS */
+    guint signal_rssi_threshold;
 
     /* New devices may not support the legacy DMS UIM commands */
     gboolean dms_uim_deprecated;
@@ -6732,6 +6733,7 @@ ser_signal_strength_ready (QmiClientNas *client,
 {
     QmiMessageNasSetEventReportOutput *output = NULL;
     GError *error = NULL;
+    gboolean indications = FALSE;
 
     output = qmi_client_nas_set_event_report_finish (client, res, &error);
     if (!output) {
@@ -6740,11 +6742,14 @@ ser_signal_strength_ready (QmiClientNas *client,
     } else if (!qmi_message_nas_set_event_report_output_get_result (output, &error)) {
         mm_dbg ("Couldn't set event report: '%s'", error->message);
         g_error_free (error);
-    }
+    } else
+        indications = ctx->enable;
 
     if (output)
         qmi_message_nas_set_event_report_output_unref (output);
 
+    mm_iface_modem_set_signal_quality_indications (MM_IFACE_MODEM (ctx->self), indications);
+
     /* Just ignore errors for now */
     ctx->self->priv->unsolicited_events_enabled = ctx->enable;
     g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
@@ -6794,6 +6799,7 @@ ri_signal_info_ready (QmiClientNas *client,
 {
     QmiMessageNasRegisterIndicationsOutput *output = NULL;
     GError *error = NULL;
+    gboolean indications = FALSE;
 
     output = qmi_client_nas_register_indications_finish (client, res, &error);
     if (!output) {
@@ -6802,11 +6808,14 @@ ri_signal_info_ready (QmiClientNas *client,
     } else if (!qmi_message_nas_register_indications_output_get_result (output, &error)) {
         mm_dbg ("Couldn't register indications: '%s'", error->message);
         g_error_free (error);
-    }
+    } else
+        indications = ctx->enable;
 
     if (output)
         qmi_message_nas_register_indications_output_unref (output);
 
+    mm_iface_modem_set_signal_quality_indications (MM_IFACE_MODEM (ctx->self), indications);
+
     /* Just ignore errors for now */
     ctx->self->priv->unsolicited_events_enabled = ctx->enable;
     g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
@@ -6854,32 +6863,62 @@ config_signal_info_ready (QmiClientNas *client,
     common_enable_disable_unsolicited_events_signal_info (ctx);
 }
 
-static void
-common_enable_disable_unsolicited_events_signal_info_config (EnableUnsolicitedEventsContext *ctx)
+/* RSSI values go between -105 and -60 for 3GPP technologies,
+ * and from -105 to -90 in 3GPP2 technologies (approx). */
+#define SIGNAL_INFO_RSSI_MIN            -105
+#define SIGNAL_INFO_RSSI_MAX            -60
+#define SIGNAL_INFO_RSSI_MAX_THRESHOLDS 10
+
+static QmiMessageNasConfigSignalInfoInput *
+config_signal_info_input_new (MMBroadbandModemQmi *self)
 {
-    /* RSSI values go between -105 and -60 for 3GPP technologies,
-     * and from -105 to -90 in 3GPP2 technologies (approx). */
-    static const gint8 thresholds_data[] = { -100, -97, -95, -92, -90, -85, -80, -75, -70, -65 };
+    static const gint8 default_thresholds_data[] = { -100, -97, -95, -92, -90, -85, -80, -75, -70, -65 };
     QmiMessageNasConfigSignalInfoInput *input;
     GArray *thresholds;
 
-    /* Signal info config only to be run when enabling */
-    if (!ctx->enable) {
-        common_enable_disable_unsolicited_events_signal_info (ctx);
-        return;
-    }
-
     input = qmi_message_nas_config_signal_info_input_new ();
+    thresholds = g_array_sized_new (FALSE, FALSE, sizeof (gint8), SIGNAL_INFO_RSSI_MAX_THRESHOLDS);
 
-    /* Prepare thresholds, separated 20 each */
-    thresholds = g_array_sized_new (FALSE, FALSE, sizeof (gint8), G_N_ELEMENTS (thresholds_data));
-    g_array_append_vals (thresholds, thresholds_data, G_N_ELEMENTS (thresholds_data));
+    if (self->priv->signal_rssi_threshold == 0)
+        g_array_append_vals (thresholds, default_thresholds_data, G_N_ELEMENTS (default_thresholds_data));
+    else {
+        guint step;
+        gint rssi;
+
+        /* Don't configure too many thresholds; the step is made large enough
+         * to cover the whole range, so thresholds below 5 dB end up as 5 dB
+         * steps, as documented in SetupThresholds() */
+        step = MAX (self->priv->signal_rssi_threshold,
+                    (guint)((SIGNAL_INFO_RSSI_MAX - SIGNAL_INFO_RSSI_MIN) / (SIGNAL_INFO_RSSI_MAX_THRESHOLDS - 1)));
+        for (rssi = SIGNAL_INFO_RSSI_MIN;
+             rssi <= SIGNAL_INFO_RSSI_MAX && thresholds->len < SIGNAL_INFO_RSSI_MAX_THRESHOLDS;
+             rssi += step) {
+            gint8 value = (gint8)rssi;
+
+            g_array_append_val (thresholds, value);
+        }
+    }
 
     qmi_message_nas_config_signal_info_input_set_rssi_threshold (
         input,
         thresholds,
         NULL);
     g_array_unref (thresholds);
+    return input;
+}
+
+static void
+common_enable_disable_unsolicited_events_signal_info_config (EnableUnsolicitedEventsContext *ctx)
+{
+    QmiMessageNasConfigSignalInfoInput *input;
+
+    /* Signal info config only to be run when enabling */
+    if (!ctx->enable) {
+        common_enable_disable_unsolicited_events_signal_info (ctx);
+        return;
+    }
+
+    input = config_signal_info_input_new (ctx->self);
     qmi_client_nas_config_signal_info (
         ctx->client,
         input,
@@ -10657,6 +10696,102 @@ signal_check_support (MMIfaceModemSignal *self,
     g_object_unref (result);
 }
 
+/*****************************************************************************/
+/* Setup thresholds (Signal interface) */
+
+static gboolean
+signal_setup_thresholds_finish (MMIfaceModemSignal *self,
+                                GAsyncResult *res,
+                                GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+#if defined WITH_NEWEST_QMI_COMMANDS
+
+static void
+signal_setup_thresholds_config_ready (QmiClientNas *client,
+                                      GAsyncResult *res,
+                                      GSimpleAsyncResult *simple)
+{
+    QmiMessageNasConfigSignalInfoOutput *output;
+    GError *error = NULL;
+
+    output = qmi_client_nas_config_signal_info_finish (client, res, &error);
+    if (!output) {
+        g_prefix_error (&error, "QMI operation failed: ");
+        g_simple_async_result_take_error (simple, error);
+    } else if (!qmi_message_nas_config_signal_info_output_get_result (output, &error)) {
+        g_prefix_error (&error, "Couldn't config signal info: ");
+        g_simple_async_result_take_error (simple, error);
+    } else
+        g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+
+    if (output)
+        qmi_message_nas_config_signal_info_output_unref (output);
+
+    g_simple_async_result_complete (simple);
+    g_object_unref (simple);
+}
+
+#endif /* WITH_NEWEST_QMI_COMMANDS */
+
+static void
+signal_setup_thresholds (MMIfaceModemSignal *_self,
+                         guint rssi_threshold,
+                         GAsyncReadyCallback callback,
+                         gpointer user_data)
+{
+    MMBroadbandModemQmi *self = MM_BROADBAND_MODEM_QMI (_self);
+    GSimpleAsyncResult *result;
+    QmiClient *client = NULL;
+
+    if (!ensure_qmi_client (self,
+                            QMI_SERVICE_NAS, &client,
+                            callback, user_data))
+        return;
+
+    result = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        signal_setup_thresholds);
+
+    /* Also applied whenever unsolicited events get enabled */
+    self->priv->signal_rssi_threshold = rssi_threshold;
+
+#if defined WITH_NEWEST_QMI_COMMANDS
+    /* Signal info introduced in NAS 1.8 */
+    if (qmi_client_check_version (client, 1, 8)) {
+        QmiMessageNasConfigSignalInfoInput *input;
+
+        if (!self->priv->unsolicited_events_enabled) {
+            g_simple_async_result_set_op_res_gboolean (result, TRUE);
+            g_simple_async_result_complete_in_idle (result);
+            g_object_unref (result);
+            return;
+        }
+
+        input = config_signal_info_input_new (self);
+        qmi_client_nas_config_signal_info (
+            QMI_CLIENT_NAS (client),
+            input,
+            5,
+            NULL,
+            (GAsyncReadyCallback)signal_setup_thresholds_config_ready,
+            result);
+        qmi_message_nas_config_signal_info_input_unref (input);
+        return;
+    }
+#endif /* WITH_NEWEST_QMI_COMMANDS */
+
+    g_simple_async_result_set_error (result,
+                                     MM_CORE_ERROR,
+                                     MM_CORE_ERROR_UNSUPPORTED,
+                                     "Signal info thresholds not supported");
+    g_simple_async_result_complete_in_idle (result);
+    g_object_unref (result);
+}
+
 /*****************************************************************************/
 /* Load extended signal information */
 
@@ -11612,6 +11747,8 @@ iface_modem_signal_init (MMIfaceModemSignal *iface)
     iface->check_support_finish = signal_check_support_finish;
     iface->load_values = signal_load_values;
     iface->load_values_finish = signal_load_values_finish;
+    iface->setup_thresholds = signal_setup_thresholds;
+    iface->setup_thresholds_finish = signal_setup_thresholds_finish;
 }
 
 static void
@@ -118,6 +118,7 @@ enum {
     PROP_MODEM_SIM_HOT_SWAP_SUPPORTED,
     PROP_MODEM_SIM_HOT_SWAP_CONFIGURED,
     PROP_FLOW_CONTROL,
+    PROP_COMPOUND_AT_COMMANDS,
     PROP_LAST
 };
 
@@ -156,6 +157,7 @@ struct _MMBroadbandModemPrivate {
     MM3gppCmerMode modem_cmer_disable_mode;
     MM3gppCmerInd modem_cmer_ind;
     MMFlowControl flow_control;
+    gboolean compound_at_commands;
 
     /*<--- Modem 3GPP interface --->*/
     /* Properties */
@@ -167,6 +169,11 @@ struct _MMBroadbandModemPrivate {
     /* Implementation helpers */
     GPtrArray *modem_3gpp_registration_regex;
     MMModem3gppFacility modem_3gpp_ignored_facility_locks;
+    gboolean modem_3gpp_pdp_context_list_cached;
+    GList *modem_3gpp_pdp_context_list;
+    gboolean modem_3gpp_pdp_context_format_list_cached;
+    GList *modem_3gpp_pdp_context_format_list;
+    gboolean modem_3gpp_cgev_enabled;
 
     /*<--- Modem 3GPP USSD interface --->*/
     /* Properties */
@@ -2621,6 +2628,86 @@ set_unsolicited_events_handlers (MMBroadbandModem *self,
     g_regex_unref (ciev_regex);
 }
 
+typedef struct {
+    MM3gppCgev event;
+    guint cid;
+} CgevContext;
+
+static void
+cgev_report_bearer_disconnected (MMBaseBearer *bearer,
+                                 CgevContext  *ctx)
+{
+    /* Detach events disconnect all bearers, deactivation events only the
+     * one bound to the given CID */
+    if (ctx->event != MM_3GPP_CGEV_NW_DETACH && ctx->event != MM_3GPP_CGEV_ME_DETACH) {
+        if (!MM_IS_BROADBAND_BEARER (bearer) ||
+            mm_broadband_bearer_get_3gpp_cid (MM_BROADBAND_BEARER (bearer)) != ctx->cid)
+            return;
+    }
+
+    if (mm_base_bearer_get_status (bearer) != MM_BEARER_STATUS_CONNECTED)
+        return;
+
+    mm_dbg ("Bearer %s disconnected by +CGEV indication",
+            mm_base_bearer_get_path (bearer));
+    mm_base_bearer_report_connection_status (bearer, MM_BEARER_CONNECTION_STATUS_DISCONNECTED);
+}
+
+static void
+cgev_received (MMPortSerialAt *port,
+               GMatchInfo *info,
+               MMBroadbandModem *self)
+{
+    CgevContext  ctx = { MM_3GPP_CGEV_UNKNOWN, 0 };
+    gchar       *str;
+
+    str = g_match_info_fetch (info, 1);
+    if (str)
+        ctx.event = mm_3gpp_parse_cgev_indication (str, &ctx.cid);
+
+    if (ctx.event == MM_3GPP_CGEV_UNKNOWN) {
+        mm_dbg ("Ignoring +CGEV indication: '%s'", str ? str : "");
+        g_free (str);
+        return;
+    }
+
+    mm_dbg ("Processing +CGEV indication: '%s'", str);
+    g_free (str);
+
+    if (self->priv->modem_bearer_list)
+        mm_bearer_list_foreach (self->priv->modem_bearer_list,
+                                (MMBearerListForeachFunc) cgev_report_bearer_disconnected,
+                                &ctx);
+}
+
+static void
+set_cgev_unsolicited_events_handlers (MMBroadbandModem *self,
+                                      gboolean enable)
+{
+    MMPortSerialAt *ports[2];
+    GRegex *cgev_regex;
+    guint i;
+
+    cgev_regex = mm_3gpp_cgev_regex_get ();
+    ports[0] = mm_base_modem_peek_port_primary (MM_BASE_MODEM (self));
+    ports[1] = mm_base_modem_peek_port_secondary (MM_BASE_MODEM (self));
+
+    for (i = 0; i < 2; i++) {
+        if (!ports[i])
+            continue;
+
+        /* Set/unset unsolicited CGEV event handler */
+        mm_port_serial_at_add_unsolicited_msg_handler (
+            ports[i],
+            cgev_regex,
+            enable ? (MMPortSerialAtUnsolicitedMsgFn) cgev_received : NULL,
+            enable ? self : NULL,
+            NULL);
+    }
+
+    g_regex_unref (cgev_regex);
+}
+
 static void
 cmer_format_check_ready (MMBroadbandModem   *self,
                          GAsyncResult       *res,
@@ -2770,6 +2857,9 @@ modem_3gpp_setup_unsolicited_events (MMIfaceModem3gpp *_self,
                                         user_data,
                                         modem_3gpp_setup_unsolicited_events);
 
+    /* Packet domain events don't depend on indicator support */
+    set_cgev_unsolicited_events_handlers (self, TRUE);
+
     /* Load supported indicators */
     if (!self->priv->modem_cind_support_checked) {
         mm_dbg ("Checking indicator support...");
@@ -2805,6 +2895,8 @@ modem_3gpp_cleanup_unsolicited_events (MMIfaceModem3gpp *_self,
                                         user_data,
                                         modem_3gpp_cleanup_unsolicited_events);
 
+    set_cgev_unsolicited_events_handlers (self, FALSE);
+
     /* If supported, go on */
     if (self->priv->modem_cind_support_checked && self->priv->modem_cind_supported)
         set_unsolicited_events_handlers (self, FALSE);
@@ -2817,6 +2909,10 @@ modem_3gpp_cleanup_unsolicited_events (MMIfaceModem3gpp *_self,
 /*****************************************************************************/
 /* Enabling/disabling unsolicited events (3GPP interface) */
 
+/* +CMER is run in both primary and secondary ports (if supported), and then
+ * +CGEREP in the same ports to get packet domain events reported, which
+ * allows detecting network initiated disconnections without polling. */
+
 typedef struct {
     MMBroadbandModem *self;
     gchar *command;
@@ -2824,6 +2920,8 @@ typedef struct {
     GSimpleAsyncResult *result;
     gboolean cmer_primary_done;
     gboolean cmer_secondary_done;
+    gboolean cgerep_primary_done;
+    gboolean cgerep_secondary_done;
 } UnsolicitedEventsContext;
 
 static void
@@ -2846,6 +2944,26 @@ modem_3gpp_enable_disable_unsolicited_events_finish (MMIfaceModem3gpp *self,
 
 static void run_unsolicited_events_setup (UnsolicitedEventsContext *ctx);
 
+static void
+cgerep_setup_ready (MMBroadbandModem *self,
+                    GAsyncResult *res,
+                    UnsolicitedEventsContext *ctx)
+{
+    GError *error = NULL;
+
+    if (!mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, &error)) {
+        /* Not critical, connection monitoring will rely on polling */
+        mm_dbg ("Couldn't %s packet domain event reporting: '%s'",
+                ctx->enable ? "enable" : "disable",
+                error->message);
+        g_error_free (error);
+    } else if (ctx->enable)
+        self->priv->modem_3gpp_cgev_enabled = TRUE;
+
+    /* Run on next port, if any */
+    run_unsolicited_events_setup (ctx);
+}
+
 static void
 unsolicited_events_setup_ready (MMBroadbandModem *self,
                                 GAsyncResult *res,
@@ -2854,19 +2972,20 @@ unsolicited_events_setup_ready (MMBroadbandModem *self,
     GError *error = NULL;
 
     mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, &error);
-    if (!error) {
-        /* Run on next port, if any */
-        run_unsolicited_events_setup (ctx);
-        return;
+    if (error) {
+        mm_dbg ("Couldn't %s event reporting: '%s'",
+                ctx->enable ? "enable" : "disable",
+                error->message);
+        g_error_free (error);
+        /* Ignore errors, but skip +CMER in the remaining ports */
+        ctx->cmer_secondary_done = TRUE;
+    } else if (ctx->enable && CIND_INDICATOR_IS_VALID (self->priv->modem_cind_indicator_signal_quality)) {
+        /* Signal quality changes are now reported via +CIEV */
+        mm_iface_modem_set_signal_quality_indications (MM_IFACE_MODEM (self), TRUE);
     }
 
-    mm_dbg ("Couldn't %s event reporting: '%s'",
-            ctx->enable ? "enable" : "disable",
-            error->message);
-    g_error_free (error);
-    /* Consider this operation complete, ignoring errors */
-    g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
-    unsolicited_events_context_complete_and_free (ctx);
+    /* Run on next port, if any */
+    run_unsolicited_events_setup (ctx);
 }
 
 static void
@@ -2896,6 +3015,28 @@ run_unsolicited_events_setup (UnsolicitedEventsContext *ctx)
         return;
     }
 
+    if (!ctx->cgerep_primary_done) {
+        ctx->cgerep_primary_done = TRUE;
+        port = mm_base_modem_peek_port_primary (MM_BASE_MODEM (ctx->self));
+    } else if (!ctx->cgerep_secondary_done) {
+        ctx->cgerep_secondary_done = TRUE;
+        port = mm_base_modem_peek_port_secondary (MM_BASE_MODEM (ctx->self));
+    }
+
+    /* Enable packet domain events in given port */
+    if (port) {
+        mm_base_modem_at_command_full (MM_BASE_MODEM (ctx->self),
+                                       port,
+                                       ctx->enable ? "+CGEREP=2" : "+CGEREP=0",
+                                       3,
+                                       FALSE,
+                                       FALSE, /* raw */
+                                       NULL, /* cancellable */
+                                       (GAsyncReadyCallback)cgerep_setup_ready,
+                                       ctx);
+        return;
+    }
+
     /* If no more ports, we're fully done now */
     g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
     unsolicited_events_context_complete_and_free (ctx);
@@ -2907,36 +3048,30 @@ modem_3gpp_enable_unsolicited_events (MMIfaceModem3gpp *_self,
                                       gpointer user_data)
 {
     MMBroadbandModem *self = MM_BROADBAND_MODEM (_self);
-    GSimpleAsyncResult *result;
+    UnsolicitedEventsContext *ctx;
 
-    result = g_simple_async_result_new (G_OBJECT (self),
-                                        callback,
-                                        user_data,
-                                        modem_3gpp_enable_unsolicited_events);
+    ctx = g_new0 (UnsolicitedEventsContext, 1);
+    ctx->self = g_object_ref (self);
+    ctx->enable = TRUE;
+    ctx->result = g_simple_async_result_new (G_OBJECT (self),
+                                             callback,
+                                             user_data,
+                                             modem_3gpp_enable_unsolicited_events);
 
     /* If supported, go on */
     if (self->priv->modem_cind_support_checked && self->priv->modem_cind_supported) {
-        gchar *cmd;
-
         /* If CMER command available, launch it */
-        cmd = mm_3gpp_build_cmer_set_request (self->priv->modem_cmer_enable_mode, self->priv->modem_cmer_ind);
-        if (cmd) {
-            UnsolicitedEventsContext *ctx;
-
-            ctx = g_new0 (UnsolicitedEventsContext, 1);
-            ctx->self = g_object_ref (self);
-            ctx->enable = TRUE;
-            ctx->command = cmd;
-            ctx->result = result;
-            run_unsolicited_events_setup (ctx);
-            return;
-        }
-        mm_dbg ("Skipping +CMER enable command: not supported");
+        ctx->command = mm_3gpp_build_cmer_set_request (self->priv->modem_cmer_enable_mode, self->priv->modem_cmer_ind);
+        if (!ctx->command)
+            mm_dbg ("Skipping +CMER enable command: not supported");
     }
 
-    g_simple_async_result_set_op_res_gboolean (result, TRUE);
-    g_simple_async_result_complete_in_idle (result);
-    g_object_unref (result);
+    if (!ctx->command) {
+        ctx->cmer_primary_done = TRUE;
+        ctx->cmer_secondary_done = TRUE;
+    }
+
+    run_unsolicited_events_setup (ctx);
 }
 
 static void
@@ -2945,35 +3080,41 @@ modem_3gpp_disable_unsolicited_events (MMIfaceModem3gpp *_self,
                                        gpointer user_data)
 {
     MMBroadbandModem *self = MM_BROADBAND_MODEM (_self);
-    GSimpleAsyncResult *result;
+    UnsolicitedEventsContext *ctx;
 
-    result = g_simple_async_result_new (G_OBJECT (self),
-                                        callback,
-                                        user_data,
-                                        modem_3gpp_disable_unsolicited_events);
+    ctx = g_new0 (UnsolicitedEventsContext, 1);
+    ctx->self = g_object_ref (self);
+    ctx->result = g_simple_async_result_new (G_OBJECT (self),
+                                             callback,
+                                             user_data,
+                                             modem_3gpp_disable_unsolicited_events);
+
+    /* Connection monitoring can no longer rely on +CGEV */
+    self->priv->modem_3gpp_cgev_enabled = FALSE;
+
+    /* Nor signal quality monitoring on +CIEV */
+    mm_iface_modem_set_signal_quality_indications (MM_IFACE_MODEM (self), FALSE);
 
     /* If CIND supported, go on */
     if (self->priv->modem_cind_support_checked && self->priv->modem_cind_supported) {
-        gchar *cmd;
-
         /* If CMER command available, launch it */
-        cmd = mm_3gpp_build_cmer_set_request (self->priv->modem_cmer_disable_mode, MM_3GPP_CMER_IND_NONE);
-        if (cmd) {
-            UnsolicitedEventsContext *ctx;
-
-            ctx = g_new0 (UnsolicitedEventsContext, 1);
-            ctx->self = g_object_ref (self);
-            ctx->command = cmd;
-            ctx->result = result;
-            run_unsolicited_events_setup (ctx);
-            return;
-        }
-        mm_dbg ("Skipping +CMER disable command: not supported");
+        ctx->command = mm_3gpp_build_cmer_set_request (self->priv->modem_cmer_disable_mode, MM_3GPP_CMER_IND_NONE);
+        if (!ctx->command)
+            mm_dbg ("Skipping +CMER disable command: not supported");
     }
 
-    g_simple_async_result_set_op_res_gboolean (result, TRUE);
-    g_simple_async_result_complete_in_idle (result);
-    g_object_unref (result);
+    if (!ctx->command) {
+        ctx->cmer_primary_done = TRUE;
+        ctx->cmer_secondary_done = TRUE;
+    }
+
+    run_unsolicited_events_setup (ctx);
+}
+
+gboolean
+mm_broadband_modem_get_cgev_enabled (MMBroadbandModem *self)
+{
+    return self->priv->modem_3gpp_cgev_enabled;
 }
 
 /*****************************************************************************/
@@ -6307,13 +6448,32 @@ typedef struct {
     MMBroadbandModem *self;
     GSimpleAsyncResult *result;
     MMSmsStorage list_storage;
+    /* Incremental listing, PDU mode only */
+    MMPortSerialAt *port;
+    GRegex *entry_regex;
+    guint n_streamed;
 } ListPartsContext;
 
+static void
+list_parts_streaming_stop (ListPartsContext *ctx)
+{
+    if (!ctx->entry_regex)
+        return;
+
+    /* Drop our callback and disable the handler, so that it no longer
+     * consumes data from the port */
+    mm_port_serial_at_add_unsolicited_msg_handler (ctx->port, ctx->entry_regex, NULL, NULL, NULL);
+    mm_port_serial_at_enable_unsolicited_msg_handler (ctx->port, ctx->entry_regex, FALSE);
+    g_clear_pointer (&ctx->entry_regex, g_regex_unref);
+}
+
 static void
 list_parts_context_complete_and_free (ListPartsContext *ctx)
 {
+    list_parts_streaming_stop (ctx);
     g_simple_async_result_complete (ctx->result);
     g_object_unref (ctx->result);
+    g_clear_object (&ctx->port);
     g_object_unref (ctx->self);
     g_free (ctx);
 }
@@ -6485,7 +6645,48 @@ sms_state_from_index (guint index)
 }
 
 static void
-sms_pdu_part_list_ready (MMBroadbandModem *self,
+sms_pdu_part_list_take (ListPartsContext *ctx,
+                        MM3gppPduInfo *info)
+{
+    MMSmsPart *part;
+    GError *error = NULL;
+
+    part = mm_sms_part_3gpp_new_from_pdu (info->index, info->pdu, &error);
+    if (part) {
+        mm_dbg ("Correctly parsed PDU (%d)", info->index);
+        mm_iface_modem_messaging_take_part (MM_IFACE_MODEM_MESSAGING (ctx->self),
+                                            part,
+                                            sms_state_from_index (info->status),
+                                            ctx->list_storage);
+    } else {
+        /* Don't treat the error as critical */
+        mm_dbg ("Error parsing PDU (%d): %s", info->index, error->message);
+        g_error_free (error);
+    }
+}
+
+static void
+sms_pdu_part_list_entry_received (MMPortSerialAt *port,
+                                  GMatchInfo *match_info,
+                                  ListPartsContext *ctx)
+{
+    MM3gppPduInfo *info;
+
+    /* Each entry is processed as soon as its PDU line is complete, and the
+     * port removes it from the response buffer right after */
+    info = mm_3gpp_parse_pdu_cmgl_entry (match_info);
+    if (!info) {
+        mm_dbg ("Couldn't parse +CMGL entry");
+        return;
+    }
+
+    ctx->n_streamed++;
+    sms_pdu_part_list_take (ctx, info);
+    mm_3gpp_pdu_info_free (info);
+}
+
+static void
+sms_pdu_part_list_ready (MMBaseModem *self,
                          GAsyncResult *res,
                          ListPartsContext *ctx)
 {
@@ -6495,15 +6696,20 @@ sms_pdu_part_list_ready (MMBroadbandModem *self,
     GList *l;
 
     /* Always always always unlock mem1 storage. Warned you've been. */
-    mm_broadband_modem_unlock_sms_storages (self, TRUE, FALSE);
+    mm_broadband_modem_unlock_sms_storages (MM_BROADBAND_MODEM (self), TRUE, FALSE);
 
-    response = mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, &error);
+    list_parts_streaming_stop (ctx);
+
+    response = mm_base_modem_at_command_full_finish (self, res, &error);
     if (error) {
         g_simple_async_result_take_error (ctx->result, error);
         list_parts_context_complete_and_free (ctx);
         return;
     }
 
+    /* Entries already processed while receiving were removed from the
+     * response; parse whatever is left, e.g. a last entry without the
+     * trailing line break */
     info_list = mm_3gpp_parse_pdu_cmgl_response (response, &error);
     if (error) {
         g_simple_async_result_take_error (ctx->result, error);
@@ -6511,23 +6717,12 @@ sms_pdu_part_list_ready (MMBroadbandModem *self,
         return;
     }
 
-    for (l = info_list; l; l = g_list_next (l)) {
-        MM3gppPduInfo *info = l->data;
-        MMSmsPart *part;
+    for (l = info_list; l; l = g_list_next (l))
+        sms_pdu_part_list_take (ctx, (MM3gppPduInfo *) l->data);
 
-        part = mm_sms_part_3gpp_new_from_pdu (info->index, info->pdu, &error);
-        if (part) {
-            mm_dbg ("Correctly parsed PDU (%d)", info->index);
-            mm_iface_modem_messaging_take_part (MM_IFACE_MODEM_MESSAGING (self),
-                                                part,
-                                                sms_state_from_index (info->status),
-                                                ctx->list_storage);
-        } else {
-            /* Don't treat the error as critical */
-            mm_dbg ("Error parsing PDU (%d): %s", info->index, error->message);
-            g_clear_error (&error);
-        }
-    }
+    mm_dbg ("Listed %u SMS parts (%u while receiving)",
+            ctx->n_streamed + g_list_length (info_list),
+            ctx->n_streamed);
 
     mm_3gpp_pdu_info_list_free (info_list);
 
@@ -6555,16 +6750,42 @@ list_parts_lock_storages_ready (MMBroadbandModem *self,
 
     /* Get SMS parts from ALL types.
      * Different command to be used if we are on Text or PDU mode */
-    mm_base_modem_at_command (MM_BASE_MODEM (self),
-                              (MM_BROADBAND_MODEM (self)->priv->modem_messaging_sms_pdu_mode ?
-                               "+CMGL=4" :
-                               "+CMGL=\"ALL\""),
-                              20,
-                              FALSE,
-                              (GAsyncReadyCallback) (MM_BROADBAND_MODEM (self)->priv->modem_messaging_sms_pdu_mode ?
-                                                     sms_pdu_part_list_ready :
-                                                     sms_text_part_list_ready),
-                              ctx);
+    if (!MM_BROADBAND_MODEM (self)->priv->modem_messaging_sms_pdu_mode) {
+        mm_base_modem_at_command (MM_BASE_MODEM (self),
+                                  "+CMGL=\"ALL\"",
+                                  20,
+                                  FALSE,
+                                  (GAsyncReadyCallback)sms_text_part_list_ready,
+                                  ctx);
+        return;
+    }
+
+    /* In PDU mode, process each entry as soon as it's received, instead of
+     * waiting for the whole listing, which may be huge with a full storage */
+    ctx->port = mm_base_modem_get_best_at_port (MM_BASE_MODEM (self), &error);
+    if (!ctx->port) {
+        mm_broadband_modem_unlock_sms_storages (self, TRUE, FALSE);
+        g_simple_async_result_take_error (ctx->result, error);
+        list_parts_context_complete_and_free (ctx);
+        return;
+    }
+
+    ctx->entry_regex = mm_3gpp_cmgl_pdu_entry_regex_get ();
+    mm_port_serial_at_add_unsolicited_msg_handler (ctx->port,
+                                                   ctx->entry_regex,
+                                                   (MMPortSerialAtUnsolicitedMsgFn)sms_pdu_part_list_entry_received,
+                                                   ctx,
+                                                   NULL);
+
+    mm_base_modem_at_command_full (MM_BASE_MODEM (self),
+                                   ctx->port,
+                                   "+CMGL=4",
+                                   20,
+                                   FALSE,
+                                   FALSE,
+                                   NULL,
+                                   (GAsyncReadyCallback)sms_pdu_part_list_ready,
+                                   ctx);
 }
 
 static void
@@ -8438,6 +8659,165 @@ modem_time_check_support (MMIfaceModemTime *self,
                                user_data);
 }
 
+/*****************************************************************************/
+/* Setup/cleanup unsolicited events (Time interface) */
+
+static gboolean
+modem_time_setup_cleanup_unsolicited_events_finish (MMIfaceModemTime *self,
+                                                    GAsyncResult *res,
+                                                    GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+static void
+ctz_received (MMPortSerialAt *port,
+              GMatchInfo *info,
+              MMBroadbandModem *self)
+{
+    MMNetworkTimezone *tz = NULL;
+    gchar *iso8601 = NULL;
+    GError *error = NULL;
+    gchar *str;
+
+    str = g_match_info_fetch (info, 1);
+    if (!mm_parse_ctz_response (str, &iso8601, &tz, &error)) {
+        mm_dbg ("Couldn't process timezone report: '%s'", error->message);
+        g_error_free (error);
+        g_free (str);
+        return;
+    }
+
+    mm_iface_modem_time_update_network_timezone (MM_IFACE_MODEM_TIME (self), tz);
+    if (iso8601)
+        mm_iface_modem_time_update_network_time (MM_IFACE_MODEM_TIME (self), iso8601);
+
+    g_object_unref (tz);
+    g_free (iso8601);
+    g_free (str);
+}
+
+static void
+set_time_unsolicited_events_handlers (MMIfaceModemTime *self,
+                                      gboolean enable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data)
+{
+    GSimpleAsyncResult *result;
+    MMPortSerialAt *ports[2];
+    GRegex *ctz_regex;
+    guint i;
+
+    result = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        set_time_unsolicited_events_handlers);
+
+    ctz_regex = mm_ctz_regex_get ();
+    ports[0] = mm_base_modem_peek_port_primary (MM_BASE_MODEM (self));
+    ports[1] = mm_base_modem_peek_port_secondary (MM_BASE_MODEM (self));
+
+    /* Enable unsolicited events in given port */
+    for (i = 0; i < 2; i++) {
+        if (!ports[i])
+            continue;
+
+        /* Set/unset unsolicited +CTZV/+CTZE event handler */
+        mm_dbg ("(%s) %s time unsolicited events handlers",
+                mm_port_get_device (MM_PORT (ports[i])),
+                enable ? "Setting" : "Removing");
+        mm_port_serial_at_add_unsolicited_msg_handler (
+            ports[i],
+            ctz_regex,
+            enable ? (MMPortSerialAtUnsolicitedMsgFn) ctz_received : NULL,
+            enable ? self : NULL,
+            NULL);
+    }
+
+    g_regex_unref (ctz_regex);
+    g_simple_async_result_set_op_res_gboolean (result, TRUE);
+    g_simple_async_result_complete_in_idle (result);
+    g_object_unref (result);
+}
+
+static void
+modem_time_setup_unsolicited_events (MMIfaceModemTime *self,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data)
+{
+    set_time_unsolicited_events_handlers (self, TRUE, callback, user_data);
+}
+
+static void
+modem_time_cleanup_unsolicited_events (MMIfaceModemTime *self,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data)
+{
+    set_time_unsolicited_events_handlers (self, FALSE, callback, user_data);
+}
+
+/*****************************************************************************/
+/* Enable/disable unsolicited events (Time interface) */
+
+static gboolean
+modem_time_enable_unsolicited_events_finish (MMIfaceModemTime *self,
+                                             GAsyncResult *res,
+                                             GError **error)
+{
+    GError *inner_error = NULL;
+
+    mm_base_modem_at_sequence_finish (MM_BASE_MODEM (self), res, NULL, &inner_error);
+    if (inner_error) {
+        g_propagate_error (error, inner_error);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static const MMBaseModemAtCommand ctzr_enable_sequence[] = {
+    /* Extended reports (+CTZE) include DST and local time */
+    { "+CTZR=2", 3, FALSE, mm_base_modem_response_processor_continue_on_error },
+    { "+CTZR=1", 3, FALSE, mm_base_modem_response_processor_continue_on_error },
+    { NULL }
+};
+
+static void
+modem_time_enable_unsolicited_events (MMIfaceModemTime *self,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data)
+{
+    mm_base_modem_at_sequence (MM_BASE_MODEM (self),
+                               ctzr_enable_sequence,
+                               NULL, /* response_processor_context */
+                               NULL, /* response_processor_context_free */
+                               callback,
+                               user_data);
+}
+
+static gboolean
+modem_time_disable_unsolicited_events_finish (MMIfaceModemTime *self,
+                                              GAsyncResult *res,
+                                              GError **error)
+{
+    /* Not critical, the modem may not support +CTZR at all */
+    mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, NULL);
+    return TRUE;
+}
+
+static void
+modem_time_disable_unsolicited_events (MMIfaceModemTime *self,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data)
+{
+    mm_base_modem_at_command (MM_BASE_MODEM (self),
+                              "+CTZR=0",
+                              3,
+                              FALSE,
+                              callback,
+                              user_data);
+}
+
 /*****************************************************************************/
 /* Check support (Signal interface) */
 
@@ -8735,6 +9115,30 @@ open_ports_initialization (MMBroadbandModem *self,
     return TRUE;
 }
 
+/* Read-only queries which only need to be run once during initialization.
+ * Note that these use the same command strings as the load_manufacturer(),
+ * load_model(), load_revision() and load_equipment_identifier()
+ * implementations, so that they get the cached replies. */
+static const gchar *identification_compound_commands[] = {
+    "+CGMI", "+CGMM", "+CGMR", "+CGSN", NULL
+};
+
+static void
+identification_compound_ready (MMBaseModem *self,
+                               GAsyncResult *res,
+                               InitializationStartedContext *ctx)
+{
+    GError *error = NULL;
+
+    /* Not fatal, each command will be sent separately */
+    if (!mm_base_modem_at_command_compound_finish (self, res, &error)) {
+        mm_dbg ("Couldn't preload identification info with a compound command: %s", error->message);
+        g_error_free (error);
+    }
+
+    initialization_started_context_complete_and_free (ctx);
+}
+
 static void
 initialization_started (MMBroadbandModem *self,
                         GAsyncReadyCallback callback,
@@ -8755,10 +9159,31 @@ initialization_started (MMBroadbandModem *self,
     if (!open_ports_initialization (self, ctx->ports, &error)) {
         g_prefix_error (&error, "Couldn't open ports during modem initialization: ");
         g_simple_async_result_take_error (ctx->result, error);
-    } else
-        g_simple_async_result_set_op_res_gpointer (ctx->result,
-                                                   ports_context_ref (ctx->ports),
-                                                   (GDestroyNotify)ports_context_unref);
+        initialization_started_context_complete_and_free (ctx);
+        return;
+    }
+
+    g_simple_async_result_set_op_res_gpointer (ctx->result,
+                                               ports_context_ref (ctx->ports),
+                                               (GDestroyNotify)ports_context_unref);
+
+    /* If the modem is known to handle compound command lines properly,
+     * preload the basic identification info in a single round-trip */
+    if (self->priv->compound_at_commands) {
+        MMPortSerialAt *port;
+
+        port = mm_base_modem_peek_best_at_port (MM_BASE_MODEM (self), NULL);
+        if (port) {
+            mm_base_modem_at_command_compound (MM_BASE_MODEM (self),
+                                               port,
+                                               identification_compound_commands,
+                                               6,
+                                               NULL,
+                                               (GAsyncReadyCallback)identification_compound_ready,
+                                               ctx);
+            return;
+        }
+    }
 
     initialization_started_context_complete_and_free (ctx);
 }
@@ -8770,6 +9195,10 @@ static gboolean
 disabling_stopped (MMBroadbandModem *self,
                    GError **error)
 {
+    /* The SIM may be changed while the modem is disabled, so don't trust
+     * the PDP context table we knew about any more */
+    mm_broadband_modem_invalidate_pdp_context_cache (self);
+
     if (self->priv->enabled_ports_ctx) {
         ports_context_unref (self->priv->enabled_ports_ctx);
         self->priv->enabled_ports_ctx = NULL;
@@ -10505,6 +10934,113 @@ mm_broadband_modem_create_device_identifier (MMBroadbandModem *self,
 }
 
 
+/*****************************************************************************/
+/* PDP context cache
+ *
+ * The PDP context table (+CGDCONT?) and the supported CID ranges (+CGDCONT=?)
+ * are kept around after the first CID selection, so that reconnections can go
+ * straight to dialing. The cache is updated with the contexts we define
+ * ourselves, and invalidated whenever it may no longer be in sync with the
+ * modem (SIM change, reset, modem disabled or failed dial attempt). */
+
+gboolean
+mm_broadband_modem_peek_cached_pdp_context_list (MMBroadbandModem *self,
+                                                 const GList **pdp_list)
+{
+    if (!self->priv->modem_3gpp_pdp_context_list_cached)
+        return FALSE;
+
+    *pdp_list = self->priv->modem_3gpp_pdp_context_list;
+    return TRUE;
+}
+
+void
+mm_broadband_modem_take_cached_pdp_context_list (MMBroadbandModem *self,
+                                                 GList *pdp_list)
+{
+    mm_3gpp_pdp_context_list_free (self->priv->modem_3gpp_pdp_context_list);
+    self->priv->modem_3gpp_pdp_context_list = pdp_list;
+    self->priv->modem_3gpp_pdp_context_list_cached = TRUE;
+}
+
+gboolean
+mm_broadband_modem_peek_cached_pdp_context_format_list (MMBroadbandModem *self,
+                                                        const GList **pdp_format_list)
+{
+    if (!self->priv->modem_3gpp_pdp_context_format_list_cached)
+        return FALSE;
+
+    *pdp_format_list = self->priv->modem_3gpp_pdp_context_format_list;
+    return TRUE;
+}
+
+void
+mm_broadband_modem_take_cached_pdp_context_format_list (MMBroadbandModem *self,
+                                                        GList *pdp_format_list)
+{
+    mm_3gpp_pdp_context_format_list_free (self->priv->modem_3gpp_pdp_context_format_list);
+    self->priv->modem_3gpp_pdp_context_format_list = pdp_format_list;
+    self->priv->modem_3gpp_pdp_context_format_list_cached = TRUE;
+}
+
+static gint
+pdp_context_cmp_cid (const MM3gppPdpContext *a,
+                     const MM3gppPdpContext *b)
+{
+    return (a->cid - b->cid);
+}
+
+void
+mm_broadband_modem_update_cached_pdp_context (MMBroadbandModem *self,
+                                              guint cid,
+                                              MMBearerIpFamily pdp_type,
+                                              const gchar *apn)
+{
+    MM3gppPdpContext *pdp = NULL;
+    GList *l;
+
+    /* Only update if we already have a valid list; otherwise it will be
+     * fully loaded next time */
+    if (!self->priv->modem_3gpp_pdp_context_list_cached)
+        return;
+
+    for (l = self->priv->modem_3gpp_pdp_context_list; l; l = g_list_next (l)) {
+        if (((MM3gppPdpContext *)l->data)->cid == cid) {
+            pdp = l->data;
+            break;
+        }
+    }
+
+    if (!pdp) {
+        pdp = g_slice_new0 (MM3gppPdpContext);
+        pdp->cid = cid;
+        self->priv->modem_3gpp_pdp_context_list =
+            g_list_insert_sorted (self->priv->modem_3gpp_pdp_context_list,
+                                  pdp,
+                                  (GCompareFunc) pdp_context_cmp_cid);
+    }
+
+    pdp->pdp_type = pdp_type;
+    g_free (pdp->apn);
+    pdp->apn = g_strdup (apn);
+}
+
+void
+mm_broadband_modem_invalidate_pdp_context_cache (MMBroadbandModem *self)
+{
+    if (self->priv->modem_3gpp_pdp_context_list_cached ||
+        self->priv->modem_3gpp_pdp_context_format_list_cached)
+        mm_dbg ("Invalidating cached PDP context list");
+
+    mm_3gpp_pdp_context_list_free (self->priv->modem_3gpp_pdp_context_list);
+    self->priv->modem_3gpp_pdp_context_list = NULL;
+    self->priv->modem_3gpp_pdp_context_list_cached = FALSE;
+
+    mm_3gpp_pdp_context_format_list_free (self->priv->modem_3gpp_pdp_context_format_list);
+    self->priv->modem_3gpp_pdp_context_format_list = NULL;
+    self->priv->modem_3gpp_pdp_context_format_list_cached = FALSE;
+}
+
 /*****************************************************************************/
 static void
 after_hotswap_event_disable_ready (MMBaseModem *self,
@@ -10524,6 +11060,8 @@ after_hotswap_event_disable_ready (MMBaseModem *self,
 void
 mm_broadband_modem_update_sim_hot_swap_detected (MMBroadbandModem *self)
 {
+    mm_broadband_modem_invalidate_pdp_context_cache (self);
+
     if (self->priv->sim_hot_swap_ports_ctx) {
         mm_dbg ("Releasing SIM hot swap ports context");
         ports_context_unref (self->priv->sim_hot_swap_ports_ctx);
@@ -10673,6 +11211,9 @@ set_property (GObject *object,
     case PROP_MODEM_SIM_HOT_SWAP_CONFIGURED:
         self->priv->sim_hot_swap_configured = g_value_get_boolean (value);
         break;
+    case PROP_COMPOUND_AT_COMMANDS:
+        self->priv->compound_at_commands = g_value_get_boolean (value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -10784,6 +11325,9 @@ get_property (GObject *object,
     case PROP_FLOW_CONTROL:
         g_value_set_flags (value, self->priv->flow_control);
         break;
+    case PROP_COMPOUND_AT_COMMANDS:
+        g_value_set_boolean (value, self->priv->compound_at_commands);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -10830,6 +11374,9 @@ finalize (GObject *object)
     if (self->priv->modem_3gpp_registration_regex)
         mm_3gpp_creg_regex_destroy (self->priv->modem_3gpp_registration_regex);
 
+    mm_3gpp_pdp_context_list_free (self->priv->modem_3gpp_pdp_context_list);
+    mm_3gpp_pdp_context_format_list_free (self->priv->modem_3gpp_pdp_context_format_list);
+
     G_OBJECT_CLASS (mm_broadband_modem_parent_class)->finalize (object);
 }
 
@@ -11108,6 +11655,14 @@ iface_modem_time_init (MMIfaceModemTime *iface)
     iface->load_network_time_finish = modem_time_load_network_time_finish;
     iface->load_network_timezone = modem_time_load_network_timezone;
     iface->load_network_timezone_finish = modem_time_load_network_timezone_finish;
+    iface->setup_unsolicited_events = modem_time_setup_unsolicited_events;
+    iface->setup_unsolicited_events_finish = modem_time_setup_cleanup_unsolicited_events_finish;
+    iface->cleanup_unsolicited_events = modem_time_cleanup_unsolicited_events;
+    iface->cleanup_unsolicited_events_finish = modem_time_setup_cleanup_unsolicited_events_finish;
+    iface->enable_unsolicited_events = modem_time_enable_unsolicited_events;
+    iface->enable_unsolicited_events_finish = modem_time_enable_unsolicited_events_finish;
+    iface->disable_unsolicited_events = modem_time_disable_unsolicited_events;
+    iface->disable_unsolicited_events_finish = modem_time_disable_unsolicited_events_finish;
 }
 
 static void
@@ -11291,4 +11846,12 @@ mm_broadband_modem_class_init (MMBroadbandModemClass *klass)
                             MM_FLOW_CONTROL_NONE,
                             G_PARAM_READABLE);
     g_object_class_install_property (object_class, PROP_FLOW_CONTROL, properties[PROP_FLOW_CONTROL]);
+
+    properties[PROP_COMPOUND_AT_COMMANDS] =
+        g_param_spec_boolean (MM_BROADBAND_MODEM_COMPOUND_AT_COMMANDS,
+                              "Compound AT commands",
+                              "Whether independent queries can be sent in a single command line",
+                              FALSE,
+                              G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+    g_object_class_install_property (object_class, PROP_COMPOUND_AT_COMMANDS, properties[PROP_COMPOUND_AT_COMMANDS]);
 }
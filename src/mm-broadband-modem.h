@@ -39,7 +39,8 @@ typedef struct _MMBroadbandModem MMBroadbandModem;
 typedef struct _MMBroadbandModemClass MMBroadbandModemClass;
 typedef struct _MMBroadbandModemPrivate MMBroadbandModemPrivate;
 
-#define MM_BROADBAND_MODEM_FLOW_CONTROL "broadband-modem-flow-control"
+#define MM_BROADBAND_MODEM_FLOW_CONTROL         "broadband-modem-flow-control"
+#define MM_BROADBAND_MODEM_COMPOUND_AT_COMMANDS "broadband-modem-compound-at-commands"
 
 struct _MMBroadbandModem {
     MMBaseModem parent;
@@ -130,6 +131,24 @@ gboolean mm_broadband_modem_lock_sms_storages_finish (MMBroadbandModem *self,
 void     mm_broadband_modem_unlock_sms_storages      (MMBroadbandModem *self,
                                                       gboolean mem1,
                                                       gboolean mem2);
+/* PDP context table cache, used during 3GPP CID selection */
+gboolean mm_broadband_modem_peek_cached_pdp_context_list        (MMBroadbandModem *self,
+                                                                 const GList **pdp_list);
+void     mm_broadband_modem_take_cached_pdp_context_list        (MMBroadbandModem *self,
+                                                                 GList *pdp_list);
+gboolean mm_broadband_modem_peek_cached_pdp_context_format_list (MMBroadbandModem *self,
+                                                                 const GList **pdp_format_list);
+void     mm_broadband_modem_take_cached_pdp_context_format_list (MMBroadbandModem *self,
+                                                                 GList *pdp_format_list);
+void     mm_broadband_modem_update_cached_pdp_context           (MMBroadbandModem *self,
+                                                                 guint cid,
+                                                                 MMBearerIpFamily pdp_type,
+                                                                 const gchar *apn);
+void     mm_broadband_modem_invalidate_pdp_context_cache        (MMBroadbandModem *self);
+
+/* Whether packet domain events (+CGEV) are reported by the modem */
+gboolean mm_broadband_modem_get_cgev_enabled (MMBroadbandModem *self);
+
 /* Helper to update SIM hot swap */
 void mm_broadband_modem_update_sim_hot_swap_detected (MMBroadbandModem *self);
 
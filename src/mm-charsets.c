@@ -111,6 +111,85 @@ charset_iconv_from (MMModemCharset charset)
     return NULL;
 }
 
+/*****************************************************************************/
+/* Cached iconv converters
+ *
+ * g_convert() opens and closes a new iconv descriptor on every call, which is
+ * far more expensive than the conversion itself for the short strings we
+ * usually handle. Instead, keep the converters open, one table per thread as
+ * GIConv descriptors cannot be shared among threads. */
+
+static void
+converter_close (gpointer converter)
+{
+    g_iconv_close ((GIConv) converter);
+}
+
+static GPrivate converters = G_PRIVATE_INIT ((GDestroyNotify) g_hash_table_unref);
+
+static GIConv
+converter_get (const gchar  *to_codeset,
+               const gchar  *from_codeset,
+               GError      **error)
+{
+    GHashTable *table;
+    GIConv      converter;
+    gchar       key[64];
+
+    table = g_private_get (&converters);
+    if (G_UNLIKELY (!table)) {
+        table = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, converter_close);
+        g_private_set (&converters, table);
+    }
+
+    g_snprintf (key, sizeof (key), "%s|%s", to_codeset, from_codeset);
+    converter = (GIConv) g_hash_table_lookup (table, key);
+    if (converter) {
+        /* Reset any shift state left by a previous failed conversion */
+        g_iconv (converter, NULL, NULL, NULL, NULL);
+        return converter;
+    }
+
+    converter = g_iconv_open (to_codeset, from_codeset);
+    if (converter == (GIConv) -1) {
+        g_set_error (error,
+                     G_CONVERT_ERROR,
+                     G_CONVERT_ERROR_NO_CONVERSION,
+                     "Conversion from character set '%s' to '%s' is not supported",
+                     from_codeset, to_codeset);
+        return converter;
+    }
+
+    g_hash_table_insert (table, g_strdup (key), converter);
+    return converter;
+}
+
+/* Same as g_convert(), but reusing cached converters */
+static gchar *
+charset_convert (const gchar  *str,
+                 gssize        len,
+                 const gchar  *to_codeset,
+                 const gchar  *from_codeset,
+                 gsize        *bytes_read,
+                 gsize        *bytes_written,
+                 GError      **error)
+{
+    GIConv converter;
+
+    converter = converter_get (to_codeset, from_codeset, error);
+    if (converter == (GIConv) -1) {
+        if (bytes_read)
+            *bytes_read = 0;
+        if (bytes_written)
+            *bytes_written = 0;
+        return NULL;
+    }
+
+    return g_convert_with_iconv (str, len, converter, bytes_read, bytes_written, error);
+}
+
+/*****************************************************************************/
+
 gboolean
 mm_modem_charset_byte_array_append (GByteArray *array,
                                     const char *utf8,
@@ -128,7 +207,7 @@ mm_modem_charset_byte_array_append (GByteArray *array,
     iconv_to = charset_iconv_to (charset);
     g_return_val_if_fail (iconv_to != NULL, FALSE);
 
-    converted = g_convert (utf8, -1, iconv_to, "UTF-8", NULL, &written, &error);
+    converted = charset_convert (utf8, -1, iconv_to, "UTF-8", NULL, &written, &error);
     if (!converted) {
         if (error) {
             mm_warn ("failed to convert '%s' to %s character set: (%d) %s",
@@ -169,9 +248,16 @@ mm_modem_charset_hex_to_utf8 (const char *src, MMModemCharset charset)
     if (charset == MM_MODEM_CHARSET_UTF8 || charset == MM_MODEM_CHARSET_IRA)
         return unconverted;
 
-    converted = g_convert (unconverted, unconverted_len,
-                           "UTF-8//TRANSLIT", iconv_from,
-                           NULL, NULL, &error);
+    /* UCS-2 doesn't need iconv at all */
+    if (charset == MM_MODEM_CHARSET_UCS2) {
+        converted = mm_charset_utf16be_to_utf8 ((const guint8 *) unconverted, unconverted_len);
+        g_free (unconverted);
+        return converted;
+    }
+
+    converted = charset_convert (unconverted, unconverted_len,
+                                 "UTF-8//TRANSLIT", iconv_from,
+                                 NULL, NULL, &error);
     if (!converted || error) {
         g_clear_error (&error);
         converted = NULL;
@@ -200,9 +286,9 @@ mm_modem_charset_utf8_to_hex (const char *src, MMModemCharset charset)
     if (charset == MM_MODEM_CHARSET_UTF8 || charset == MM_MODEM_CHARSET_IRA)
         return g_strdup (src);
 
-    converted = g_convert (src, strlen (src),
-                           iconv_to, "UTF-8//TRANSLIT",
-                           NULL, &converted_len, &error);
+    converted = charset_convert (src, strlen (src),
+                                 iconv_to, "UTF-8//TRANSLIT",
+                                 NULL, &converted_len, &error);
     if (!converted || error) {
         g_clear_error (&error);
         g_free (converted);
@@ -215,6 +301,58 @@ mm_modem_charset_utf8_to_hex (const char *src, MMModemCharset charset)
     return hex;
 }
 
+gchar *
+mm_charset_utf16be_to_utf8 (const guint8 *utf16,
+                            gsize         len)
+{
+    gchar *utf8;
+    gchar *p;
+    gsize  i;
+
+    /* Input must be given in full code units */
+    if (len % 2)
+        return NULL;
+
+    /* Every 2-byte code unit needs at most 3 bytes in UTF-8, and surrogate
+     * pairs need 4 bytes for 4 input bytes */
+    utf8 = g_malloc ((len / 2) * 3 + 1);
+    p = utf8;
+
+    for (i = 0; i < len; i += 2) {
+        gunichar c;
+
+        c = (utf16[i] << 8) | utf16[i + 1];
+
+        if (c < 0x80) {
+            *p++ = (gchar) c;
+            continue;
+        }
+
+        /* High surrogate, must be followed by a low surrogate */
+        if (c >= 0xD800 && c <= 0xDBFF) {
+            gunichar low;
+
+            if (i + 3 >= len)
+                goto error;
+            low = (utf16[i + 2] << 8) | utf16[i + 3];
+            if (low < 0xDC00 || low > 0xDFFF)
+                goto error;
+            c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+            i += 2;
+        } else if (c >= 0xDC00 && c <= 0xDFFF)
+            goto error;
+
+        p += g_unichar_to_utf8 (c, p);
+    }
+
+    *p = '\0';
+    return utf8;
+
+error:
+    g_free (utf8);
+    return NULL;
+}
+
 /* GSM 03.38 encoding conversion stuff */
 
 #define GSM_DEF_ALPHABET_SIZE 128
@@ -351,18 +489,71 @@ static const GsmUtf8Mapping gsm_ext_utf8_alphabet[GSM_EXT_ALPHABET_SIZE] = {
 
 #define GSM_ESCAPE_CHAR 0x1b
 
-static guint8
-gsm_ext_char_to_utf8 (const guint8 gsm, guint8 out_utf8[3])
+/* Lookup tables, built once from the alphabets above:
+ *  - UTF-8 to GSM, indexed by code point, for all code points below 0x100,
+ *    which covers ASCII and Latin-1. Each entry is the GSM char plus a flag
+ *    telling whether it's in the default or the extended alphabet; 0 if the
+ *    char cannot be represented.
+ *  - GSM extended char to its index in the extended alphabet table, plus 1.
+ */
+#define GSM_LUT_DEF 0x0100
+#define GSM_LUT_EXT 0x0200
+
+static guint16 utf8_to_gsm_lut[256];
+static guint8  gsm_ext_lut[GSM_DEF_ALPHABET_SIZE];
+
+static gunichar
+gsm_mapping_get_char (const GsmUtf8Mapping *mapping)
 {
-    int i;
+    gchar buffer[4] = { 0 };
+
+    memcpy (buffer, mapping->chars, mapping->len);
+    return g_utf8_get_char_validated (buffer, mapping->len);
+}
+
+static void
+gsm_luts_init (void)
+{
+    static gsize initialized = 0;
+
+    if (g_once_init_enter (&initialized)) {
+        guint i;
+
+        /* Keep the first match in the default alphabet, as the linear search
+         * did; entries that aren't valid UTF-8 never match anything */
+        for (i = 0; i < GSM_DEF_ALPHABET_SIZE; i++) {
+            gunichar c;
 
-    for (i = 0; i < GSM_EXT_ALPHABET_SIZE; i++) {
-        if (gsm == gsm_ext_utf8_alphabet[i].gsm) {
-            memcpy (&out_utf8[0], &gsm_ext_utf8_alphabet[i].chars[0], gsm_ext_utf8_alphabet[i].len);
-            return gsm_ext_utf8_alphabet[i].len;
+            c = gsm_mapping_get_char (&gsm_def_utf8_alphabet[i]);
+            if (c < G_N_ELEMENTS (utf8_to_gsm_lut) && !utf8_to_gsm_lut[c])
+                utf8_to_gsm_lut[c] = GSM_LUT_DEF | i;
         }
+
+        /* The extended alphabet takes precedence */
+        for (i = 0; i < GSM_EXT_ALPHABET_SIZE; i++) {
+            gunichar c;
+
+            c = gsm_mapping_get_char (&gsm_ext_utf8_alphabet[i]);
+            if (c < G_N_ELEMENTS (utf8_to_gsm_lut))
+                utf8_to_gsm_lut[c] = GSM_LUT_EXT | gsm_ext_utf8_alphabet[i].gsm;
+            gsm_ext_lut[gsm_ext_utf8_alphabet[i].gsm] = i + 1;
+        }
+
+        g_once_init_leave (&initialized, 1);
     }
-    return 0;
+}
+
+static guint8
+gsm_ext_char_to_utf8 (const guint8 gsm, guint8 out_utf8[3])
+{
+    const GsmUtf8Mapping *mapping;
+
+    if (gsm >= GSM_DEF_ALPHABET_SIZE || !gsm_ext_lut[gsm])
+        return 0;
+
+    mapping = &gsm_ext_utf8_alphabet[gsm_ext_lut[gsm] - 1];
+    memcpy (&out_utf8[0], &mapping->chars[0], mapping->len);
+    return mapping->len;
 }
 
 static gboolean
@@ -383,98 +574,145 @@ utf8_to_gsm_ext_char (const char *utf8, guint32 len, guint8 *out_gsm)
     return FALSE;
 }
 
+/* Returns 1 if the char is in the default alphabet, 2 if it's in the extended
+ * alphabet (i.e. needs the escape char), or 0 if it cannot be represented */
+static guint
+utf8_to_gsm_char (const char *utf8, guint32 len, guint8 *out_gsm)
+{
+    gunichar c;
+    guint16  entry;
+
+    switch (len) {
+    case 1:
+        c = (guint8) utf8[0];
+        break;
+    case 2:
+        c = ((utf8[0] & 0x1f) << 6) | (utf8[1] & 0x3f);
+        break;
+    default:
+        c = G_N_ELEMENTS (utf8_to_gsm_lut);
+        break;
+    }
+
+    if (c < G_N_ELEMENTS (utf8_to_gsm_lut)) {
+        entry = utf8_to_gsm_lut[c];
+        if (!entry)
+            return 0;
+        *out_gsm = entry & 0x7F;
+        return (entry & GSM_LUT_EXT) ? 2 : 1;
+    }
+
+    /* Greek capitals and the euro sign */
+    if (utf8_to_gsm_ext_char (utf8, len, out_gsm))
+        return 2;
+    if (utf8_to_gsm_def_char (utf8, len, out_gsm))
+        return 1;
+    return 0;
+}
+
 guint8 *
 mm_charset_gsm_unpacked_to_utf8 (const guint8 *gsm, guint32 len)
 {
-    int i;
-    GByteArray *utf8;
+    guint32 i;
+    guint8 *utf8;
+    guint8 *p;
 
     g_return_val_if_fail (gsm != NULL, NULL);
     g_return_val_if_fail (len < 4096, NULL);
 
-    /* worst case initial length */
-    utf8 = g_byte_array_sized_new (len * 2 + 1);
+    gsm_luts_init ();
+
+    /* Worst case: 2 bytes per default alphabet char, 3 bytes per escaped
+     * (i.e. 2 chars) extended alphabet char */
+    utf8 = g_malloc (len * 2 + 1);
+    p = utf8;
 
     for (i = 0; i < len; i++) {
-        guint8 uchars[4];
+        guint8 c;
         guint8 ulen;
 
-        if (gsm[i] == GSM_ESCAPE_CHAR) {
+        c = gsm[i];
+
+        /* Plain ASCII chars in the default alphabet */
+        if (c < GSM_DEF_ALPHABET_SIZE && c != GSM_ESCAPE_CHAR && gsm_def_utf8_alphabet[c].len == 1) {
+            *p++ = gsm_def_utf8_alphabet[c].chars[0];
+            continue;
+        }
+
+        if (c == GSM_ESCAPE_CHAR) {
             /* Extended alphabet, decode next char */
-            ulen = gsm_ext_char_to_utf8 (gsm[i+1], uchars);
+            ulen = (i + 1 < len) ? gsm_ext_char_to_utf8 (gsm[i + 1], p) : 0;
             if (ulen)
                 i += 1;
         } else {
             /* Default alphabet */
-            ulen = gsm_def_char_to_utf8 (gsm[i], uchars);
+            ulen = gsm_def_char_to_utf8 (c, p);
         }
 
         if (ulen)
-            g_byte_array_append (utf8, &uchars[0], ulen);
+            p += ulen;
         else
-            g_byte_array_append (utf8, (guint8 *) "?", 1);
+            *p++ = '?';
     }
 
-    g_byte_array_append (utf8, (guint8 *) "\0", 1);  /* NULL terminator */
-    return g_byte_array_free (utf8, FALSE);
+    *p = '\0';
+    return utf8;
 }
 
 guint8 *
 mm_charset_utf8_to_unpacked_gsm (const char *utf8, guint32 *out_len)
 {
-    GByteArray *gsm;
+    guint8 *gsm;
+    guint8 *p;
     const char *c = utf8, *next = c;
-    static const guint8 gesc = GSM_ESCAPE_CHAR;
-    int i = 0;
 
     g_return_val_if_fail (utf8 != NULL, NULL);
     g_return_val_if_fail (out_len != NULL, NULL);
     g_return_val_if_fail (g_utf8_validate (utf8, -1, NULL), NULL);
 
-    /* worst case initial length */
-    gsm = g_byte_array_sized_new (g_utf8_strlen (utf8, -1) * 2 + 1);
+    gsm_luts_init ();
 
-    if (*utf8 == 0x00) {
-        /* Zero-length string */
-        g_byte_array_append (gsm, (guint8 *) "\0", 1);
-        *out_len = 0;
-        return g_byte_array_free (gsm, FALSE);
-    }
+    /* Worst case, every UTF-8 byte is a char needing the escape char; the
+     * byte length is an upper bound of the char count, and cheaper to get */
+    gsm = g_malloc (strlen (utf8) * 2 + 1);
+    p = gsm;
 
-    while (next && *next) {
-        guint8 gch = 0x3f;  /* 0x3f == '?' */
+    while (*c) {
+        guint8 gch;
 
         next = g_utf8_next_char (c);
 
-        /* Try escaped chars first, then default alphabet */
-        if (utf8_to_gsm_ext_char (c, next - c, &gch)) {
-            /* Add the escape char */
-            g_byte_array_append (gsm, &gesc, 1);
-            g_byte_array_append (gsm, &gch, 1);
-        } else if (utf8_to_gsm_def_char (c, next - c, &gch))
-            g_byte_array_append (gsm, &gch, 1);
+        /* Unsupported chars are skipped */
+        switch (utf8_to_gsm_char (c, next - c, &gch)) {
+        case 2:
+            *p++ = GSM_ESCAPE_CHAR;
+            /* fall through */
+        case 1:
+            *p++ = gch;
+            break;
+        default:
+            break;
+        }
 
         c = next;
-        i++;
     }
 
-    *out_len = gsm->len;
-    return g_byte_array_free (gsm, FALSE);
+    *out_len = p - gsm;
+    *p = '\0';
+    return gsm;
 }
 
 static gboolean
 gsm_is_subset (gunichar c, const char *utf8, gsize ulen, guint *out_clen)
 {
     guint8 gsm;
+    guint clen;
 
-    *out_clen = 1;
-    if (utf8_to_gsm_def_char (utf8, ulen, &gsm))
-        return TRUE;
-    if (utf8_to_gsm_ext_char (utf8, ulen, &gsm)) {
-        *out_clen = 2;
-        return TRUE;
-    }
-    return FALSE;
+    gsm_luts_init ();
+
+    clen = utf8_to_gsm_char (utf8, ulen, &gsm);
+    *out_clen = clen ? clen : 1;
+    return (clen > 0);
 }
 
 static gboolean
@@ -636,40 +874,67 @@ mm_charset_get_encoded_len (const char *utf8,
     return len;
 }
 
+/* The septets are packed LSB first, so 8 septets always fill exactly 7
+ * octets. Both kernels below process full blocks of 8 septets in a single
+ * 64-bit word, and then handle the remaining septets one by one. */
+
+static inline guint64
+load_le64 (const guint8 *src, guint n_bytes)
+{
+    guint64 word = 0;
+
+    memcpy (&word, src, n_bytes);
+    return GUINT64_FROM_LE (word);
+}
+
 guint8 *
 gsm_unpack (const guint8 *gsm,
             guint32 num_septets,
             guint8 start_offset,  /* in _bits_ */
             guint32 *out_unpacked_len)
 {
-    GByteArray *unpacked;
-    int i;
-
-    unpacked = g_byte_array_sized_new (num_septets + 1);
+    guint8 *unpacked;
+    const guint8 *src;
+    guint8 shift;
+    guint32 i;
+
+    unpacked = g_malloc (num_septets + 1);
+
+    src = gsm + (start_offset / 8);
+    shift = start_offset % 8;
+
+    /* Only read the octets that hold septets: a block of 8 septets spans 7
+     * octets, or 8 if not octet-aligned */
+    for (i = 0; i + 8 <= num_septets; i += 8, src += 7) {
+        guint64 word;
+
+        word = load_le64 (src, shift ? 8 : 7) >> shift;
+        unpacked[i]     = word & 0x7F;
+        unpacked[i + 1] = (word >> 7) & 0x7F;
+        unpacked[i + 2] = (word >> 14) & 0x7F;
+        unpacked[i + 3] = (word >> 21) & 0x7F;
+        unpacked[i + 4] = (word >> 28) & 0x7F;
+        unpacked[i + 5] = (word >> 35) & 0x7F;
+        unpacked[i + 6] = (word >> 42) & 0x7F;
+        unpacked[i + 7] = (word >> 49) & 0x7F;
+    }
 
-    for (i = 0; i < num_septets; i++) {
-        guint8 bits_here, bits_in_next, octet, offset, c;
+    for (; i < num_septets; i++) {
         guint32 start_bit;
+        guint8 offset, c;
 
         start_bit = start_offset + (i * 7); /* Overall bit offset of char in buffer */
         offset = start_bit % 8;  /* Offset to start of char in this byte */
-        bits_here = offset ? (8 - offset) : 7;
-        bits_in_next = 7 - bits_here;
 
-        /* Grab bits in the current byte */
-        octet = gsm[start_bit / 8];
-        c = (octet >> offset) & (0xFF >> (8 - bits_here));
-
-        /* Grab any bits that spilled over to next byte */
-        if (bits_in_next) {
-            octet = gsm[(start_bit / 8) + 1];
-            c |= (octet & (0xFF >> (8 - bits_in_next))) << bits_here;
-        }
-        g_byte_array_append (unpacked, &c, 1);
+        /* Grab bits in the current byte, and any that spilled over to next byte */
+        c = gsm[start_bit / 8] >> offset;
+        if (offset > 1)
+            c |= gsm[(start_bit / 8) + 1] << (8 - offset);
+        unpacked[i] = c & 0x7F;
     }
 
-    *out_unpacked_len = unpacked->len;
-    return g_byte_array_free (unpacked, FALSE);
+    *out_unpacked_len = num_septets;
+    return unpacked;
 }
 
 guint8 *
@@ -679,8 +944,9 @@ gsm_pack (const guint8 *src,
           guint32 *out_packed_len)
 {
     guint8 *packed;
-    guint octet = 0, lshift, plen;
-    int i = 0;
+    guint8 *dst;
+    guint plen;
+    guint32 i;
 
     g_return_val_if_fail (start_offset < 8, NULL);
 
@@ -690,17 +956,42 @@ gsm_pack (const guint8 *src,
     plen /= 8;  /* now in bytes */
 
     packed = g_malloc0 (plen);
+    dst = packed;
+
+    for (i = 0; i + 8 <= src_len; i += 8, dst += 7) {
+        guint64 word;
+        guint   j;
+
+        word = ((guint64) (src[i]     & 0x7F))       |
+               ((guint64) (src[i + 1] & 0x7F) << 7)  |
+               ((guint64) (src[i + 2] & 0x7F) << 14) |
+               ((guint64) (src[i + 3] & 0x7F) << 21) |
+               ((guint64) (src[i + 4] & 0x7F) << 28) |
+               ((guint64) (src[i + 5] & 0x7F) << 35) |
+               ((guint64) (src[i + 6] & 0x7F) << 42) |
+               ((guint64) (src[i + 7] & 0x7F) << 49);
+        word <<= start_offset;
+
+        /* The first octet may already hold bits of the previous block; the
+         * 8th one is only touched if not octet-aligned */
+        for (j = 0; j < (start_offset ? 8 : 7); j++)
+            dst[j] |= (guint8) (word >> (j * 8));
+    }
+
+    for (; i < src_len; i++) {
+        guint32 start_bit;
+        guint8 lshift, c;
+
+        start_bit = start_offset + (i * 7);
+        lshift = start_bit % 8;
+        c = src[i] & 0x7F;
 
-    for (i = 0, lshift = start_offset; i < src_len; i++) {
-        packed[octet] |= (src[i] & 0x7F) << lshift;
+        packed[start_bit / 8] |= c << lshift;
         if (lshift > 1) {
             /* Grab the lost bits and add to next octet */
-            g_assert (octet + 1 < plen);
-            packed[octet + 1] = (src[i] & 0x7F) >> (8 - lshift);
+            g_assert ((start_bit / 8) + 1 < plen);
+            packed[(start_bit / 8) + 1] |= c >> (8 - lshift);
         }
-        if (lshift)
-            octet++;
-        lshift = lshift ? lshift - 1 : 7;
     }
 
     if (out_packed_len)
@@ -739,9 +1030,9 @@ mm_charset_take_and_convert_to_utf8 (gchar *str, MMModemCharset charset)
         GError *error = NULL;
 
         iconv_from = charset_iconv_from (charset);
-        utf8 = g_convert (str, strlen (str),
-                          "UTF-8//TRANSLIT", iconv_from,
-                          NULL, NULL, &error);
+        utf8 = charset_convert (str, strlen (str),
+                                "UTF-8//TRANSLIT", iconv_from,
+                                NULL, NULL, &error);
         if (!utf8 || error) {
             g_clear_error (&error);
             utf8 = NULL;
@@ -782,9 +1073,9 @@ mm_charset_take_and_convert_to_utf8 (gchar *str, MMModemCharset charset)
          * the partial conversion length to re-convert the part of the string
          * that is UTF-8, if any.
          */
-        utf8 = g_convert (str, strlen (str),
-                          "UTF-8//TRANSLIT", "UTF-8//TRANSLIT",
-                          &bread, &bwritten, NULL);
+        utf8 = charset_convert (str, strlen (str),
+                                "UTF-8//TRANSLIT", "UTF-8//TRANSLIT",
+                                &bread, &bwritten, NULL);
 
         /* Valid conversion, or we didn't get enough valid UTF-8 */
         if (utf8 || (bwritten <= 2)) {
@@ -796,9 +1087,9 @@ mm_charset_take_and_convert_to_utf8 (gchar *str, MMModemCharset charset)
          * location and get what we can.
          */
         str[bread] = '\0';
-        utf8 = g_convert (str, strlen (str),
-                          "UTF-8//TRANSLIT", "UTF-8//TRANSLIT",
-                          NULL, NULL, NULL);
+        utf8 = charset_convert (str, strlen (str),
+                                "UTF-8//TRANSLIT", "UTF-8//TRANSLIT",
+                                NULL, NULL, NULL);
         g_free (str);
         break;
     }
@@ -862,9 +1153,9 @@ mm_utf8_take_and_convert_to_charset (gchar *str,
         GError *error = NULL;
 
         iconv_to = charset_iconv_from (charset);
-        encoded = g_convert (str, strlen (str),
-                             iconv_to, "UTF-8",
-                             NULL, NULL, &error);
+        encoded = charset_convert (str, strlen (str),
+                                   iconv_to, "UTF-8",
+                                   NULL, NULL, &error);
         if (!encoded || error) {
             g_clear_error (&error);
             encoded = NULL;
@@ -881,9 +1172,9 @@ mm_utf8_take_and_convert_to_charset (gchar *str,
         gchar *hex;
 
         iconv_to = charset_iconv_from (charset);
-        encoded = g_convert (str, strlen (str),
-                             iconv_to, "UTF-8",
-                             NULL, &encoded_len, &error);
+        encoded = charset_convert (str, strlen (str),
+                                   iconv_to, "UTF-8",
+                                   NULL, &encoded_len, &error);
         if (!encoded || error) {
             g_clear_error (&error);
             encoded = NULL;
@@ -53,6 +53,12 @@ char *mm_modem_charset_hex_to_utf8 (const char *src, MMModemCharset charset);
  */
 char *mm_modem_charset_utf8_to_hex (const char *src, MMModemCharset charset);
 
+/* Convert UCS-2BE, or UTF-16BE with surrogate pairs, to UTF-8 without iconv.
+ * Returns NULL if the input isn't valid.
+ */
+gchar *mm_charset_utf16be_to_utf8 (const guint8 *utf16,
+                                   gsize         len);
+
 guint8 *mm_charset_utf8_to_unpacked_gsm (const char *utf8, guint32 *out_len);
 
 guint8 *mm_charset_gsm_unpacked_to_utf8 (const guint8 *gsm, guint32 len);
@@ -36,6 +36,10 @@ static gboolean     version_flag;
 static gboolean     debug;
 static gboolean     no_auto_scan = NO_AUTO_SCAN_DEFAULT;
 static const gchar *initial_kernel_events;
+static gint         bearer_stats_sampling_interval;
+static const gchar *identity_cache;
+static const gchar *sms_store;
+static gint         network_scan_cache_ttl = MM_CONTEXT_NETWORK_SCAN_CACHE_TTL_DEFAULT;
 
 static const GOptionEntry entries[] = {
     {
@@ -48,6 +52,26 @@ static const GOptionEntry entries[] = {
         "Path to initial kernel events file",
         "[PATH]"
     },
+    {
+        "bearer-stats-sampling-interval", 0, 0, G_OPTION_ARG_INT, &bearer_stats_sampling_interval,
+        "Sample the kernel counters of connected data interfaces every [MS] milliseconds",
+        "[MS]"
+    },
+    {
+        "identity-cache", 0, 0, G_OPTION_ARG_FILENAME, &identity_cache,
+        "Path to the file where modem identity information is cached",
+        "[PATH]"
+    },
+    {
+        "sms-store", 0, 0, G_OPTION_ARG_FILENAME, &sms_store,
+        "Path to the directory where received SMS messages are stored",
+        "[PATH]"
+    },
+    {
+        "network-scan-cache-ttl", 0, 0, G_OPTION_ARG_INT, &network_scan_cache_ttl,
+        "Reuse network scan results for up to [SECONDS] seconds in ScanCached()",
+        "[SECONDS]"
+    },
     {
         "debug", 0, 0, G_OPTION_ARG_NONE, &debug,
         "Run with extended debugging capabilities",
@@ -84,6 +108,30 @@ mm_context_get_no_auto_scan (void)
     return no_auto_scan;
 }
 
+guint
+mm_context_get_bearer_stats_sampling_interval (void)
+{
+    return (guint) bearer_stats_sampling_interval;
+}
+
+const gchar *
+mm_context_get_identity_cache (void)
+{
+    return identity_cache;
+}
+
+const gchar *
+mm_context_get_sms_store (void)
+{
+    return sms_store;
+}
+
+guint
+mm_context_get_network_scan_cache_ttl (void)
+{
+    return (guint) network_scan_cache_ttl;
+}
+
 /*****************************************************************************/
 /* Log context */
 
@@ -292,6 +340,16 @@ mm_context_init (gint argc,
             log_show_ts = TRUE;
     }
 
+    if (bearer_stats_sampling_interval < 0) {
+        g_warning ("error: --bearer-stats-sampling-interval must not be negative");
+        exit (1);
+    }
+
+    if (network_scan_cache_ttl < 0) {
+        g_warning ("error: --network-scan-cache-ttl must not be negative");
+        exit (1);
+    }
+
     /* Initial kernel events processing may only be used if autoscan is disabled */
 #if defined WITH_UDEV
     if (!no_auto_scan && initial_kernel_events) {
@@ -23,12 +23,18 @@
 # define MM_DIST_VERSION VERSION
 #endif
 
+#define MM_CONTEXT_NETWORK_SCAN_CACHE_TTL_DEFAULT 60
+
 void mm_context_init (gint    argc,
                       gchar **argv);
 
-gboolean     mm_context_get_debug                 (void);
-const gchar *mm_context_get_initial_kernel_events (void);
-gboolean     mm_context_get_no_auto_scan          (void);
+gboolean     mm_context_get_debug                          (void);
+const gchar *mm_context_get_initial_kernel_events          (void);
+gboolean     mm_context_get_no_auto_scan                   (void);
+guint        mm_context_get_bearer_stats_sampling_interval (void);
+const gchar *mm_context_get_identity_cache                 (void);
+const gchar *mm_context_get_sms_store                      (void);
+guint        mm_context_get_network_scan_cache_ttl         (void);
 
 /* Logging support */
 const gchar *mm_context_get_log_level               (void);
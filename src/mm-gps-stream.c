@@ -0,0 +1,357 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include <glib-unix.h>
+
+#include <ModemManager.h>
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
+
+#include "mm-gps-stream.h"
+#include "mm-log.h"
+
+typedef struct {
+    MMGpsStream *stream;
+    guint id;
+    MMGpsStreamFormat format;
+    gint fd;
+    guint watch_id;
+
+    /* Records waiting for the socket to be writable */
+    GQueue queue;
+    gsize queued_bytes;
+    gsize max_queued_bytes;
+
+    /* Stats */
+    guint32 sequence;
+    guint64 sent_records;
+    guint64 sent_bytes;
+    guint64 dropped_records;
+} Subscriber;
+
+struct _MMGpsStream {
+    GList *subscribers;
+    guint next_id;
+    guint n_fix_subscribers;
+};
+
+/*****************************************************************************/
+
+static void
+subscriber_free (Subscriber *subscriber)
+{
+    if (subscriber->watch_id)
+        g_source_remove (subscriber->watch_id);
+    g_queue_foreach (&subscriber->queue, (GFunc)g_bytes_unref, NULL);
+    g_queue_clear (&subscriber->queue);
+    close (subscriber->fd);
+    g_free (subscriber);
+}
+
+static void
+subscriber_remove (Subscriber *subscriber)
+{
+    MMGpsStream *self = subscriber->stream;
+
+    mm_dbg ("GPS stream subscriber %u gone (%" G_GUINT64_FORMAT " records sent, "
+            "%" G_GUINT64_FORMAT " dropped)",
+            subscriber->id,
+            subscriber->sent_records,
+            subscriber->dropped_records);
+
+    if (subscriber->format == MM_GPS_STREAM_FORMAT_FIX)
+        self->n_fix_subscribers--;
+    self->subscribers = g_list_remove (self->subscribers, subscriber);
+    subscriber_free (subscriber);
+}
+
+/* Returns FALSE if the subscriber is gone and was removed */
+static gboolean
+subscriber_flush (Subscriber *subscriber)
+{
+    GBytes *record;
+
+    while ((record = g_queue_peek_head (&subscriber->queue)) != NULL) {
+        gconstpointer data;
+        gsize size;
+        gssize written;
+
+        data = g_bytes_get_data (record, &size);
+        written = send (subscriber->fd, data, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+                return TRUE;
+            /* EPIPE when the subscriber closed its end */
+            subscriber_remove (subscriber);
+            return FALSE;
+        }
+
+        /* Sequenced packets are either fully written or not at all */
+        g_queue_pop_head (&subscriber->queue);
+        subscriber->queued_bytes -= size;
+        subscriber->sent_records++;
+        subscriber->sent_bytes += size;
+        g_bytes_unref (record);
+    }
+
+    return TRUE;
+}
+
+static gboolean
+subscriber_writable_cb (gint fd,
+                        GIOCondition condition,
+                        Subscriber *subscriber)
+{
+    if (condition & (G_IO_HUP | G_IO_ERR)) {
+        subscriber->watch_id = 0;
+        subscriber_remove (subscriber);
+        return G_SOURCE_REMOVE;
+    }
+
+    if (!subscriber_flush (subscriber))
+        return G_SOURCE_REMOVE;
+
+    if (g_queue_is_empty (&subscriber->queue)) {
+        subscriber->watch_id = 0;
+        return G_SOURCE_REMOVE;
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+subscriber_push (Subscriber *subscriber,
+                 GBytes *record)
+{
+    g_queue_push_tail (&subscriber->queue, g_bytes_ref (record));
+    subscriber->queued_bytes += g_bytes_get_size (record);
+
+    /* Backpressure: drop the oldest records, but never the one just added */
+    while (subscriber->queued_bytes > subscriber->max_queued_bytes &&
+           g_queue_get_length (&subscriber->queue) > 1) {
+        GBytes *oldest;
+
+        oldest = g_queue_pop_head (&subscriber->queue);
+        subscriber->queued_bytes -= g_bytes_get_size (oldest);
+        subscriber->dropped_records++;
+        g_bytes_unref (oldest);
+    }
+
+    if (!subscriber_flush (subscriber))
+        return;
+
+    if (!g_queue_is_empty (&subscriber->queue) && !subscriber->watch_id)
+        subscriber->watch_id = g_unix_fd_add (subscriber->fd,
+                                              G_IO_OUT | G_IO_HUP | G_IO_ERR,
+                                              (GUnixFDSourceFunc)subscriber_writable_cb,
+                                              subscriber);
+}
+
+/*****************************************************************************/
+
+gint
+mm_gps_stream_add_subscriber (MMGpsStream *self,
+                              MMGpsStreamFormat format,
+                              gsize max_queued_bytes,
+                              guint *out_id,
+                              GError **error)
+{
+    Subscriber *subscriber;
+    gint fds[2];
+
+    if (socketpair (AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) < 0) {
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_FAILED,
+                     "Couldn't create GPS stream socket: %s",
+                     g_strerror (errno));
+        return -1;
+    }
+
+    /* We never read from our end */
+    shutdown (fds[0], SHUT_RD);
+
+    subscriber = g_new0 (Subscriber, 1);
+    subscriber->stream = self;
+    subscriber->id = ++self->next_id;
+    subscriber->format = format;
+    subscriber->fd = fds[0];
+    subscriber->max_queued_bytes = max_queued_bytes ? max_queued_bytes : MM_GPS_STREAM_DEFAULT_MAX_QUEUED_BYTES;
+    g_queue_init (&subscriber->queue);
+
+    if (format == MM_GPS_STREAM_FORMAT_FIX)
+        self->n_fix_subscribers++;
+    self->subscribers = g_list_append (self->subscribers, subscriber);
+
+    mm_dbg ("GPS stream subscriber %u added (%s)",
+            subscriber->id,
+            format == MM_GPS_STREAM_FORMAT_FIX ? "fix" : "nmea");
+
+    if (out_id)
+        *out_id = subscriber->id;
+    return fds[1];
+}
+
+guint
+mm_gps_stream_get_n_subscribers (MMGpsStream *self)
+{
+    return g_list_length (self->subscribers);
+}
+
+/*****************************************************************************/
+
+static guint32
+utc_time_to_msecs (const gchar *utc_time)
+{
+    guint hours;
+    guint minutes;
+    gdouble seconds;
+
+    /* hhmmss.ss */
+    if (!utc_time ||
+        strlen (utc_time) < 6 ||
+        sscanf (utc_time, "%2u%2u%lf", &hours, &minutes, &seconds) != 3)
+        return G_MAXUINT32;
+
+    return (guint32) ((((hours * 60) + minutes) * 60 + seconds) * 1000);
+}
+
+static GBytes *
+build_fix_record (MMLocationGpsRaw *raw,
+                  guint32 sequence)
+{
+    guint8 record[MM_GPS_STREAM_FIX_RECORD_SIZE];
+    guint32 aux32;
+    guint64 aux64;
+    gdouble values[3];
+    guint i;
+
+    aux32 = GUINT32_TO_LE (utc_time_to_msecs (mm_location_gps_raw_get_utc_time (raw)));
+    memcpy (&record[0], &aux32, 4);
+    aux32 = GUINT32_TO_LE (sequence);
+    memcpy (&record[4], &aux32, 4);
+
+    values[0] = mm_location_gps_raw_get_latitude (raw);
+    values[1] = mm_location_gps_raw_get_longitude (raw);
+    values[2] = mm_location_gps_raw_get_altitude (raw);
+    for (i = 0; i < G_N_ELEMENTS (values); i++) {
+        memcpy (&aux64, &values[i], 8);
+        aux64 = GUINT64_TO_LE (aux64);
+        memcpy (&record[8 + (i * 8)], &aux64, 8);
+    }
+
+    return g_bytes_new (record, sizeof (record));
+}
+
+void
+mm_gps_stream_push_trace (MMGpsStream *self,
+                          const gchar *trace)
+{
+    GBytes *nmea = NULL;
+    MMLocationGpsRaw *raw = NULL;
+    gboolean fix = FALSE;
+    GList *l;
+    GList *next;
+
+    if (!self->subscribers)
+        return;
+
+    /* Only GGA traces with a position give a fix. Each trace is parsed on
+     * its own, as the parser keeps the last position known when a trace
+     * comes without one. */
+    if (self->n_fix_subscribers > 0) {
+        raw = mm_location_gps_raw_new ();
+        if (mm_location_gps_raw_add_trace (raw, trace) &&
+            mm_location_gps_raw_get_latitude (raw) != MM_LOCATION_LATITUDE_UNKNOWN &&
+            mm_location_gps_raw_get_longitude (raw) != MM_LOCATION_LONGITUDE_UNKNOWN)
+            fix = TRUE;
+    }
+
+    for (l = self->subscribers; l; l = next) {
+        Subscriber *subscriber = l->data;
+
+        /* The subscriber may get removed while pushing */
+        next = g_list_next (l);
+
+        if (subscriber->format == MM_GPS_STREAM_FORMAT_NMEA) {
+            if (!nmea)
+                nmea = g_bytes_new (trace, strlen (trace));
+            subscriber_push (subscriber, nmea);
+        } else if (fix) {
+            GBytes *record;
+
+            record = build_fix_record (raw, subscriber->sequence++);
+            subscriber_push (subscriber, record);
+            g_bytes_unref (record);
+        }
+    }
+
+    if (nmea)
+        g_bytes_unref (nmea);
+    if (raw)
+        g_object_unref (raw);
+}
+
+/*****************************************************************************/
+
+GVariant *
+mm_gps_stream_get_stats (MMGpsStream *self)
+{
+    GVariantBuilder builder;
+    GList *l;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+    for (l = self->subscribers; l; l = g_list_next (l)) {
+        Subscriber *subscriber = l->data;
+
+        g_variant_builder_open (&builder, G_VARIANT_TYPE ("a{sv}"));
+        g_variant_builder_add (&builder, "{sv}", "id", g_variant_new_uint32 (subscriber->id));
+        g_variant_builder_add (&builder, "{sv}", "format",
+                               g_variant_new_string (subscriber->format == MM_GPS_STREAM_FORMAT_FIX ? "fix" : "nmea"));
+        g_variant_builder_add (&builder, "{sv}", "sent-records", g_variant_new_uint64 (subscriber->sent_records));
+        g_variant_builder_add (&builder, "{sv}", "sent-bytes", g_variant_new_uint64 (subscriber->sent_bytes));
+        g_variant_builder_add (&builder, "{sv}", "dropped-records", g_variant_new_uint64 (subscriber->dropped_records));
+        g_variant_builder_add (&builder, "{sv}", "queued-records", g_variant_new_uint32 (g_queue_get_length (&subscriber->queue)));
+        g_variant_builder_add (&builder, "{sv}", "queued-bytes", g_variant_new_uint64 (subscriber->queued_bytes));
+        g_variant_builder_close (&builder);
+    }
+    return g_variant_builder_end (&builder);
+}
+
+/*****************************************************************************/
+
+MMGpsStream *
+mm_gps_stream_new (void)
+{
+    MMGpsStream *self;
+
+    self = g_new0 (MMGpsStream, 1);
+    return self;
+}
+
+void
+mm_gps_stream_free (MMGpsStream *self)
+{
+    g_list_free_full (self->subscribers, (GDestroyNotify)subscriber_free);
+    g_free (self);
+}
@@ -0,0 +1,66 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#ifndef MM_GPS_STREAM_H
+#define MM_GPS_STREAM_H
+
+#include <glib.h>
+
+/*****************************************************************************/
+/* Delivery of GPS data to subscribers through a socket.
+ *
+ * Each subscriber gets one end of a SOCK_SEQPACKET socket pair, where each
+ * packet is either one full NMEA trace (including the trailing <CR><LF>) or
+ * one fix record. Records that cannot be written right away are queued; when
+ * the queue goes over its limit, the oldest records are dropped. */
+
+typedef enum {
+    MM_GPS_STREAM_FORMAT_NMEA,
+    MM_GPS_STREAM_FORMAT_FIX,
+} MMGpsStreamFormat;
+
+/* Fix records are 32 bytes long, all fields little endian:
+ *   guint32 utc_time:  milliseconds since 00:00 UTC, or G_MAXUINT32 if unknown
+ *   guint32 sequence:  record number within the subscription, so that
+ *                      dropped records can be detected
+ *   gdouble latitude
+ *   gdouble longitude
+ *   gdouble altitude
+ */
+#define MM_GPS_STREAM_FIX_RECORD_SIZE 32
+
+#define MM_GPS_STREAM_DEFAULT_MAX_QUEUED_BYTES (64 * 1024)
+
+typedef struct _MMGpsStream MMGpsStream;
+
+MMGpsStream *mm_gps_stream_new  (void);
+void         mm_gps_stream_free (MMGpsStream *self);
+
+/* Returns the subscriber end of the socket, owned by the caller */
+gint mm_gps_stream_add_subscriber (MMGpsStream        *self,
+                                   MMGpsStreamFormat   format,
+                                   gsize               max_queued_bytes,
+                                   guint              *out_id,
+                                   GError            **error);
+
+guint mm_gps_stream_get_n_subscribers (MMGpsStream *self);
+
+void mm_gps_stream_push_trace (MMGpsStream *self,
+                               const gchar *trace);
+
+/* aa{sv}, one dictionary per subscriber */
+GVariant *mm_gps_stream_get_stats (MMGpsStream *self);
+
+#endif /* MM_GPS_STREAM_H */
@@ -0,0 +1,224 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include <glib/gstdio.h>
+
+#include "mm-identity-cache.h"
+#include "mm-log.h"
+
+#define KEY_MANUFACTURER          "manufacturer"
+#define KEY_MODEL                 "model"
+#define KEY_REVISION              "revision"
+#define KEY_EQUIPMENT_IDENTIFIER  "equipment-identifier"
+#define KEY_DEVICE_IDENTIFIER     "device-identifier"
+#define KEY_SUPPORTED_IP_FAMILIES "supported-ip-families"
+
+/*****************************************************************************/
+
+void
+mm_identity_cache_entry_free (MMIdentityCacheEntry *entry)
+{
+    if (!entry)
+        return;
+    g_free (entry->manufacturer);
+    g_free (entry->model);
+    g_free (entry->revision);
+    g_free (entry->equipment_identifier);
+    g_free (entry->device_identifier);
+    g_slice_free (MMIdentityCacheEntry, entry);
+}
+
+gchar *
+mm_identity_cache_build_key (const gchar *plugin,
+                             guint16      vid,
+                             guint16      pid,
+                             const gchar *device)
+{
+    g_return_val_if_fail (plugin != NULL, NULL);
+    g_return_val_if_fail (device != NULL, NULL);
+
+    /* Group names in key files cannot contain brackets */
+    if (strchr (device, '[') || strchr (device, ']'))
+        return NULL;
+
+    return g_strdup_printf ("%s:%04x:%04x:%s", plugin, vid, pid, device);
+}
+
+/*****************************************************************************/
+
+static GKeyFile *
+identity_cache_load (const gchar  *path,
+                     GError      **error)
+{
+    GKeyFile *keyfile;
+    GError   *inner_error = NULL;
+
+    keyfile = g_key_file_new ();
+    if (!g_key_file_load_from_file (keyfile, path, G_KEY_FILE_NONE, &inner_error)) {
+        /* A missing cache file is just an empty cache */
+        if (!g_error_matches (inner_error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+            g_propagate_error (error, inner_error);
+            g_key_file_free (keyfile);
+            return NULL;
+        }
+        g_error_free (inner_error);
+    }
+
+    return keyfile;
+}
+
+static gboolean
+identity_cache_save (GKeyFile     *keyfile,
+                     const gchar  *path,
+                     GError      **error)
+{
+    gchar    *data;
+    gsize     length;
+    gchar    *dirname;
+    gboolean  saved;
+
+    dirname = g_path_get_dirname (path);
+    if (g_mkdir_with_parents (dirname, 0755) < 0) {
+        g_set_error (error,
+                     G_FILE_ERROR,
+                     g_file_error_from_errno (errno),
+                     "Couldn't create directory '%s': %s",
+                     dirname, g_strerror (errno));
+        g_free (dirname);
+        return FALSE;
+    }
+    g_free (dirname);
+
+    /* g_file_set_contents() writes to a temporary file and renames it, so
+     * readers never see a partially written cache */
+    data = g_key_file_to_data (keyfile, &length, NULL);
+    saved = g_file_set_contents (path, data, length, error);
+    g_free (data);
+    return saved;
+}
+
+/*****************************************************************************/
+
+MMIdentityCacheEntry *
+mm_identity_cache_lookup (const gchar *path,
+                          const gchar *key)
+{
+    MMIdentityCacheEntry *entry;
+    GKeyFile             *keyfile;
+    GError               *error = NULL;
+
+    g_return_val_if_fail (path != NULL, NULL);
+    g_return_val_if_fail (key != NULL, NULL);
+
+    keyfile = identity_cache_load (path, &error);
+    if (!keyfile) {
+        mm_dbg ("Couldn't load identity cache: %s", error->message);
+        g_error_free (error);
+        return NULL;
+    }
+
+    if (!g_key_file_has_group (keyfile, key)) {
+        g_key_file_free (keyfile);
+        return NULL;
+    }
+
+    entry = g_slice_new0 (MMIdentityCacheEntry);
+    entry->manufacturer         = g_key_file_get_string (keyfile, key, KEY_MANUFACTURER, NULL);
+    entry->model                = g_key_file_get_string (keyfile, key, KEY_MODEL, NULL);
+    entry->revision             = g_key_file_get_string (keyfile, key, KEY_REVISION, NULL);
+    entry->equipment_identifier = g_key_file_get_string (keyfile, key, KEY_EQUIPMENT_IDENTIFIER, NULL);
+    entry->device_identifier    = g_key_file_get_string (keyfile, key, KEY_DEVICE_IDENTIFIER, NULL);
+    entry->supported_ip_families = (MMBearerIpFamily) g_key_file_get_uint64 (keyfile, key, KEY_SUPPORTED_IP_FAMILIES, NULL);
+    g_key_file_free (keyfile);
+
+    /* Without a revision the entry cannot be revalidated, so ignore it */
+    if (!entry->revision || !entry->device_identifier) {
+        mm_dbg ("Ignoring incomplete identity cache entry for '%s'", key);
+        mm_identity_cache_entry_free (entry);
+        return NULL;
+    }
+
+    return entry;
+}
+
+gboolean
+mm_identity_cache_store (const gchar                 *path,
+                         const gchar                 *key,
+                         const MMIdentityCacheEntry  *entry,
+                         GError                     **error)
+{
+    GKeyFile *keyfile;
+    gboolean  stored;
+
+    g_return_val_if_fail (path != NULL, FALSE);
+    g_return_val_if_fail (key != NULL, FALSE);
+    g_return_val_if_fail (entry != NULL, FALSE);
+
+    keyfile = identity_cache_load (path, error);
+    if (!keyfile)
+        return FALSE;
+
+    /* Always rewrite the whole group, so that no stale key survives */
+    g_key_file_remove_group (keyfile, key, NULL);
+
+#define SET_STRING(name, value) do {                            \
+        if (value)                                              \
+            g_key_file_set_string (keyfile, key, name, value);  \
+    } while (0)
+
+    SET_STRING (KEY_MANUFACTURER,         entry->manufacturer);
+    SET_STRING (KEY_MODEL,                entry->model);
+    SET_STRING (KEY_REVISION,             entry->revision);
+    SET_STRING (KEY_EQUIPMENT_IDENTIFIER, entry->equipment_identifier);
+    SET_STRING (KEY_DEVICE_IDENTIFIER,    entry->device_identifier);
+
+#undef SET_STRING
+
+    g_key_file_set_uint64 (keyfile, key, KEY_SUPPORTED_IP_FAMILIES, (guint64) entry->supported_ip_families);
+
+    stored = identity_cache_save (keyfile, path, error);
+    g_key_file_free (keyfile);
+    return stored;
+}
+
+gboolean
+mm_identity_cache_remove (const gchar  *path,
+                          const gchar  *key,
+                          GError      **error)
+{
+    GKeyFile *keyfile;
+    gboolean  removed;
+
+    g_return_val_if_fail (path != NULL, FALSE);
+    g_return_val_if_fail (key != NULL, FALSE);
+
+    keyfile = identity_cache_load (path, error);
+    if (!keyfile)
+        return FALSE;
+
+    /* Nothing to do if no such entry */
+    if (!g_key_file_has_group (keyfile, key)) {
+        g_key_file_free (keyfile);
+        return TRUE;
+    }
+
+    g_key_file_remove_group (keyfile, key, NULL);
+    removed = identity_cache_save (keyfile, path, error);
+    g_key_file_free (keyfile);
+    return removed;
+}
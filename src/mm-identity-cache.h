@@ -0,0 +1,56 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#ifndef MM_IDENTITY_CACHE_H
+#define MM_IDENTITY_CACHE_H
+
+#include <glib.h>
+
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
+
+/*****************************************************************************/
+/* On-disk cache of the modem identity information, which doesn't change
+ * for a given device unless the firmware is upgraded. */
+
+typedef struct {
+    gchar            *manufacturer;
+    gchar            *model;
+    gchar            *revision;
+    gchar            *equipment_identifier;
+    gchar            *device_identifier;
+    MMBearerIpFamily  supported_ip_families;
+} MMIdentityCacheEntry;
+
+void mm_identity_cache_entry_free (MMIdentityCacheEntry *entry);
+
+/* The key identifies the physical device, as the device identifier itself
+ * can only be computed once the identity information is loaded. */
+gchar *mm_identity_cache_build_key (const gchar *plugin,
+                                    guint16      vid,
+                                    guint16      pid,
+                                    const gchar *device);
+
+MMIdentityCacheEntry *mm_identity_cache_lookup (const gchar                 *path,
+                                                const gchar                 *key);
+gboolean              mm_identity_cache_store  (const gchar                 *path,
+                                                const gchar                 *key,
+                                                const MMIdentityCacheEntry  *entry,
+                                                GError                     **error);
+gboolean              mm_identity_cache_remove (const gchar                 *path,
+                                                const gchar                 *key,
+                                                GError                     **error);
+
+#endif /* MM_IDENTITY_CACHE_H */
@@ -26,6 +26,7 @@
 #include "mm-base-modem.h"
 #include "mm-modem-helpers.h"
 #include "mm-error-helpers.h"
+#include "mm-context.h"
 #include "mm-log.h"
 
 #define REGISTRATION_CHECK_TIMEOUT_SEC 30
@@ -34,9 +35,11 @@
 
 #define REGISTRATION_STATE_CONTEXT_TAG    "3gpp-registration-state-context-tag"
 #define REGISTRATION_CHECK_CONTEXT_TAG    "3gpp-registration-check-context-tag"
+#define SCAN_CONTEXT_TAG                  "3gpp-scan-context-tag"
 
 static GQuark registration_state_context_quark;
 static GQuark registration_check_context_quark;
+static GQuark scan_context_quark;
 
 /*****************************************************************************/
 
@@ -609,6 +612,7 @@ typedef struct {
     MmGdbusModem3gpp *skeleton;
     GDBusMethodInvocation *invocation;
     MMIfaceModem3gpp *self;
+    gboolean cached;
 } HandleScanContext;
 
 static void
@@ -620,6 +624,80 @@ handle_scan_context_free (HandleScanContext *ctx)
     g_free (ctx);
 }
 
+static void
+handle_scan_context_complete_and_free (HandleScanContext *ctx,
+                                       GVariant *results,
+                                       const GError *error)
+{
+    if (error)
+        g_dbus_method_invocation_return_gerror (ctx->invocation, error);
+    else if (ctx->cached)
+        mm_gdbus_modem3gpp_complete_scan_cached (ctx->skeleton,
+                                                 ctx->invocation,
+                                                 results);
+    else
+        mm_gdbus_modem3gpp_complete_scan (ctx->skeleton,
+                                          ctx->invocation,
+                                          results);
+    handle_scan_context_free (ctx);
+}
+
+/* Network scans are shared by all the requests received while they run, and
+ * their results are kept for a while */
+typedef struct {
+    /* HandleScanContext, waiting for the ongoing scan */
+    GList *waiting;
+    /* Results of the last successful scan, aa{sv} */
+    GVariant *results;
+    gint64 results_time;
+} ScanContext;
+
+static void
+scan_context_free (ScanContext *ctx)
+{
+    g_assert (!ctx->waiting);
+    if (ctx->results)
+        g_variant_unref (ctx->results);
+    g_free (ctx);
+}
+
+static ScanContext *
+get_scan_context (MMIfaceModem3gpp *self)
+{
+    ScanContext *ctx;
+
+    if (G_UNLIKELY (!scan_context_quark))
+        scan_context_quark = (g_quark_from_static_string (
+                                  SCAN_CONTEXT_TAG));
+
+    ctx = g_object_get_qdata (G_OBJECT (self), scan_context_quark);
+    if (!ctx) {
+        ctx = g_new0 (ScanContext, 1);
+        g_object_set_qdata_full (
+            G_OBJECT (self),
+            scan_context_quark,
+            ctx,
+            (GDestroyNotify)scan_context_free);
+    }
+
+    return ctx;
+}
+
+static void
+scan_results_invalidate (MMIfaceModem3gpp *self)
+{
+    ScanContext *ctx;
+
+    if (G_UNLIKELY (!scan_context_quark))
+        return;
+
+    ctx = g_object_get_qdata (G_OBJECT (self), scan_context_quark);
+    if (ctx && ctx->results) {
+        g_variant_unref (ctx->results);
+        ctx->results = NULL;
+    }
+}
+
 static GVariant *
 scan_networks_build_result (GList *info_list)
 {
@@ -653,32 +731,74 @@ scan_networks_build_result (GList *info_list)
         g_variant_builder_close (&builder);
     }
 
-    return g_variant_ref (g_variant_builder_end (&builder));
+    return g_variant_ref_sink (g_variant_builder_end (&builder));
 }
 
 static void
 handle_scan_ready (MMIfaceModem3gpp *self,
-                   GAsyncResult *res,
-                   HandleScanContext *ctx)
+                   GAsyncResult *res)
 {
+    ScanContext *scan_ctx;
+    GVariant *results = NULL;
     GError *error = NULL;
     GList *info_list;
+    GList *waiting;
+    GList *l;
+
+    scan_ctx = get_scan_context (self);
 
     info_list = MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks_finish (self, res, &error);
+    if (!error) {
+        results = scan_networks_build_result (info_list);
+        if (scan_ctx->results)
+            g_variant_unref (scan_ctx->results);
+        scan_ctx->results = g_variant_ref (results);
+        scan_ctx->results_time = g_get_monotonic_time ();
+    }
+
+    /* Complete all the requests that joined the scan */
+    waiting = scan_ctx->waiting;
+    scan_ctx->waiting = NULL;
+    mm_dbg ("Network scan finished, completing %u requests", g_list_length (waiting));
+    for (l = waiting; l; l = g_list_next (l))
+        handle_scan_context_complete_and_free ((HandleScanContext *)l->data, results, error);
+    g_list_free (waiting);
+
+    if (results)
+        g_variant_unref (results);
     if (error)
-        g_dbus_method_invocation_take_error (ctx->invocation, error);
-    else {
-        GVariant *dict_array;
+        g_error_free (error);
+    mm_3gpp_network_info_list_free (info_list);
+}
 
-        dict_array = scan_networks_build_result (info_list);
-        mm_gdbus_modem3gpp_complete_scan (ctx->skeleton,
-                                          ctx->invocation,
-                                          dict_array);
-        g_variant_unref (dict_array);
+static void
+handle_scan_run (HandleScanContext *ctx)
+{
+    ScanContext *scan_ctx;
+
+    scan_ctx = get_scan_context (ctx->self);
+
+    /* Reuse the last results if they're recent enough */
+    if (ctx->cached &&
+        scan_ctx->results &&
+        ((g_get_monotonic_time () - scan_ctx->results_time) <
+         ((gint64) mm_context_get_network_scan_cache_ttl () * G_USEC_PER_SEC))) {
+        mm_dbg ("Reusing network scan results");
+        handle_scan_context_complete_and_free (ctx, scan_ctx->results, NULL);
+        return;
     }
 
-    mm_3gpp_network_info_list_free (info_list);
-    handle_scan_context_free (ctx);
+    /* Join the ongoing scan, if any */
+    scan_ctx->waiting = g_list_append (scan_ctx->waiting, ctx);
+    if (scan_ctx->waiting->next) {
+        mm_dbg ("Network scan already in progress");
+        return;
+    }
+
+    MM_IFACE_MODEM_3GPP_GET_INTERFACE (ctx->self)->scan_networks (
+        ctx->self,
+        (GAsyncReadyCallback)handle_scan_ready,
+        NULL);
 }
 
 static void
@@ -742,20 +862,18 @@ handle_scan_auth_ready (MMBaseModem *self,
     case MM_MODEM_STATE_DISCONNECTING:
     case MM_MODEM_STATE_CONNECTING:
     case MM_MODEM_STATE_CONNECTED:
-        MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks (
-            MM_IFACE_MODEM_3GPP (self),
-            (GAsyncReadyCallback)handle_scan_ready,
-            ctx);
+        handle_scan_run (ctx);
         return;
     }
 
     handle_scan_context_free (ctx);
 }
 
-static gboolean
-handle_scan (MmGdbusModem3gpp *skeleton,
-             GDBusMethodInvocation *invocation,
-             MMIfaceModem3gpp *self)
+static void
+handle_scan_common (MmGdbusModem3gpp *skeleton,
+                    GDBusMethodInvocation *invocation,
+                    MMIfaceModem3gpp *self,
+                    gboolean cached)
 {
     HandleScanContext *ctx;
 
@@ -763,12 +881,30 @@ handle_scan (MmGdbusModem3gpp *skeleton,
     ctx->skeleton = g_object_ref (skeleton);
     ctx->invocation = g_object_ref (invocation);
     ctx->self = g_object_ref (self);
+    ctx->cached = cached;
 
     mm_base_modem_authorize (MM_BASE_MODEM (self),
                              invocation,
                              MM_AUTHORIZATION_DEVICE_CONTROL,
                              (GAsyncReadyCallback)handle_scan_auth_ready,
                              ctx);
+}
+
+static gboolean
+handle_scan (MmGdbusModem3gpp *skeleton,
+             GDBusMethodInvocation *invocation,
+             MMIfaceModem3gpp *self)
+{
+    handle_scan_common (skeleton, invocation, self, FALSE);
+    return TRUE;
+}
+
+static gboolean
+handle_scan_cached (MmGdbusModem3gpp *skeleton,
+                    GDBusMethodInvocation *invocation,
+                    MMIfaceModem3gpp *self)
+{
+    handle_scan_common (skeleton, invocation, self, TRUE);
     return TRUE;
 }
 
@@ -1143,6 +1279,8 @@ update_registration_reload_current_registration_info_ready (MMIfaceModem3gpp *se
 
     ctx = get_registration_state_context (self);
     ctx->reloading_registration_info = FALSE;
+
+    mm_base_modem_end_property_updates (MM_BASE_MODEM (self));
 }
 
 static void
@@ -1216,6 +1354,10 @@ update_registration_state (MMIfaceModem3gpp *self,
         /* Reload current registration info. ONLY update the state to REGISTERED
          * after having loaded operator code/name/subscription state */
         ctx->reloading_registration_info = TRUE;
+
+        /* Operator info, access technology, location and registration state
+         * all change while reloading; notify them together */
+        mm_base_modem_begin_property_updates (MM_BASE_MODEM (self));
         mm_iface_modem_3gpp_reload_current_registration_info (
             self,
             (GAsyncReadyCallback)update_registration_reload_current_registration_info_ready,
@@ -1307,6 +1449,7 @@ mm_iface_modem_3gpp_update_subscription_state (MMIfaceModem3gpp *self,
 /*****************************************************************************/
 
 typedef struct {
+    MMBaseModem *self;
     guint timeout_source;
     gboolean running;
 } RegistrationCheckContext;
@@ -1315,7 +1458,7 @@ static void
 registration_check_context_free (RegistrationCheckContext *ctx)
 {
     if (ctx->timeout_source)
-        g_source_remove (ctx->timeout_source);
+        mm_base_modem_poll_remove (ctx->self, ctx->timeout_source);
     g_free (ctx);
 }
 
@@ -1388,9 +1531,12 @@ periodic_registration_check_enable (MMIfaceModem3gpp *self)
     /* Create context and keep it as object data */
     mm_dbg ("Periodic 3GPP registration checks enabled");
     ctx = g_new0 (RegistrationCheckContext, 1);
-    ctx->timeout_source = g_timeout_add_seconds (REGISTRATION_CHECK_TIMEOUT_SEC,
-                                                 (GSourceFunc)periodic_registration_check,
-                                                 self);
+    ctx->self = MM_BASE_MODEM (self);
+    ctx->timeout_source = mm_base_modem_poll_add (MM_BASE_MODEM (self),
+                                                  MM_BASE_MODEM_POLL_REGISTRATION,
+                                                  REGISTRATION_CHECK_TIMEOUT_SEC,
+                                                  (GSourceFunc)periodic_registration_check,
+                                                  self);
     g_object_set_qdata_full (G_OBJECT (self),
                              registration_check_context_quark,
                              ctx,
@@ -1482,6 +1628,8 @@ interface_disabling_step (GTask *task)
     case DISABLING_STEP_PERIODIC_REGISTRATION_CHECKS:
         /* Disable periodic registration checks, if they were set */
         periodic_registration_check_disable (self);
+        /* Scan results are not valid after disabling */
+        scan_results_invalidate (self);
         /* Fall down to next step */
         ctx->step++;
 
@@ -2016,6 +2164,10 @@ interface_initialization_step (GTask *task)
                           "handle-scan",
                           G_CALLBACK (handle_scan),
                           self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-scan-cached",
+                          G_CALLBACK (handle_scan_cached),
+                          self);
 
 
         /* Finally, export the new interface */
@@ -1129,6 +1129,7 @@ mm_iface_modem_cdma_update_cdma1x_registration_state (MMIfaceModemCdma *self,
 /*****************************************************************************/
 
 typedef struct {
+    MMBaseModem *self;
     guint timeout_source;
     gboolean running;
 } RegistrationCheckContext;
@@ -1137,7 +1138,7 @@ static void
 registration_check_context_free (RegistrationCheckContext *ctx)
 {
     if (ctx->timeout_source)
-        g_source_remove (ctx->timeout_source);
+        mm_base_modem_poll_remove (ctx->self, ctx->timeout_source);
     g_free (ctx);
 }
 
@@ -1210,9 +1211,12 @@ periodic_registration_check_enable (MMIfaceModemCdma *self)
     /* Create context and keep it as object data */
     mm_dbg ("Periodic CDMA registration checks enabled");
     ctx = g_new0 (RegistrationCheckContext, 1);
-    ctx->timeout_source = g_timeout_add_seconds (REGISTRATION_CHECK_TIMEOUT_SEC,
-                                                 (GSourceFunc)periodic_registration_check,
-                                                 self);
+    ctx->self = MM_BASE_MODEM (self);
+    ctx->timeout_source = mm_base_modem_poll_add (MM_BASE_MODEM (self),
+                                                  MM_BASE_MODEM_POLL_REGISTRATION,
+                                                  REGISTRATION_CHECK_TIMEOUT_SEC,
+                                                  (GSourceFunc)periodic_registration_check,
+                                                  self);
     g_object_set_qdata_full (G_OBJECT (self),
                              registration_check_context_quark,
                              ctx,
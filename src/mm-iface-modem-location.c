@@ -14,12 +14,17 @@
  * Copyright (C) 2012 Lanedo GmbH <aleksander@lanedo.com>
  */
 
+#include <unistd.h>
+
+#include <gio/gunixfdlist.h>
+
 #include <ModemManager.h>
 #define _LIBMM_INSIDE_MM
 #include <libmm-glib.h>
 
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-location.h"
+#include "mm-gps-stream.h"
 #include "mm-log.h"
 
 #define MM_LOCATION_GPS_REFRESH_TIME_SECS 30
@@ -46,6 +51,8 @@ typedef struct {
     MMLocationGpsNmea *location_gps_nmea;
     time_t location_gps_raw_last_time;
     MMLocationGpsRaw *location_gps_raw;
+    /* Unthrottled GPS stream subscribers */
+    MMGpsStream *gps_stream;
     /* CDMA BS location */
     MMLocationCdmaBs *location_cdma_bs;
 } LocationContext;
@@ -59,6 +66,8 @@ location_context_free (LocationContext *ctx)
         g_object_unref (ctx->location_gps_nmea);
     if (ctx->location_gps_raw)
         g_object_unref (ctx->location_gps_raw);
+    if (ctx->gps_stream)
+        mm_gps_stream_free (ctx->gps_stream);
     if (ctx->location_cdma_bs)
         g_object_unref (ctx->location_cdma_bs);
     g_free (ctx);
@@ -249,6 +258,10 @@ mm_iface_modem_location_gps_update (MMIfaceModemLocation *self,
     if (!skeleton)
         return;
 
+    /* Stream subscribers get every trace, regardless of the refresh rate */
+    if (ctx->gps_stream)
+        mm_gps_stream_push_trace (ctx->gps_stream, nmea_trace);
+
     if (mm_gdbus_modem_location_get_enabled (skeleton) & MM_MODEM_LOCATION_SOURCE_GPS_NMEA) {
         g_assert (ctx->location_gps_nmea != NULL);
         if (mm_location_gps_nmea_add_trace (ctx->location_gps_nmea, nmea_trace) &&
@@ -1195,6 +1208,243 @@ handle_get_location (MmGdbusModemLocation *skeleton,
 
 /*****************************************************************************/
 
+typedef struct {
+    MmGdbusModemLocation *skeleton;
+    GDBusMethodInvocation *invocation;
+    MMIfaceModemLocation *self;
+    GVariant *options;
+} HandleOpenGpsStreamContext;
+
+static void
+handle_open_gps_stream_context_free (HandleOpenGpsStreamContext *ctx)
+{
+    g_object_unref (ctx->skeleton);
+    g_object_unref (ctx->invocation);
+    g_object_unref (ctx->self);
+    g_variant_unref (ctx->options);
+    g_free (ctx);
+}
+
+static gboolean
+parse_gps_stream_options (GVariant *options,
+                          MMGpsStreamFormat *format,
+                          guint *max_queued_bytes,
+                          GError **error)
+{
+    GVariantIter iter;
+    gchar *key;
+    GVariant *value;
+    gboolean ret = TRUE;
+
+    *format = MM_GPS_STREAM_FORMAT_NMEA;
+    *max_queued_bytes = 0;
+
+    g_variant_iter_init (&iter, options);
+    while (ret && g_variant_iter_next (&iter, "{sv}", &key, &value)) {
+        if (g_str_equal (key, "format") &&
+            g_variant_is_of_type (value, G_VARIANT_TYPE_STRING)) {
+            const gchar *str;
+
+            str = g_variant_get_string (value, NULL);
+            if (g_str_equal (str, "nmea"))
+                *format = MM_GPS_STREAM_FORMAT_NMEA;
+            else if (g_str_equal (str, "fix"))
+                *format = MM_GPS_STREAM_FORMAT_FIX;
+            else {
+                g_set_error (error,
+                             MM_CORE_ERROR,
+                             MM_CORE_ERROR_INVALID_ARGS,
+                             "Invalid GPS stream format: '%s'",
+                             str);
+                ret = FALSE;
+            }
+        } else if (g_str_equal (key, "max-queued-bytes") &&
+                   g_variant_is_of_type (value, G_VARIANT_TYPE_UINT32)) {
+            *max_queued_bytes = g_variant_get_uint32 (value);
+        } else {
+            g_set_error (error,
+                         MM_CORE_ERROR,
+                         MM_CORE_ERROR_INVALID_ARGS,
+                         "Invalid GPS stream option: '%s'",
+                         key);
+            ret = FALSE;
+        }
+        g_free (key);
+        g_variant_unref (value);
+    }
+
+    return ret;
+}
+
+static void
+handle_open_gps_stream_auth_ready (MMBaseModem *self,
+                                   GAsyncResult *res,
+                                   HandleOpenGpsStreamContext *ctx)
+{
+    MMModemState modem_state;
+    LocationContext *location_ctx;
+    MMGpsStreamFormat format;
+    GUnixFDList *fd_list;
+    guint max_queued_bytes;
+    guint id = 0;
+    gint fd;
+    GError *error = NULL;
+
+    if (!mm_base_modem_authorize_finish (self, res, &error)) {
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+        handle_open_gps_stream_context_free (ctx);
+        return;
+    }
+
+    modem_state = MM_MODEM_STATE_UNKNOWN;
+    g_object_get (self,
+                  MM_IFACE_MODEM_STATE, &modem_state,
+                  NULL);
+    if (modem_state < MM_MODEM_STATE_ENABLED) {
+        g_dbus_method_invocation_return_error (ctx->invocation,
+                                               MM_CORE_ERROR,
+                                               MM_CORE_ERROR_WRONG_STATE,
+                                               "Cannot open GPS stream: "
+                                               "device not yet enabled");
+        handle_open_gps_stream_context_free (ctx);
+        return;
+    }
+
+    if (!(mm_gdbus_modem_location_get_enabled (ctx->skeleton) & (MM_MODEM_LOCATION_SOURCE_GPS_NMEA |
+                                                                  MM_MODEM_LOCATION_SOURCE_GPS_RAW))) {
+        g_dbus_method_invocation_return_error (ctx->invocation,
+                                               MM_CORE_ERROR,
+                                               MM_CORE_ERROR_WRONG_STATE,
+                                               "Cannot open GPS stream: "
+                                               "GPS location gathering not enabled");
+        handle_open_gps_stream_context_free (ctx);
+        return;
+    }
+
+    if (!parse_gps_stream_options (ctx->options, &format, &max_queued_bytes, &error)) {
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+        handle_open_gps_stream_context_free (ctx);
+        return;
+    }
+
+    location_ctx = get_location_context (ctx->self);
+    if (!location_ctx->gps_stream)
+        location_ctx->gps_stream = mm_gps_stream_new ();
+
+    fd = mm_gps_stream_add_subscriber (location_ctx->gps_stream, format, max_queued_bytes, &id, &error);
+    if (fd < 0) {
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+        handle_open_gps_stream_context_free (ctx);
+        return;
+    }
+
+    /* The fd list keeps its own duplicate */
+    fd_list = g_unix_fd_list_new ();
+    if (g_unix_fd_list_append (fd_list, fd, &error) < 0) {
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+        close (fd);
+        g_object_unref (fd_list);
+        handle_open_gps_stream_context_free (ctx);
+        return;
+    }
+    close (fd);
+
+    mm_gdbus_modem_location_complete_open_gps_stream (ctx->skeleton,
+                                                      ctx->invocation,
+                                                      fd_list,
+                                                      g_variant_new_handle (0),
+                                                      id);
+    g_object_unref (fd_list);
+    handle_open_gps_stream_context_free (ctx);
+}
+
+static gboolean
+handle_open_gps_stream (MmGdbusModemLocation *skeleton,
+                        GDBusMethodInvocation *invocation,
+                        GUnixFDList *fd_list,
+                        GVariant *options,
+                        MMIfaceModemLocation *self)
+{
+    HandleOpenGpsStreamContext *ctx;
+
+    ctx = g_new (HandleOpenGpsStreamContext, 1);
+    ctx->skeleton = g_object_ref (skeleton);
+    ctx->invocation = g_object_ref (invocation);
+    ctx->self = g_object_ref (self);
+    ctx->options = g_variant_ref (options);
+
+    mm_base_modem_authorize (MM_BASE_MODEM (self),
+                             invocation,
+                             MM_AUTHORIZATION_LOCATION,
+                             (GAsyncReadyCallback)handle_open_gps_stream_auth_ready,
+                             ctx);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    MmGdbusModemLocation *skeleton;
+    GDBusMethodInvocation *invocation;
+    MMIfaceModemLocation *self;
+} HandleGetGpsStreamStatsContext;
+
+static void
+handle_get_gps_stream_stats_context_free (HandleGetGpsStreamStatsContext *ctx)
+{
+    g_object_unref (ctx->skeleton);
+    g_object_unref (ctx->invocation);
+    g_object_unref (ctx->self);
+    g_free (ctx);
+}
+
+static void
+handle_get_gps_stream_stats_auth_ready (MMBaseModem *self,
+                                        GAsyncResult *res,
+                                        HandleGetGpsStreamStatsContext *ctx)
+{
+    LocationContext *location_ctx;
+    GVariant *stats;
+    GError *error = NULL;
+
+    if (!mm_base_modem_authorize_finish (self, res, &error)) {
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+        handle_get_gps_stream_stats_context_free (ctx);
+        return;
+    }
+
+    location_ctx = get_location_context (ctx->self);
+    if (location_ctx->gps_stream)
+        stats = mm_gps_stream_get_stats (location_ctx->gps_stream);
+    else
+        stats = g_variant_new_array (G_VARIANT_TYPE ("a{sv}"), NULL, 0);
+
+    mm_gdbus_modem_location_complete_get_gps_stream_stats (ctx->skeleton, ctx->invocation, stats);
+    handle_get_gps_stream_stats_context_free (ctx);
+}
+
+static gboolean
+handle_get_gps_stream_stats (MmGdbusModemLocation *skeleton,
+                             GDBusMethodInvocation *invocation,
+                             MMIfaceModemLocation *self)
+{
+    HandleGetGpsStreamStatsContext *ctx;
+
+    ctx = g_new (HandleGetGpsStreamStatsContext, 1);
+    ctx->skeleton = g_object_ref (skeleton);
+    ctx->invocation = g_object_ref (invocation);
+    ctx->self = g_object_ref (self);
+
+    mm_base_modem_authorize (MM_BASE_MODEM (self),
+                             invocation,
+                             MM_AUTHORIZATION_LOCATION,
+                             (GAsyncReadyCallback)handle_get_gps_stream_stats_auth_ready,
+                             ctx);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
 typedef struct _DisablingContext DisablingContext;
 static void interface_disabling_step (GTask *task);
 
@@ -1604,6 +1854,14 @@ interface_initialization_step (GTask *task)
                           "handle-get-location",
                           G_CALLBACK (handle_get_location),
                           self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-open-gps-stream",
+                          G_CALLBACK (handle_open_gps_stream),
+                          self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-get-gps-stream-stats",
+                          G_CALLBACK (handle_get_gps_stream_stats),
+                          self);
 
         /* Finally, export the new interface */
         mm_gdbus_object_skeleton_set_modem_location (MM_GDBUS_OBJECT_SKELETON (self),
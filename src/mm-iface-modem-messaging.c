@@ -20,15 +20,23 @@
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-messaging.h"
 #include "mm-sms-list.h"
+#include "mm-sms-store.h"
+#include "mm-context.h"
 #include "mm-log.h"
 
-#define SUPPORT_CHECKED_TAG "messaging-support-checked-tag"
-#define SUPPORTED_TAG       "messaging-supported-tag"
-#define STORAGE_CONTEXT_TAG "messaging-storage-context-tag"
+#define SUPPORT_CHECKED_TAG   "messaging-support-checked-tag"
+#define SUPPORTED_TAG         "messaging-supported-tag"
+#define STORAGE_CONTEXT_TAG   "messaging-storage-context-tag"
+#define SMS_STORE_CONTEXT_TAG "messaging-sms-store-context-tag"
+#define UPDATE_LIST_TAG       "messaging-update-list-tag"
+
+#define SMS_STORE_DELETE_RETRY_TIMEOUT_SECS 2
 
 static GQuark support_checked_quark;
 static GQuark supported_quark;
 static GQuark storage_context_quark;
+static GQuark sms_store_context_quark;
+static GQuark update_list_quark;
 
 /*****************************************************************************/
 
@@ -140,6 +148,246 @@ get_storage_context (MMIfaceModemMessaging *self)
     return ctx;
 }
 
+/*****************************************************************************/
+/* Daemon-side SMS store */
+
+typedef struct {
+    MMSmsStorage storage;
+    guint index;
+} PendingDeletion;
+
+typedef struct {
+    MMSmsStore *store;
+    /* Parts already in the store, to be removed from the modem */
+    GQueue *pending;
+    gboolean deleting;
+    guint retry_id;
+} SmsStoreContext;
+
+static void
+sms_store_context_free (SmsStoreContext *ctx)
+{
+    if (ctx->retry_id)
+        g_source_remove (ctx->retry_id);
+    g_queue_free_full (ctx->pending, g_free);
+    mm_sms_store_free (ctx->store);
+    g_free (ctx);
+}
+
+static SmsStoreContext *
+peek_sms_store_context (MMIfaceModemMessaging *self)
+{
+    if (G_UNLIKELY (!sms_store_context_quark))
+        sms_store_context_quark = (g_quark_from_static_string (
+                                       SMS_STORE_CONTEXT_TAG));
+
+    return g_object_get_qdata (G_OBJECT (self), sms_store_context_quark);
+}
+
+static SmsStoreContext *
+open_sms_store_context (MMIfaceModemMessaging *self)
+{
+    SmsStoreContext *ctx;
+    MMSmsStore *store;
+    const gchar *equipment_identifier;
+    gchar *name;
+    gchar *path;
+    GError *error = NULL;
+
+    if (!mm_context_get_sms_store ())
+        return NULL;
+
+    ctx = peek_sms_store_context (self);
+    if (ctx)
+        return ctx;
+
+    /* One store per device, so that messages follow the modem around */
+    equipment_identifier = mm_iface_modem_get_equipment_identifier (MM_IFACE_MODEM (self));
+    if (!equipment_identifier) {
+        mm_dbg ("Not using SMS store: unknown equipment identifier");
+        return NULL;
+    }
+
+    name = g_strdelimit (g_strdup (equipment_identifier), G_DIR_SEPARATOR_S, '_');
+    path = g_build_filename (mm_context_get_sms_store (), name, NULL);
+    g_free (name);
+
+    store = mm_sms_store_open (path, &error);
+    g_free (path);
+    if (!store) {
+        mm_warn ("Couldn't open SMS store: %s", error->message);
+        g_error_free (error);
+        return NULL;
+    }
+
+    ctx = g_new0 (SmsStoreContext, 1);
+    ctx->store = store;
+    ctx->pending = g_queue_new ();
+    g_object_set_qdata_full (G_OBJECT (self),
+                             sms_store_context_quark,
+                             ctx,
+                             (GDestroyNotify)sms_store_context_free);
+    return ctx;
+}
+
+static void sms_store_process_deletions (MMIfaceModemMessaging *self);
+
+static gboolean
+sms_store_retry_deletions_cb (MMIfaceModemMessaging *self)
+{
+    SmsStoreContext *ctx;
+
+    ctx = peek_sms_store_context (self);
+    ctx->retry_id = 0;
+    sms_store_process_deletions (self);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+delete_stored_part_ready (MMBaseModem *self,
+                          GAsyncResult *res,
+                          gpointer unused)
+{
+    SmsStoreContext *ctx;
+    GError *error = NULL;
+
+    ctx = peek_sms_store_context (MM_IFACE_MODEM_MESSAGING (self));
+    ctx->deleting = FALSE;
+
+    if (!mm_base_sms_delete_stored_part_finish (self, res, &error)) {
+        /* Storages are locked while listing, sending... so try again later */
+        if (g_error_matches (error, MM_CORE_ERROR, MM_CORE_ERROR_RETRY)) {
+            g_error_free (error);
+            ctx->retry_id = g_timeout_add_seconds (SMS_STORE_DELETE_RETRY_TIMEOUT_SECS,
+                                                   (GSourceFunc)sms_store_retry_deletions_cb,
+                                                   self);
+            return;
+        }
+
+        mm_warn ("Couldn't remove stored SMS part from the modem: %s", error->message);
+        g_error_free (error);
+    }
+
+    g_free (g_queue_pop_head (ctx->pending));
+    sms_store_process_deletions (MM_IFACE_MODEM_MESSAGING (self));
+}
+
+static void
+sms_store_process_deletions (MMIfaceModemMessaging *self)
+{
+    SmsStoreContext *ctx;
+    PendingDeletion *pending;
+
+    ctx = peek_sms_store_context (self);
+    if (ctx->deleting || ctx->retry_id || g_queue_is_empty (ctx->pending))
+        return;
+
+    pending = g_queue_peek_head (ctx->pending);
+    ctx->deleting = TRUE;
+    mm_base_sms_delete_stored_part (MM_BASE_MODEM (self),
+                                    pending->storage,
+                                    pending->index,
+                                    (GAsyncReadyCallback)delete_stored_part_ready,
+                                    NULL);
+}
+
+static void
+sms_store_load_part (MMSmsPart *part,
+                     MMSmsState state,
+                     MMSmsList *list)
+{
+    GError *error = NULL;
+
+    if (!mm_sms_list_take_part (list, part, state, MM_SMS_STORAGE_UNKNOWN, &error)) {
+        mm_dbg ("Couldn't take stored part in SMS list: '%s'", error->message);
+        g_error_free (error);
+        mm_sms_part_free (part);
+    }
+}
+
+static void
+sms_store_load (MMIfaceModemMessaging *self,
+                MMSmsList *list)
+{
+    SmsStoreContext *ctx;
+    guint n_loaded;
+
+    ctx = open_sms_store_context (self);
+    if (!ctx)
+        return;
+
+    n_loaded = mm_sms_store_foreach (ctx->store,
+                                     (MMSmsStoreForeachFn)sms_store_load_part,
+                                     list);
+    mm_dbg ("Loaded %u SMS parts from the store", n_loaded);
+}
+
+/* Returns TRUE if the part was already in the store and got freed */
+static gboolean
+sms_store_take_part (MMIfaceModemMessaging *self,
+                     MMSmsPart *sms_part,
+                     MMSmsState state,
+                     MMSmsStorage *storage)
+{
+    SmsStoreContext *ctx;
+    PendingDeletion *pending;
+    gboolean already_stored;
+    GError *error = NULL;
+
+    /* Only received parts which are in a modem storage */
+    ctx = peek_sms_store_context (self);
+    if (!ctx ||
+        state != MM_SMS_STATE_RECEIVED ||
+        *storage == MM_SMS_STORAGE_UNKNOWN ||
+        mm_sms_part_get_index (sms_part) == SMS_PART_INVALID_INDEX)
+        return FALSE;
+
+    /* The part may have been stored right before a restart, without having
+     * been removed from the modem yet */
+    already_stored = mm_sms_store_contains (ctx->store, sms_part);
+    if (!already_stored &&
+        !mm_sms_store_append (ctx->store, sms_part, state, &error)) {
+        mm_warn ("Couldn't keep SMS part in the store, leaving it in the modem: %s",
+                 error->message);
+        g_error_free (error);
+        return FALSE;
+    }
+
+    /* Safe in the store, so free the modem storage */
+    pending = g_new (PendingDeletion, 1);
+    pending->storage = *storage;
+    pending->index = mm_sms_part_get_index (sms_part);
+    g_queue_push_tail (ctx->pending, pending);
+    sms_store_process_deletions (self);
+
+    if (already_stored) {
+        mm_dbg ("SMS part at '%s/%u' was already in the store",
+                mm_sms_storage_get_string (*storage),
+                mm_sms_part_get_index (sms_part));
+        mm_sms_part_free (sms_part);
+        return TRUE;
+    }
+
+    mm_sms_part_set_index (sms_part, SMS_PART_INVALID_INDEX);
+    *storage = MM_SMS_STORAGE_UNKNOWN;
+    return FALSE;
+}
+
+static void
+sms_store_remove_sms (MMIfaceModemMessaging *self,
+                      MMBaseSms *sms)
+{
+    SmsStoreContext *ctx;
+    GList *l;
+
+    ctx = peek_sms_store_context (self);
+    if (!ctx)
+        return;
+
+    for (l = mm_base_sms_get_parts (sms); l; l = g_list_next (l))
+        mm_sms_store_remove (ctx->store, (MMSmsPart *)l->data);
+}
+
 /*****************************************************************************/
 
 typedef struct {
@@ -147,6 +395,7 @@ typedef struct {
     GDBusMethodInvocation *invocation;
     MMIfaceModemMessaging *self;
     gchar *path;
+    MMBaseSms *sms;
 } HandleDeleteContext;
 
 static void
@@ -155,6 +404,8 @@ handle_delete_context_free (HandleDeleteContext *ctx)
     g_object_unref (ctx->skeleton);
     g_object_unref (ctx->invocation);
     g_object_unref (ctx->self);
+    if (ctx->sms)
+        g_object_unref (ctx->sms);
     g_free (ctx->path);
     g_free (ctx);
 }
@@ -168,8 +419,11 @@ handle_delete_ready (MMSmsList *list,
 
     if (!mm_sms_list_delete_sms_finish (list, res, &error))
         g_dbus_method_invocation_take_error (ctx->invocation, error);
-    else
+    else {
+        if (ctx->sms)
+            sms_store_remove_sms (ctx->self, ctx->sms);
         mm_gdbus_modem_messaging_complete_delete (ctx->skeleton, ctx->invocation);
+    }
 
     handle_delete_context_free (ctx);
 }
@@ -214,6 +468,11 @@ handle_delete_auth_ready (MMBaseModem *self,
         return;
     }
 
+    /* Keep the SMS around, its parts may need to be removed from the store */
+    ctx->sms = mm_sms_list_get_sms (list, ctx->path);
+    if (ctx->sms)
+        g_object_ref (ctx->sms);
+
     mm_sms_list_delete_sms (list,
                             ctx->path,
                             (GAsyncReadyCallback)handle_delete_ready,
@@ -229,7 +488,7 @@ handle_delete (MmGdbusModemMessaging *skeleton,
 {
     HandleDeleteContext *ctx;
 
-    ctx = g_new (HandleDeleteContext, 1);
+    ctx = g_new0 (HandleDeleteContext, 1);
     ctx->skeleton = g_object_ref (skeleton);
     ctx->invocation = g_object_ref (invocation);
     ctx->self = g_object_ref (self);
@@ -363,12 +622,144 @@ handle_create (MmGdbusModemMessaging *skeleton,
 
 /*****************************************************************************/
 
+typedef struct {
+    MmGdbusModemMessaging *skeleton;
+    GDBusMethodInvocation *invocation;
+    MMIfaceModemMessaging *self;
+    GStrv paths;
+} HandleSendBatchContext;
+
+static void
+handle_send_batch_context_free (HandleSendBatchContext *ctx)
+{
+    g_object_unref (ctx->skeleton);
+    g_object_unref (ctx->invocation);
+    g_object_unref (ctx->self);
+    g_strfreev (ctx->paths);
+    g_free (ctx);
+}
+
+static void
+handle_send_batch_ready (MMBaseModem *self,
+                         GAsyncResult *res,
+                         HandleSendBatchContext *ctx)
+{
+    GError *error = NULL;
+    GVariant *results = NULL;
+    GVariant *stats = NULL;
+
+    if (!mm_base_sms_send_batch_finish (self, res, &results, &stats, &error))
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+    else {
+        mm_gdbus_modem_messaging_complete_send_batch (ctx->skeleton,
+                                                      ctx->invocation,
+                                                      results,
+                                                      stats);
+        g_variant_unref (results);
+        g_variant_unref (stats);
+    }
+
+    handle_send_batch_context_free (ctx);
+}
+
+static void
+handle_send_batch_auth_ready (MMBaseModem *self,
+                              GAsyncResult *res,
+                              HandleSendBatchContext *ctx)
+{
+    MMModemState modem_state = MM_MODEM_STATE_UNKNOWN;
+    MMSmsList *list = NULL;
+    GError *error = NULL;
+    GList *sms_list = NULL;
+    guint i;
+
+    if (!mm_base_modem_authorize_finish (self, res, &error)) {
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+        handle_send_batch_context_free (ctx);
+        return;
+    }
+
+    g_object_get (self,
+                  MM_IFACE_MODEM_STATE, &modem_state,
+                  NULL);
+
+    if (modem_state < MM_MODEM_STATE_ENABLED) {
+        g_dbus_method_invocation_return_error (ctx->invocation,
+                                               MM_CORE_ERROR,
+                                               MM_CORE_ERROR_WRONG_STATE,
+                                               "Cannot send SMS: device not yet enabled");
+        handle_send_batch_context_free (ctx);
+        return;
+    }
+
+    g_object_get (self,
+                  MM_IFACE_MODEM_MESSAGING_SMS_LIST, &list,
+                  NULL);
+    if (!list) {
+        g_dbus_method_invocation_return_error (ctx->invocation,
+                                               MM_CORE_ERROR,
+                                               MM_CORE_ERROR_WRONG_STATE,
+                                               "Cannot send SMS: missing SMS list");
+        handle_send_batch_context_free (ctx);
+        return;
+    }
+
+    /* All given messages must exist before sending any of them */
+    for (i = 0; ctx->paths && ctx->paths[i]; i++) {
+        MMBaseSms *sms;
+
+        sms = mm_sms_list_get_sms (list, ctx->paths[i]);
+        if (!sms) {
+            g_dbus_method_invocation_return_error (ctx->invocation,
+                                                   MM_CORE_ERROR,
+                                                   MM_CORE_ERROR_INVALID_ARGS,
+                                                   "Cannot send SMS: no SMS found with path '%s'",
+                                                   ctx->paths[i]);
+            g_list_free (sms_list);
+            g_object_unref (list);
+            handle_send_batch_context_free (ctx);
+            return;
+        }
+        sms_list = g_list_prepend (sms_list, sms);
+    }
+    sms_list = g_list_reverse (sms_list);
+
+    mm_base_sms_send_batch (self,
+                            sms_list,
+                            (GAsyncReadyCallback)handle_send_batch_ready,
+                            ctx);
+    g_list_free (sms_list);
+    g_object_unref (list);
+}
+
 static gboolean
-handle_list (MmGdbusModemMessaging *skeleton,
-             GDBusMethodInvocation *invocation,
-             MMIfaceModemMessaging *self)
+handle_send_batch (MmGdbusModemMessaging *skeleton,
+                   GDBusMethodInvocation *invocation,
+                   const gchar *const *paths,
+                   MMIfaceModemMessaging *self)
+{
+    HandleSendBatchContext *ctx;
+
+    ctx = g_new (HandleSendBatchContext, 1);
+    ctx->skeleton = g_object_ref (skeleton);
+    ctx->invocation = g_object_ref (invocation);
+    ctx->self = g_object_ref (self);
+    ctx->paths = g_strdupv ((gchar **)paths);
+
+    mm_base_modem_authorize (MM_BASE_MODEM (self),
+                             invocation,
+                             MM_AUTHORIZATION_MESSAGING,
+                             (GAsyncReadyCallback)handle_send_batch_auth_ready,
+                             ctx);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+static MMSmsList *
+get_sms_list_for_listing (MMIfaceModemMessaging *self,
+                          GDBusMethodInvocation *invocation)
 {
-    GStrv paths;
     MMSmsList *list = NULL;
     MMModemState modem_state;
 
@@ -383,7 +774,7 @@ handle_list (MmGdbusModemMessaging *skeleton,
                                                MM_CORE_ERROR_WRONG_STATE,
                                                "Cannot list SMS messages: "
                                                "device not yet enabled");
-        return TRUE;
+        return NULL;
     }
 
     g_object_get (self,
@@ -394,10 +785,30 @@ handle_list (MmGdbusModemMessaging *skeleton,
                                                MM_CORE_ERROR,
                                                MM_CORE_ERROR_WRONG_STATE,
                                                "Cannot list SMS: missing SMS list");
-        return TRUE;
+        return NULL;
     }
 
-    paths = mm_sms_list_get_paths (list);
+    return list;
+}
+
+static gboolean
+handle_list (MmGdbusModemMessaging *skeleton,
+             GDBusMethodInvocation *invocation,
+             MMIfaceModemMessaging *self)
+{
+    GStrv paths;
+    MMSmsList *list;
+
+    list = get_sms_list_for_listing (self, invocation);
+    if (!list)
+        return TRUE;
+
+    /* Objects not yet exported get exported as they're listed */
+    paths = mm_sms_list_get_paths_page (list,
+                                        0, 0,
+                                        MM_SMS_LIST_FILTER_ANY,
+                                        MM_SMS_LIST_FILTER_ANY,
+                                        NULL);
     mm_gdbus_modem_messaging_complete_list (skeleton,
                                             invocation,
                                             (const gchar *const *)paths);
@@ -408,6 +819,68 @@ handle_list (MmGdbusModemMessaging *skeleton,
 
 /*****************************************************************************/
 
+static gboolean
+handle_list_page (MmGdbusModemMessaging *skeleton,
+                  GDBusMethodInvocation *invocation,
+                  GVariant *options,
+                  MMIfaceModemMessaging *self)
+{
+    GStrv paths;
+    MMSmsList *list;
+    GVariantIter iter;
+    gchar *key;
+    GVariant *value;
+    guint offset = 0;
+    guint limit = 0;
+    guint state = MM_SMS_LIST_FILTER_ANY;
+    guint storage = MM_SMS_LIST_FILTER_ANY;
+    guint total = 0;
+
+    g_variant_iter_init (&iter, options);
+    while (g_variant_iter_next (&iter, "{sv}", &key, &value)) {
+        guint *target = NULL;
+
+        if (g_str_equal (key, "offset"))
+            target = &offset;
+        else if (g_str_equal (key, "limit"))
+            target = &limit;
+        else if (g_str_equal (key, "state"))
+            target = &state;
+        else if (g_str_equal (key, "storage"))
+            target = &storage;
+
+        if (!target || !g_variant_is_of_type (value, G_VARIANT_TYPE_UINT32)) {
+            g_dbus_method_invocation_return_error (invocation,
+                                                   MM_CORE_ERROR,
+                                                   MM_CORE_ERROR_INVALID_ARGS,
+                                                   "Invalid list option: '%s'",
+                                                   key);
+            g_variant_unref (value);
+            g_free (key);
+            return TRUE;
+        }
+
+        *target = g_variant_get_uint32 (value);
+        g_variant_unref (value);
+        g_free (key);
+    }
+
+    list = get_sms_list_for_listing (self, invocation);
+    if (!list)
+        return TRUE;
+
+    paths = mm_sms_list_get_paths_page (list, offset, limit, state, storage, &total);
+    mm_gdbus_modem_messaging_complete_list_page (skeleton,
+                                                 invocation,
+                                                 (const gchar *const *)paths,
+                                                 total);
+    g_strfreev (paths);
+    g_object_unref (list);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
 gboolean
 mm_iface_modem_messaging_take_part (MMIfaceModemMessaging *self,
                                     MMSmsPart *sms_part,
@@ -424,6 +897,12 @@ mm_iface_modem_messaging_take_part (MMIfaceModemMessaging *self,
     if (!list)
         return FALSE;
 
+    /* When using the daemon-side store, the part may be moved there */
+    if (sms_store_take_part (self, sms_part, state, &storage)) {
+        g_object_unref (list);
+        return TRUE;
+    }
+
     added = mm_sms_list_take_part (list, sms_part, state, storage, &error);
     if (!added) {
         mm_dbg ("Couldn't take part in SMS list: '%s'", error->message);
@@ -489,15 +968,60 @@ mm_iface_modem_messaging_is_storage_supported_for_receiving (MMIfaceModemMessagi
 
 /*****************************************************************************/
 
+typedef struct {
+    MmGdbusModemMessaging *skeleton;
+    MMSmsList *list;
+    guint id;
+} UpdateListContext;
+
 static void
-update_message_list (MmGdbusModemMessaging *skeleton,
-                     MMSmsList *list)
+update_list_context_free (UpdateListContext *ctx)
+{
+    if (ctx->id)
+        g_source_remove (ctx->id);
+    g_object_unref (ctx->list);
+    g_free (ctx);
+}
+
+static gboolean
+update_message_list_idle (UpdateListContext *ctx)
 {
     gchar **paths;
 
-    paths = mm_sms_list_get_paths (list);
-    mm_gdbus_modem_messaging_set_messages (skeleton, (const gchar *const *)paths);
+    paths = mm_sms_list_get_paths (ctx->list);
+    mm_gdbus_modem_messaging_set_messages (ctx->skeleton, (const gchar *const *)paths);
     g_strfreev (paths);
+
+    /* Removing the qdata disposes the context */
+    ctx->id = 0;
+    g_object_set_qdata (G_OBJECT (ctx->skeleton), update_list_quark, NULL);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+update_message_list (MmGdbusModemMessaging *skeleton,
+                     MMSmsList *list)
+{
+    UpdateListContext *ctx;
+
+    if (G_UNLIKELY (!update_list_quark))
+        update_list_quark = (g_quark_from_static_string (
+                                 UPDATE_LIST_TAG));
+
+    /* Bursts of additions or removals (e.g. when loading the initial list
+     * of parts) end up in a single update of the Messages property */
+    ctx = g_object_get_qdata (G_OBJECT (skeleton), update_list_quark);
+    if (ctx && ctx->list == list)
+        return;
+
+    ctx = g_new0 (UpdateListContext, 1);
+    ctx->skeleton = skeleton;
+    ctx->list = g_object_ref (list);
+    ctx->id = g_idle_add ((GSourceFunc)update_message_list_idle, ctx);
+    g_object_set_qdata_full (G_OBJECT (skeleton),
+                             update_list_quark,
+                             ctx,
+                             (GDestroyNotify)update_list_context_free);
 }
 
 static void
@@ -701,11 +1225,19 @@ struct _EnablingContext {
     EnablingStep step;
     MmGdbusModemMessaging *skeleton;
     guint mem1_storage_index;
+    /* Set while messages loaded are only exported on demand */
+    MMSmsList *lazy_list;
 };
 
 static void
 enabling_context_free (EnablingContext *ctx)
 {
+    /* Messages received from now on are exported right away, also if
+     * enabling failed */
+    if (ctx->lazy_list) {
+        mm_sms_list_set_lazy_export (ctx->lazy_list, FALSE);
+        g_object_unref (ctx->lazy_list);
+    }
     if (ctx->skeleton)
         g_object_unref (ctx->skeleton);
     g_free (ctx);
@@ -930,6 +1462,14 @@ interface_enabling_step (GTask *task)
                           G_CALLBACK (sms_deleted),
                           ctx->skeleton);
 
+        /* Messages loaded while enabling are only exported in DBus once
+         * requested */
+        mm_sms_list_set_lazy_export (list, TRUE);
+        ctx->lazy_list = g_object_ref (list);
+
+        /* Export the messages kept in the daemon-side store, if any */
+        sms_store_load (self, list);
+
         g_object_unref (list);
 
         /* Fall down to next step */
@@ -1335,6 +1875,14 @@ interface_initialization_step (GTask *task)
                           "handle-list",
                           G_CALLBACK (handle_list),
                           self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-list-page",
+                          G_CALLBACK (handle_list_page),
+                          self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-send-batch",
+                          G_CALLBACK (handle_send_batch),
+                          self);
 
         /* Finally, export the new interface */
         mm_gdbus_object_skeleton_set_modem_messaging (MM_GDBUS_OBJECT_SKELETON (self),
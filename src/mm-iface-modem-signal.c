@@ -13,21 +13,30 @@
  * Copyright (C) 2013 Aleksander Morgado <aleksander@gnu.org>
  */
 
+#include <string.h>
+
 #include <ModemManager.h>
 #define _LIBMM_INSIDE_MM
 #include <libmm-glib.h>
 
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-signal.h"
+#include "mm-base-modem.h"
+#include "mm-modem-helpers.h"
+#include "mm-signal-history.h"
 #include "mm-log.h"
 
 #define SUPPORT_CHECKED_TAG "signal-support-checked-tag"
 #define SUPPORTED_TAG       "signal-supported-tag"
 #define REFRESH_CONTEXT_TAG "signal-refresh-context-tag"
+#define HISTORY_TAG         "signal-history-tag"
+#define REPORT_CONTEXT_TAG  "signal-report-context-tag"
 
 static GQuark support_checked_quark;
 static GQuark supported_quark;
 static GQuark refresh_context_quark;
+static GQuark history_quark;
+static GQuark report_context_quark;
 
 /*****************************************************************************/
 
@@ -39,6 +48,152 @@ mm_iface_modem_signal_bind_simple_status (MMIfaceModemSignal *self,
 
 /*****************************************************************************/
 
+static MMSignalHistory *
+peek_history (MMIfaceModemSignal *self)
+{
+    MMSignalHistory *history;
+
+    if (G_UNLIKELY (!history_quark))
+        history_quark = g_quark_from_static_string (HISTORY_TAG);
+
+    history = g_object_get_qdata (G_OBJECT (self), history_quark);
+    if (!history) {
+        history = mm_signal_history_new (MM_SIGNAL_HISTORY_DEFAULT_SIZE);
+        g_object_set_qdata_full (G_OBJECT (self),
+                                 history_quark,
+                                 history,
+                                 (GDestroyNotify)mm_signal_history_free);
+    }
+    return history;
+}
+
+static void
+history_add (MMIfaceModemSignal *self,
+             guint64 timestamp,
+             MMModemAccessTechnology access_technology,
+             MMSignal *signal)
+{
+    if (signal)
+        mm_signal_history_add (peek_history (self), timestamp, access_technology, signal);
+}
+
+/*****************************************************************************/
+/* Hysteresis applied before publishing new values */
+
+typedef enum {
+    SIGNAL_TECH_CDMA,
+    SIGNAL_TECH_EVDO,
+    SIGNAL_TECH_GSM,
+    SIGNAL_TECH_UMTS,
+    SIGNAL_TECH_LTE,
+    SIGNAL_TECH_LAST
+} SignalTech;
+
+typedef enum {
+    THRESHOLD_RSSI,
+    THRESHOLD_RSRP,
+    THRESHOLD_RSRQ,
+    THRESHOLD_SNR,
+    THRESHOLD_ECIO,
+    THRESHOLD_LAST
+} Threshold;
+
+static const gchar *threshold_keys[THRESHOLD_LAST] = {
+    [THRESHOLD_RSSI] = "rssi-threshold",
+    [THRESHOLD_RSRP] = "rsrp-threshold",
+    [THRESHOLD_RSRQ] = "rsrq-threshold",
+    [THRESHOLD_SNR]  = "snr-threshold",
+    [THRESHOLD_ECIO] = "ecio-threshold",
+};
+
+typedef struct {
+    /* Minimum change, in dB, to publish new values; 0 for any change */
+    guint thresholds[THRESHOLD_LAST];
+    /* Values last published */
+    MMSignal *published[SIGNAL_TECH_LAST];
+} ReportContext;
+
+static void
+report_context_free (ReportContext *ctx)
+{
+    guint i;
+
+    for (i = 0; i < SIGNAL_TECH_LAST; i++)
+        g_clear_object (&ctx->published[i]);
+    g_slice_free (ReportContext, ctx);
+}
+
+static ReportContext *
+peek_report_context (MMIfaceModemSignal *self)
+{
+    ReportContext *ctx;
+
+    if (G_UNLIKELY (!report_context_quark))
+        report_context_quark = g_quark_from_static_string (REPORT_CONTEXT_TAG);
+
+    ctx = g_object_get_qdata (G_OBJECT (self), report_context_quark);
+    if (!ctx) {
+        ctx = g_slice_new0 (ReportContext);
+        g_object_set_qdata_full (G_OBJECT (self),
+                                 report_context_quark,
+                                 ctx,
+                                 (GDestroyNotify)report_context_free);
+    }
+    return ctx;
+}
+
+static void
+publish_values (MMIfaceModemSignal *self,
+                MmGdbusModemSignal *skeleton,
+                SignalTech tech,
+                MMSignal *signal)
+{
+    ReportContext *ctx;
+    GVariant *dictionary;
+
+    if (!signal)
+        return;
+
+    ctx = peek_report_context (self);
+    if (ctx->published[tech] &&
+        !mm_signal_changed_over_thresholds (ctx->published[tech],
+                                            signal,
+                                            ctx->thresholds[THRESHOLD_RSSI],
+                                            ctx->thresholds[THRESHOLD_RSRP],
+                                            ctx->thresholds[THRESHOLD_RSRQ],
+                                            ctx->thresholds[THRESHOLD_SNR],
+                                            ctx->thresholds[THRESHOLD_ECIO]))
+        return;
+
+    dictionary = mm_signal_get_dictionary (signal);
+    switch (tech) {
+    case SIGNAL_TECH_CDMA:
+        mm_gdbus_modem_signal_set_cdma (skeleton, dictionary);
+        break;
+    case SIGNAL_TECH_EVDO:
+        mm_gdbus_modem_signal_set_evdo (skeleton, dictionary);
+        break;
+    case SIGNAL_TECH_GSM:
+        mm_gdbus_modem_signal_set_gsm (skeleton, dictionary);
+        break;
+    case SIGNAL_TECH_UMTS:
+        mm_gdbus_modem_signal_set_umts (skeleton, dictionary);
+        break;
+    case SIGNAL_TECH_LTE:
+        mm_gdbus_modem_signal_set_lte (skeleton, dictionary);
+        break;
+    default:
+        g_assert_not_reached ();
+    }
+    g_variant_unref (dictionary);
+
+    if (ctx->published[tech])
+        g_object_unref (ctx->published[tech]);
+    ctx->published[tech] = g_object_ref (signal);
+}
+
+/*****************************************************************************/
+
 typedef struct {
     guint rate;
     guint timeout_source;
@@ -56,6 +211,13 @@ static void
 clear_values (MMIfaceModemSignal *self)
 {
     MmGdbusModemSignal *skeleton;
+    ReportContext *report_ctx;
+    guint i;
+
+    /* Whatever comes next gets published */
+    report_ctx = peek_report_context (self);
+    for (i = 0; i < SIGNAL_TECH_LAST; i++)
+        g_clear_object (&report_ctx->published[i]);
 
     g_object_get (self,
                   MM_IFACE_MODEM_SIGNAL_DBUS_SKELETON, &skeleton,
@@ -75,7 +237,6 @@ static void
 load_values_ready (MMIfaceModemSignal *self,
                    GAsyncResult *res)
 {
-    GVariant *dictionary;
     GError *error = NULL;
     MMSignal *cdma = NULL;
     MMSignal *evdo = NULL;
@@ -83,6 +244,7 @@ load_values_ready (MMIfaceModemSignal *self,
     MMSignal *umts = NULL;
     MMSignal *lte = NULL;
     MmGdbusModemSignal *skeleton;
+    guint64 timestamp;
 
     if (!MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->load_values_finish (
             self,
@@ -99,52 +261,47 @@ load_values_ready (MMIfaceModemSignal *self,
         return;
     }
 
+    /* Keep the samples, one per access technology reported */
+    timestamp = (guint64)(g_get_real_time () / 1000);
+    history_add (self, timestamp, MM_MODEM_ACCESS_TECHNOLOGY_1XRTT, cdma);
+    history_add (self, timestamp, (MM_MODEM_ACCESS_TECHNOLOGY_EVDO0 |
+                                   MM_MODEM_ACCESS_TECHNOLOGY_EVDOA |
+                                   MM_MODEM_ACCESS_TECHNOLOGY_EVDOB), evdo);
+    history_add (self, timestamp, MM_MODEM_ACCESS_TECHNOLOGY_GSM, gsm);
+    history_add (self, timestamp, MM_MODEM_ACCESS_TECHNOLOGY_UMTS, umts);
+    history_add (self, timestamp, MM_MODEM_ACCESS_TECHNOLOGY_LTE, lte);
+
     g_object_get (self,
                   MM_IFACE_MODEM_SIGNAL_DBUS_SKELETON, &skeleton,
                   NULL);
     if (!skeleton) {
         mm_warn ("Cannot update extended signal information: "
                  "Couldn't get interface skeleton");
+        g_clear_object (&cdma);
+        g_clear_object (&evdo);
+        g_clear_object (&gsm);
+        g_clear_object (&umts);
+        g_clear_object (&lte);
         return;
     }
 
-    if (cdma) {
-        dictionary = mm_signal_get_dictionary (cdma);
-        mm_gdbus_modem_signal_set_cdma (skeleton, dictionary);
-        g_variant_unref (dictionary);
-        g_object_unref (cdma);
-    }
-
-    if (evdo) {
-        dictionary = mm_signal_get_dictionary (evdo);
-        mm_gdbus_modem_signal_set_evdo (skeleton, dictionary);
-        g_variant_unref (dictionary);
-        g_object_unref (evdo);
-    }
-
-    if (gsm) {
-        dictionary = mm_signal_get_dictionary (gsm);
-        mm_gdbus_modem_signal_set_gsm (skeleton, dictionary);
-        g_variant_unref (dictionary);
-        g_object_unref (gsm);
-    }
-
-    if (umts) {
-        dictionary = mm_signal_get_dictionary (umts);
-        mm_gdbus_modem_signal_set_umts (skeleton, dictionary);
-        g_variant_unref (dictionary);
-        g_object_unref (umts);
-    }
-
-    if (lte) {
-        dictionary = mm_signal_get_dictionary (lte);
-        mm_gdbus_modem_signal_set_lte (skeleton, dictionary);
-        g_variant_unref (dictionary);
-        g_object_unref (lte);
-    }
+    /* Only values that changed beyond the configured thresholds, all of
+     * them notified at once */
+    mm_base_modem_begin_property_updates (MM_BASE_MODEM (self));
+    publish_values (self, skeleton, SIGNAL_TECH_CDMA, cdma);
+    publish_values (self, skeleton, SIGNAL_TECH_EVDO, evdo);
+    publish_values (self, skeleton, SIGNAL_TECH_GSM,  gsm);
+    publish_values (self, skeleton, SIGNAL_TECH_UMTS, umts);
+    publish_values (self, skeleton, SIGNAL_TECH_LTE,  lte);
+    g_clear_object (&cdma);
+    g_clear_object (&evdo);
+    g_clear_object (&gsm);
+    g_clear_object (&umts);
+    g_clear_object (&lte);
 
     /* Flush right away */
     g_dbus_interface_skeleton_flush (G_DBUS_INTERFACE_SKELETON (skeleton));
+    mm_base_modem_end_property_updates (MM_BASE_MODEM (self));
 
     g_object_unref (skeleton);
 }
@@ -301,6 +458,207 @@ handle_setup (MmGdbusModemSignal *skeleton,
 
 /*****************************************************************************/
 
+typedef struct {
+    GDBusMethodInvocation *invocation;
+    MmGdbusModemSignal *skeleton;
+    MMIfaceModemSignal *self;
+    guint64 since;
+} HandleGetHistoryContext;
+
+static void
+handle_get_history_context_free (HandleGetHistoryContext *ctx)
+{
+    g_object_unref (ctx->invocation);
+    g_object_unref (ctx->skeleton);
+    g_object_unref (ctx->self);
+    g_slice_free (HandleGetHistoryContext, ctx);
+}
+
+static void
+handle_get_history_auth_ready (MMBaseModem *self,
+                               GAsyncResult *res,
+                               HandleGetHistoryContext *ctx)
+{
+    GError *error = NULL;
+
+    if (!mm_base_modem_authorize_finish (self, res, &error))
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+    else
+        mm_gdbus_modem_signal_complete_get_history (
+            ctx->skeleton,
+            ctx->invocation,
+            mm_signal_history_get_samples (peek_history (ctx->self), ctx->since));
+    handle_get_history_context_free (ctx);
+}
+
+static gboolean
+handle_get_history (MmGdbusModemSignal *skeleton,
+                    GDBusMethodInvocation *invocation,
+                    guint64 since,
+                    MMIfaceModemSignal *self)
+{
+    HandleGetHistoryContext *ctx;
+
+    ctx = g_slice_new (HandleGetHistoryContext);
+    ctx->invocation = g_object_ref (invocation);
+    ctx->skeleton = g_object_ref (skeleton);
+    ctx->self = g_object_ref (self);
+    ctx->since = since;
+
+    mm_base_modem_authorize (MM_BASE_MODEM (self),
+                             invocation,
+                             MM_AUTHORIZATION_DEVICE_CONTROL,
+                             (GAsyncReadyCallback)handle_get_history_auth_ready,
+                             ctx);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    GDBusMethodInvocation *invocation;
+    MmGdbusModemSignal *skeleton;
+    MMIfaceModemSignal *self;
+    GVariant *settings;
+    guint thresholds[THRESHOLD_LAST];
+} HandleSetupThresholdsContext;
+
+static void
+handle_setup_thresholds_context_free (HandleSetupThresholdsContext *ctx)
+{
+    g_object_unref (ctx->invocation);
+    g_object_unref (ctx->skeleton);
+    g_object_unref (ctx->self);
+    g_variant_unref (ctx->settings);
+    g_slice_free (HandleSetupThresholdsContext, ctx);
+}
+
+static gboolean
+parse_thresholds (GVariant *settings,
+                  guint *thresholds,
+                  GError **error)
+{
+    GVariantIter iter;
+    const gchar *key;
+    GVariant *value;
+
+    g_variant_iter_init (&iter, settings);
+    while (g_variant_iter_next (&iter, "{&sv}", &key, &value)) {
+        guint i;
+
+        for (i = 0; i < THRESHOLD_LAST; i++) {
+            if (g_str_equal (key, threshold_keys[i]))
+                break;
+        }
+
+        if (i == THRESHOLD_LAST || !g_variant_is_of_type (value, G_VARIANT_TYPE_UINT32)) {
+            g_set_error (error,
+                         MM_CORE_ERROR,
+                         MM_CORE_ERROR_INVALID_ARGS,
+                         "Invalid threshold setting: '%s'",
+                         key);
+            g_variant_unref (value);
+            return FALSE;
+        }
+
+        thresholds[i] = g_variant_get_uint32 (value);
+        g_variant_unref (value);
+    }
+
+    return TRUE;
+}
+
+static void
+handle_setup_thresholds_complete (HandleSetupThresholdsContext *ctx)
+{
+    ReportContext *report_ctx;
+
+    report_ctx = peek_report_context (ctx->self);
+    memcpy (report_ctx->thresholds, ctx->thresholds, sizeof (ctx->thresholds));
+    mm_dbg ("Extended signal information thresholds updated (rssi: %u, rsrp: %u, rsrq: %u, snr: %u, ecio: %u)",
+            ctx->thresholds[THRESHOLD_RSSI],
+            ctx->thresholds[THRESHOLD_RSRP],
+            ctx->thresholds[THRESHOLD_RSRQ],
+            ctx->thresholds[THRESHOLD_SNR],
+            ctx->thresholds[THRESHOLD_ECIO]);
+
+    mm_gdbus_modem_signal_complete_setup_thresholds (ctx->skeleton, ctx->invocation);
+    handle_setup_thresholds_context_free (ctx);
+}
+
+static void
+setup_thresholds_ready (MMIfaceModemSignal *self,
+                        GAsyncResult *res,
+                        HandleSetupThresholdsContext *ctx)
+{
+    GError *error = NULL;
+
+    if (!MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->setup_thresholds_finish (self, res, &error)) {
+        /* The daemon-side thresholds still apply */
+        if (!g_error_matches (error, MM_CORE_ERROR, MM_CORE_ERROR_UNSUPPORTED)) {
+            g_dbus_method_invocation_take_error (ctx->invocation, error);
+            handle_setup_thresholds_context_free (ctx);
+            return;
+        }
+        mm_dbg ("Couldn't setup signal thresholds in the modem: '%s'", error->message);
+        g_error_free (error);
+    }
+
+    handle_setup_thresholds_complete (ctx);
+}
+
+static void
+handle_setup_thresholds_auth_ready (MMBaseModem *self,
+                                    GAsyncResult *res,
+                                    HandleSetupThresholdsContext *ctx)
+{
+    GError *error = NULL;
+
+    if (!mm_base_modem_authorize_finish (self, res, &error) ||
+        !parse_thresholds (ctx->settings, ctx->thresholds, &error)) {
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+        handle_setup_thresholds_context_free (ctx);
+        return;
+    }
+
+    /* Let the modem report changes on its own if it can */
+    if (MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (ctx->self)->setup_thresholds &&
+        MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (ctx->self)->setup_thresholds_finish) {
+        MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (ctx->self)->setup_thresholds (
+            ctx->self,
+            ctx->thresholds[THRESHOLD_RSSI],
+            (GAsyncReadyCallback)setup_thresholds_ready,
+            ctx);
+        return;
+    }
+
+    handle_setup_thresholds_complete (ctx);
+}
+
+static gboolean
+handle_setup_thresholds (MmGdbusModemSignal *skeleton,
+                         GDBusMethodInvocation *invocation,
+                         GVariant *settings,
+                         MMIfaceModemSignal *self)
+{
+    HandleSetupThresholdsContext *ctx;
+
+    ctx = g_slice_new0 (HandleSetupThresholdsContext);
+    ctx->invocation = g_object_ref (invocation);
+    ctx->skeleton = g_object_ref (skeleton);
+    ctx->self = g_object_ref (self);
+    ctx->settings = g_variant_ref (settings);
+
+    mm_base_modem_authorize (MM_BASE_MODEM (self),
+                             invocation,
+                             MM_AUTHORIZATION_DEVICE_CONTROL,
+                             (GAsyncReadyCallback)handle_setup_thresholds_auth_ready,
+                             ctx);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
 gboolean
 mm_iface_modem_signal_disable_finish (MMIfaceModemSignal *self,
                                       GAsyncResult *res,
@@ -487,6 +845,14 @@ interface_initialization_step (GTask *task)
                           "handle-setup",
                           G_CALLBACK (handle_setup),
                           self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-get-history",
+                          G_CALLBACK (handle_get_history),
+                          self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-setup-thresholds",
+                          G_CALLBACK (handle_setup_thresholds),
+                          self);
         /* Finally, export the new interface */
         mm_gdbus_object_skeleton_set_modem_signal (MM_GDBUS_OBJECT_SKELETON (self),
                                                    MM_GDBUS_MODEM_SIGNAL (ctx->skeleton));
@@ -55,6 +55,16 @@ struct _MMIfaceModemSignal {
                                      MMSignal **umts,
                                      MMSignal **lte,
                                      GError **error);
+
+    /* Setup the RSSI change, in dB, that makes the modem report signal
+     * quality indications; 0 for the modem default (async) */
+    void     (* setup_thresholds)        (MMIfaceModemSignal *self,
+                                          guint rssi_threshold,
+                                          GAsyncReadyCallback callback,
+                                          gpointer user_data);
+    gboolean (* setup_thresholds_finish) (MMIfaceModemSignal *self,
+                                          GAsyncResult *res,
+                                          GError **error);
 };
 
 GType mm_iface_modem_signal_get_type (void);
@@ -19,18 +19,24 @@
 
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-time.h"
+#include "mm-base-modem.h"
 #include "mm-log.h"
 
 #define SUPPORT_CHECKED_TAG              "time-support-checked-tag"
 #define SUPPORTED_TAG                    "time-supported-tag"
 #define NETWORK_TIMEZONE_CANCELLABLE_TAG "time-network-timezone-cancellable"
+#define NETWORK_TIME_TAG                 "time-network-time-tag"
 
 static GQuark support_checked_quark;
 static GQuark supported_quark;
 static GQuark network_timezone_cancellable_quark;
+static GQuark network_time_quark;
 
-#define TIMEZONE_POLL_INTERVAL_SEC 5
-#define TIMEZONE_POLL_RETRIES 6
+/* Timezone polling is just a fallback for when the modem doesn't report
+ * timezone changes on its own, so back off and give up soon */
+#define TIMEZONE_POLL_INTERVAL_SEC     5
+#define TIMEZONE_POLL_INTERVAL_MAX_SEC 60
+#define TIMEZONE_POLL_RETRIES          6
 
 /*****************************************************************************/
 
@@ -129,6 +135,7 @@ typedef struct {
     gulong state_changed_id;
     guint network_timezone_poll_id;
     guint network_timezone_poll_retries;
+    guint network_timezone_poll_interval;
 } UpdateNetworkTimezoneContext;
 
 static gboolean timezone_poll_cb (GTask *task);
@@ -158,7 +165,7 @@ cancelled (GCancellable *cancellable,
 
     /* If waiting in the timeout loop, remove the timeout */
     else if (ctx->network_timezone_poll_id)
-        g_source_remove (ctx->network_timezone_poll_id);
+        mm_base_modem_poll_remove (MM_BASE_MODEM (self), ctx->network_timezone_poll_id);
 
     g_task_return_new_error (task,
                              MM_CORE_ERROR,
@@ -173,6 +180,7 @@ update_network_timezone_dictionary (MMIfaceModemTime *self,
 {
     MmGdbusModemTime *skeleton = NULL;
     GVariant *dictionary;
+    GVariant *current;
 
     g_object_get (self,
                   MM_IFACE_MODEM_TIME_DBUS_SKELETON, &skeleton,
@@ -180,8 +188,11 @@ update_network_timezone_dictionary (MMIfaceModemTime *self,
     if (!skeleton)
         return;
 
+    /* Only update the property if the timezone really changed */
     dictionary = mm_network_timezone_get_dictionary (tz);
-    mm_gdbus_modem_time_set_network_timezone (skeleton, dictionary);
+    current = mm_gdbus_modem_time_get_network_timezone (skeleton);
+    if (!dictionary || !current || !g_variant_equal (dictionary, current))
+        mm_gdbus_modem_time_set_network_timezone (skeleton, dictionary);
     if (dictionary)
         g_variant_unref (dictionary);
 
@@ -217,6 +228,9 @@ load_network_timezone_ready (MMIfaceModemTime *self,
             !g_error_matches (error,
                               MM_CORE_ERROR,
                               MM_CORE_ERROR_RETRY)) {
+            if (ctx->network_timezone_poll_retries == 0)
+                mm_dbg ("Network timezone not available after %u retries, giving up",
+                        TIMEZONE_POLL_RETRIES);
             g_task_return_error (task, error);
             g_object_unref (task);
             return;
@@ -228,9 +242,13 @@ load_network_timezone_ready (MMIfaceModemTime *self,
                                                    G_CALLBACK (cancelled),
                                                    task,
                                                    NULL);
-        ctx->network_timezone_poll_id = g_timeout_add_seconds (TIMEZONE_POLL_INTERVAL_SEC,
-                                                               (GSourceFunc)timezone_poll_cb,
-                                                               task);
+        ctx->network_timezone_poll_interval = MIN (ctx->network_timezone_poll_interval * 2,
+                                                   TIMEZONE_POLL_INTERVAL_MAX_SEC);
+        ctx->network_timezone_poll_id = mm_base_modem_poll_add (MM_BASE_MODEM (self),
+                                                                MM_BASE_MODEM_POLL_TIMEZONE,
+                                                                ctx->network_timezone_poll_interval,
+                                                                (GSourceFunc)timezone_poll_cb,
+                                                                task);
 
         g_error_free (error);
         return;
@@ -280,9 +298,12 @@ start_timezone_poll (GTask *task)
     /* Setup loop to query current timezone, don't do it right away.
      * Note that we're passing the context reference to the loop. */
     ctx->network_timezone_poll_retries = TIMEZONE_POLL_RETRIES;
-    ctx->network_timezone_poll_id = g_timeout_add_seconds (TIMEZONE_POLL_INTERVAL_SEC,
-                                                           (GSourceFunc)timezone_poll_cb,
-                                                           task);
+    ctx->network_timezone_poll_interval = TIMEZONE_POLL_INTERVAL_SEC;
+    ctx->network_timezone_poll_id = mm_base_modem_poll_add (MM_BASE_MODEM (g_task_get_source_object (task)),
+                                                            MM_BASE_MODEM_POLL_TIMEZONE,
+                                                            ctx->network_timezone_poll_interval,
+                                                            (GSourceFunc)timezone_poll_cb,
+                                                            task);
 }
 
 static void
@@ -374,18 +395,48 @@ mm_iface_modem_time_update_network_time (MMIfaceModemTime *self,
 {
     MmGdbusModemTime *skeleton;
 
+    if (G_UNLIKELY (!network_time_quark))
+        network_time_quark = g_quark_from_static_string (NETWORK_TIME_TAG);
+
+    /* Don't notify the same time twice */
+    if (!g_strcmp0 (network_time, g_object_get_qdata (G_OBJECT (self), network_time_quark)))
+        return;
+
     g_object_get (self,
                   MM_IFACE_MODEM_TIME_DBUS_SKELETON, &skeleton,
                   NULL);
     if (!skeleton)
         return;
 
+    g_object_set_qdata_full (G_OBJECT (self),
+                             network_time_quark,
+                             g_strdup (network_time),
+                             g_free);
+
     /* Notify about the updated network time */
     mm_gdbus_modem_time_emit_network_time_changed (skeleton, network_time);
 
     g_object_unref (skeleton);
 }
 
+void
+mm_iface_modem_time_update_network_timezone (MMIfaceModemTime *self,
+                                             MMNetworkTimezone *tz)
+{
+    GCancellable *cancellable = NULL;
+
+    /* The modem reports timezone changes on its own, so stop polling */
+    if (G_LIKELY (network_timezone_cancellable_quark))
+        cancellable = g_object_get_qdata (G_OBJECT (self), network_timezone_cancellable_quark);
+    if (cancellable) {
+        mm_dbg ("Network timezone reported by the modem, stopping polling");
+        g_cancellable_cancel (cancellable);
+        g_object_set_qdata (G_OBJECT (self), network_timezone_cancellable_quark, NULL);
+    }
+
+    update_network_timezone_dictionary (self, tz);
+}
+
 /*****************************************************************************/
 
 typedef struct _DisablingContext DisablingContext;
@@ -492,6 +543,10 @@ interface_disabling_step (GTask *task)
             }
         }
 
+        /* Notify the network time again once re-enabled */
+        if (G_LIKELY (network_time_quark))
+            g_object_set_qdata (G_OBJECT (self), network_time_quark, NULL);
+
         /* Fall down to next step */
         ctx->step++;
     }
@@ -133,4 +133,9 @@ void mm_iface_modem_time_bind_simple_status (MMIfaceModemTime *self,
 void mm_iface_modem_time_update_network_time (MMIfaceModemTime *self,
                                               const gchar *network_time);
 
+/* Implementations of the unsolicited events handling should call this method
+ * to notify about the updated timezone; polling for it is stopped then */
+void mm_iface_modem_time_update_network_timezone (MMIfaceModemTime *self,
+                                                  MMNetworkTimezone *tz);
+
 #endif /* MM_IFACE_MODEM_TIME_H */
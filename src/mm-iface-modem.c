@@ -24,16 +24,21 @@
 #include "mm-iface-modem-cdma.h"
 #include "mm-base-modem.h"
 #include "mm-base-modem-at.h"
+#include "mm-broadband-modem.h"
 #include "mm-base-sim.h"
 #include "mm-bearer-list.h"
 #include "mm-log.h"
 #include "mm-context.h"
+#include "mm-identity-cache.h"
 
 #define SIGNAL_QUALITY_RECENT_TIMEOUT_SEC 60
 
 #define SIGNAL_CHECK_INITIAL_RETRIES      5
 #define SIGNAL_CHECK_INITIAL_TIMEOUT_SEC  3
 #define SIGNAL_CHECK_TIMEOUT_SEC          30
+/* Signal quality polling interval when the modem reports signal changes on
+ * its own */
+#define SIGNAL_CHECK_SAFETY_NET_TIMEOUT_SEC 300
 
 #define STATE_UPDATE_CONTEXT_TAG          "state-update-context-tag"
 #define SIGNAL_QUALITY_UPDATE_CONTEXT_TAG "signal-quality-update-context-tag"
@@ -929,6 +934,9 @@ mm_iface_modem_update_access_technologies (MMIfaceModem *self,
     if (!skeleton)
         return;
 
+    /* Notified together with whatever else changes along */
+    mm_base_modem_begin_property_updates (MM_BASE_MODEM (self));
+
     old_access_tech = mm_gdbus_modem_get_access_technologies (skeleton);
 
     /* Build the new access tech */
@@ -953,6 +961,7 @@ mm_iface_modem_update_access_technologies (MMIfaceModem *self,
         g_free (new_access_tech_string);
     }
 
+    mm_base_modem_end_property_updates (MM_BASE_MODEM (self));
     g_object_unref (skeleton);
 }
 
@@ -1011,6 +1020,8 @@ expire_signal_quality (MMIfaceModem *self)
     return G_SOURCE_REMOVE;
 }
 
+static guint signal_quality_recent_timeout (MMIfaceModem *self);
+
 static void
 update_signal_quality (MMIfaceModem *self,
                        guint signal_quality,
@@ -1043,6 +1054,9 @@ update_signal_quality (MMIfaceModem *self,
             (GDestroyNotify)signal_quality_update_context_free);
     }
 
+    /* Notified together with whatever else changes along */
+    mm_base_modem_begin_property_updates (MM_BASE_MODEM (self));
+
     /* Note: we always set the new value, even if the signal quality level
      * is the same, in order to provide an up to date 'recent' flag.
      * The only exception being if 'expire' is FALSE; in that case we assume
@@ -1067,10 +1081,11 @@ update_signal_quality (MMIfaceModem *self,
     /* If we got a new expirable value, setup new timeout */
     if (expire)
         ctx->recent_timeout_source = (g_timeout_add_seconds (
-                                          SIGNAL_QUALITY_RECENT_TIMEOUT_SEC,
+                                          signal_quality_recent_timeout (self),
                                           (GSourceFunc)expire_signal_quality,
                                           self));
 
+    mm_base_modem_end_property_updates (MM_BASE_MODEM (self));
     g_object_unref (skeleton);
 }
 
@@ -1093,10 +1108,11 @@ typedef enum {
 } SignalCheckStep;
 
 typedef struct {
-    gboolean enabled;
-    guint    interval;
-    guint    initial_retries;
-    guint    timeout_source;
+    MMIfaceModem *self;
+    gboolean      enabled;
+    guint         interval;
+    guint         initial_retries;
+    guint         timeout_source;
 
     /* Values polled in this iteration */
     guint                   signal_quality;
@@ -1107,6 +1123,12 @@ typedef struct {
     gboolean signal_quality_polling_supported;
     gboolean access_technology_polling_supported;
 
+    /* Whether the modem reports signal changes via indications, in which
+     * case polling signal quality is just a safety net */
+    gboolean indications_enabled;
+    /* Monotonic time of the last signal quality polled */
+    gint64 signal_quality_polled_time;
+
     /* Steps triggered when polling active */
     SignalCheckStep running_step;
 } SignalCheckContext;
@@ -1115,7 +1137,7 @@ static void
 signal_check_context_free (SignalCheckContext *ctx)
 {
     if (ctx->timeout_source)
-        g_source_remove (ctx->timeout_source);
+        mm_base_modem_poll_remove (MM_BASE_MODEM (ctx->self), ctx->timeout_source);
     g_slice_free (SignalCheckContext, ctx);
 }
 
@@ -1132,6 +1154,7 @@ get_signal_check_context (MMIfaceModem *self)
     if (!ctx) {
         /* Create context and attach it to the object */
         ctx = g_slice_new0 (SignalCheckContext);
+        ctx->self = self;
         ctx->running_step = SIGNAL_CHECK_STEP_NONE;
 
         /* Initially assume supported if load_access_technologies() is
@@ -1154,9 +1177,72 @@ get_signal_check_context (MMIfaceModem *self)
     return ctx;
 }
 
+static gboolean periodic_signal_check_cb (MMIfaceModem *self);
+
+static guint
+signal_check_default_interval (SignalCheckContext *ctx)
+{
+    /* Signal quality indications don't tell about access technology changes,
+     * so keep on polling for those at the default rate */
+    if (ctx->indications_enabled && !ctx->access_technology_polling_supported)
+        return SIGNAL_CHECK_SAFETY_NET_TIMEOUT_SEC;
+    return SIGNAL_CHECK_TIMEOUT_SEC;
+}
+
+static gboolean
+signal_quality_poll_needed (SignalCheckContext *ctx)
+{
+    /* Always poll during the initial high frequency checks */
+    if (!ctx->indications_enabled ||
+        ctx->interval == SIGNAL_CHECK_INITIAL_TIMEOUT_SEC ||
+        !ctx->signal_quality_polled_time)
+        return TRUE;
+
+    /* Allow some margin, so that checks scheduled right at the end of the
+     * safety net interval aren't skipped */
+    return ((g_get_monotonic_time () - ctx->signal_quality_polled_time) / G_USEC_PER_SEC >=
+            SIGNAL_CHECK_SAFETY_NET_TIMEOUT_SEC - SIGNAL_CHECK_TIMEOUT_SEC / 2);
+}
+
+static guint
+signal_quality_recent_timeout (MMIfaceModem *self)
+{
+    /* With indications, a value not updated is just a value that didn't
+     * change, so it's valid at least until the next safety net check */
+    if (get_signal_check_context (self)->indications_enabled)
+        return 2 * SIGNAL_CHECK_SAFETY_NET_TIMEOUT_SEC;
+    return SIGNAL_QUALITY_RECENT_TIMEOUT_SEC;
+}
+
+void
+mm_iface_modem_set_signal_quality_indications (MMIfaceModem *self,
+                                               gboolean      enabled)
+{
+    SignalCheckContext *ctx;
+
+    ctx = get_signal_check_context (self);
+    if (ctx->indications_enabled == enabled)
+        return;
+
+    mm_dbg ("Signal quality indications %s: polling signal quality every %us",
+            enabled ? "enabled" : "disabled",
+            enabled ? SIGNAL_CHECK_SAFETY_NET_TIMEOUT_SEC : SIGNAL_CHECK_TIMEOUT_SEC);
+    ctx->indications_enabled = enabled;
+
+    /* The high frequency initial checks are kept as they are */
+    if (ctx->interval == SIGNAL_CHECK_INITIAL_TIMEOUT_SEC)
+        return;
+    ctx->interval = signal_check_default_interval (ctx);
+
+    /* Without indications, don't wait for the long safety net interval */
+    if (!enabled && ctx->timeout_source) {
+        mm_base_modem_poll_remove (MM_BASE_MODEM (self), ctx->timeout_source);
+        ctx->timeout_source = mm_base_modem_poll_add (MM_BASE_MODEM (self), MM_BASE_MODEM_POLL_SIGNAL_QUALITY, ctx->interval, (GSourceFunc) periodic_signal_check_cb, self);
+    }
+}
+
 static void     periodic_signal_check_disable (MMIfaceModem *self,
                                                gboolean      clear);
-static gboolean periodic_signal_check_cb      (MMIfaceModem *self);
 static void     peridic_signal_check_step     (MMIfaceModem *self);
 
 static void
@@ -1235,7 +1321,8 @@ peridic_signal_check_step (MMIfaceModem *self)
         ctx->running_step++;
 
     case SIGNAL_CHECK_STEP_SIGNAL_QUALITY:
-        if (ctx->enabled && ctx->signal_quality_polling_supported) {
+        if (ctx->enabled && ctx->signal_quality_polling_supported && signal_quality_poll_needed (ctx)) {
+            ctx->signal_quality_polled_time = g_get_monotonic_time ();
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_signal_quality (
                 self, (GAsyncReadyCallback)signal_quality_check_ready, NULL);
             return;
@@ -1291,16 +1378,19 @@ peridic_signal_check_step (MMIfaceModem *self)
 
             if (signal_quality_ready && access_technology_ready) {
                 mm_dbg ("Initial signal quality and access technology ready: fallback to default frequency");
-                ctx->interval = SIGNAL_CHECK_TIMEOUT_SEC;
+                ctx->interval = signal_check_default_interval (ctx);
             } else if (--ctx->initial_retries == 0) {
                 mm_dbg ("Too many periodic signal checks at high frequency: fallback to default frequency");
-                ctx->interval = SIGNAL_CHECK_TIMEOUT_SEC;
+                ctx->interval = signal_check_default_interval (ctx);
             }
+        } else {
+            /* Access technology polling may have been found unsupported */
+            ctx->interval = signal_check_default_interval (ctx);
         }
 
         mm_dbg ("Periodic signal quality checks scheduled in %ds", ctx->interval);
         g_assert (!ctx->timeout_source);
-        ctx->timeout_source = g_timeout_add_seconds (ctx->interval, (GSourceFunc) periodic_signal_check_cb, self);
+        ctx->timeout_source = mm_base_modem_poll_add (MM_BASE_MODEM (self), MM_BASE_MODEM_POLL_SIGNAL_QUALITY, ctx->interval, (GSourceFunc) periodic_signal_check_cb, self);
         return;
     }
 }
@@ -1349,7 +1439,7 @@ mm_iface_modem_refresh_signal (MMIfaceModem *self)
     /* Remove the scheduled timeout as we're going to refresh
      * right away */
     if (ctx->timeout_source) {
-        g_source_remove (ctx->timeout_source);
+        mm_base_modem_poll_remove (MM_BASE_MODEM (self), ctx->timeout_source);
         ctx->timeout_source = 0;
     }
 
@@ -1372,17 +1462,19 @@ periodic_signal_check_disable (MMIfaceModem *self,
     if (!ctx->enabled)
         return;
 
-    /* Clear access technology and signal quality */
+    /* Clear access technology and signal quality, notified at once */
     if (clear) {
+        mm_base_modem_begin_property_updates (MM_BASE_MODEM (self));
         update_signal_quality (self, 0, FALSE);
         mm_iface_modem_update_access_technologies (self,
                                                    MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN,
                                                    MM_MODEM_ACCESS_TECHNOLOGY_ANY);
+        mm_base_modem_end_property_updates (MM_BASE_MODEM (self));
     }
 
     /* Remove scheduled timeout */
     if (ctx->timeout_source) {
-        g_source_remove (ctx->timeout_source);
+        mm_base_modem_poll_remove (MM_BASE_MODEM (self), ctx->timeout_source);
         ctx->timeout_source = 0;
     }
 
@@ -1901,6 +1993,10 @@ handle_reset_ready (MMIfaceModem *self,
 {
     GError *error = NULL;
 
+    /* Whatever the result, the PDP context table may have changed */
+    if (MM_IS_BROADBAND_MODEM (self))
+        mm_broadband_modem_invalidate_pdp_context_cache (MM_BROADBAND_MODEM (self));
+
     if (!MM_IFACE_MODEM_GET_INTERFACE (self)->reset_finish (self, res, &error))
         g_dbus_method_invocation_take_error (ctx->invocation, error);
     else
@@ -1985,6 +2081,10 @@ handle_factory_reset_ready (MMIfaceModem *self,
 {
     GError *error = NULL;
 
+    /* Whatever the result, the PDP context table may have changed */
+    if (MM_IS_BROADBAND_MODEM (self))
+        mm_broadband_modem_invalidate_pdp_context_cache (MM_BROADBAND_MODEM (self));
+
     if (!MM_IFACE_MODEM_GET_INTERFACE (self)->factory_reset_finish (self, res, &error))
         g_dbus_method_invocation_take_error (ctx->invocation, error);
     else
@@ -2047,6 +2147,73 @@ handle_factory_reset (MmGdbusModem *skeleton,
     return TRUE;
 }
 
+/*****************************************************************************/
+/* Periodic task intervals */
+
+typedef struct {
+    MmGdbusModem *skeleton;
+    GDBusMethodInvocation *invocation;
+    MMIfaceModem *self;
+    GVariant *intervals;
+} HandleSetPollIntervalsContext;
+
+static void
+handle_set_poll_intervals_context_free (HandleSetPollIntervalsContext *ctx)
+{
+    g_object_unref (ctx->skeleton);
+    g_object_unref (ctx->invocation);
+    g_object_unref (ctx->self);
+    g_variant_unref (ctx->intervals);
+    g_free (ctx);
+}
+
+static void
+handle_set_poll_intervals_auth_ready (MMBaseModem *self,
+                                      GAsyncResult *res,
+                                      HandleSetPollIntervalsContext *ctx)
+{
+    GError *error = NULL;
+
+    if (!mm_base_modem_authorize_finish (self, res, &error)) {
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+        handle_set_poll_intervals_context_free (ctx);
+        return;
+    }
+
+    if (!mm_base_modem_set_poll_intervals (self, ctx->intervals, &error)) {
+        g_dbus_method_invocation_take_error (ctx->invocation, error);
+        handle_set_poll_intervals_context_free (ctx);
+        return;
+    }
+
+    mm_gdbus_modem_set_poll_intervals (ctx->skeleton, mm_base_modem_get_poll_intervals (self));
+    mm_gdbus_modem_complete_set_poll_intervals (ctx->skeleton, ctx->invocation);
+    handle_set_poll_intervals_context_free (ctx);
+}
+
+static gboolean
+handle_set_poll_intervals (MmGdbusModem *skeleton,
+                           GDBusMethodInvocation *invocation,
+                           GVariant *intervals,
+                           MMIfaceModem *self)
+{
+    HandleSetPollIntervalsContext *ctx;
+
+    ctx = g_new (HandleSetPollIntervalsContext, 1);
+    ctx->skeleton = g_object_ref (skeleton);
+    ctx->invocation = g_object_ref (invocation);
+    ctx->self = g_object_ref (self);
+    ctx->intervals = g_variant_ref (intervals);
+
+    mm_base_modem_authorize (MM_BASE_MODEM (self),
+                             invocation,
+                             MM_AUTHORIZATION_DEVICE_CONTROL,
+                             (GAsyncReadyCallback)handle_set_poll_intervals_auth_ready,
+                             ctx);
+
+    return TRUE;
+}
+
 /*****************************************************************************/
 /* Current capabilities setting */
 
@@ -3835,16 +4002,121 @@ struct _InitializationContext {
     InitializationStep step;
     MmGdbusModem *skeleton;
     GError *fatal_error;
+    gchar *identity_cache_key;
+    MMIdentityCacheEntry *identity_cache_entry;
 };
 
 static void
 initialization_context_free (InitializationContext *ctx)
 {
     g_assert (ctx->fatal_error == NULL);
+    mm_identity_cache_entry_free (ctx->identity_cache_entry);
+    g_free (ctx->identity_cache_key);
     g_object_unref (ctx->skeleton);
     g_free (ctx);
 }
 
+/*****************************************************************************/
+/* Identity cache
+ *
+ * Manufacturer, model, device identifier and supported IP families are
+ * preloaded from the cache. The revision and the equipment identifier are
+ * always loaded from the modem, and they are used to validate the preloaded
+ * values, so that a firmware upgrade or a different unit plugged in the same
+ * port never exposes stale information. */
+
+static void
+identity_cache_preload (MMIfaceModem          *self,
+                        InitializationContext *ctx)
+{
+    const gchar *path;
+
+    path = mm_context_get_identity_cache ();
+    if (!path)
+        return;
+
+    /* Only preload when nothing was loaded yet */
+    if (mm_gdbus_modem_get_manufacturer (ctx->skeleton) ||
+        mm_gdbus_modem_get_model (ctx->skeleton) ||
+        mm_gdbus_modem_get_device_identifier (ctx->skeleton))
+        return;
+
+    g_free (ctx->identity_cache_key);
+    ctx->identity_cache_key = mm_identity_cache_build_key (mm_base_modem_get_plugin (MM_BASE_MODEM (self)),
+                                                           (guint16) mm_base_modem_get_vendor_id (MM_BASE_MODEM (self)),
+                                                           (guint16) mm_base_modem_get_product_id (MM_BASE_MODEM (self)),
+                                                           mm_base_modem_get_device (MM_BASE_MODEM (self)));
+    if (!ctx->identity_cache_key)
+        return;
+
+    ctx->identity_cache_entry = mm_identity_cache_lookup (path, ctx->identity_cache_key);
+    if (!ctx->identity_cache_entry)
+        return;
+
+    mm_dbg ("Preloading modem identity from cache");
+    mm_gdbus_modem_set_manufacturer (ctx->skeleton, ctx->identity_cache_entry->manufacturer);
+    mm_gdbus_modem_set_model (ctx->skeleton, ctx->identity_cache_entry->model);
+    mm_gdbus_modem_set_device_identifier (ctx->skeleton, ctx->identity_cache_entry->device_identifier);
+    mm_gdbus_modem_set_supported_ip_families (ctx->skeleton, ctx->identity_cache_entry->supported_ip_families);
+}
+
+static gboolean
+identity_cache_validate (InitializationContext *ctx)
+{
+    if (!ctx->identity_cache_entry)
+        return TRUE;
+
+    if (!g_strcmp0 (ctx->identity_cache_entry->revision,
+                    mm_gdbus_modem_get_revision (ctx->skeleton)) &&
+        !g_strcmp0 (ctx->identity_cache_entry->equipment_identifier,
+                    mm_gdbus_modem_get_equipment_identifier (ctx->skeleton)))
+        return TRUE;
+
+    mm_dbg ("Cached modem identity doesn't match revision or equipment identifier: reloading");
+
+    /* Clear the preloaded values so that the steps load them again */
+    mm_gdbus_modem_set_manufacturer (ctx->skeleton, NULL);
+    mm_gdbus_modem_set_model (ctx->skeleton, NULL);
+    mm_gdbus_modem_set_device_identifier (ctx->skeleton, NULL);
+    mm_gdbus_modem_set_supported_ip_families (ctx->skeleton, MM_BEARER_IP_FAMILY_NONE);
+
+    mm_identity_cache_entry_free (ctx->identity_cache_entry);
+    ctx->identity_cache_entry = NULL;
+    return FALSE;
+}
+
+static void
+identity_cache_store (InitializationContext *ctx)
+{
+    MMIdentityCacheEntry  entry;
+    const gchar          *path;
+    GError               *error = NULL;
+
+    path = mm_context_get_identity_cache ();
+    if (!path || !ctx->identity_cache_key)
+        return;
+
+    /* Validated entry, nothing changed */
+    if (ctx->identity_cache_entry)
+        return;
+
+    entry.manufacturer          = (gchar *) mm_gdbus_modem_get_manufacturer (ctx->skeleton);
+    entry.model                 = (gchar *) mm_gdbus_modem_get_model (ctx->skeleton);
+    entry.revision              = (gchar *) mm_gdbus_modem_get_revision (ctx->skeleton);
+    entry.equipment_identifier  = (gchar *) mm_gdbus_modem_get_equipment_identifier (ctx->skeleton);
+    entry.device_identifier     = (gchar *) mm_gdbus_modem_get_device_identifier (ctx->skeleton);
+    entry.supported_ip_families = mm_gdbus_modem_get_supported_ip_families (ctx->skeleton);
+
+    /* Without revision there is no way to validate the entry later */
+    if (!entry.revision || !entry.device_identifier)
+        return;
+
+    if (!mm_identity_cache_store (path, ctx->identity_cache_key, &entry, &error)) {
+        mm_warn ("Couldn't store modem identity in cache: %s", error->message);
+        g_error_free (error);
+    }
+}
+
 #undef STR_REPLY_READY_FN
 #define STR_REPLY_READY_FN(NAME,DISPLAY)                                \
     static void                                                         \
@@ -4423,6 +4695,8 @@ interface_initialization_step (GTask *task)
             mm_gdbus_modem_set_ports (ctx->skeleton, mm_common_ports_array_to_variant (port_infos, n_port_infos));
             mm_modem_port_info_array_free (port_infos, n_port_infos);
         }
+        /* Preload identity from the cache, if any */
+        identity_cache_preload (self, ctx);
         /* Fall down to next step */
         ctx->step++;
 
@@ -4589,6 +4863,14 @@ interface_initialization_step (GTask *task)
         ctx->step++;
 
     case INITIALIZATION_STEP_DEVICE_ID:
+        /* If the cached identity is no longer valid, go back and load all
+         * the values that were preloaded from it */
+        if (!identity_cache_validate (ctx)) {
+            ctx->step = INITIALIZATION_STEP_MANUFACTURER;
+            interface_initialization_step (task);
+            return;
+        }
+
         /* Device ID is meant to be loaded only once during the whole
          * lifetime of the modem. Therefore, if we already have them loaded,
          * don't try to load them again. */
@@ -4872,6 +5154,13 @@ interface_initialization_step (GTask *task)
                           "handle-factory-reset",
                           G_CALLBACK (handle_factory_reset),
                           self);
+        /* Periodic task intervals are per-modem settings, not operations */
+        mm_gdbus_modem_set_poll_intervals (ctx->skeleton,
+                                           mm_base_modem_get_poll_intervals (MM_BASE_MODEM (self)));
+        g_signal_connect (ctx->skeleton,
+                          "handle-set-poll-intervals",
+                          G_CALLBACK (handle_set_poll_intervals),
+                          self);
 
         if (ctx->fatal_error) {
             if (g_error_matches (ctx->fatal_error,
@@ -4888,6 +5177,9 @@ interface_initialization_step (GTask *task)
                 }
             }
         } else {
+            /* Keep the identity around for the next initialization */
+            identity_cache_store (ctx);
+
             /* We are done without errors!
              * Handle method invocations */
             g_signal_connect (ctx->skeleton,
@@ -5245,6 +5537,24 @@ mm_iface_modem_get_model (MMIfaceModem *self)
     return model;
 }
 
+const gchar *
+mm_iface_modem_get_equipment_identifier (MMIfaceModem *self)
+{
+    const gchar *equipment_identifier = NULL;
+    MmGdbusModem *skeleton;
+
+    g_object_get (self,
+                  MM_IFACE_MODEM_DBUS_SKELETON, &skeleton,
+                  NULL);
+
+    if (skeleton) {
+        equipment_identifier = mm_gdbus_modem_get_equipment_identifier (skeleton);
+        g_object_unref (skeleton);
+    }
+
+    return equipment_identifier;
+}
+
 /*****************************************************************************/
 
 static void
@@ -364,6 +364,9 @@ gboolean mm_iface_modem_is_4g_only (MMIfaceModem *self);
 /* Helper to query model */
 const gchar *mm_iface_modem_get_model (MMIfaceModem *self);
 
+/* Helper to query equipment identifier */
+const gchar *mm_iface_modem_get_equipment_identifier (MMIfaceModem *self);
+
 /* Initialize Modem interface (async) */
 void     mm_iface_modem_initialize        (MMIfaceModem *self,
                                            GCancellable *cancellable,
@@ -452,6 +455,12 @@ void mm_iface_modem_update_signal_quality (MMIfaceModem *self,
 /* Allow requesting to refresh signal via polling */
 void mm_iface_modem_refresh_signal (MMIfaceModem *self);
 
+/* Let the interface know whether the modem reports signal quality changes on
+ * its own, so that signal quality polling is reduced to a long interval safety
+ * net. Access technologies are still polled at the default rate. */
+void mm_iface_modem_set_signal_quality_indications (MMIfaceModem *self,
+                                                    gboolean      enabled);
+
 /* Allow setting allowed modes */
 void     mm_iface_modem_set_current_modes        (MMIfaceModem *self,
                                                   MMModemMode allowed,
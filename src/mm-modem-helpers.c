@@ -131,6 +131,43 @@ mm_split_string_groups (const gchar *str)
 
 /*****************************************************************************/
 
+/* Each information response is framed as <CR><LF>text<CR><LF>, so the
+ * replies of consecutive commands in the same line are separated by an
+ * empty line; the leading and trailing ones are already removed by the
+ * serial parser. Note that a single reply may span multiple lines, but never
+ * multiple empty-line separated blocks. */
+gchar **
+mm_split_compound_response (const gchar *response,
+                            guint n_commands)
+{
+    gchar **split;
+    guint i;
+
+    g_return_val_if_fail (n_commands > 0, NULL);
+
+    if (!response)
+        return NULL;
+
+    split = g_strsplit (response, "\r\n\r\n", -1);
+    if (g_strv_length (split) != n_commands) {
+        g_strfreev (split);
+        return NULL;
+    }
+
+    for (i = 0; split[i]; i++) {
+        g_strstrip (split[i]);
+        /* Empty replies would be ambiguous */
+        if (!split[i][0]) {
+            g_strfreev (split);
+            return NULL;
+        }
+    }
+
+    return split;
+}
+
+/*****************************************************************************/
+
 static int uint_compare_func (gconstpointer a, gconstpointer b)
 {
    return (*(guint *)a - *(guint *)b);
@@ -495,6 +532,42 @@ mm_filter_supported_capabilities (MMModemCapability all,
 
 /*****************************************************************************/
 
+static gboolean
+signal_value_changed (gdouble previous,
+                      gdouble current,
+                      guint threshold)
+{
+    gdouble change;
+
+    /* Values becoming available or unavailable are always a change */
+    if (previous == MM_SIGNAL_UNKNOWN || current == MM_SIGNAL_UNKNOWN || threshold == 0)
+        return previous != current;
+
+    change = current - previous;
+    return (change < 0 ? -change : change) >= threshold;
+}
+
+gboolean
+mm_signal_changed_over_thresholds (MMSignal *previous,
+                                   MMSignal *current,
+                                   guint rssi_threshold,
+                                   guint rsrp_threshold,
+                                   guint rsrq_threshold,
+                                   guint snr_threshold,
+                                   guint ecio_threshold)
+{
+    return (signal_value_changed (mm_signal_get_rssi (previous), mm_signal_get_rssi (current), rssi_threshold) ||
+            signal_value_changed (mm_signal_get_rscp (previous), mm_signal_get_rscp (current), rssi_threshold) ||
+            signal_value_changed (mm_signal_get_io   (previous), mm_signal_get_io   (current), rssi_threshold) ||
+            signal_value_changed (mm_signal_get_rsrp (previous), mm_signal_get_rsrp (current), rsrp_threshold) ||
+            signal_value_changed (mm_signal_get_rsrq (previous), mm_signal_get_rsrq (current), rsrq_threshold) ||
+            signal_value_changed (mm_signal_get_snr  (previous), mm_signal_get_snr  (current), snr_threshold)  ||
+            signal_value_changed (mm_signal_get_sinr (previous), mm_signal_get_sinr (current), snr_threshold)  ||
+            signal_value_changed (mm_signal_get_ecio (previous), mm_signal_get_ecio (current), ecio_threshold));
+}
+
+/*****************************************************************************/
+
 GRegex *
 mm_voice_ring_regex_get (void)
 {
@@ -533,6 +606,19 @@ mm_voice_clip_regex_get (void)
                         NULL);
 }
 
+GRegex *
+mm_ctz_regex_get (void)
+{
+    /* Example:
+     * <CR><LF>+CTZV: +04<CR><LF>
+     * <CR><LF>+CTZE: +04,1,"2016/10/18,12:30:00"<CR><LF>
+     */
+    return g_regex_new ("\\r\\n(\\+CTZ[VE]:[^\\r\\n]*)\\r\\n",
+                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                        0,
+                        NULL);
+}
+
 /*************************************************************************/
 
 static MMFlowControl
@@ -847,6 +933,17 @@ mm_3gpp_cds_regex_get (void)
                         NULL);
 }
 
+/*************************************************************************/
+
+GRegex *
+mm_3gpp_cgev_regex_get (void)
+{
+    return g_regex_new ("\\r\\n\\+CGEV:\\s*(.*)\\r\\n",
+                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                        0,
+                        NULL);
+}
+
 /*************************************************************************/
 /* AT+WS46=? response parser
  *
@@ -1593,6 +1690,93 @@ mm_3gpp_parse_cgact_read_response (const gchar *reply,
 
 /*************************************************************************/
 
+static gboolean
+cgev_get_cid (const gchar *str,
+              guint       *out_cid)
+{
+    gchar    *aux;
+    gboolean  ret;
+
+    aux = mm_strip_quotes (g_strdup (str));
+    ret = mm_get_uint_from_str (aux, out_cid);
+    g_free (aux);
+    return ret;
+}
+
+MM3gppCgev
+mm_3gpp_parse_cgev_indication (const gchar *str,
+                               guint       *out_cid)
+{
+    static const struct {
+        const gchar *prefix;
+        MM3gppCgev   event;
+    } events[] = {
+        /* Note: longest prefixes first */
+        { "NW PDN DEACT", MM_3GPP_CGEV_NW_DEACT_PDN },
+        { "ME PDN DEACT", MM_3GPP_CGEV_ME_DEACT_PDN },
+        { "NW DEACT",     MM_3GPP_CGEV_NW_DEACT_PDP },
+        { "ME DEACT",     MM_3GPP_CGEV_ME_DEACT_PDP },
+        { "NW DETACH",    MM_3GPP_CGEV_NW_DETACH    },
+        { "ME DETACH",    MM_3GPP_CGEV_ME_DETACH    },
+    };
+    MM3gppCgev   event = MM_3GPP_CGEV_UNKNOWN;
+    const gchar *args = NULL;
+    gchar      **split;
+    guint        n_split;
+    guint        cid = 0;
+    guint        i;
+
+    str = mm_strip_tag (str, "+CGEV:");
+
+    for (i = 0; i < G_N_ELEMENTS (events); i++) {
+        if (g_str_has_prefix (str, events[i].prefix)) {
+            event = events[i].event;
+            args = str + strlen (events[i].prefix);
+            break;
+        }
+    }
+
+    if (event == MM_3GPP_CGEV_UNKNOWN ||
+        event == MM_3GPP_CGEV_NW_DETACH ||
+        event == MM_3GPP_CGEV_ME_DETACH) {
+        if (out_cid)
+            *out_cid = 0;
+        return event;
+    }
+
+    split = g_strsplit (args, ",", -1);
+    n_split = g_strv_length (split);
+
+    switch (event) {
+    case MM_3GPP_CGEV_NW_DEACT_PDN:
+    case MM_3GPP_CGEV_ME_DEACT_PDN:
+        /* <cid>[,<WLAN_Offload>] */
+        if (n_split >= 1 && !cgev_get_cid (split[0], &cid))
+            cid = 0;
+        break;
+    case MM_3GPP_CGEV_NW_DEACT_PDP:
+    case MM_3GPP_CGEV_ME_DEACT_PDP:
+        /* Either <p_cid>,<cid>,<event_type>[,<WLAN_Offload>] for secondary
+         * contexts or <PDP_type>,<PDP_addr>[,<cid>] */
+        if (n_split >= 1 && cgev_get_cid (split[0], &cid)) {
+            if (n_split < 2 || !cgev_get_cid (split[1], &cid))
+                cid = 0;
+        } else if (n_split < 3 || !cgev_get_cid (split[2], &cid))
+            cid = 0;
+        break;
+    default:
+        g_assert_not_reached ();
+    }
+
+    g_strfreev (split);
+
+    if (out_cid)
+        *out_cid = cid;
+    return event;
+}
+
+/*************************************************************************/
+
 static gulong
 parse_uint (char *str, int base, glong nmin, glong nmax, gboolean *valid)
 {
@@ -3191,6 +3375,32 @@ mm_3gpp_pdu_info_list_free (GList *info_list)
     g_list_free_full (info_list, (GDestroyNotify)mm_3gpp_pdu_info_free);
 }
 
+GRegex *
+mm_3gpp_cmgl_pdu_entry_regex_get (void)
+{
+    /* The line break after the PDU is required, so that only complete
+     * entries are matched while the response is still being received */
+    return g_regex_new ("\\+CMGL:\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,[^\\r\\n]*\\r\\n([^\\r\\n]+)\\r\\n",
+                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                        0,
+                        NULL);
+}
+
+MM3gppPduInfo *
+mm_3gpp_parse_pdu_cmgl_entry (GMatchInfo *match_info)
+{
+    MM3gppPduInfo *info;
+
+    info = g_new0 (MM3gppPduInfo, 1);
+    if (mm_get_int_from_match_info (match_info, 1, &info->index) &&
+        mm_get_int_from_match_info (match_info, 2, &info->status) &&
+        (info->pdu = mm_get_string_unquoted_from_match_info (match_info, 3)) != NULL)
+        return info;
+
+    mm_3gpp_pdu_info_free (info);
+    return NULL;
+}
+
 GList *
 mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
                                  GError **error)
@@ -4236,3 +4446,95 @@ mm_parse_cclk_response (const char *response,
 
     return ret;
 }
+
+gboolean
+mm_parse_ctz_response (const gchar *response,
+                       gchar **iso8601p,
+                       MMNetworkTimezone **tzp,
+                       GError **error)
+{
+    GRegex *r;
+    GMatchInfo *match_info = NULL;
+    GError *match_error = NULL;
+    gchar *type = NULL;
+    guint year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    guint dst = 0;
+    gint tz = 0;
+    gboolean dst_valid;
+    gboolean ret = FALSE;
+
+    g_assert (iso8601p || tzp); /* at least one */
+
+    /* Sample messages, timezone given in 15 minute intervals and DST in hours:
+     *   +CTZV: -32
+     *   +CTZE: "+04",1,"2016/10/18,12:30:00"
+     */
+    r = g_regex_new ("[+]CTZ([VE]):\\s*\"?([-+]?\\d+)\"?(?:,\\s*(\\d+))?"
+                     "(?:,\\s*\"(\\d+)/(\\d+)/(\\d+),(\\d+):(\\d+):(\\d+)\")?",
+                     0, 0, NULL);
+    g_assert (r != NULL);
+
+    if (!g_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
+        if (match_error) {
+            g_propagate_error (error, match_error);
+            g_prefix_error (error, "Could not parse +CTZV/+CTZE results: ");
+        } else {
+            g_set_error (error,
+                         MM_CORE_ERROR,
+                         MM_CORE_ERROR_FAILED,
+                         "Couldn't match +CTZV/+CTZE reply: %s", response);
+        }
+        goto out;
+    }
+
+    type = g_match_info_fetch (match_info, 1);
+    if (!mm_get_int_from_match_info (match_info, 2, &tz)) {
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_FAILED,
+                     "Failed to parse timezone in +CTZV/+CTZE reply: %s", response);
+        goto out;
+    }
+
+    /* DST only given in +CTZE */
+    dst_valid = (g_str_equal (type, "E") &&
+                 g_match_info_get_match_count (match_info) >= 4 &&
+                 mm_get_uint_from_match_info (match_info, 3, &dst));
+
+    if (tzp) {
+        *tzp = mm_network_timezone_new ();
+        mm_network_timezone_set_offset (*tzp, tz * 15);
+        if (dst_valid)
+            mm_network_timezone_set_dst_offset (*tzp, dst * 60);
+    }
+
+    if (iso8601p) {
+        *iso8601p = NULL;
+
+        /* Local time is optional */
+        if (g_match_info_get_match_count (match_info) >= 10 &&
+            mm_get_uint_from_match_info (match_info, 4, &year)   &&
+            mm_get_uint_from_match_info (match_info, 5, &month)  &&
+            mm_get_uint_from_match_info (match_info, 6, &day)    &&
+            mm_get_uint_from_match_info (match_info, 7, &hour)   &&
+            mm_get_uint_from_match_info (match_info, 8, &minute) &&
+            mm_get_uint_from_match_info (match_info, 9, &second)) {
+            if (year < 100)
+                year += (year >= 70 ? 1900 : 2000);
+            *iso8601p = mm_new_iso8601_time (year, month, day, hour,
+                                             minute, second,
+                                             TRUE, (tz * 15));
+        }
+    }
+
+    ret = TRUE;
+
+ out:
+
+    g_free (type);
+    if (match_info)
+        g_match_info_free (match_info);
+    g_regex_unref (r);
+
+    return ret;
+}
@@ -53,6 +53,12 @@ const gchar *mm_strip_tag    (const gchar *str,
 
 gchar **mm_split_string_groups (const gchar *str);
 
+/* Split the reply to a compound command line (e.g. AT+CGMI;+CGMM) into the
+ * replies of each command. Returns NULL if the reply can't be split into
+ * exactly the given number of replies. */
+gchar **mm_split_compound_response (const gchar *response,
+                                    guint n_commands);
+
 GArray *mm_parse_uint_list (const gchar  *str,
                             GError      **error);
 
@@ -88,6 +94,17 @@ GArray *mm_filter_supported_modes (const GArray *all,
 GArray *mm_filter_supported_capabilities (MMModemCapability all,
                                           const GArray *supported_combinations);
 
+/* Whether extended signal values changed enough to be published again, given
+ * the minimum change in dB of each kind of value (0 for any change). RSCP and
+ * Io follow the RSSI threshold, SINR the SNR one. */
+gboolean mm_signal_changed_over_thresholds (MMSignal *previous,
+                                            MMSignal *current,
+                                            guint rssi_threshold,
+                                            guint rsrp_threshold,
+                                            guint rsrq_threshold,
+                                            guint snr_threshold,
+                                            guint ecio_threshold);
+
 /*****************************************************************************/
 /* VOICE specific helpers and utilities */
 /*****************************************************************************/
@@ -95,6 +112,9 @@ GRegex *mm_voice_ring_regex_get (void);
 GRegex *mm_voice_cring_regex_get(void);
 GRegex *mm_voice_clip_regex_get (void);
 
+/* +CTZV/+CTZE unsolicited messages */
+GRegex *mm_ctz_regex_get (void);
+
 /*****************************************************************************/
 /* SERIAL specific helpers and utilities */
 
@@ -123,6 +143,7 @@ GRegex    *mm_3gpp_ciev_regex_get (void);
 GRegex    *mm_3gpp_cusd_regex_get (void);
 GRegex    *mm_3gpp_cmti_regex_get (void);
 GRegex    *mm_3gpp_cds_regex_get (void);
+GRegex    *mm_3gpp_cgev_regex_get (void);
 
 /* AT+WS46=? response parser: returns array of MMModemMode values */
 GArray *mm_3gpp_parse_ws46_test_response (const gchar  *response,
@@ -181,6 +202,21 @@ void mm_3gpp_pdp_context_active_list_free (GList *pdp_active_list);
 GList *mm_3gpp_parse_cgact_read_response (const gchar *reply,
                                           GError **error);
 
+/* +CGEV unsolicited message parser. Only the events reporting the loss of
+ * connectivity are recognized, all others are reported as unknown. The CID
+ * is given when the event applies to a specific context. */
+typedef enum {
+    MM_3GPP_CGEV_UNKNOWN,
+    MM_3GPP_CGEV_NW_DETACH,
+    MM_3GPP_CGEV_ME_DETACH,
+    MM_3GPP_CGEV_NW_DEACT_PDN,
+    MM_3GPP_CGEV_ME_DEACT_PDN,
+    MM_3GPP_CGEV_NW_DEACT_PDP,
+    MM_3GPP_CGEV_ME_DEACT_PDP,
+} MM3gppCgev;
+MM3gppCgev mm_3gpp_parse_cgev_indication (const gchar *str,
+                                          guint *out_cid);
+
 /* CREG/CGREG response/unsolicited message parser */
 gboolean mm_3gpp_parse_creg_response (GMatchInfo *info,
                                       MMModem3gppRegistrationState *out_reg_state,
@@ -277,6 +313,10 @@ void   mm_3gpp_pdu_info_list_free      (GList *info_list);
 GList *mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
                                         GError **error);
 
+/* Single +CMGL entry in PDU mode, for incremental parsing */
+GRegex        *mm_3gpp_cmgl_pdu_entry_regex_get (void);
+MM3gppPduInfo *mm_3gpp_parse_pdu_cmgl_entry     (GMatchInfo *match_info);
+
 /* AT+CMGR (Read message) response parser */
 MM3gppPduInfo *mm_3gpp_parse_cmgr_read_response (const gchar *reply,
                                                  guint index,
@@ -395,4 +435,11 @@ gboolean mm_parse_cclk_response (const gchar *response,
                                  MMNetworkTimezone **tzp,
                                  GError **error);
 
+/* +CTZV/+CTZE unsolicited message parser; the ISO-8601 time is only given
+ * if the message includes it */
+gboolean mm_parse_ctz_response (const gchar *response,
+                                gchar **iso8601p,
+                                MMNetworkTimezone **tzp,
+                                GError **error);
+
 #endif  /* MM_MODEM_HELPERS_H */
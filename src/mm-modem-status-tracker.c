@@ -0,0 +1,244 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include "mm-modem-status-tracker.h"
+
+/* Maximum number of removed modems remembered; clients asking for changes
+ * older than the last forgotten removal get the complete list instead */
+#define MAX_REMOVED 64
+
+typedef struct {
+    GVariant *record;
+    guint64 generation;
+    gboolean seen;
+} Entry;
+
+typedef struct {
+    gchar *path;
+    guint64 generation;
+} Removed;
+
+struct _MMModemStatusTracker {
+    /* Path -> Entry */
+    GHashTable *entries;
+    /* Removed, oldest first */
+    GQueue removed;
+    guint64 generation;
+    /* Generation of the last removal forgotten */
+    guint64 horizon;
+};
+
+/*****************************************************************************/
+
+static void
+entry_free (Entry *entry)
+{
+    g_variant_unref (entry->record);
+    g_free (entry);
+}
+
+static void
+removed_free (Removed *removed)
+{
+    g_free (removed->path);
+    g_free (removed);
+}
+
+static void
+forget_removed (MMModemStatusTracker *self,
+                const gchar *path)
+{
+    GList *l;
+
+    for (l = self->removed.head; l; l = g_list_next (l)) {
+        Removed *removed = l->data;
+
+        /* The new record supersedes the removal */
+        if (g_str_equal (removed->path, path)) {
+            removed_free (removed);
+            g_queue_delete_link (&self->removed, l);
+            return;
+        }
+    }
+}
+
+static void
+add_removed (MMModemStatusTracker *self,
+             const gchar *path,
+             guint64 generation)
+{
+    Removed *removed;
+
+    removed = g_new0 (Removed, 1);
+    removed->path = g_strdup (path);
+    removed->generation = generation;
+    g_queue_push_tail (&self->removed, removed);
+
+    while (g_queue_get_length (&self->removed) > MAX_REMOVED) {
+        removed = g_queue_pop_head (&self->removed);
+        self->horizon = MAX (self->horizon, removed->generation);
+        removed_free (removed);
+    }
+}
+
+void
+mm_modem_status_tracker_refresh (MMModemStatusTracker *self,
+                                 GVariant *records)
+{
+    GHashTableIter hash_iter;
+    GVariantIter iter;
+    const gchar *path;
+    GVariant *record;
+    Entry *entry;
+    guint64 next;
+    gboolean changed = FALSE;
+
+    g_return_if_fail (g_variant_is_of_type (records, G_VARIANT_TYPE ("a{oa{sv}}")));
+
+    /* All changes found in the same refresh share the generation */
+    next = self->generation + 1;
+
+    g_hash_table_iter_init (&hash_iter, self->entries);
+    while (g_hash_table_iter_next (&hash_iter, NULL, (gpointer *)&entry))
+        entry->seen = FALSE;
+
+    g_variant_iter_init (&iter, records);
+    while (g_variant_iter_next (&iter, "{&o@a{sv}}", &path, &record)) {
+        entry = g_hash_table_lookup (self->entries, path);
+        if (!entry) {
+            entry = g_new0 (Entry, 1);
+            g_hash_table_insert (self->entries, g_strdup (path), entry);
+            forget_removed (self, path);
+        } else if (g_variant_equal (entry->record, record)) {
+            entry->seen = TRUE;
+            g_variant_unref (record);
+            continue;
+        } else
+            g_variant_unref (entry->record);
+
+        entry->record = record;
+        entry->generation = next;
+        entry->seen = TRUE;
+        changed = TRUE;
+    }
+
+    g_hash_table_iter_init (&hash_iter, self->entries);
+    while (g_hash_table_iter_next (&hash_iter, (gpointer *)&path, (gpointer *)&entry)) {
+        if (entry->seen)
+            continue;
+        add_removed (self, path, next);
+        g_hash_table_iter_remove (&hash_iter);
+        changed = TRUE;
+    }
+
+    if (changed)
+        self->generation = next;
+}
+
+guint64
+mm_modem_status_tracker_get_generation (MMModemStatusTracker *self)
+{
+    return self->generation;
+}
+
+/*****************************************************************************/
+
+static GVariant *
+build_record (const gchar *path,
+              Entry *entry)
+{
+    GVariantBuilder builder;
+    GVariantIter iter;
+    const gchar *key;
+    GVariant *value;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&builder, "{sv}", "path", g_variant_new_object_path (path));
+    g_variant_builder_add (&builder, "{sv}", "generation", g_variant_new_uint64 (entry->generation));
+
+    g_variant_iter_init (&iter, entry->record);
+    while (g_variant_iter_next (&iter, "{&sv}", &key, &value)) {
+        g_variant_builder_add (&builder, "{sv}", key, value);
+        g_variant_unref (value);
+    }
+
+    return g_variant_builder_end (&builder);
+}
+
+GVariant *
+mm_modem_status_tracker_get_changes (MMModemStatusTracker *self,
+                                     guint64 since,
+                                     gboolean *out_complete,
+                                     GVariant **out_removed)
+{
+    GVariantBuilder builder;
+    GVariantBuilder removed_builder;
+    GHashTableIter hash_iter;
+    const gchar *path;
+    Entry *entry;
+    gboolean complete;
+    GList *l;
+
+    /* Generations from a previous daemon run are never valid */
+    complete = (since == 0 || since < self->horizon || since > self->generation);
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+    g_hash_table_iter_init (&hash_iter, self->entries);
+    while (g_hash_table_iter_next (&hash_iter, (gpointer *)&path, (gpointer *)&entry)) {
+        if (complete || entry->generation > since)
+            g_variant_builder_add_value (&builder, build_record (path, entry));
+    }
+
+    g_variant_builder_init (&removed_builder, G_VARIANT_TYPE ("ao"));
+    if (!complete) {
+        for (l = self->removed.head; l; l = g_list_next (l)) {
+            Removed *removed = l->data;
+
+            if (removed->generation > since)
+                g_variant_builder_add (&removed_builder, "o", removed->path);
+        }
+    }
+
+    if (out_complete)
+        *out_complete = complete;
+    if (out_removed)
+        *out_removed = g_variant_builder_end (&removed_builder);
+    else
+        g_variant_builder_clear (&removed_builder);
+
+    return g_variant_builder_end (&builder);
+}
+
+/*****************************************************************************/
+
+MMModemStatusTracker *
+mm_modem_status_tracker_new (void)
+{
+    MMModemStatusTracker *self;
+
+    self = g_new0 (MMModemStatusTracker, 1);
+    self->entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)entry_free);
+    g_queue_init (&self->removed);
+    return self;
+}
+
+void
+mm_modem_status_tracker_free (MMModemStatusTracker *self)
+{
+    g_hash_table_unref (self->entries);
+    g_queue_foreach (&self->removed, (GFunc)removed_free, NULL);
+    g_queue_clear (&self->removed);
+    g_free (self);
+}
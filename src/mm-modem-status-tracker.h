@@ -0,0 +1,50 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#ifndef MM_MODEM_STATUS_TRACKER_H
+#define MM_MODEM_STATUS_TRACKER_H
+
+#include <glib.h>
+
+/*****************************************************************************/
+/* Change tracking of per-modem status records.
+ *
+ * Every time the tracker is refreshed with the current records, the ones that
+ * changed (or appeared, or went away) get tagged with a new generation number,
+ * so that clients can ask only for the changes since the last generation they
+ * saw. */
+
+typedef struct _MMModemStatusTracker MMModemStatusTracker;
+
+MMModemStatusTracker *mm_modem_status_tracker_new  (void);
+void                  mm_modem_status_tracker_free (MMModemStatusTracker *self);
+
+/* @records is a{oa{sv}} with the status of all the current modems; any modem
+ * previously known and not given here is considered removed. */
+void mm_modem_status_tracker_refresh (MMModemStatusTracker *self,
+                                      GVariant             *records);
+
+guint64 mm_modem_status_tracker_get_generation (MMModemStatusTracker *self);
+
+/* Returns aa{sv} with the records changed after generation @since, each one
+ * including "path" and "generation" keys. If the changes since @since are not
+ * known (e.g. @since is 0), all records are returned and @out_complete is set
+ * to TRUE. */
+GVariant *mm_modem_status_tracker_get_changes (MMModemStatusTracker  *self,
+                                               guint64                since,
+                                               gboolean              *out_complete,
+                                               GVariant             **out_removed);
+
+#endif /* MM_MODEM_STATUS_TRACKER_H */
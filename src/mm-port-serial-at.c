@@ -432,6 +432,33 @@ mm_port_serial_at_command (MMPortSerialAt *self,
     g_byte_array_unref (buf);
 }
 
+void
+mm_port_serial_at_set_cached_reply (MMPortSerialAt *self,
+                                    const gchar *command,
+                                    const gchar *reply)
+{
+    GByteArray *buf;
+    GByteArray *response;
+
+    g_return_if_fail (MM_IS_PORT_SERIAL_AT (self));
+    g_return_if_fail (command != NULL);
+    g_return_if_fail (reply != NULL);
+
+    /* Build the command exactly as mm_port_serial_at_command() would */
+    buf = at_command_to_byte_array (command,
+                                    FALSE,
+                                    (mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY ?
+                                     self->priv->send_lf :
+                                     TRUE));
+    g_return_if_fail (buf != NULL);
+
+    response = g_byte_array_sized_new (strlen (reply));
+    g_byte_array_append (response, (const guint8 *) reply, strlen (reply));
+    mm_port_serial_set_cached_reply (MM_PORT_SERIAL (self), buf, response);
+    g_byte_array_unref (response);
+    g_byte_array_unref (buf);
+}
+
 static void
 debug_log (MMPortSerial *port, const char *prefix, const char *buf, gsize len)
 {
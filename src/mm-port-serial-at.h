@@ -107,6 +107,12 @@ const gchar *mm_port_serial_at_command_finish (MMPortSerialAt *self,
                                                GAsyncResult *res,
                                                GError **error);
 
+/* Seed the reply cache for the given command, e.g. with one of the replies
+ * to a compound command line */
+void         mm_port_serial_at_set_cached_reply (MMPortSerialAt *self,
+                                                 const gchar *command,
+                                                 const gchar *reply);
+
 /*
  * Convert a string into a quoted and escaped string. Returns a new
  * allocated string. Follows ITU V.250 5.4.2.2 "String constants".
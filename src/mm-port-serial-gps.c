@@ -18,6 +18,10 @@
 #include <unistd.h>
 #include <string.h>
 
+#include <ModemManager.h>
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
+
 #include "mm-port-serial-gps.h"
 #include "mm-log.h"
 
@@ -28,9 +32,6 @@ struct _MMPortSerialGpsPrivate {
     MMPortSerialGpsTraceFn callback;
     gpointer user_data;
     GDestroyNotify notify;
-
-    /* Regex for all known traces */
-    GRegex *known_traces_regex;
 };
 
 /*****************************************************************************/
@@ -53,21 +54,6 @@ mm_port_serial_gps_add_trace_handler (MMPortSerialGps *self,
 
 /*****************************************************************************/
 
-static gboolean
-remove_eval_cb (const GMatchInfo *match_info,
-                GString *result,
-                gpointer user_data)
-{
-    int *result_len = (int *) user_data;
-    int start;
-    int end;
-
-    if (g_match_info_fetch_pos  (match_info, 0, &start, &end))
-        *result_len -= (end - start);
-
-    return FALSE;
-}
-
 static MMPortSerialResponseType
 parse_response (MMPortSerial *port,
                 GByteArray *response,
@@ -75,61 +61,77 @@ parse_response (MMPortSerial *port,
                 GError **error)
 {
     MMPortSerialGps *self = MM_PORT_SERIAL_GPS (port);
-    gboolean matches;
-    GMatchInfo *match_info;
-    gchar *str;
-    gint result_len;
-    guint i;
-
-    for (i = 0; i < response->len; i++) {
-        /* If there is any content before the first $,
-         * assume it's garbage, and skip it */
-        if (response->data[i] == '$') {
-            if (i > 0)
-                g_byte_array_remove_range (response, 0, i);
-            /* else, good, we're already started with $ */
-            break;
+    GByteArray *other;
+    gsize data_len;
+    gsize offset = 0;
+    gsize start;
+    gsize end;
+    gboolean found = FALSE;
+    guint8 *dollar;
+
+    /* If there is any content before the first $,
+     * assume it's garbage, and skip it */
+    dollar = memchr (response->data, '$', response->len);
+    if (dollar && dollar != response->data)
+        g_byte_array_remove_range (response, 0, dollar - response->data);
+
+    /* Traces are given to the handler in place, so make sure there is always
+     * room to NUL-terminate the last one */
+    data_len = response->len;
+    g_byte_array_append (response, (const guint8 *) "", 1);
+
+    other = g_byte_array_new ();
+    while (mm_nmea_trace_find ((const gchar *) &response->data[offset],
+                               data_len - offset,
+                               &start,
+                               &end)) {
+        gchar *trace;
+        guint8 next;
+
+        start += offset;
+        end += offset;
+        found = TRUE;
+
+        /* Whatever was before the trace isn't part of it */
+        if (start > offset)
+            g_byte_array_append (other, &response->data[offset], start - offset);
+        offset = end;
+
+        trace = (gchar *) &response->data[start];
+        if (!mm_nmea_trace_validate (trace, end - start)) {
+            mm_dbg ("(%s): ignoring NMEA trace with wrong checksum",
+                    mm_port_get_device (MM_PORT (self)));
+            continue;
         }
-    }
 
-    matches = g_regex_match_full (self->priv->known_traces_regex,
-                                  (const gchar *) response->data,
-                                  response->len,
-                                  0, 0, &match_info, NULL);
-
-    if (self->priv->callback) {
-        while (g_match_info_matches (match_info)) {
-            gchar *trace;
-
-            trace = g_match_info_fetch (match_info, 0);
-            if (trace) {
-                self->priv->callback (self, trace, self->priv->user_data);
-                g_free (trace);
-            }
-            g_match_info_next (match_info, NULL);
+        if (self->priv->callback) {
+            next = response->data[end];
+            response->data[end] = '\0';
+            self->priv->callback (self, trace, self->priv->user_data);
+            response->data[end] = next;
         }
     }
 
-    g_match_info_free (match_info);
+    g_byte_array_set_size (response, data_len);
 
-    if (!matches)
+    if (!found) {
+        g_byte_array_unref (other);
         return MM_PORT_SERIAL_RESPONSE_NONE;
+    }
 
-    /* Remove matches */
-    result_len = response->len;
-    str = g_regex_replace_eval (self->priv->known_traces_regex,
-                                (const char *) response->data,
-                                response->len,
-                                0, 0,
-                                remove_eval_cb, &result_len, NULL);
-
-    /* Cleanup response buffer */
-    g_byte_array_remove_range (response, 0, response->len);
-
-    /* Build parsed response */
-    *parsed_response = g_byte_array_new_take ((guint8 *)str, result_len);
+    /* Leave the last incomplete trace, if any, in the buffer */
+    dollar = memchr (&response->data[offset], '$', data_len - offset);
+    if (dollar) {
+        g_byte_array_append (other, &response->data[offset], dollar - &response->data[offset]);
+        offset = dollar - response->data;
+    } else {
+        g_byte_array_append (other, &response->data[offset], data_len - offset);
+        offset = data_len;
+    }
+    g_byte_array_remove_range (response, 0, offset);
 
-    return TRUE;
+    *parsed_response = other;
+    return MM_PORT_SERIAL_RESPONSE_BUFFER;
 }
 
 /*****************************************************************************/
@@ -183,13 +185,6 @@ mm_port_serial_gps_init (MMPortSerialGps *self)
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                                               MM_TYPE_PORT_SERIAL_GPS,
                                               MMPortSerialGpsPrivate);
-
-    /* We'll assume that all traces start with the dollar sign and end with \r\n */
-    self->priv->known_traces_regex =
-        g_regex_new ("\\$.*\\r\\n",
-                     G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                     0,
-                     NULL);
 }
 
 static void
@@ -200,8 +195,6 @@ finalize (GObject *object)
     if (self->priv->notify)
         self->priv->notify (self->priv->user_data);
 
-    g_regex_unref (self->priv->known_traces_regex);
-
     G_OBJECT_CLASS (mm_port_serial_gps_parent_class)->finalize (object);
 }
 
@@ -624,6 +624,14 @@ port_serial_set_cached_reply (MMPortSerial *self,
         g_hash_table_remove (self->priv->reply_cache, command);
 }
 
+void
+mm_port_serial_set_cached_reply (MMPortSerial *self,
+                                 const GByteArray *command,
+                                 const GByteArray *response)
+{
+    port_serial_set_cached_reply (self, command, response);
+}
+
 static const GByteArray *
 port_serial_get_cached_reply (MMPortSerial *self,
                               GByteArray *command)
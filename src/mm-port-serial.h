@@ -150,6 +150,12 @@ GByteArray *mm_port_serial_command_finish (MMPortSerial *self,
                                            GAsyncResult *res,
                                            GError **error);
 
+/* Store a reply for a given command, as if it had been received from the
+ * port; it will be used by commands allowing cached replies. */
+void mm_port_serial_set_cached_reply (MMPortSerial *self,
+                                      const GByteArray *command,
+                                      const GByteArray *response);
+
 gboolean mm_port_serial_set_flow_control (MMPortSerial   *self,
                                           MMFlowControl   flow_control,
                                           GError        **error);
@@ -0,0 +1,380 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <string.h>
+
+#include "mm-properties-coalescer.h"
+#include "mm-log.h"
+
+#define DBUS_PROPERTIES_INTERFACE "org.freedesktop.DBus.Properties"
+#define DBUS_PROPERTIES_CHANGED   "PropertiesChanged"
+
+/* Merged changes of a single interface */
+typedef struct {
+    gchar *interface_name;
+    /* Property name -> GVariant */
+    GHashTable *changed;
+    /* Property name -> Property name */
+    GHashTable *invalidated;
+} Pending;
+
+/* State shared with the filter, which runs in the GDBus worker thread */
+typedef struct {
+    volatile gint ref_count;
+    GMutex mutex;
+    gchar *object_path;
+    gboolean held;
+    /* Pending, in the order the interfaces were first changed */
+    GQueue pending;
+    /* GDBusMessage -> Pending; signals sent on release, which are filled in
+     * with the merged changes when they go through the filter, so that they
+     * are never sent after (and overwrite) a newer change */
+    GHashTable *releases;
+    guint n_received;
+    guint n_emitted;
+} Shared;
+
+struct _MMPropertiesCoalescer {
+    GDBusConnection *connection;
+    guint filter_id;
+    Shared *shared;
+    guint hold_count;
+    guint hold_timeout_id;
+};
+
+/*****************************************************************************/
+
+static void
+pending_free (Pending *pending)
+{
+    g_free (pending->interface_name);
+    g_hash_table_unref (pending->changed);
+    g_hash_table_unref (pending->invalidated);
+    g_free (pending);
+}
+
+static Pending *
+pending_lookup (Shared *shared,
+                const gchar *interface_name,
+                gboolean create)
+{
+    Pending *pending;
+    GList *l;
+
+    for (l = shared->pending.head; l; l = g_list_next (l)) {
+        pending = l->data;
+        if (g_str_equal (pending->interface_name, interface_name))
+            return pending;
+    }
+
+    if (!create)
+        return NULL;
+
+    pending = g_new0 (Pending, 1);
+    pending->interface_name = g_strdup (interface_name);
+    pending->changed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_variant_unref);
+    pending->invalidated = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    g_queue_push_tail (&shared->pending, pending);
+    return pending;
+}
+
+static void
+pending_merge (Pending *pending,
+               GVariant *changed,
+               const gchar **invalidated)
+{
+    GVariantIter iter;
+    const gchar *name;
+    GVariant *value;
+    guint i;
+
+    g_variant_iter_init (&iter, changed);
+    while (g_variant_iter_next (&iter, "{&sv}", &name, &value)) {
+        g_hash_table_remove (pending->invalidated, name);
+        g_hash_table_replace (pending->changed, g_strdup (name), value);
+    }
+
+    for (i = 0; invalidated && invalidated[i]; i++) {
+        gchar *aux;
+
+        g_hash_table_remove (pending->changed, invalidated[i]);
+        aux = g_strdup (invalidated[i]);
+        g_hash_table_replace (pending->invalidated, aux, aux);
+    }
+}
+
+static GVariant *
+pending_build_body (Pending *pending)
+{
+    GVariantBuilder changed;
+    GVariantBuilder invalidated;
+    GHashTableIter iter;
+    const gchar *name;
+    GVariant *value;
+
+    g_variant_builder_init (&changed, G_VARIANT_TYPE ("a{sv}"));
+    g_hash_table_iter_init (&iter, pending->changed);
+    while (g_hash_table_iter_next (&iter, (gpointer *)&name, (gpointer *)&value))
+        g_variant_builder_add (&changed, "{sv}", name, value);
+
+    g_variant_builder_init (&invalidated, G_VARIANT_TYPE ("as"));
+    g_hash_table_iter_init (&iter, pending->invalidated);
+    while (g_hash_table_iter_next (&iter, (gpointer *)&name, NULL))
+        g_variant_builder_add (&invalidated, "s", name);
+
+    return g_variant_new ("(sa{sv}as)", pending->interface_name, &changed, &invalidated);
+}
+
+/*****************************************************************************/
+
+static Shared *
+shared_ref (Shared *shared)
+{
+    g_atomic_int_inc (&shared->ref_count);
+    return shared;
+}
+
+static void
+shared_unref (Shared *shared)
+{
+    if (g_atomic_int_dec_and_test (&shared->ref_count)) {
+        g_queue_foreach (&shared->pending, (GFunc)pending_free, NULL);
+        g_queue_clear (&shared->pending);
+        g_hash_table_unref (shared->releases);
+        g_free (shared->object_path);
+        g_mutex_clear (&shared->mutex);
+        g_free (shared);
+    }
+}
+
+static gboolean
+is_properties_changed (Shared *shared,
+                       GDBusMessage *message)
+{
+    return (g_dbus_message_get_message_type (message) == G_DBUS_MESSAGE_TYPE_SIGNAL &&
+            !g_strcmp0 (g_dbus_message_get_member (message), DBUS_PROPERTIES_CHANGED) &&
+            !g_strcmp0 (g_dbus_message_get_interface (message), DBUS_PROPERTIES_INTERFACE) &&
+            !g_strcmp0 (g_dbus_message_get_path (message), shared->object_path));
+}
+
+/* Runs in the GDBus worker thread */
+static GDBusMessage *
+filter_cb (GDBusConnection *connection,
+           GDBusMessage *message,
+           gboolean incoming,
+           Shared *shared)
+{
+    const gchar *interface_name;
+    const gchar **invalidated;
+    GVariant *changed;
+    GVariant *body;
+    Pending *pending;
+
+    if (incoming || !is_properties_changed (shared, message))
+        return message;
+
+    g_mutex_lock (&shared->mutex);
+
+    /* One of our own signals with merged changes */
+    pending = g_hash_table_lookup (shared->releases, message);
+    if (pending) {
+        GDBusMessage *copy;
+
+        g_hash_table_remove (shared->releases, message);
+        g_queue_remove (&shared->pending, pending);
+        copy = g_dbus_message_copy (message, NULL);
+        if (copy) {
+            g_dbus_message_set_body (copy, pending_build_body (pending));
+            shared->n_emitted++;
+        }
+        pending_free (pending);
+        g_mutex_unlock (&shared->mutex);
+        g_object_unref (message);
+        return copy;
+    }
+
+    shared->n_received++;
+
+    body = g_dbus_message_get_body (message);
+    if (!body || !g_variant_is_of_type (body, G_VARIANT_TYPE ("(sa{sv}as)"))) {
+        shared->n_emitted++;
+        g_mutex_unlock (&shared->mutex);
+        return message;
+    }
+
+    g_variant_get (body, "(&s@a{sv}^a&s)", &interface_name, &changed, &invalidated);
+
+    /* Merge if held, or if a release of the same interface is on its way */
+    pending = pending_lookup (shared, interface_name, shared->held);
+    if (pending) {
+        pending_merge (pending, changed, invalidated);
+        g_object_unref (message);
+        message = NULL;
+    } else
+        shared->n_emitted++;
+
+    g_variant_unref (changed);
+    g_free (invalidated);
+    g_mutex_unlock (&shared->mutex);
+    return message;
+}
+
+/*****************************************************************************/
+
+static gboolean
+release_matches (GDBusMessage *message,
+                 Pending *pending,
+                 Pending *target)
+{
+    return pending == target;
+}
+
+static void
+release_now (MMPropertiesCoalescer *self)
+{
+    Shared *shared = self->shared;
+    GList *messages = NULL;
+    GList *l;
+
+    g_mutex_lock (&shared->mutex);
+    shared->held = FALSE;
+    for (l = shared->pending.head; l; l = g_list_next (l)) {
+        Pending *pending = l->data;
+        GDBusMessage *message;
+
+        /* Already being released */
+        if (g_hash_table_find (shared->releases, (GHRFunc)release_matches, pending))
+            continue;
+
+        message = g_dbus_message_new_signal (shared->object_path,
+                                             DBUS_PROPERTIES_INTERFACE,
+                                             DBUS_PROPERTIES_CHANGED);
+        g_dbus_message_set_body (message, pending_build_body (pending));
+        /* Both the table and the list below own a reference */
+        g_hash_table_insert (shared->releases, g_object_ref (message), pending);
+        messages = g_list_append (messages, message);
+    }
+    g_mutex_unlock (&shared->mutex);
+
+    for (l = messages; l; l = g_list_next (l))
+        g_dbus_connection_send_message (self->connection,
+                                        G_DBUS_MESSAGE (l->data),
+                                        G_DBUS_SEND_MESSAGE_FLAGS_NONE,
+                                        NULL,
+                                        NULL);
+    g_list_free_full (messages, g_object_unref);
+}
+
+static gboolean
+hold_timeout_cb (MMPropertiesCoalescer *self)
+{
+    mm_dbg ("Property updates held for too long in '%s', releasing",
+            self->shared->object_path);
+    self->hold_timeout_id = 0;
+    self->hold_count = 0;
+    release_now (self);
+    return G_SOURCE_REMOVE;
+}
+
+void
+mm_properties_coalescer_hold (MMPropertiesCoalescer *self)
+{
+    if (self->hold_count++ > 0)
+        return;
+
+    g_mutex_lock (&self->shared->mutex);
+    self->shared->held = TRUE;
+    g_mutex_unlock (&self->shared->mutex);
+
+    self->hold_timeout_id = g_timeout_add (MM_PROPERTIES_COALESCER_MAX_HOLD_MS,
+                                           (GSourceFunc)hold_timeout_cb,
+                                           self);
+}
+
+void
+mm_properties_coalescer_release (MMPropertiesCoalescer *self)
+{
+    /* Already released by the timeout */
+    if (self->hold_count == 0)
+        return;
+
+    if (--self->hold_count > 0)
+        return;
+
+    if (self->hold_timeout_id) {
+        g_source_remove (self->hold_timeout_id);
+        self->hold_timeout_id = 0;
+    }
+    release_now (self);
+}
+
+void
+mm_properties_coalescer_get_stats (MMPropertiesCoalescer *self,
+                                   guint *n_received,
+                                   guint *n_emitted)
+{
+    g_mutex_lock (&self->shared->mutex);
+    if (n_received)
+        *n_received = self->shared->n_received;
+    if (n_emitted)
+        *n_emitted = self->shared->n_emitted;
+    g_mutex_unlock (&self->shared->mutex);
+}
+
+/*****************************************************************************/
+
+MMPropertiesCoalescer *
+mm_properties_coalescer_new (GDBusConnection *connection,
+                             const gchar *object_path)
+{
+    MMPropertiesCoalescer *self;
+
+    self = g_new0 (MMPropertiesCoalescer, 1);
+    self->connection = g_object_ref (connection);
+
+    self->shared = g_new0 (Shared, 1);
+    self->shared->ref_count = 1;
+    g_mutex_init (&self->shared->mutex);
+    self->shared->object_path = g_strdup (object_path);
+    g_queue_init (&self->shared->pending);
+    self->shared->releases = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
+
+    /* The filter may still run after being removed, so it keeps its own
+     * reference to the shared state */
+    self->filter_id = g_dbus_connection_add_filter (connection,
+                                                    (GDBusMessageFilterFunction)filter_cb,
+                                                    shared_ref (self->shared),
+                                                    (GDestroyNotify)shared_unref);
+    return self;
+}
+
+void
+mm_properties_coalescer_free (MMPropertiesCoalescer *self)
+{
+    /* Don't lose whatever was held */
+    if (self->hold_count > 0) {
+        self->hold_count = 0;
+        if (self->hold_timeout_id) {
+            g_source_remove (self->hold_timeout_id);
+            self->hold_timeout_id = 0;
+        }
+        release_now (self);
+    }
+
+    g_dbus_connection_remove_filter (self->connection, self->filter_id);
+    shared_unref (self->shared);
+    g_object_unref (self->connection);
+    g_free (self);
+}
@@ -0,0 +1,53 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#ifndef MM_PROPERTIES_COALESCER_H
+#define MM_PROPERTIES_COALESCER_H
+
+#include <gio/gio.h>
+
+/*****************************************************************************/
+/* Coalescing of PropertiesChanged signals.
+ *
+ * The interface skeletons already merge all property changes done within the
+ * same main loop iteration into a single PropertiesChanged signal per
+ * interface, but related updates (e.g. registration state and the operator
+ * info loaded afterwards) usually span several iterations. While held, the
+ * PropertiesChanged signals emitted for the given object path are kept back
+ * and merged, and sent once released, one per interface.
+ *
+ * The values exposed in the skeletons are updated right away; only the
+ * signals are delayed. */
+
+typedef struct _MMPropertiesCoalescer MMPropertiesCoalescer;
+
+MMPropertiesCoalescer *mm_properties_coalescer_new  (GDBusConnection *connection,
+                                                     const gchar     *object_path);
+void                   mm_properties_coalescer_free (MMPropertiesCoalescer *self);
+
+/* Holds may be nested; signals are released when the last hold is released,
+ * or after MM_PROPERTIES_COALESCER_MAX_HOLD_MS in any case. */
+#define MM_PROPERTIES_COALESCER_MAX_HOLD_MS 1000
+
+void mm_properties_coalescer_hold    (MMPropertiesCoalescer *self);
+void mm_properties_coalescer_release (MMPropertiesCoalescer *self);
+
+/* Number of PropertiesChanged signals emitted by the skeletons, and number of
+ * them actually sent to the bus */
+void mm_properties_coalescer_get_stats (MMPropertiesCoalescer *self,
+                                        guint                 *n_received,
+                                        guint                 *n_emitted);
+
+#endif /* MM_PROPERTIES_COALESCER_H */
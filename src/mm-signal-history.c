@@ -0,0 +1,147 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include "mm-signal-history.h"
+
+typedef struct {
+    guint64 sequence;
+    guint64 timestamp;
+    guint32 access_technology;
+    gint16 rssi;
+    gint16 rsrp;
+    gint16 rsrq;
+    gint16 snr;
+    gint16 ecio;
+} Sample;
+
+struct _MMSignalHistory {
+    Sample *samples;
+    guint max_samples;
+    /* Index of the oldest sample */
+    guint first;
+    guint n_samples;
+    /* Sequence number of the next sample added */
+    guint64 next_sequence;
+};
+
+/*****************************************************************************/
+
+static gint16
+pack_value (gdouble value)
+{
+    gdouble tenths;
+
+    if (value == MM_SIGNAL_UNKNOWN)
+        return MM_SIGNAL_HISTORY_VALUE_UNKNOWN;
+
+    /* Out of range values are clamped, never reported as unknown */
+    tenths = value * 10.0;
+    tenths += (tenths < 0 ? -0.5 : 0.5);
+    if (tenths <= (gdouble)(G_MININT16 + 1))
+        return G_MININT16 + 1;
+    if (tenths >= (gdouble)G_MAXINT16)
+        return G_MAXINT16;
+    return (gint16)tenths;
+}
+
+void
+mm_signal_history_add (MMSignalHistory *self,
+                       guint64 timestamp,
+                       MMModemAccessTechnology access_technology,
+                       MMSignal *signal)
+{
+    Sample *sample;
+
+    if (self->n_samples < self->max_samples)
+        sample = &self->samples[(self->first + self->n_samples++) % self->max_samples];
+    else {
+        sample = &self->samples[self->first];
+        self->first = (self->first + 1) % self->max_samples;
+    }
+
+    sample->sequence = self->next_sequence++;
+    sample->timestamp = timestamp;
+    sample->access_technology = access_technology;
+    sample->rssi = pack_value (mm_signal_get_rssi (signal));
+    sample->rsrp = pack_value (mm_signal_get_rsrp (signal));
+    sample->rsrq = pack_value (mm_signal_get_rsrq (signal));
+    sample->snr  = pack_value (mm_signal_get_snr  (signal));
+    sample->ecio = pack_value (mm_signal_get_ecio (signal));
+}
+
+guint
+mm_signal_history_get_n_samples (MMSignalHistory *self)
+{
+    return self->n_samples;
+}
+
+GVariant *
+mm_signal_history_get_samples (MMSignalHistory *self,
+                               guint64 since)
+{
+    GVariantBuilder builder;
+    guint64 oldest;
+    guint i = 0;
+
+    /* Sequence numbers of the samples kept are consecutive, so the first one
+     * after @since is found right away */
+    if (self->n_samples > 0) {
+        oldest = self->samples[self->first].sequence;
+        if (since >= oldest)
+            i = (since - oldest + 1 < self->n_samples ?
+                 (guint)(since - oldest + 1) :
+                 self->n_samples);
+    }
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ttunnnnn)"));
+    for (; i < self->n_samples; i++) {
+        const Sample *sample;
+
+        sample = &self->samples[(self->first + i) % self->max_samples];
+        g_variant_builder_add (&builder, "(ttunnnnn)",
+                               sample->sequence,
+                               sample->timestamp,
+                               sample->access_technology,
+                               sample->rssi,
+                               sample->rsrp,
+                               sample->rsrq,
+                               sample->snr,
+                               sample->ecio);
+    }
+    return g_variant_builder_end (&builder);
+}
+
+/*****************************************************************************/
+
+MMSignalHistory *
+mm_signal_history_new (guint max_samples)
+{
+    MMSignalHistory *self;
+
+    g_return_val_if_fail (max_samples > 0, NULL);
+
+    self = g_new0 (MMSignalHistory, 1);
+    self->max_samples = max_samples;
+    self->samples = g_new0 (Sample, max_samples);
+    self->next_sequence = 1;
+    return self;
+}
+
+void
+mm_signal_history_free (MMSignalHistory *self)
+{
+    g_free (self->samples);
+    g_free (self);
+}
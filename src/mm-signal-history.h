@@ -0,0 +1,60 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#ifndef MM_SIGNAL_HISTORY_H
+#define MM_SIGNAL_HISTORY_H
+
+#include <glib.h>
+
+#include <ModemManager.h>
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
+
+/*****************************************************************************/
+/* Fixed-size history of extended signal quality samples.
+ *
+ * Values are stored in tenths of dB in 16-bit integers, with
+ * MM_SIGNAL_HISTORY_VALUE_UNKNOWN for the ones not reported; once full, each
+ * new sample overwrites the oldest one. */
+
+/* One sample is stored per access technology in each load, so the time
+ * covered depends on how many of them the modem reports: e.g. one hour at a
+ * 5s rate with a single one, half that with two. */
+#define MM_SIGNAL_HISTORY_DEFAULT_SIZE  720
+#define MM_SIGNAL_HISTORY_VALUE_UNKNOWN G_MININT16
+
+typedef struct _MMSignalHistory MMSignalHistory;
+
+MMSignalHistory *mm_signal_history_new  (guint max_samples);
+void             mm_signal_history_free (MMSignalHistory *self);
+
+/* Each sample gets a sequence number, starting at 1 and increased by one on
+ * every sample added. @timestamp is in milliseconds since the epoch and only
+ * kept as data: it is wall clock time, so it may go backwards if the system
+ * clock is changed. */
+void mm_signal_history_add (MMSignalHistory         *self,
+                            guint64                  timestamp,
+                            MMModemAccessTechnology  access_technology,
+                            MMSignal                *signal);
+
+guint mm_signal_history_get_n_samples (MMSignalHistory *self);
+
+/* Returns a(ttunnnnn) with the sequence number, timestamp, access technology,
+ * RSSI, RSRP, RSRQ, SNR and Ec/Io of all samples with a sequence number
+ * greater than @since, in the order they were added. */
+GVariant *mm_signal_history_get_samples (MMSignalHistory *self,
+                                         guint64          since);
+
+#endif /* MM_SIGNAL_HISTORY_H */
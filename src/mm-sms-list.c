@@ -50,8 +50,192 @@ struct _MMSmsListPrivate {
     MMBaseModem *modem;
     /* List of sms objects */
     GList *list;
+    /* Indexes on the list contents:
+     *  - DBus path to list link
+     *  - (storage, part index) to SMS
+     *  - (pdu type, number, multipart reference) to SMS
+     *  - SMS to the keys it was indexed with, so that updates only touch
+     *    the entries of that SMS
+     */
+    GHashTable *by_path;
+    GHashTable *by_part;
+    GHashTable *by_concat;
+    GHashTable *by_sms;
+    /* Whether new SMS objects are exported on demand */
+    gboolean lazy_export;
 };
 
+/*****************************************************************************/
+/* Indexes */
+
+static gint64 *
+build_part_key (MMSmsStorage storage,
+                guint        index)
+{
+    gint64 *key;
+
+    key = g_new (gint64, 1);
+    *key = (((gint64) storage) << 32) | index;
+    return key;
+}
+
+static gchar *
+build_concat_key (MMSmsPduType  pdu_type,
+                  const gchar  *number,
+                  guint         reference)
+{
+    return g_strdup_printf ("%u|%s|%u", pdu_type, number ? number : "", reference);
+}
+
+typedef struct {
+    GList  *link;
+    gchar  *path;
+    GArray *part_keys;
+    gchar  *concat_key;
+} SmsIndexEntry;
+
+static void
+sms_index_entry_free (SmsIndexEntry *entry)
+{
+    g_free (entry->path);
+    g_array_unref (entry->part_keys);
+    g_free (entry->concat_key);
+    g_slice_free (SmsIndexEntry, entry);
+}
+
+static void
+sms_index_add_part (MMSmsList     *self,
+                    MMBaseSms     *sms,
+                    SmsIndexEntry *entry,
+                    MMSmsStorage   storage,
+                    guint          index)
+{
+    gint64 *key;
+
+    if (storage == MM_SMS_STORAGE_UNKNOWN || index == SMS_PART_INVALID_INDEX)
+        return;
+
+    key = build_part_key (storage, index);
+    g_array_append_val (entry->part_keys, *key);
+    g_hash_table_insert (self->priv->by_part, key, sms);
+}
+
+static void
+sms_index_update (MMSmsList     *self,
+                  MMBaseSms     *sms,
+                  SmsIndexEntry *entry)
+{
+    MMSmsStorage  storage;
+    GList        *l;
+
+    if (mm_base_sms_get_path (sms)) {
+        entry->path = g_strdup (mm_base_sms_get_path (sms));
+        g_hash_table_insert (self->priv->by_path, g_strdup (entry->path), entry->link);
+    }
+
+    storage = mm_base_sms_get_storage (sms);
+    for (l = mm_base_sms_get_parts (sms); l; l = g_list_next (l))
+        sms_index_add_part (self, sms, entry, storage, mm_sms_part_get_index ((MMSmsPart *)l->data));
+
+    if (mm_base_sms_is_multipart (sms) && mm_base_sms_get_parts (sms)) {
+        MMSmsPart *first;
+
+        first = (MMSmsPart *) mm_base_sms_get_parts (sms)->data;
+        entry->concat_key = build_concat_key (mm_sms_part_get_pdu_type (first),
+                                              mm_sms_part_get_number (first),
+                                              mm_base_sms_get_multipart_reference (sms));
+        g_hash_table_insert (self->priv->by_concat, g_strdup (entry->concat_key), sms);
+    }
+}
+
+static void
+sms_index_remove (MMSmsList     *self,
+                  MMBaseSms     *sms,
+                  SmsIndexEntry *entry)
+{
+    guint i;
+
+    /* Use the keys the SMS was indexed with, as the part indexes and path
+     * may have already been reset, e.g. after deleting the SMS. Keys now
+     * owned by a different SMS are left alone. */
+    if (entry->path && g_hash_table_lookup (self->priv->by_path, entry->path) == entry->link)
+        g_hash_table_remove (self->priv->by_path, entry->path);
+    g_clear_pointer (&entry->path, g_free);
+
+    for (i = 0; i < entry->part_keys->len; i++) {
+        gint64 *key;
+
+        key = &g_array_index (entry->part_keys, gint64, i);
+        if (g_hash_table_lookup (self->priv->by_part, key) == sms)
+            g_hash_table_remove (self->priv->by_part, key);
+    }
+    g_array_set_size (entry->part_keys, 0);
+
+    if (entry->concat_key && g_hash_table_lookup (self->priv->by_concat, entry->concat_key) == sms)
+        g_hash_table_remove (self->priv->by_concat, entry->concat_key);
+    g_clear_pointer (&entry->concat_key, g_free);
+}
+
+static GList *
+find_link_by_path (MMSmsList   *self,
+                   const gchar *path)
+{
+    return (GList *) g_hash_table_lookup (self->priv->by_path, path);
+}
+
+static void
+sms_index_changed (MMBaseSms  *sms,
+                   GParamSpec *pspec,
+                   MMSmsList  *self)
+{
+    SmsIndexEntry *entry;
+
+    /* The path is set when exporting, and the storage and part indexes
+     * once stored, so refresh the indexes of this SMS. */
+    entry = g_hash_table_lookup (self->priv->by_sms, sms);
+    g_assert (entry);
+    sms_index_remove (self, sms, entry);
+    sms_index_update (self, sms, entry);
+}
+
+static void
+list_prepend (MMSmsList *self,
+              MMBaseSms *sms)
+{
+    SmsIndexEntry *entry;
+
+    self->priv->list = g_list_prepend (self->priv->list, sms);
+
+    entry = g_slice_new0 (SmsIndexEntry);
+    entry->link = self->priv->list;
+    entry->part_keys = g_array_new (FALSE, FALSE, sizeof (gint64));
+    g_hash_table_insert (self->priv->by_sms, sms, entry);
+    sms_index_update (self, sms, entry);
+
+    g_signal_connect (sms,
+                      "notify::" MM_BASE_SMS_PATH,
+                      G_CALLBACK (sms_index_changed),
+                      self);
+    g_signal_connect (sms,
+                      "notify::storage",
+                      G_CALLBACK (sms_index_changed),
+                      self);
+}
+
+static void
+list_delete_link (MMSmsList *self,
+                  GList     *link)
+{
+    MMBaseSms *sms;
+
+    sms = MM_BASE_SMS (link->data);
+    g_signal_handlers_disconnect_by_data (sms, self);
+    sms_index_remove (self, sms, g_hash_table_lookup (self->priv->by_sms, sms));
+    g_hash_table_remove (self->priv->by_sms, sms);
+    self->priv->list = g_list_delete_link (self->priv->list, link);
+    g_object_unref (sms);
+}
+
 /*****************************************************************************/
 
 gboolean
@@ -59,26 +243,22 @@ mm_sms_list_has_local_multipart_reference (MMSmsList *self,
                                            const gchar *number,
                                            guint8 reference)
 {
-    GList *l;
+    MMBaseSms *sms;
+    gchar *key;
 
     /* No one should look for multipart reference 0, which isn't valid */
     g_assert (reference != 0);
 
-    for (l = self->priv->list; l; l = g_list_next (l)) {
-        MMBaseSms *sms = MM_BASE_SMS (l->data);
+    key = build_concat_key (MM_SMS_PDU_TYPE_SUBMIT, number, reference);
+    sms = g_hash_table_lookup (self->priv->by_concat, key);
+    g_free (key);
 
-        if (mm_base_sms_is_multipart (sms) &&
+    /* Does the SMS list have a stored SMS with the same destination number
+     * and multipart reference? */
+    return (sms &&
             mm_gdbus_sms_get_pdu_type (MM_GDBUS_SMS (sms)) == MM_SMS_PDU_TYPE_SUBMIT &&
             mm_base_sms_get_storage (sms) != MM_SMS_STORAGE_UNKNOWN &&
-            mm_base_sms_get_multipart_reference (sms) == reference &&
-            g_str_equal (mm_gdbus_sms_get_number (MM_GDBUS_SMS (sms)), number)) {
-            /* Yes, the SMS list has an SMS with the same destination number
-             * and multipart reference */
-            return TRUE;
-        }
-    }
-
-    return FALSE;
+            !g_strcmp0 (mm_gdbus_sms_get_number (MM_GDBUS_SMS (sms)), number));
 }
 
 /*****************************************************************************/
@@ -89,6 +269,67 @@ mm_sms_list_get_count (MMSmsList *self)
     return g_list_length (self->priv->list);
 }
 
+MMBaseSms *
+mm_sms_list_get_sms (MMSmsList *self,
+                     const gchar *sms_path)
+{
+    GList *l;
+
+    l = find_link_by_path (self, sms_path);
+    return (l ? MM_BASE_SMS (l->data) : NULL);
+}
+
+GStrv
+mm_sms_list_get_paths_page (MMSmsList *self,
+                            guint offset,
+                            guint limit,
+                            guint state,
+                            guint storage,
+                            guint *n_matches)
+{
+    GPtrArray *paths;
+    GList *l;
+    guint n = 0;
+
+    paths = g_ptr_array_new ();
+
+    for (l = self->priv->list; l; l = g_list_next (l)) {
+        MMBaseSms *sms = MM_BASE_SMS (l->data);
+        const gchar *path;
+
+        path = mm_base_sms_get_path (sms);
+        if (!path)
+            continue;
+        if (state != MM_SMS_LIST_FILTER_ANY &&
+            mm_gdbus_sms_get_state (MM_GDBUS_SMS (sms)) != state)
+            continue;
+        if (storage != MM_SMS_LIST_FILTER_ANY &&
+            mm_base_sms_get_storage (sms) != storage)
+            continue;
+
+        /* Count all matches, but only return the requested page */
+        if (n >= offset && (!limit || paths->len < limit)) {
+            /* The caller is about to give the path away */
+            mm_base_sms_ensure_exported (sms);
+            g_ptr_array_add (paths, g_strdup (path));
+        }
+        n++;
+    }
+
+    if (n_matches)
+        *n_matches = n;
+
+    g_ptr_array_add (paths, NULL);
+    return (GStrv) g_ptr_array_free (paths, FALSE);
+}
+
+void
+mm_sms_list_set_lazy_export (MMSmsList *self,
+                             gboolean lazy)
+{
+    self->priv->lazy_export = lazy;
+}
+
 GStrv
 mm_sms_list_get_paths (MMSmsList *self)
 {
@@ -102,7 +343,10 @@ mm_sms_list_get_paths (MMSmsList *self)
     for (i = 0, l = self->priv->list; l; l = g_list_next (l)) {
         const gchar *path;
 
-        /* Don't try to add NULL paths (not yet exported SMS objects) */
+        /* Don't try to add NULL paths (not yet exported SMS objects), nor
+         * the ones only exported on demand */
+        if (mm_base_sms_get_lazy_export (MM_BASE_SMS (l->data)))
+            continue;
         path = mm_base_sms_get_path (MM_BASE_SMS (l->data));
         if (path)
             path_list[i++] = g_strdup (path);
@@ -121,13 +365,6 @@ mm_sms_list_delete_sms_finish (MMSmsList *self,
     return g_task_propagate_boolean (G_TASK (res), error);
 }
 
-static guint
-cmp_sms_by_path (MMBaseSms *sms,
-                 const gchar *path)
-{
-    return g_strcmp0 (mm_base_sms_get_path (sms), path);
-}
-
 static void
 delete_ready (MMBaseSms *sms,
               GAsyncResult *res,
@@ -148,13 +385,9 @@ delete_ready (MMBaseSms *sms,
     self = g_task_get_source_object (task);
     path = g_task_get_task_data (task);
     /* The SMS was properly deleted, we now remove it from our list */
-    l = g_list_find_custom (self->priv->list,
-                            path,
-                            (GCompareFunc)cmp_sms_by_path);
-    if (l) {
-        g_object_unref (MM_BASE_SMS (l->data));
-        self->priv->list = g_list_delete_link (self->priv->list, l);
-    }
+    l = find_link_by_path (self, path);
+    if (l)
+        list_delete_link (self, l);
 
     /* We don't need to unref the SMS any more, but we can use the
      * reference we got in the method, which is the one kept alive
@@ -178,9 +411,7 @@ mm_sms_list_delete_sms (MMSmsList *self,
     GList *l;
     GTask *task;
 
-    l = g_list_find_custom (self->priv->list,
-                            (gpointer)sms_path,
-                            (GCompareFunc)cmp_sms_by_path);
+    l = find_link_by_path (self, sms_path);
     if (!l) {
         g_task_report_new_error (self,
                                  callback,
@@ -208,7 +439,7 @@ void
 mm_sms_list_add_sms (MMSmsList *self,
                      MMBaseSms *sms)
 {
-    self->priv->list = g_list_prepend (self->priv->list, g_object_ref (sms));
+    list_prepend (self, g_object_ref (sms));
     g_signal_emit (self, signals[SIGNAL_ADDED], 0,
                    mm_base_sms_get_path (sms),
                    FALSE);
@@ -216,29 +447,6 @@ mm_sms_list_add_sms (MMSmsList *self,
 
 /*****************************************************************************/
 
-static guint
-cmp_sms_by_concat_reference (MMBaseSms *sms,
-                             gpointer user_data)
-{
-    if (!mm_base_sms_is_multipart (sms))
-        return -1;
-
-    return (GPOINTER_TO_UINT (user_data) - mm_base_sms_get_multipart_reference (sms));
-}
-
-typedef struct {
-    guint part_index;
-    MMSmsStorage storage;
-} PartIndexAndStorage;
-
-static guint
-cmp_sms_by_part_index_and_storage (MMBaseSms *sms,
-                                   PartIndexAndStorage *ctx)
-{
-    return !(mm_base_sms_get_storage (sms) == ctx->storage &&
-             mm_base_sms_has_part_index (sms, ctx->part_index));
-}
-
 static gboolean
 take_singlepart (MMSmsList *self,
                  MMSmsPart *part,
@@ -256,10 +464,15 @@ take_singlepart (MMSmsList *self,
     if (!sms)
         return FALSE;
 
-    self->priv->list = g_list_prepend (self->priv->list, sms);
-    g_signal_emit (self, signals[SIGNAL_ADDED], 0,
-                   mm_base_sms_get_path (sms),
-                   state == MM_SMS_STATE_RECEIVED);
+    mm_base_sms_set_lazy_export (sms, self->priv->lazy_export);
+    mm_base_sms_export (sms);
+
+    list_prepend (self, sms);
+    /* Objects exported on demand are only reported when listed */
+    if (!self->priv->lazy_export)
+        g_signal_emit (self, signals[SIGNAL_ADDED], 0,
+                       mm_base_sms_get_path (sms),
+                       state == MM_SMS_STATE_RECEIVED);
     return TRUE;
 }
 
@@ -270,17 +483,29 @@ take_multipart (MMSmsList *self,
                 MMSmsStorage storage,
                 GError **error)
 {
-    GList *l;
     MMBaseSms *sms;
     guint concat_reference;
+    gchar *key;
 
     concat_reference = mm_sms_part_get_concat_reference (part);
-    l = g_list_find_custom (self->priv->list,
-                            GUINT_TO_POINTER (concat_reference),
-                            (GCompareFunc)cmp_sms_by_concat_reference);
-    if (l)
+    key = build_concat_key (mm_sms_part_get_pdu_type (part),
+                            mm_sms_part_get_number (part),
+                            concat_reference);
+    sms = g_hash_table_lookup (self->priv->by_concat, key);
+    g_free (key);
+
+    if (sms) {
         /* Try to take the part */
-        return mm_base_sms_multipart_take_part (MM_BASE_SMS (l->data), part, error);
+        if (!mm_base_sms_multipart_take_part (sms, part, error))
+            return FALSE;
+
+        sms_index_add_part (self,
+                            sms,
+                            g_hash_table_lookup (self->priv->by_sms, sms),
+                            storage,
+                            mm_sms_part_get_index (part));
+        return TRUE;
+    }
 
     /* Create new Multipart */
     sms = mm_base_sms_multipart_new (self->priv->modem,
@@ -293,11 +518,20 @@ take_multipart (MMSmsList *self,
     if (!sms)
         return FALSE;
 
-    self->priv->list = g_list_prepend (self->priv->list, sms);
-    g_signal_emit (self, signals[SIGNAL_ADDED], 0,
-                   mm_base_sms_get_path (sms),
-                   (state == MM_SMS_STATE_RECEIVED ||
-                    state == MM_SMS_STATE_RECEIVING));
+    /* We do export uncomplete multipart messages, in order to be able to
+     *  request removal of all parts of those multipart SMS that will never
+     *  get completed.
+     * Only the STATE of the SMS object will be valid in the exported DBus
+     *  interface.*/
+    mm_base_sms_set_lazy_export (sms, self->priv->lazy_export);
+    mm_base_sms_export (sms);
+
+    list_prepend (self, sms);
+    if (!self->priv->lazy_export)
+        g_signal_emit (self, signals[SIGNAL_ADDED], 0,
+                       mm_base_sms_get_path (sms),
+                       (state == MM_SMS_STATE_RECEIVED ||
+                        state == MM_SMS_STATE_RECEIVING));
 
     return TRUE;
 }
@@ -307,18 +541,20 @@ mm_sms_list_has_part (MMSmsList *self,
                       MMSmsStorage storage,
                       guint index)
 {
-    PartIndexAndStorage ctx;
+    MMBaseSms *sms;
+    gint64 key;
 
     if (storage == MM_SMS_STORAGE_UNKNOWN ||
         index == SMS_PART_INVALID_INDEX)
         return FALSE;
 
-    ctx.part_index = index;
-    ctx.storage = storage;
+    key = (((gint64) storage) << 32) | index;
+    sms = g_hash_table_lookup (self->priv->by_part, &key);
 
-    return !!g_list_find_custom (self->priv->list,
-                                 &ctx,
-                                 (GCompareFunc)cmp_sms_by_part_index_and_storage);
+    /* Double check, in case the part index was reset without us noticing */
+    return (sms &&
+            mm_base_sms_get_storage (sms) == storage &&
+            mm_base_sms_has_part_index (sms, index));
 }
 
 gboolean
@@ -328,11 +564,6 @@ mm_sms_list_take_part (MMSmsList *self,
                        MMSmsStorage storage,
                        GError **error)
 {
-    PartIndexAndStorage ctx;
-
-    ctx.part_index = mm_sms_part_get_index (part);
-    ctx.storage = storage;
-
     /* Ensure we don't have already taken a part with the same index */
     if (mm_sms_list_has_part (self,
                               storage,
@@ -426,6 +657,11 @@ mm_sms_list_init (MMSmsList *self)
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                                               MM_TYPE_SMS_LIST,
                                               MMSmsListPrivate);
+
+    self->priv->by_path = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    self->priv->by_part = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, NULL);
+    self->priv->by_concat = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    self->priv->by_sms = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)sms_index_entry_free);
 }
 
 static void
@@ -434,12 +670,33 @@ dispose (GObject *object)
     MMSmsList *self = MM_SMS_LIST (object);
 
     g_clear_object (&self->priv->modem);
-    g_list_free_full (self->priv->list, g_object_unref);
-    self->priv->list = NULL;
+
+    g_hash_table_remove_all (self->priv->by_path);
+    g_hash_table_remove_all (self->priv->by_part);
+    g_hash_table_remove_all (self->priv->by_concat);
+    g_hash_table_remove_all (self->priv->by_sms);
+    while (self->priv->list) {
+        g_signal_handlers_disconnect_by_data (self->priv->list->data, self);
+        g_object_unref (self->priv->list->data);
+        self->priv->list = g_list_delete_link (self->priv->list, self->priv->list);
+    }
 
     G_OBJECT_CLASS (mm_sms_list_parent_class)->dispose (object);
 }
 
+static void
+finalize (GObject *object)
+{
+    MMSmsList *self = MM_SMS_LIST (object);
+
+    g_hash_table_unref (self->priv->by_path);
+    g_hash_table_unref (self->priv->by_part);
+    g_hash_table_unref (self->priv->by_concat);
+    g_hash_table_unref (self->priv->by_sms);
+
+    G_OBJECT_CLASS (mm_sms_list_parent_class)->finalize (object);
+}
+
 static void
 mm_sms_list_class_init (MMSmsListClass *klass)
 {
@@ -451,6 +708,7 @@ mm_sms_list_class_init (MMSmsListClass *klass)
     object_class->get_property = get_property;
     object_class->set_property = set_property;
     object_class->dispose = dispose;
+    object_class->finalize = finalize;
 
     /* Properties */
     properties[PROP_MODEM] =
@@ -58,8 +58,27 @@ GType mm_sms_list_get_type (void);
 
 MMSmsList *mm_sms_list_new (MMBaseModem *modem);
 
+/* Only the paths of the objects exported right away, which are the ones
+ * reported with the added signal */
 GStrv mm_sms_list_get_paths (MMSmsList *self);
+
+/* Pass as state or storage filter to match any value */
+#define MM_SMS_LIST_FILTER_ANY G_MAXUINT
+
+/* Paths returned here are exported, if they weren't already */
+GStrv mm_sms_list_get_paths_page (MMSmsList *self,
+                                  guint offset,
+                                  guint limit,
+                                  guint state,
+                                  guint storage,
+                                  guint *n_matches);
+
+/* SMS objects taken while set are only exported on demand */
+void mm_sms_list_set_lazy_export (MMSmsList *self,
+                                  gboolean lazy);
 guint mm_sms_list_get_count (MMSmsList *self);
+MMBaseSms *mm_sms_list_get_sms (MMSmsList *self,
+                                const gchar *sms_path);
 
 gboolean mm_sms_list_has_part (MMSmsList *self,
                                MMSmsStorage storage,
@@ -248,7 +248,7 @@ sms_decode_text (const guint8 *text, int len, MMSmsEncoding encoding, int bit_of
         g_free (unpacked);
     } else if (encoding == MM_SMS_ENCODING_UCS2) {
         mm_dbg ("Converting SMS part text from UCS-2BE to UTF8...");
-        utf8 = g_convert ((char *) text, len, "UTF8", "UCS-2BE", NULL, NULL, NULL);
+        utf8 = mm_charset_utf16be_to_utf8 (text, len);
         mm_dbg ("   Got UTF-8 text: '%s'", utf8);
     } else {
         g_warn_if_reached ();
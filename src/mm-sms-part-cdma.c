@@ -229,34 +229,156 @@ encoding_to_string (Encoding encoding)
 }
 
 /*****************************************************************************/
-/* Read bits; o_bits < 8; n_bits <= 8
+/* Bitstream reader and writer
+ *
+ * Fields in CDMA SMS PDUs are not byte-aligned; bits are taken MSB first:
  *
  * Byte 0            Byte 1
  * [7|6|5|4|3|2|1|0] [7|6|5|4|3|2|1|0]
  *
- * o_bits+n_bits <= 16
- *
+ * Both reader and writer are bounded to the buffer they were initialized
+ * with; an operation that would go past its end fails without moving the
+ * current offset.
  */
-static guint8
-read_bits (const guint8 *bytes,
-           guint8 o_bits,
-           guint8 n_bits)
+
+typedef struct {
+    const guint8 *data;
+    guint n_bits;
+    guint offset;
+} BitReader;
+
+static void
+bit_reader_init (BitReader *reader,
+                 const guint8 *data,
+                 guint n_bytes)
 {
-    guint8 bits_in_first;
-    guint8 bits_in_second;
+    reader->data = data;
+    reader->n_bits = n_bytes * 8;
+    reader->offset = 0;
+}
+
+static guint
+bit_reader_get_remaining (const BitReader *reader)
+{
+    return reader->n_bits - reader->offset;
+}
 
-    g_assert (o_bits < 8);
-    g_assert (n_bits <= 8);
-    g_assert (o_bits + n_bits <= 16);
+/* n_bits <= 32 */
+static gboolean
+bit_reader_read (BitReader *reader,
+                 guint n_bits,
+                 guint32 *out)
+{
+    const guint8 *bytes;
+    guint64 acc = 0;
+    guint shift;
+    guint n_bytes;
+    guint i;
 
-    /* Read only from the first byte */
-    if (o_bits + n_bits <= 8)
-        return (bytes[0] >> (8 - o_bits - n_bits)) & ((1 << n_bits) - 1);
+    g_assert (n_bits > 0 && n_bits <= 32);
 
-    /* Read (8 - o_bits) from the first byte and (n_bits - (8 - o_bits)) from the second byte */
-    bits_in_first = 8 - o_bits;
-    bits_in_second = n_bits - bits_in_first;
-    return (read_bits (&bytes[0], o_bits, bits_in_first) << bits_in_second) | read_bits (&bytes[1], 0, bits_in_second);
+    if (bit_reader_get_remaining (reader) < n_bits)
+        return FALSE;
+
+    /* Load all the bytes the field spans, at most 5, and extract it at once */
+    bytes = &reader->data[reader->offset / 8];
+    shift = reader->offset % 8;
+    n_bytes = (shift + n_bits + 7) / 8;
+    for (i = 0; i < n_bytes; i++)
+        acc = (acc << 8) | bytes[i];
+
+    *out = (guint32) ((acc >> ((n_bytes * 8) - shift - n_bits)) &
+                      ((G_GUINT64_CONSTANT (1) << n_bits) - 1));
+    reader->offset += n_bits;
+    return TRUE;
+}
+
+/* Read n_bytes full octets, not necessarily aligned */
+static gboolean
+bit_reader_read_bytes (BitReader *reader,
+                       guint n_bytes,
+                       guint8 *out)
+{
+    const guint8 *bytes;
+    guint shift;
+    guint i;
+
+    if (bit_reader_get_remaining (reader) / 8 < n_bytes)
+        return FALSE;
+    if (!n_bytes)
+        return TRUE;
+
+    bytes = &reader->data[reader->offset / 8];
+    shift = reader->offset % 8;
+    if (!shift)
+        memcpy (out, bytes, n_bytes);
+    else {
+        for (i = 0; i < n_bytes; i++)
+            out[i] = (guint8) ((bytes[i] << shift) | (bytes[i + 1] >> (8 - shift)));
+    }
+
+    reader->offset += n_bytes * 8;
+    return TRUE;
+}
+
+typedef struct {
+    guint8 *data;
+    guint n_bits;
+    guint offset;
+} BitWriter;
+
+static void
+bit_writer_init (BitWriter *writer,
+                 guint8 *data,
+                 guint n_bytes)
+{
+    writer->data = data;
+    writer->n_bits = n_bytes * 8;
+    writer->offset = 0;
+}
+
+/* n_bits <= 32; the bits being written are overwritten, whatever they had */
+static gboolean
+bit_writer_write (BitWriter *writer,
+                  guint n_bits,
+                  guint32 value)
+{
+    guint8 *bytes;
+    guint64 acc = 0;
+    guint64 mask;
+    guint shift;
+    guint tail;
+    guint n_bytes;
+    guint i;
+
+    g_assert (n_bits > 0 && n_bits <= 32);
+
+    if (writer->n_bits - writer->offset < n_bits)
+        return FALSE;
+
+    bytes = &writer->data[writer->offset / 8];
+    shift = writer->offset % 8;
+    n_bytes = (shift + n_bits + 7) / 8;
+    tail = (n_bytes * 8) - shift - n_bits;
+    mask = ((G_GUINT64_CONSTANT (1) << n_bits) - 1) << tail;
+
+    for (i = 0; i < n_bytes; i++)
+        acc = (acc << 8) | bytes[i];
+    acc = (acc & ~mask) | (((guint64) value << tail) & mask);
+    for (i = n_bytes; i > 0; i--) {
+        bytes[i - 1] = (guint8) acc;
+        acc >>= 8;
+    }
+
+    writer->offset += n_bits;
+    return TRUE;
+}
+
+/* Bytes used so far, including the last partially written one */
+static guint
+bit_writer_get_n_bytes (const BitWriter *writer)
+{
+    return (writer->offset + 7) / 8;
 }
 
 /*****************************************************************************/
@@ -465,39 +587,32 @@ static void
 read_address (MMSmsPart *sms_part,
               const struct Parameter *parameter)
 {
-    guint8 digit_mode;
-    guint8 number_mode;
-    guint8 number_type;
-    guint8 numbering_plan;
-    guint8 num_fields;
-    guint byte_offset = 0;
-    guint bit_offset = 0;
+    BitReader reader;
+    guint32 digit_mode;
+    guint32 number_mode;
+    guint32 number_type;
+    guint32 numbering_plan;
+    guint32 num_fields;
+    guint32 aux;
     guint i;
     gchar *number = NULL;
 
-#define OFFSETS_UPDATE(n_bits) do { \
-        bit_offset += n_bits;       \
-        if (bit_offset >= 8) {      \
-            bit_offset-=8;          \
-            byte_offset++;          \
-        }                           \
-    } while (0)
-
-#define PARAMETER_SIZE_CHECK(required_size)                             \
-    if (parameter->parameter_len < required_size) {                     \
-        mm_dbg ("        cannot read address, need at least %u bytes (got %u)", \
-                required_size,                                          \
-                parameter->parameter_len);                              \
+#define READER_SIZE_CHECK(required_bits)                                \
+    if (bit_reader_get_remaining (&reader) < (required_bits)) {         \
+        mm_dbg ("        cannot read address, need at least %u more bits (got %u)", \
+                (guint) (required_bits),                                \
+                bit_reader_get_remaining (&reader));                    \
         return;                                                         \
     }
 
-    /* Readability of digit mode and number mode (first 2 bits, i.e. first byte) */
-    PARAMETER_SIZE_CHECK (1);
+#define READ_BITS(n_bits, out)                  \
+    READER_SIZE_CHECK (n_bits);                 \
+    bit_reader_read (&reader, n_bits, out)
+
+    bit_reader_init (&reader, parameter->parameter_value, parameter->parameter_len);
 
     /* Digit mode */
-    digit_mode = read_bits (&parameter->parameter_value[byte_offset], bit_offset, 1);
-    OFFSETS_UPDATE (1);
-    g_assert (digit_mode <= 1);
+    READ_BITS (1, &digit_mode);
     switch (digit_mode) {
     case DIGIT_MODE_DTMF:
         mm_dbg ("        digit mode: dtmf");
@@ -510,8 +625,7 @@ read_address (MMSmsPart *sms_part,
     }
 
     /* Number mode */
-    number_mode = read_bits (&parameter->parameter_value[byte_offset], bit_offset, 1);
-    OFFSETS_UPDATE (1);
+    READ_BITS (1, &number_mode);
     switch (number_mode) {
     case NUMBER_MODE_DIGIT:
         mm_dbg ("        number mode: digit");
@@ -525,9 +639,7 @@ read_address (MMSmsPart *sms_part,
 
     /* Number type */
     if (digit_mode == DIGIT_MODE_ASCII) {
-        /* No need for readability check, still in first byte always */
-        number_type = read_bits (&parameter->parameter_value[byte_offset], bit_offset, 3);
-        OFFSETS_UPDATE (3);
+        READ_BITS (3, &number_type);
         switch (number_type) {
         case NUMBER_TYPE_UNKNOWN:
             mm_dbg ("        number type: unknown");
@@ -556,10 +668,7 @@ read_address (MMSmsPart *sms_part,
 
     /* Numbering plan */
     if (digit_mode == DIGIT_MODE_ASCII && number_mode == NUMBER_MODE_DIGIT) {
-        /* Readability of numbering plan; may go to second byte */
-        PARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + 4) / 8));
-        numbering_plan = read_bits (&parameter->parameter_value[byte_offset], bit_offset, 4);
-        OFFSETS_UPDATE (4);
+        READ_BITS (4, &numbering_plan);
         switch (numbering_plan) {
         case NUMBERING_PLAN_UNKNOWN:
             mm_dbg ("        numbering plan: unknown");
@@ -583,52 +692,43 @@ read_address (MMSmsPart *sms_part,
     } else
         numbering_plan = 0xFF;
 
-    /* Readability of num_fields; will go to third byte (((bit_offset + 8) / 8) == 1) */
-    PARAMETER_SIZE_CHECK (byte_offset + 2);
-    num_fields = read_bits (&parameter->parameter_value[byte_offset], bit_offset, 8);
-    OFFSETS_UPDATE (8);
+    READ_BITS (8, &num_fields);
     mm_dbg ("        num fields: %u", num_fields);
 
-    /* Address string */
+    /* Address string; the whole field is checked before allocating it */
 
     if (digit_mode == DIGIT_MODE_DTMF) {
         /* DTMF */
-        PARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_fields * 4)) / 8));
+        READER_SIZE_CHECK (num_fields * 4);
         number = g_malloc (num_fields + 1);
         for (i = 0; i < num_fields; i++) {
-            number[i] = dtmf_to_ascii (read_bits (&parameter->parameter_value[byte_offset], bit_offset, 4));
-            OFFSETS_UPDATE (4);
+            bit_reader_read (&reader, 4, &aux);
+            number[i] = dtmf_to_ascii (aux);
         }
         number[i] = '\0';
     } else if (number_mode == NUMBER_MODE_DIGIT) {
         /* ASCII
          * TODO: should we expose numbering plan and number type? */
-        PARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_fields * 8)) / 8));
+        READER_SIZE_CHECK (num_fields * 8);
         number = g_malloc (num_fields + 1);
-        for (i = 0; i < num_fields; i++) {
-            number[i] = read_bits (&parameter->parameter_value[byte_offset], bit_offset, 8);
-            OFFSETS_UPDATE (8);
-        }
-        number[i] = '\0';
+        bit_reader_read_bytes (&reader, num_fields, (guint8 *) number);
+        number[num_fields] = '\0';
     } else if (number_type == DATA_NETWORK_ADDRESS_TYPE_INTERNET_EMAIL_ADDRESS) {
         /* Internet e-mail address (ASCII) */
-        PARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_fields * 8)) / 8));
+        READER_SIZE_CHECK (num_fields * 8);
         number = g_malloc (num_fields + 1);
-        for (i = 0; i < num_fields; i++) {
-            number[i] = read_bits (&parameter->parameter_value[byte_offset], bit_offset, 8);
-            OFFSETS_UPDATE (8);
-        }
-        number[i] = '\0';
+        bit_reader_read_bytes (&reader, num_fields, (guint8 *) number);
+        number[num_fields] = '\0';
     } else if (number_type == DATA_NETWORK_ADDRESS_TYPE_INTERNET_PROTOCOL) {
         GString *str;
 
         /* Binary data network address (most significant first)
          * For now, just print the hex string (e.g. FF:01...) */
-        PARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_fields * 8)) / 8));
+        READER_SIZE_CHECK (num_fields * 8);
         str = g_string_sized_new (num_fields * 2);
         for (i = 0; i < num_fields; i++) {
-            g_string_append_printf (str, "%.2X", read_bits (&parameter->parameter_value[byte_offset], bit_offset, 8));
-            OFFSETS_UPDATE (8);
+            bit_reader_read (&reader, 8, &aux);
+            g_string_append_printf (str, "%.2X", aux);
         }
         number = g_string_free (str, FALSE);
     } else
@@ -639,15 +739,16 @@ read_address (MMSmsPart *sms_part,
     mm_sms_part_set_number (sms_part, number);
     g_free (number);
 
-#undef OFFSETS_UPDATE
-#undef PARAMETER_SIZE_CHECK
+#undef READ_BITS
+#undef READER_SIZE_CHECK
 }
 
 static void
 read_bearer_reply_option (MMSmsPart *sms_part,
                           const struct Parameter *parameter)
 {
-    guint8 sequence;
+    BitReader reader;
+    guint32 sequence;
 
     g_assert (parameter->parameter_id == PARAMETER_ID_BEARER_REPLY_OPTION);
 
@@ -657,7 +758,8 @@ read_bearer_reply_option (MMSmsPart *sms_part,
         return;
     }
 
-    sequence = read_bits (&parameter->parameter_value[0], 0, 6);
+    bit_reader_init (&reader, parameter->parameter_value, parameter->parameter_len);
+    bit_reader_read (&reader, 6, &sequence);
     mm_dbg ("        sequence: %u", sequence);
 
     mm_sms_part_set_message_reference (sms_part, sequence);
@@ -667,9 +769,10 @@ static void
 read_cause_codes (MMSmsPart *sms_part,
                   const struct Parameter *parameter)
 {
-    guint8 sequence;
-    guint8 error_class;
-    guint8 cause_code;
+    BitReader reader;
+    guint32 sequence;
+    guint32 error_class;
+    guint32 cause_code;
     MMSmsDeliveryState delivery_state;
 
     g_assert (parameter->parameter_id == PARAMETER_ID_BEARER_REPLY_OPTION);
@@ -680,19 +783,20 @@ read_cause_codes (MMSmsPart *sms_part,
         return;
     }
 
-    sequence = read_bits (&parameter->parameter_value[0], 0, 6);
+    bit_reader_init (&reader, parameter->parameter_value, parameter->parameter_len);
+
+    bit_reader_read (&reader, 6, &sequence);
     mm_dbg ("        sequence: %u", sequence);
 
-    error_class = read_bits (&parameter->parameter_value[0], 6, 2);
+    bit_reader_read (&reader, 2, &error_class);
     mm_dbg ("        error class: %u", error_class);
 
     if (error_class != ERROR_CLASS_NO_ERROR) {
-        if (parameter->parameter_len != 2) {
+        if (!bit_reader_read (&reader, 8, &cause_code)) {
             mm_dbg ("        invalid cause codes length found (%u != 2): ignoring",
                     parameter->parameter_len);
             return;
         }
-        cause_code = parameter->parameter_value[1];
         mm_dbg ("        cause code: %u", cause_code);
     } else
         cause_code = 0;
@@ -708,9 +812,10 @@ static void
 read_bearer_data_message_identifier (MMSmsPart *sms_part,
                                      const struct Parameter *subparameter)
 {
-    guint8 message_type;
-    guint16 message_id;
-    guint8 header_ind;
+    BitReader reader;
+    guint32 message_type;
+    guint32 message_id;
+    guint32 header_ind;
 
     g_assert (subparameter->parameter_id == SUBPARAMETER_ID_MESSAGE_ID);
 
@@ -720,7 +825,9 @@ read_bearer_data_message_identifier (MMSmsPart *sms_part,
         return;
     }
 
-    message_type = read_bits (&subparameter->parameter_value[0], 0, 4);
+    bit_reader_init (&reader, subparameter->parameter_value, subparameter->parameter_len);
+
+    bit_reader_read (&reader, 4, &message_type);
     switch (message_type) {
     case TELESERVICE_MESSAGE_TYPE_UNKNOWN:
         mm_dbg ("            message type: unknown");
@@ -754,12 +861,11 @@ read_bearer_data_message_identifier (MMSmsPart *sms_part,
         break;
     }
 
-    message_id = ((read_bits (&subparameter->parameter_value[0], 4, 8) << 8) |
-                  (read_bits (&subparameter->parameter_value[1], 4, 8)));
-    message_id = GUINT16_FROM_BE (message_id);
-    mm_dbg ("            message id: %u", (guint) message_id);
+    /* Most significant bits first, so no endianness conversion needed */
+    bit_reader_read (&reader, 16, &message_id);
+    mm_dbg ("            message id: %u", message_id);
 
-    header_ind = read_bits (&subparameter->parameter_value[2], 4, 1);
+    bit_reader_read (&reader, 1, &header_ind);
     mm_dbg ("            header indicator: %u", header_ind);
 }
 
@@ -767,64 +873,52 @@ static void
 read_bearer_data_user_data (MMSmsPart *sms_part,
                             const struct Parameter *subparameter)
 {
-    guint8 message_encoding;
-    guint8 message_type = 0;
-    guint8 num_fields;
-    guint byte_offset = 0;
-    guint bit_offset = 0;
-
-#define OFFSETS_UPDATE(n_bits) do { \
-        bit_offset += n_bits;       \
-        if (bit_offset >= 8) {      \
-            bit_offset-=8;          \
-            byte_offset++;          \
-        }                           \
-    } while (0)
-
-#define SUBPARAMETER_SIZE_CHECK(required_size)                             \
-    if (subparameter->parameter_len < required_size) {                  \
-        mm_dbg ("        cannot read user data, need at least %u bytes (got %u)", \
-                required_size,                                          \
-                subparameter->parameter_len);                           \
+    BitReader reader;
+    guint32 message_encoding;
+    guint32 message_type = 0;
+    guint32 num_fields;
+
+#define READER_SIZE_CHECK(required_bits)                                \
+    if (bit_reader_get_remaining (&reader) < (required_bits)) {         \
+        mm_dbg ("        cannot read user data, need at least %u more bits (got %u)", \
+                (guint) (required_bits),                                \
+                bit_reader_get_remaining (&reader));                    \
         return;                                                         \
     }
 
+#define READ_BITS(n_bits, out)                  \
+    READER_SIZE_CHECK (n_bits);                 \
+    bit_reader_read (&reader, n_bits, out)
+
     g_assert (subparameter->parameter_id == SUBPARAMETER_ID_USER_DATA);
 
+    bit_reader_init (&reader, subparameter->parameter_value, subparameter->parameter_len);
+
     /* Message encoding */
-    SUBPARAMETER_SIZE_CHECK (1);
-    message_encoding = read_bits (&subparameter->parameter_value[byte_offset], bit_offset, 5);
-    OFFSETS_UPDATE (5);
+    READ_BITS (5, &message_encoding);
     mm_dbg ("            message encoding: %s", encoding_to_string (message_encoding));
 
     /* Message type, only if extended protocol message */
     if (message_encoding == ENCODING_EXTENDED_PROTOCOL_MESSAGE) {
-        SUBPARAMETER_SIZE_CHECK (2);
-        message_type = read_bits (&subparameter->parameter_value[byte_offset], bit_offset, 8);
-        OFFSETS_UPDATE (8);
+        READ_BITS (8, &message_type);
         mm_dbg ("            message type: %u", message_type);
     }
 
     /* Number of fields */
-    SUBPARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + 8) / 8));
-    num_fields = read_bits (&subparameter->parameter_value[byte_offset], bit_offset, 8);
-    OFFSETS_UPDATE (8);
+    READ_BITS (8, &num_fields);
     mm_dbg ("            num fields: %u", num_fields);
 
-    /* Now, process actual text or data */
+    /* Now, process actual text or data; the whole field is checked before
+     * allocating it */
     switch (message_encoding) {
     case ENCODING_OCTET: {
         GByteArray *data;
-        guint i;
 
-        SUBPARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_fields * 8)) / 8));
+        READER_SIZE_CHECK (num_fields * 8);
 
         data = g_byte_array_sized_new (num_fields);
         g_byte_array_set_size (data, num_fields);
-        for (i = 0; i < num_fields; i++) {
-            data->data[i] = read_bits (&subparameter->parameter_value[byte_offset], bit_offset, 8);
-            OFFSETS_UPDATE (8);
-        }
+        bit_reader_read_bytes (&reader, num_fields, data->data);
 
         mm_dbg ("            data: (%u bytes)", num_fields);
         mm_sms_part_take_data (sms_part, data);
@@ -833,14 +927,15 @@ read_bearer_data_user_data (MMSmsPart *sms_part,
 
     case ENCODING_ASCII_7BIT: {
         gchar *text;
+        guint32 aux;
         guint i;
 
-        SUBPARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_fields * 7)) / 8));
+        READER_SIZE_CHECK (num_fields * 7);
 
         text = g_malloc (num_fields + 1);
         for (i = 0; i < num_fields; i++) {
-            text[i] = read_bits (&subparameter->parameter_value[byte_offset], bit_offset, 7);
-            OFFSETS_UPDATE (7);
+            bit_reader_read (&reader, 7, &aux);
+            text[i] = aux;
         }
         text[i] = '\0';
 
@@ -852,16 +947,12 @@ read_bearer_data_user_data (MMSmsPart *sms_part,
     case ENCODING_LATIN: {
         gchar *latin;
         gchar *text;
-        guint i;
 
-        SUBPARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_fields * 8)) / 8));
+        READER_SIZE_CHECK (num_fields * 8);
 
         latin = g_malloc (num_fields + 1);
-        for (i = 0; i < num_fields; i++) {
-            latin[i] = read_bits (&subparameter->parameter_value[byte_offset], bit_offset, 8);
-            OFFSETS_UPDATE (8);
-        }
-        latin[i] = '\0';
+        bit_reader_read_bytes (&reader, num_fields, (guint8 *) latin);
+        latin[num_fields] = '\0';
 
         text = g_convert (latin, -1, "UTF-8", "ISO−8859−1", NULL, NULL, NULL);
         if (!text) {
@@ -876,23 +967,19 @@ read_bearer_data_user_data (MMSmsPart *sms_part,
     }
 
     case ENCODING_UNICODE: {
-        gchar *utf16;
+        guint8 *utf16;
         gchar *text;
-        guint i;
         guint num_bytes;
 
         /* 2 bytes per field! */
         num_bytes = num_fields * 2;
 
-        SUBPARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_bytes * 8)) / 8));
+        READER_SIZE_CHECK (num_bytes * 8);
 
         utf16 = g_malloc (num_bytes);
-        for (i = 0; i < num_bytes; i++) {
-            utf16[i] = read_bits (&subparameter->parameter_value[byte_offset], bit_offset, 8);
-            OFFSETS_UPDATE (8);
-        }
+        bit_reader_read_bytes (&reader, num_bytes, utf16);
 
-        text = g_convert (utf16, num_bytes, "UTF-8", "UCS-2BE", NULL, NULL, NULL);
+        text = mm_charset_utf16be_to_utf8 (utf16, num_bytes);
         if (!text) {
             mm_dbg ("            text/data: ignored (UTF-16 to UTF-8 conversion error)");
         } else {
@@ -908,8 +995,8 @@ read_bearer_data_user_data (MMSmsPart *sms_part,
         mm_dbg ("            text/data: ignored (unsupported encoding)");
     }
 
-#undef OFFSETS_UPDATE
-#undef SUBPARAMETER_SIZE_CHECK
+#undef READ_BITS
+#undef READER_SIZE_CHECK
 }
 
 static void
@@ -1153,43 +1240,6 @@ mm_sms_part_cdma_new_from_binary_pdu (guint index,
     return sms_part;
 }
 
-/*****************************************************************************/
-/* Write bits; o_bits < 8; n_bits <= 8
- *
- * Byte 0            Byte 1
- * [7|6|5|4|3|2|1|0] [7|6|5|4|3|2|1|0]
- *
- * o_bits+n_bits <= 16
- *
- * NOTE! The bits being set should be 0 initially.
- */
-static void
-write_bits (guint8 *bytes,
-            guint8 o_bits,
-            guint8 n_bits,
-            guint8 bits)
-{
-    guint8 bits_in_first;
-    guint8 bits_in_second;
-
-    g_assert (o_bits < 8);
-    g_assert (n_bits <= 8);
-    g_assert (o_bits + n_bits <= 16);
-
-    /* Write only in the first byte */
-    if (o_bits + n_bits <= 8) {
-        bytes[0] |= (bits & ((1 << n_bits) - 1)) << (8 - o_bits - n_bits);
-        return;
-    }
-
-    /* Write (8 - o_bits) in the first byte and (n_bits - (8 - o_bits)) in the second byte */
-    bits_in_first = 8 - o_bits;
-    bits_in_second = n_bits - bits_in_first;
-
-    write_bits (&bytes[0], o_bits, bits_in_first, (bits >> bits_in_second));
-    write_bits (&bytes[1], 0, bits_in_second, bits);
-}
-
 /*****************************************************************************/
 
 static guint8
@@ -1245,24 +1295,26 @@ write_teleservice_id (MMSmsPart *part,
 static gboolean
 write_destination_address (MMSmsPart *part,
                            guint8 *pdu,
+                           guint pdu_size,
                            guint *absolute_offset,
                            GError **error)
 {
+    BitWriter writer;
     const gchar *number;
-    guint bit_offset;
-    guint byte_offset;
     guint n_digits;
+    guint n_bytes;
     guint i;
 
     mm_dbg ("    writing destination address...");
 
-#define OFFSETS_UPDATE(n_bits) do { \
-        bit_offset += n_bits;       \
-        if (bit_offset >= 8) {      \
-            bit_offset-=8;          \
-            byte_offset++;          \
-        }                           \
-    } while (0)
+#define WRITE_BITS(n_bits, value)                                       \
+    if (!bit_writer_write (&writer, n_bits, value)) {                   \
+        g_set_error (error,                                             \
+                     MM_CORE_ERROR,                                     \
+                     MM_CORE_ERROR_FAILED,                              \
+                     "Not enough room to write the destination address"); \
+        return FALSE;                                                   \
+    }
 
     number = mm_sms_part_get_number (part);
     n_digits = strlen (number);
@@ -1270,18 +1322,15 @@ write_destination_address (MMSmsPart *part,
     pdu[0] = PARAMETER_ID_DESTINATION_ADDRESS;
     /* Write parameter length at the end */
 
-    byte_offset = 2;
-    bit_offset = 0;
+    bit_writer_init (&writer, &pdu[2], pdu_size - 2);
 
     /* Digit mode: DTMF always */
     mm_dbg ("        digit mode: dtmf");
-    write_bits (&pdu[byte_offset], bit_offset, 1, DIGIT_MODE_DTMF);
-    OFFSETS_UPDATE (1);
+    WRITE_BITS (1, DIGIT_MODE_DTMF);
 
     /* Number mode: DIGIT always */
     mm_dbg ("        number mode: digit");
-    write_bits (&pdu[byte_offset], bit_offset, 1, NUMBER_MODE_DIGIT);
-    OFFSETS_UPDATE (1);
+    WRITE_BITS (1, NUMBER_MODE_DIGIT);
 
     /* Number type and numbering plan only needed in ASCII digit mode, so skip */
 
@@ -1295,8 +1344,7 @@ write_destination_address (MMSmsPart *part,
         return FALSE;
     }
     mm_dbg ("        num fields: %u", n_digits);
-    write_bits (&pdu[byte_offset], bit_offset, 8, n_digits);
-    OFFSETS_UPDATE (8);
+    WRITE_BITS (8, n_digits);
 
     /* Actual DTMF encoded number */
     mm_dbg ("        address: %s", number);
@@ -1312,23 +1360,22 @@ write_destination_address (MMSmsPart *part,
                          number[i]);
             return FALSE;
         }
-        write_bits (&pdu[byte_offset], bit_offset, 4, dtmf);
-        OFFSETS_UPDATE (4);
+        WRITE_BITS (4, dtmf);
     }
 
-#undef OFFSETS_UPDATE
+#undef WRITE_BITS
 
-    /* Write parameter length (remove header length to offset) */
-    byte_offset += !!bit_offset - 2;
-    if (byte_offset > 256) {
+    /* Write parameter length */
+    n_bytes = bit_writer_get_n_bytes (&writer);
+    if (n_bytes > 256) {
         g_set_error (error,
                      MM_CORE_ERROR,
                      MM_CORE_ERROR_UNSUPPORTED,
                      "Number too long (max 256 bytes, %u given)",
-                     byte_offset);
+                     n_bytes);
         return FALSE;
     }
-    pdu[1] = byte_offset;
+    pdu[1] = n_bytes;
 
     *absolute_offset += (2 + pdu[1]);
     return TRUE;
@@ -1337,16 +1384,29 @@ write_destination_address (MMSmsPart *part,
 static gboolean
 write_bearer_data_message_identifier (MMSmsPart *part,
                                       guint8 *pdu,
+                                      guint pdu_size,
                                       guint *parameter_offset,
                                       GError **error)
 {
+    BitWriter writer;
+
+    if (pdu_size < 5) {
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_FAILED,
+                     "Not enough room to write the message identifier");
+        return FALSE;
+    }
+
     pdu[0] = SUBPARAMETER_ID_MESSAGE_ID;
     pdu[1] = 3; /* subparameter_len, always 3 */
 
     mm_dbg ("        writing message identifier: submit");
 
+    bit_writer_init (&writer, &pdu[2], 3);
+
     /* Message type */
-    write_bits (&pdu[2], 0, 4, TELESERVICE_MESSAGE_TYPE_SUBMIT);
+    bit_writer_write (&writer, 4, TELESERVICE_MESSAGE_TYPE_SUBMIT);
 
     /* Skip adding a message id; assume it's filled in by device */
 
@@ -1418,15 +1478,16 @@ decide_best_encoding (const gchar *text,
 static gboolean
 write_bearer_data_user_data (MMSmsPart *part,
                              guint8 *pdu,
+                             guint pdu_size,
                              guint *parameter_offset,
                              GError **error)
 {
+    BitWriter writer;
     const gchar *text;
     const GByteArray *data;
-    guint bit_offset = 0;
-    guint byte_offset = 0;
     guint num_fields;
     guint num_bits_per_field;
+    guint n_bytes;
     guint i;
     Encoding encoding;
     GByteArray *converted = NULL;
@@ -1435,13 +1496,16 @@ write_bearer_data_user_data (MMSmsPart *part,
 
     mm_dbg ("        writing user data...");
 
-#define OFFSETS_UPDATE(n_bits) do { \
-        bit_offset += n_bits;       \
-        if (bit_offset >= 8) {      \
-            bit_offset-=8;          \
-            byte_offset++;          \
-        }                           \
-    } while (0)
+#define WRITE_BITS(n_bits, value)                                       \
+    if (!bit_writer_write (&writer, n_bits, value)) {                   \
+        if (converted)                                                  \
+            g_byte_array_unref (converted);                             \
+        g_set_error (error,                                             \
+                     MM_CORE_ERROR,                                     \
+                     MM_CORE_ERROR_FAILED,                              \
+                     "Not enough room to write the user data");         \
+        return FALSE;                                                   \
+    }
 
     text = mm_sms_part_get_text (part);
     data = mm_sms_part_get_data (part);
@@ -1450,8 +1514,7 @@ write_bearer_data_user_data (MMSmsPart *part,
 
     pdu[0] = SUBPARAMETER_ID_USER_DATA;
     /* Write parameter length at the end */
-    byte_offset = 2;
-    bit_offset = 0;
+    bit_writer_init (&writer, &pdu[2], pdu_size - 2);
 
     /* Text or Data */
     if (text) {
@@ -1470,8 +1533,7 @@ write_bearer_data_user_data (MMSmsPart *part,
 
     /* Message encoding*/
     mm_dbg ("            message encoding: %s", encoding_to_string (encoding));
-    write_bits (&pdu[byte_offset], bit_offset, 5, encoding);
-    OFFSETS_UPDATE (5);
+    WRITE_BITS (5, encoding);
 
     /* Number of fields */
     if (num_fields > 256) {
@@ -1485,8 +1547,7 @@ write_bearer_data_user_data (MMSmsPart *part,
         return FALSE;
     }
     mm_dbg ("            num fields: %u", num_fields);
-    write_bits (&pdu[byte_offset], bit_offset, 8, num_fields);
-    OFFSETS_UPDATE (8);
+    WRITE_BITS (8, num_fields);
 
     /* For ASCII-7, write 7 bits in each iteration; for the remaining ones
      * go byte per byte */
@@ -1495,27 +1556,25 @@ write_bearer_data_user_data (MMSmsPart *part,
     else
         mm_dbg ("            data: (%u bytes)", num_fields);
     num_bits_per_iter = num_bits_per_field < 8 ? num_bits_per_field : 8;
-    for (i = 0; i < aux->len; i++) {
-        write_bits (&pdu[byte_offset], bit_offset, num_bits_per_iter, aux->data[i]);
-        OFFSETS_UPDATE (num_bits_per_iter);
-    }
+    for (i = 0; i < aux->len; i++)
+        WRITE_BITS (num_bits_per_iter, aux->data[i]);
 
     if (converted)
         g_byte_array_unref (converted);
 
-#undef OFFSETS_UPDATE
+#undef WRITE_BITS
 
-    /* Write subparameter length (remove header length to offset) */
-    byte_offset += !!bit_offset - 2;
-    if (byte_offset > 256) {
+    /* Write subparameter length */
+    n_bytes = bit_writer_get_n_bytes (&writer);
+    if (n_bytes > 256) {
         g_set_error (error,
                      MM_CORE_ERROR,
                      MM_CORE_ERROR_UNSUPPORTED,
                      "Data or Text too long (max 256 bytes, %u given)",
-                     byte_offset);
+                     n_bytes);
         return FALSE;
     }
-    pdu[1] = byte_offset;
+    pdu[1] = n_bytes;
 
     *parameter_offset += (2 + pdu[1]);
     return TRUE;
@@ -1524,6 +1583,7 @@ write_bearer_data_user_data (MMSmsPart *part,
 static gboolean
 write_bearer_data (MMSmsPart *part,
                    guint8 *pdu,
+                   guint pdu_size,
                    guint *absolute_offset,
                    GError **error)
 {
@@ -1536,9 +1596,9 @@ write_bearer_data (MMSmsPart *part,
     /* Write parameter length at the end */
 
     offset = 2;
-    if (!write_bearer_data_message_identifier (part, &pdu[offset], &offset, &inner_error))
+    if (!write_bearer_data_message_identifier (part, &pdu[offset], pdu_size - offset, &offset, &inner_error))
         mm_dbg ("Error writing message identifier: %s", inner_error->message);
-    else if (!write_bearer_data_user_data (part, &pdu[offset], &offset, &inner_error))
+    else if (!write_bearer_data_user_data (part, &pdu[offset], pdu_size - offset, &offset, &inner_error))
         mm_dbg ("Error writing user data: %s", inner_error->message);
 
     if (inner_error) {
@@ -1563,6 +1623,9 @@ write_bearer_data (MMSmsPart *part,
     return TRUE;
 }
 
+/* See the size estimations below */
+#define SUBMIT_PDU_MAX_SIZE 1024
+
 guint8 *
 mm_sms_part_cdma_get_submit_pdu (MMSmsPart *part,
                                  guint *out_pdulen,
@@ -1592,16 +1655,16 @@ mm_sms_part_cdma_get_submit_pdu (MMSmsPart *part,
      *  Destination address: 2 + 256 bytes
      *  Bearer data: 2 + 256 bytes
      */
-    pdu = g_malloc0 (1024);
+    pdu = g_malloc0 (SUBMIT_PDU_MAX_SIZE);
 
     /* First byte: SMS message type */
     pdu[offset++] = MESSAGE_TYPE_POINT_TO_POINT;
 
     if (!write_teleservice_id (part, &pdu[offset], &offset, &inner_error))
         mm_dbg ("Error writing Teleservice ID: %s", inner_error->message);
-    else if (!write_destination_address (part, &pdu[offset], &offset, &inner_error))
+    else if (!write_destination_address (part, &pdu[offset], SUBMIT_PDU_MAX_SIZE - offset, &offset, &inner_error))
         mm_dbg ("Error writing destination address: %s", inner_error->message);
-    else if (!write_bearer_data (part, &pdu[offset], &offset, &inner_error))
+    else if (!write_bearer_data (part, &pdu[offset], SUBMIT_PDU_MAX_SIZE - offset, &offset, &inner_error))
         mm_dbg ("Error writing bearer data: %s", inner_error->message);
 
     if (inner_error) {
@@ -0,0 +1,126 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include "mm-sms-send-sequence.h"
+
+struct _MMSmsSendSequence {
+    guint n_items;
+    gboolean hold_link;
+    gboolean stop_on_error;
+
+    gboolean started;
+    /* Step given and not yet completed, DONE if none */
+    MMSmsSendStep pending;
+    guint next_item;
+    gboolean stopped;
+    gboolean link_held;
+    guint n_failed;
+};
+
+/*****************************************************************************/
+
+MMSmsSendStep
+mm_sms_send_sequence_next (MMSmsSendSequence *self,
+                           guint *item)
+{
+    g_return_val_if_fail (self->pending == MM_SMS_SEND_STEP_DONE, MM_SMS_SEND_STEP_DONE);
+
+    if (!self->started) {
+        self->started = TRUE;
+        if (self->hold_link && self->n_items > 1) {
+            self->pending = MM_SMS_SEND_STEP_MORE_MESSAGES_ENABLE;
+            return self->pending;
+        }
+    }
+
+    if (!self->stopped && self->next_item < self->n_items) {
+        if (item)
+            *item = self->next_item;
+        self->pending = MM_SMS_SEND_STEP_ITEM;
+        return self->pending;
+    }
+
+    /* Let the link go whatever happened with the items */
+    if (self->link_held) {
+        self->pending = MM_SMS_SEND_STEP_MORE_MESSAGES_DISABLE;
+        return self->pending;
+    }
+
+    return MM_SMS_SEND_STEP_DONE;
+}
+
+void
+mm_sms_send_sequence_step_done (MMSmsSendSequence *self,
+                                gboolean success)
+{
+    switch (self->pending) {
+    case MM_SMS_SEND_STEP_MORE_MESSAGES_ENABLE:
+        /* Not critical, items are sent anyway */
+        self->link_held = success;
+        break;
+    case MM_SMS_SEND_STEP_ITEM:
+        self->next_item++;
+        if (!success) {
+            self->n_failed++;
+            if (self->stop_on_error)
+                self->stopped = TRUE;
+        }
+        break;
+    case MM_SMS_SEND_STEP_MORE_MESSAGES_DISABLE:
+        /* Released anyway by the network after a while */
+        self->link_held = FALSE;
+        break;
+    case MM_SMS_SEND_STEP_DONE:
+    default:
+        g_return_if_reached ();
+    }
+
+    self->pending = MM_SMS_SEND_STEP_DONE;
+}
+
+gboolean
+mm_sms_send_sequence_get_link_held (MMSmsSendSequence *self)
+{
+    return self->link_held;
+}
+
+guint
+mm_sms_send_sequence_get_n_failed (MMSmsSendSequence *self)
+{
+    return self->n_failed;
+}
+
+/*****************************************************************************/
+
+MMSmsSendSequence *
+mm_sms_send_sequence_new (guint n_items,
+                          gboolean hold_link,
+                          gboolean stop_on_error)
+{
+    MMSmsSendSequence *self;
+
+    self = g_slice_new0 (MMSmsSendSequence);
+    self->n_items = n_items;
+    self->hold_link = hold_link;
+    self->stop_on_error = stop_on_error;
+    self->pending = MM_SMS_SEND_STEP_DONE;
+    return self;
+}
+
+void
+mm_sms_send_sequence_free (MMSmsSendSequence *self)
+{
+    g_slice_free (MMSmsSendSequence, self);
+}
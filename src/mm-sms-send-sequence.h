@@ -0,0 +1,58 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#ifndef MM_SMS_SEND_SEQUENCE_H
+#define MM_SMS_SEND_SEQUENCE_H
+
+#include <glib.h>
+
+/*****************************************************************************/
+/* Order of the steps when sending several items (the parts of a multipart
+ * SMS, or the messages of a batch) in a row.
+ *
+ * When more than one item is sent and the link may be held, the network is
+ * asked to keep it open between them (AT+CMMS=1) before the first item, and
+ * to let it go (AT+CMMS=0) after the last one, whatever the results. Items
+ * sent within an enclosing sequence holding the link don't hold it again.
+ *
+ * Each step given by mm_sms_send_sequence_next() must be completed with
+ * mm_sms_send_sequence_step_done() before asking for the next one. */
+
+typedef enum {
+    MM_SMS_SEND_STEP_DONE,
+    MM_SMS_SEND_STEP_MORE_MESSAGES_ENABLE,
+    MM_SMS_SEND_STEP_ITEM,
+    MM_SMS_SEND_STEP_MORE_MESSAGES_DISABLE,
+} MMSmsSendStep;
+
+typedef struct _MMSmsSendSequence MMSmsSendSequence;
+
+/* With @stop_on_error, the items after a failed one are not sent */
+MMSmsSendSequence *mm_sms_send_sequence_new  (guint    n_items,
+                                              gboolean hold_link,
+                                              gboolean stop_on_error);
+void               mm_sms_send_sequence_free (MMSmsSendSequence *self);
+
+/* @item is set to the index of the item to send in MM_SMS_SEND_STEP_ITEM */
+MMSmsSendStep mm_sms_send_sequence_next      (MMSmsSendSequence *self,
+                                              guint             *item);
+void          mm_sms_send_sequence_step_done (MMSmsSendSequence *self,
+                                              gboolean           success);
+
+/* Whether the link is currently held by this sequence */
+gboolean mm_sms_send_sequence_get_link_held (MMSmsSendSequence *self);
+guint    mm_sms_send_sequence_get_n_failed  (MMSmsSendSequence *self);
+
+#endif /* MM_SMS_SEND_SEQUENCE_H */
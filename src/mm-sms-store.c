@@ -0,0 +1,804 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <glib/gstdio.h>
+
+#include "mm-sms-store.h"
+#include "mm-log.h"
+
+#define LOG_FILE_NAME   "parts.log"
+#define INDEX_FILE_NAME "parts.idx"
+
+#define INDEX_MAGIC   "MMSMSIDX"
+#define INDEX_VERSION 3
+#define RECORD_MAGIC  0x52534d4d /* "MMSR" */
+
+#define KEY_STATE                   "state"
+#define KEY_PDU_TYPE                "pdu-type"
+#define KEY_SMSC                    "smsc"
+#define KEY_NUMBER                  "number"
+#define KEY_TIMESTAMP               "timestamp"
+#define KEY_DISCHARGE_TIMESTAMP     "discharge-timestamp"
+#define KEY_TEXT                    "text"
+#define KEY_DATA                    "data"
+#define KEY_ENCODING                "encoding"
+#define KEY_CLASS                   "class"
+#define KEY_VALIDITY_RELATIVE       "validity-relative"
+#define KEY_DELIVERY_STATE          "delivery-state"
+#define KEY_MESSAGE_REFERENCE       "message-reference"
+#define KEY_DELIVERY_REPORT_REQUEST "delivery-report-request"
+#define KEY_CONCAT_REFERENCE        "concat-reference"
+#define KEY_CONCAT_MAX              "concat-max"
+#define KEY_CONCAT_SEQUENCE         "concat-sequence"
+#define KEY_CDMA_TELESERVICE_ID     "cdma-teleservice-id"
+#define KEY_CDMA_SERVICE_CATEGORY   "cdma-service-category"
+
+/* All integers in the index and in the record headers are little endian */
+
+typedef struct {
+    gchar   magic[8];
+    guint32 version;
+    guint32 entry_size;
+} IndexHeader;
+
+typedef struct {
+    guint64 offset;           /* of the record header in the log */
+    guint64 content_hash;     /* of the part contents, without state */
+    guint32 length;           /* of the record data, without header */
+    guint32 timestamp;        /* seconds since the epoch, 0 if unknown */
+    guint32 number_hash;
+    guint16 concat_reference;
+    guint8  concat_sequence;
+    guint8  flags;
+} IndexEntry;
+
+typedef struct {
+    guint32 magic;
+    guint32 length;
+} RecordHeader;
+
+G_STATIC_ASSERT (sizeof (IndexHeader) == 16);
+G_STATIC_ASSERT (sizeof (IndexEntry) == 32);
+G_STATIC_ASSERT (sizeof (RecordHeader) == 8);
+
+#define INDEX_ENTRY_FLAG_DELETED 0x01
+
+struct _MMSmsStore {
+    gchar       *log_path;
+    gchar       *index_path;
+    gint         log_fd;
+    gint         index_fd;
+    guint64      log_size;
+    guint        n_entries;
+    guint        n_live;
+    /* Read-only mapping of the index; dropped whenever the file changes */
+    GMappedFile *index_map;
+    /* Content hash -> positions of the live entries with it */
+    GHashTable  *lookup;
+};
+
+/*****************************************************************************/
+
+static gboolean
+write_all_at (gint          fd,
+              gconstpointer buf,
+              gsize         len,
+              guint64       offset)
+{
+    const guint8 *p = buf;
+
+    while (len > 0) {
+        gssize n;
+
+        n = pwrite (fd, p, len, (off_t) offset);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return FALSE;
+        }
+        p += n;
+        len -= n;
+        offset += n;
+    }
+    return TRUE;
+}
+
+static gboolean
+read_all_at (gint     fd,
+             gpointer buf,
+             gsize    len,
+             guint64  offset)
+{
+    guint8 *p = buf;
+
+    while (len > 0) {
+        gssize n;
+
+        n = pread (fd, p, len, (off_t) offset);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return FALSE;
+        }
+        if (n == 0)
+            return FALSE;
+        p += n;
+        len -= n;
+        offset += n;
+    }
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+static void
+index_invalidate (MMSmsStore *self)
+{
+    if (self->index_map) {
+        g_mapped_file_unref (self->index_map);
+        self->index_map = NULL;
+    }
+}
+
+static const IndexEntry *
+index_peek_entries (MMSmsStore *self)
+{
+    GError *error = NULL;
+
+    if (!self->n_entries)
+        return NULL;
+
+    if (!self->index_map) {
+        self->index_map = g_mapped_file_new (self->index_path, FALSE, &error);
+        if (!self->index_map) {
+            mm_warn ("Couldn't map SMS store index: %s", error->message);
+            g_error_free (error);
+            return NULL;
+        }
+        if (g_mapped_file_get_length (self->index_map) <
+            sizeof (IndexHeader) + (gsize) self->n_entries * sizeof (IndexEntry)) {
+            mm_warn ("SMS store index is shorter than expected");
+            index_invalidate (self);
+            return NULL;
+        }
+    }
+
+    return (const IndexEntry *) (g_mapped_file_get_contents (self->index_map) + sizeof (IndexHeader));
+}
+
+/*****************************************************************************/
+
+static GVariant *
+part_to_variant (MMSmsPart  *part,
+                 MMSmsState  state)
+{
+    GVariantBuilder   builder;
+    const GByteArray *data;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+
+#define ADD_UINT(key, value) \
+    g_variant_builder_add (&builder, "{sv}", key, g_variant_new_uint32 (value))
+
+#define ADD_STRING(key, value) do {                                                 \
+        const gchar *str = value;                                                   \
+        if (str && g_utf8_validate (str, -1, NULL))                                 \
+            g_variant_builder_add (&builder, "{sv}", key, g_variant_new_string (str)); \
+    } while (0)
+
+    ADD_UINT   (KEY_STATE,                 state);
+    ADD_UINT   (KEY_PDU_TYPE,              mm_sms_part_get_pdu_type (part));
+    ADD_STRING (KEY_SMSC,                  mm_sms_part_get_smsc (part));
+    ADD_STRING (KEY_NUMBER,                mm_sms_part_get_number (part));
+    ADD_STRING (KEY_TIMESTAMP,             mm_sms_part_get_timestamp (part));
+    ADD_STRING (KEY_DISCHARGE_TIMESTAMP,   mm_sms_part_get_discharge_timestamp (part));
+    ADD_STRING (KEY_TEXT,                  mm_sms_part_get_text (part));
+    ADD_UINT   (KEY_ENCODING,              mm_sms_part_get_encoding (part));
+    ADD_UINT   (KEY_VALIDITY_RELATIVE,     mm_sms_part_get_validity_relative (part));
+    ADD_UINT   (KEY_DELIVERY_STATE,        mm_sms_part_get_delivery_state (part));
+    ADD_UINT   (KEY_MESSAGE_REFERENCE,     mm_sms_part_get_message_reference (part));
+    ADD_UINT   (KEY_CONCAT_REFERENCE,      mm_sms_part_get_concat_reference (part));
+    ADD_UINT   (KEY_CONCAT_MAX,            mm_sms_part_get_concat_max (part));
+    ADD_UINT   (KEY_CONCAT_SEQUENCE,       mm_sms_part_get_concat_sequence (part));
+    ADD_UINT   (KEY_CDMA_TELESERVICE_ID,   mm_sms_part_get_cdma_teleservice_id (part));
+    ADD_UINT   (KEY_CDMA_SERVICE_CATEGORY, mm_sms_part_get_cdma_service_category (part));
+
+#undef ADD_STRING
+#undef ADD_UINT
+
+    g_variant_builder_add (&builder, "{sv}", KEY_CLASS,
+                           g_variant_new_int32 (mm_sms_part_get_class (part)));
+    g_variant_builder_add (&builder, "{sv}", KEY_DELIVERY_REPORT_REQUEST,
+                           g_variant_new_boolean (mm_sms_part_get_delivery_report_request (part)));
+
+    data = mm_sms_part_get_data (part);
+    if (data)
+        g_variant_builder_add (&builder, "{sv}", KEY_DATA,
+                               g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, data->data, data->len, 1));
+
+    return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+static MMSmsPart *
+part_from_variant (GVariant   *dict,
+                   MMSmsState *state)
+{
+    MMSmsPart   *part;
+    guint32      value;
+    gint32       class;
+    gboolean     delivery_report_request;
+    const gchar *str;
+    GVariant    *data;
+
+    if (!g_variant_lookup (dict, KEY_PDU_TYPE, "u", &value))
+        return NULL;
+    part = mm_sms_part_new (SMS_PART_INVALID_INDEX, (MMSmsPduType) value);
+
+    *state = MM_SMS_STATE_RECEIVED;
+    if (g_variant_lookup (dict, KEY_STATE, "u", &value))
+        *state = (MMSmsState) value;
+
+#define GET_STRING(key, setter) do {                        \
+        if (g_variant_lookup (dict, key, "&s", &str))       \
+            setter (part, str);                             \
+    } while (0)
+
+#define GET_UINT(key, setter, type) do {                    \
+        if (g_variant_lookup (dict, key, "u", &value))      \
+            setter (part, (type) value);                    \
+    } while (0)
+
+    GET_STRING (KEY_SMSC,                mm_sms_part_set_smsc);
+    GET_STRING (KEY_NUMBER,              mm_sms_part_set_number);
+    GET_STRING (KEY_TIMESTAMP,           mm_sms_part_set_timestamp);
+    GET_STRING (KEY_DISCHARGE_TIMESTAMP, mm_sms_part_set_discharge_timestamp);
+    GET_STRING (KEY_TEXT,                mm_sms_part_set_text);
+
+    GET_UINT (KEY_ENCODING,              mm_sms_part_set_encoding,              MMSmsEncoding);
+    GET_UINT (KEY_VALIDITY_RELATIVE,     mm_sms_part_set_validity_relative,     guint);
+    GET_UINT (KEY_DELIVERY_STATE,        mm_sms_part_set_delivery_state,        guint);
+    GET_UINT (KEY_MESSAGE_REFERENCE,     mm_sms_part_set_message_reference,     guint);
+    GET_UINT (KEY_CONCAT_REFERENCE,      mm_sms_part_set_concat_reference,      guint);
+    GET_UINT (KEY_CONCAT_MAX,            mm_sms_part_set_concat_max,            guint);
+    GET_UINT (KEY_CONCAT_SEQUENCE,       mm_sms_part_set_concat_sequence,       guint);
+    GET_UINT (KEY_CDMA_TELESERVICE_ID,   mm_sms_part_set_cdma_teleservice_id,   MMSmsCdmaTeleserviceId);
+    GET_UINT (KEY_CDMA_SERVICE_CATEGORY, mm_sms_part_set_cdma_service_category, MMSmsCdmaServiceCategory);
+
+#undef GET_UINT
+#undef GET_STRING
+
+    if (g_variant_lookup (dict, KEY_CLASS, "i", &class))
+        mm_sms_part_set_class (part, class);
+    if (g_variant_lookup (dict, KEY_DELIVERY_REPORT_REQUEST, "b", &delivery_report_request))
+        mm_sms_part_set_delivery_report_request (part, delivery_report_request);
+
+    data = g_variant_lookup_value (dict, KEY_DATA, G_VARIANT_TYPE_BYTESTRING);
+    if (data) {
+        const guint8 *bytes;
+        gsize         len = 0;
+        GByteArray   *array;
+
+        bytes = g_variant_get_fixed_array (data, &len, 1);
+        array = g_byte_array_sized_new (len);
+        g_byte_array_append (array, bytes, len);
+        mm_sms_part_take_data (part, array);
+        g_variant_unref (data);
+    }
+
+    return part;
+}
+
+/*****************************************************************************/
+/* Parts are matched on their whole contents, without state: the index entry
+ * keeps a hash of them, along with the sender, timestamp and concatenation
+ * info, so that lookups never need to read the log. */
+
+static GVariant *
+part_to_content_variant (MMSmsPart *part)
+{
+    return part_to_variant (part, MM_SMS_STATE_UNKNOWN);
+}
+
+static guint64
+content_hash (GVariant *content)
+{
+    const guint8 *p;
+    gsize         len;
+    guint64       hash = G_GUINT64_CONSTANT (14695981039346656037);
+
+    /* FNV-1a; must not change as it's stored on disk */
+    p = g_variant_get_data (content);
+    for (len = g_variant_get_size (content); len > 0; len--, p++) {
+        hash ^= *p;
+        hash *= G_GUINT64_CONSTANT (1099511628211);
+    }
+    return hash;
+}
+
+static guint32
+number_hash (const gchar *number)
+{
+    guint32 hash = 2166136261u;
+
+    /* FNV-1a; must not change as it's stored on disk */
+    for (; number && *number; number++) {
+        hash ^= (guint8) *number;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static guint32
+timestamp_to_epoch (const gchar *timestamp)
+{
+    GTimeVal tv;
+
+    if (timestamp && g_time_val_from_iso8601 (timestamp, &tv) &&
+        tv.tv_sec > 0 && (guint64) tv.tv_sec <= G_MAXUINT32)
+        return (guint32) tv.tv_sec;
+    return 0;
+}
+
+/* Fills in the lookup fields of @entry, as stored on disk */
+static void
+build_index_entry (MMSmsPart  *part,
+                   IndexEntry *entry)
+{
+    GVariant *content;
+
+    memset (entry, 0, sizeof (IndexEntry));
+
+    content = part_to_content_variant (part);
+    entry->content_hash = GUINT64_TO_LE (content_hash (content));
+    g_variant_unref (content);
+
+    entry->timestamp = GUINT32_TO_LE (timestamp_to_epoch (mm_sms_part_get_timestamp (part)));
+    entry->number_hash = GUINT32_TO_LE (number_hash (mm_sms_part_get_number (part)));
+    if (mm_sms_part_should_concat (part)) {
+        entry->concat_reference = GUINT16_TO_LE ((guint16) mm_sms_part_get_concat_reference (part));
+        entry->concat_sequence = (guint8) mm_sms_part_get_concat_sequence (part);
+    }
+}
+
+static gboolean
+index_entry_matches (const IndexEntry *entry,
+                     const IndexEntry *key)
+{
+    return (!(entry->flags & INDEX_ENTRY_FLAG_DELETED) &&
+            entry->content_hash == key->content_hash &&
+            entry->timestamp == key->timestamp &&
+            entry->number_hash == key->number_hash &&
+            entry->concat_reference == key->concat_reference &&
+            entry->concat_sequence == key->concat_sequence);
+}
+
+static GVariant *
+record_read (MMSmsStore       *self,
+             const IndexEntry *entry)
+{
+    RecordHeader header;
+    guint64      offset;
+    guint32      length;
+    gpointer     data;
+
+    offset = GUINT64_FROM_LE (entry->offset);
+    length = GUINT32_FROM_LE (entry->length);
+
+    if (offset + sizeof (header) + length > self->log_size ||
+        !read_all_at (self->log_fd, &header, sizeof (header), offset) ||
+        GUINT32_FROM_LE (header.magic) != RECORD_MAGIC ||
+        GUINT32_FROM_LE (header.length) != length) {
+        mm_warn ("Invalid SMS store record at offset %" G_GUINT64_FORMAT, offset);
+        return NULL;
+    }
+
+    data = g_malloc (length);
+    if (!read_all_at (self->log_fd, data, length, offset + sizeof (header))) {
+        mm_warn ("Couldn't read SMS store record at offset %" G_GUINT64_FORMAT, offset);
+        g_free (data);
+        return NULL;
+    }
+
+    /* Not trusted, so that a corrupted record is never dereferenced
+     * out of bounds */
+    return g_variant_ref_sink (g_variant_new_from_data (G_VARIANT_TYPE ("a{sv}"),
+                                                        data, length,
+                                                        FALSE,
+                                                        g_free, data));
+}
+
+static void
+lookup_add (MMSmsStore       *self,
+            const IndexEntry *entry,
+            guint             position)
+{
+    guint64 hash;
+    GArray *positions;
+
+    hash = GUINT64_FROM_LE (entry->content_hash);
+    positions = g_hash_table_lookup (self->lookup, &hash);
+    if (!positions) {
+        positions = g_array_new (FALSE, FALSE, sizeof (guint));
+        g_hash_table_insert (self->lookup, g_memdup (&hash, sizeof (hash)), positions);
+    }
+    g_array_append_val (positions, position);
+}
+
+static void
+lookup_remove (MMSmsStore       *self,
+               const IndexEntry *entry,
+               guint             position)
+{
+    guint64 hash;
+    GArray *positions;
+    guint   i;
+
+    hash = GUINT64_FROM_LE (entry->content_hash);
+    positions = g_hash_table_lookup (self->lookup, &hash);
+    if (!positions)
+        return;
+
+    for (i = 0; i < positions->len; i++) {
+        if (g_array_index (positions, guint, i) == position) {
+            g_array_remove_index (positions, i);
+            break;
+        }
+    }
+    if (!positions->len)
+        g_hash_table_remove (self->lookup, &hash);
+}
+
+/* Returns the position of the first live entry for @part, or -1 */
+static gint
+index_find (MMSmsStore *self,
+            MMSmsPart  *part)
+{
+    const IndexEntry *entries;
+    IndexEntry        key;
+    guint64           hash;
+    GArray           *positions;
+    guint             i;
+
+    build_index_entry (part, &key);
+    hash = GUINT64_FROM_LE (key.content_hash);
+    positions = g_hash_table_lookup (self->lookup, &hash);
+    if (!positions)
+        return -1;
+
+    entries = index_peek_entries (self);
+    if (!entries)
+        return -1;
+
+    for (i = 0; i < positions->len; i++) {
+        guint position;
+
+        position = g_array_index (positions, guint, i);
+        if (index_entry_matches (&entries[position], &key))
+            return (gint) position;
+    }
+    return -1;
+}
+
+/*****************************************************************************/
+
+static gint
+open_file (const gchar  *path,
+           GError      **error)
+{
+    gint fd;
+
+    fd = g_open (path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0)
+        g_set_error (error,
+                     G_FILE_ERROR,
+                     g_file_error_from_errno (errno),
+                     "Couldn't open '%s': %s",
+                     path, g_strerror (errno));
+    return fd;
+}
+
+static gboolean
+index_load_header (MMSmsStore  *self,
+                   GError     **error)
+{
+    struct stat  st;
+    IndexHeader  header;
+
+    if (fstat (self->index_fd, &st) < 0) {
+        g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+                     "Couldn't stat '%s': %s", self->index_path, g_strerror (errno));
+        return FALSE;
+    }
+
+    /* New store */
+    if (st.st_size == 0) {
+        memcpy (header.magic, INDEX_MAGIC, sizeof (header.magic));
+        header.version = GUINT32_TO_LE (INDEX_VERSION);
+        header.entry_size = GUINT32_TO_LE (sizeof (IndexEntry));
+        if (!write_all_at (self->index_fd, &header, sizeof (header), 0)) {
+            g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+                         "Couldn't write '%s': %s", self->index_path, g_strerror (errno));
+            return FALSE;
+        }
+        self->n_entries = 0;
+        return TRUE;
+    }
+
+    if (!read_all_at (self->index_fd, &header, sizeof (header), 0) ||
+        memcmp (header.magic, INDEX_MAGIC, sizeof (header.magic)) != 0 ||
+        GUINT32_FROM_LE (header.version) != INDEX_VERSION ||
+        GUINT32_FROM_LE (header.entry_size) != sizeof (IndexEntry)) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "Invalid SMS store index '%s'", self->index_path);
+        return FALSE;
+    }
+
+    /* Drop a trailing partial entry, e.g. after a crash while appending */
+    self->n_entries = (st.st_size - sizeof (IndexHeader)) / sizeof (IndexEntry);
+    if (st.st_size != (off_t) (sizeof (IndexHeader) + (gsize) self->n_entries * sizeof (IndexEntry)) &&
+        ftruncate (self->index_fd, sizeof (IndexHeader) + (gsize) self->n_entries * sizeof (IndexEntry)) < 0)
+        mm_warn ("Couldn't truncate SMS store index: %s", g_strerror (errno));
+
+    return TRUE;
+}
+
+MMSmsStore *
+mm_sms_store_open (const gchar  *path,
+                   GError      **error)
+{
+    MMSmsStore       *self;
+    struct stat       st;
+    const IndexEntry *entries;
+    guint             i;
+
+    g_return_val_if_fail (path != NULL, NULL);
+
+    if (g_mkdir_with_parents (path, 0700) < 0) {
+        g_set_error (error,
+                     G_FILE_ERROR,
+                     g_file_error_from_errno (errno),
+                     "Couldn't create directory '%s': %s",
+                     path, g_strerror (errno));
+        return NULL;
+    }
+
+    self = g_slice_new0 (MMSmsStore);
+    self->log_fd = -1;
+    self->index_fd = -1;
+    self->log_path = g_build_filename (path, LOG_FILE_NAME, NULL);
+    self->index_path = g_build_filename (path, INDEX_FILE_NAME, NULL);
+    self->lookup = g_hash_table_new_full (g_int64_hash,
+                                          g_int64_equal,
+                                          g_free,
+                                          (GDestroyNotify) g_array_unref);
+
+    self->log_fd = open_file (self->log_path, error);
+    if (self->log_fd < 0)
+        goto failed;
+    self->index_fd = open_file (self->index_path, error);
+    if (self->index_fd < 0)
+        goto failed;
+
+    if (fstat (self->log_fd, &st) < 0) {
+        g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+                     "Couldn't stat '%s': %s", self->log_path, g_strerror (errno));
+        goto failed;
+    }
+    self->log_size = st.st_size;
+
+    if (!index_load_header (self, error))
+        goto failed;
+
+    entries = index_peek_entries (self);
+    for (i = 0; entries && i < self->n_entries; i++) {
+        if (!(entries[i].flags & INDEX_ENTRY_FLAG_DELETED)) {
+            lookup_add (self, &entries[i], i);
+            self->n_live++;
+        }
+    }
+
+    mm_dbg ("Opened SMS store at '%s': %u parts (%u removed)",
+            path, self->n_live, self->n_entries - self->n_live);
+    return self;
+
+failed:
+    mm_sms_store_free (self);
+    return NULL;
+}
+
+void
+mm_sms_store_free (MMSmsStore *self)
+{
+    if (!self)
+        return;
+
+    index_invalidate (self);
+    if (self->lookup)
+        g_hash_table_unref (self->lookup);
+    if (self->log_fd >= 0)
+        close (self->log_fd);
+    if (self->index_fd >= 0)
+        close (self->index_fd);
+    g_free (self->log_path);
+    g_free (self->index_path);
+    g_slice_free (MMSmsStore, self);
+}
+
+/*****************************************************************************/
+
+guint
+mm_sms_store_get_count (MMSmsStore *self)
+{
+    return self->n_live;
+}
+
+gboolean
+mm_sms_store_append (MMSmsStore  *self,
+                     MMSmsPart   *part,
+                     MMSmsState   state,
+                     GError     **error)
+{
+    GVariant     *variant;
+    RecordHeader  header;
+    IndexEntry    entry;
+    gsize         length;
+
+    variant = part_to_variant (part, state);
+    length = g_variant_get_size (variant);
+
+    header.magic = GUINT32_TO_LE (RECORD_MAGIC);
+    header.length = GUINT32_TO_LE ((guint32) length);
+
+    build_index_entry (part, &entry);
+    entry.offset = GUINT64_TO_LE (self->log_size);
+    entry.length = GUINT32_TO_LE ((guint32) length);
+
+    /* The record must be on disk before the index entry pointing to it,
+     * as the caller will remove the part from the modem right after */
+    if (!write_all_at (self->log_fd, &header, sizeof (header), self->log_size) ||
+        !write_all_at (self->log_fd, g_variant_get_data (variant), length, self->log_size + sizeof (header)) ||
+        fsync (self->log_fd) < 0) {
+        g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+                     "Couldn't write SMS store log: %s", g_strerror (errno));
+        g_variant_unref (variant);
+        return FALSE;
+    }
+    g_variant_unref (variant);
+
+    if (!write_all_at (self->index_fd, &entry, sizeof (entry),
+                       sizeof (IndexHeader) + (guint64) self->n_entries * sizeof (IndexEntry)) ||
+        fsync (self->index_fd) < 0) {
+        g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+                     "Couldn't write SMS store index: %s", g_strerror (errno));
+        return FALSE;
+    }
+
+    lookup_add (self, &entry, self->n_entries);
+    self->log_size += sizeof (header) + length;
+    self->n_entries++;
+    self->n_live++;
+    index_invalidate (self);
+    return TRUE;
+}
+
+gboolean
+mm_sms_store_contains (MMSmsStore *self,
+                       MMSmsPart  *part)
+{
+    return (index_find (self, part) >= 0);
+}
+
+static void
+store_reset (MMSmsStore *self)
+{
+    /* Nothing left, so reclaim the space used by removed parts */
+    index_invalidate (self);
+    g_hash_table_remove_all (self->lookup);
+    if (ftruncate (self->log_fd, 0) < 0 ||
+        ftruncate (self->index_fd, sizeof (IndexHeader)) < 0) {
+        mm_warn ("Couldn't truncate SMS store: %s", g_strerror (errno));
+        return;
+    }
+    self->log_size = 0;
+    self->n_entries = 0;
+}
+
+gboolean
+mm_sms_store_remove (MMSmsStore *self,
+                     MMSmsPart  *part)
+{
+    const IndexEntry *entries;
+    gint              i;
+    guint8            flags;
+
+    i = index_find (self, part);
+    if (i < 0)
+        return FALSE;
+
+    /* Only the flags byte of the entry is updated */
+    entries = index_peek_entries (self);
+    flags = entries[i].flags | INDEX_ENTRY_FLAG_DELETED;
+    if (!write_all_at (self->index_fd, &flags, 1,
+                       sizeof (IndexHeader) + (guint64) i * sizeof (IndexEntry) + G_STRUCT_OFFSET (IndexEntry, flags))) {
+        mm_warn ("Couldn't update SMS store index: %s", g_strerror (errno));
+        return FALSE;
+    }
+
+    lookup_remove (self, &entries[i], (guint) i);
+    index_invalidate (self);
+    self->n_live--;
+    if (!self->n_live)
+        store_reset (self);
+    else if (fsync (self->index_fd) < 0)
+        mm_warn ("Couldn't sync SMS store index: %s", g_strerror (errno));
+
+    return TRUE;
+}
+
+guint
+mm_sms_store_foreach (MMSmsStore          *self,
+                      MMSmsStoreForeachFn  callback,
+                      gpointer             user_data)
+{
+    const IndexEntry *entries;
+    GArray           *live;
+    guint             n_loaded = 0;
+    guint             i;
+
+    entries = index_peek_entries (self);
+    if (!entries)
+        return 0;
+
+    /* Collect the entries first, the callback may modify the store */
+    live = g_array_new (FALSE, FALSE, sizeof (IndexEntry));
+    for (i = 0; i < self->n_entries; i++) {
+        if (!(entries[i].flags & INDEX_ENTRY_FLAG_DELETED))
+            g_array_append_val (live, entries[i]);
+    }
+
+    for (i = 0; i < live->len; i++) {
+        const IndexEntry *entry;
+        GVariant         *variant;
+        MMSmsPart        *part;
+        MMSmsState        state;
+
+        entry = &g_array_index (live, IndexEntry, i);
+        variant = record_read (self, entry);
+        if (!variant)
+            continue;
+
+        part = part_from_variant (variant, &state);
+        g_variant_unref (variant);
+
+        if (!part) {
+            mm_warn ("Couldn't parse SMS store record at offset %" G_GUINT64_FORMAT,
+                     GUINT64_FROM_LE (entry->offset));
+            continue;
+        }
+
+        callback (part, state, user_data);
+        n_loaded++;
+    }
+
+    g_array_unref (live);
+    return n_loaded;
+}
@@ -0,0 +1,61 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#ifndef MM_SMS_STORE_H
+#define MM_SMS_STORE_H
+
+#include <glib.h>
+
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
+
+#include "mm-sms-part.h"
+
+/*****************************************************************************/
+/* Daemon-side store of received SMS parts.
+ *
+ * Parts are appended to a log file, and a fixed-size index entry with a hash
+ * of the part contents, the sender, timestamp and concatenation info is
+ * appended to a separate index file, which is memory-mapped. Lookups only
+ * use the index, through a table of the live entries by content hash; the
+ * log itself is only read to load the parts back. */
+
+typedef struct _MMSmsStore MMSmsStore;
+
+MMSmsStore *mm_sms_store_open (const gchar  *path,
+                               GError      **error);
+void        mm_sms_store_free (MMSmsStore   *self);
+
+gboolean mm_sms_store_append   (MMSmsStore  *self,
+                                MMSmsPart   *part,
+                                MMSmsState   state,
+                                GError     **error);
+gboolean mm_sms_store_contains (MMSmsStore  *self,
+                                MMSmsPart   *part);
+/* Removes a single stored part with the same contents */
+gboolean mm_sms_store_remove   (MMSmsStore  *self,
+                                MMSmsPart   *part);
+guint    mm_sms_store_get_count (MMSmsStore *self);
+
+/* The callback takes ownership of the part */
+typedef void (* MMSmsStoreForeachFn) (MMSmsPart  *part,
+                                      MMSmsState  state,
+                                      gpointer    user_data);
+
+guint mm_sms_store_foreach (MMSmsStore          *self,
+                            MMSmsStoreForeachFn  callback,
+                            gpointer             user_data);
+
+#endif /* MM_SMS_STORE_H */
@@ -327,6 +327,62 @@ test_pack_gsm7_7_chars_offset (void *f, gpointer d)
     g_free (packed);
 }
 
+/* Plain bit by bit packing, to validate the block based kernels */
+static void
+reference_pack_gsm7 (const guint8 *src, guint32 len, guint8 start_offset, guint8 *packed)
+{
+    guint32 i;
+    guint    b;
+
+    for (i = 0; i < len; i++) {
+        for (b = 0; b < 7; b++) {
+            guint32 bit = start_offset + (i * 7) + b;
+
+            if (src[i] & (1 << b))
+                packed[bit / 8] |= 1 << (bit % 8);
+        }
+    }
+}
+
+static void
+test_pack_unpack_gsm7_blocks (void *f, gpointer d)
+{
+    guint8  src[40];
+    guint32 len;
+    guint8  offset;
+    guint   i;
+
+    for (i = 0; i < sizeof (src); i++)
+        src[i] = (guint8) ((i * 37 + 11) & 0x7F);
+
+    /* All lengths around the 8 septet block boundaries, at every offset.
+     * Nothing is allocated when packing 0 septets, so start at 1. */
+    for (len = 1; len <= sizeof (src); len++) {
+        for (offset = 0; offset < 8; offset++) {
+            guint8  expected[48] = { 0 };
+            guint8 *packed;
+            guint8 *unpacked;
+            guint32 packed_len = 0;
+            guint32 unpacked_len = 0;
+
+            reference_pack_gsm7 (src, len, offset, expected);
+
+            packed = gsm_pack (src, len, offset, &packed_len);
+            g_assert (packed);
+            g_assert_cmpuint (packed_len, ==, ((len * 7) + offset + 7) / 8);
+            g_assert_cmpint (memcmp (packed, expected, packed_len), ==, 0);
+
+            unpacked = gsm_unpack (packed, len, offset, &unpacked_len);
+            g_assert (unpacked);
+            g_assert_cmpuint (unpacked_len, ==, len);
+            g_assert_cmpint (memcmp (unpacked, src, len), ==, 0);
+
+            g_free (unpacked);
+            g_free (packed);
+        }
+    }
+}
+
 static void
 test_take_convert_ucs2_hex_utf8 (void *f, gpointer d)
 {
@@ -362,6 +418,223 @@ test_take_convert_ucs2_bad_ascii2 (void *f, gpointer d)
     g_assert (converted == NULL);
 }
 
+static void
+test_utf16be_to_utf8 (void *f, gpointer d)
+{
+    static const guint8 ucs2[] = { 0x00, 0x48, 0x00, 0xe9, 0x04, 0x20, 0x20, 0xac, 0x4e, 0x2d };
+    static const guint8 utf16[] = { 0x00, 0x41, 0xd8, 0x3d, 0xde, 0x00, 0x00, 0x42 };
+    static const guint8 lone_high[] = { 0x00, 0x41, 0xd8, 0x3d };
+    static const guint8 lone_low[] = { 0xde, 0x00, 0x00, 0x41 };
+    static const guint8 odd[] = { 0x00, 0x41, 0x00 };
+    gchar *utf8;
+    gchar *expected;
+
+    /* Plain UCS-2 must match what iconv gives */
+    utf8 = mm_charset_utf16be_to_utf8 (ucs2, sizeof (ucs2));
+    expected = g_convert ((const gchar *) ucs2, sizeof (ucs2), "UTF-8", "UCS-2BE", NULL, NULL, NULL);
+    g_assert (expected != NULL);
+    g_assert_cmpstr (utf8, ==, expected);
+    g_assert_cmpstr (utf8, ==, "Hé\xd0\xa0€中");
+    g_free (expected);
+    g_free (utf8);
+
+    /* Surrogate pairs are decoded */
+    utf8 = mm_charset_utf16be_to_utf8 (utf16, sizeof (utf16));
+    g_assert_cmpstr (utf8, ==, "A\xf0\x9f\x98\x80" "B");
+    g_free (utf8);
+
+    /* Invalid input */
+    g_assert (mm_charset_utf16be_to_utf8 (lone_high, sizeof (lone_high)) == NULL);
+    g_assert (mm_charset_utf16be_to_utf8 (lone_low, sizeof (lone_low)) == NULL);
+    g_assert (mm_charset_utf16be_to_utf8 (odd, sizeof (odd)) == NULL);
+
+    /* Empty input */
+    utf8 = mm_charset_utf16be_to_utf8 (ucs2, 0);
+    g_assert_cmpstr (utf8, ==, "");
+    g_free (utf8);
+}
+
+static void
+test_hex_to_utf8_ucs2 (void *f, gpointer d)
+{
+    gchar *utf8;
+
+    utf8 = mm_modem_charset_hex_to_utf8 ("004D006F00640065006D", MM_MODEM_CHARSET_UCS2);
+    g_assert_cmpstr (utf8, ==, "Modem");
+    g_free (utf8);
+
+    utf8 = mm_modem_charset_hex_to_utf8 ("0041D83DDE00", MM_MODEM_CHARSET_UCS2);
+    g_assert_cmpstr (utf8, ==, "A\xf0\x9f\x98\x80");
+    g_free (utf8);
+
+    utf8 = mm_modem_charset_hex_to_utf8 ("0041D83D", MM_MODEM_CHARSET_UCS2);
+    g_assert (utf8 == NULL);
+}
+
+static void
+test_take_convert_8859_1_repeated (void *f, gpointer d)
+{
+    guint i;
+
+    /* Converters are cached, make sure reusing them gives the same result
+     * also after a failed conversion */
+    for (i = 0; i < 3; i++) {
+        gchar *utf8;
+
+        utf8 = mm_charset_take_and_convert_to_utf8 (g_strdup ("Caf\xe9"), MM_MODEM_CHARSET_8859_1);
+        g_assert_cmpstr (utf8, ==, "Café");
+        g_free (utf8);
+
+        utf8 = mm_charset_take_and_convert_to_utf8 (g_strdup ("\241\255\254\250\244\234"), MM_MODEM_CHARSET_UCS2);
+        g_assert (utf8 == NULL);
+    }
+}
+
+/*****************************************************************************/
+/* Benchmark, only run in perf mode (-m perf) */
+
+#define BENCHMARK_SMS_COUNT 20000
+
+static void
+test_benchmark_ucs2_decode (void *f, gpointer d)
+{
+    static const gchar *text = "Привет! Это тестовое сообщение, отправленное в UCS-2, 你好";
+    gchar  *ucs2;
+    gsize   ucs2_len = 0;
+    gchar  *hex;
+    GTimer *timer;
+    gdouble iconv_time;
+    gdouble fast_time;
+    gdouble hex_time;
+    guint   i;
+
+    if (!g_test_perf ())
+        return;
+
+    ucs2 = g_convert (text, -1, "UCS-2BE", "UTF-8", NULL, &ucs2_len, NULL);
+    g_assert (ucs2 != NULL);
+    hex = mm_utils_bin2hexstr ((const guint8 *) ucs2, ucs2_len);
+
+    timer = g_timer_new ();
+
+    /* What SMS text decoding used to do: a new iconv descriptor per message */
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_SMS_COUNT; i++)
+        g_free (g_convert (ucs2, ucs2_len, "UTF-8", "UCS-2BE", NULL, NULL, NULL));
+    iconv_time = g_timer_elapsed (timer, NULL);
+
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_SMS_COUNT; i++)
+        g_free (mm_charset_utf16be_to_utf8 ((const guint8 *) ucs2, ucs2_len));
+    fast_time = g_timer_elapsed (timer, NULL);
+
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_SMS_COUNT; i++)
+        g_free (mm_modem_charset_hex_to_utf8 (hex, MM_MODEM_CHARSET_UCS2));
+    hex_time = g_timer_elapsed (timer, NULL);
+
+    g_test_message ("Decoding %u UCS-2 texts: g_convert() %.3fs, direct %.3fs (x%.1f), from hex %.3fs",
+                    BENCHMARK_SMS_COUNT, iconv_time, fast_time,
+                    fast_time > 0 ? iconv_time / fast_time : 0.0, hex_time);
+    g_test_minimized_result (fast_time, "UCS-2 decoding time: %.3fs", fast_time);
+
+    g_timer_destroy (timer);
+    g_free (hex);
+    g_free (ucs2);
+}
+
+static void
+test_benchmark_cached_converters (void *f, gpointer d)
+{
+    GTimer *timer;
+    gdouble iconv_time;
+    gdouble cached_time;
+    guint   i;
+
+    if (!g_test_perf ())
+        return;
+
+    timer = g_timer_new ();
+
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_SMS_COUNT; i++)
+        g_free (g_convert ("Caf\xe9 Op\xe9rateur", -1, "UTF-8//TRANSLIT", "ISO8859-1", NULL, NULL, NULL));
+    iconv_time = g_timer_elapsed (timer, NULL);
+
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_SMS_COUNT; i++)
+        g_free (mm_charset_take_and_convert_to_utf8 (g_strdup ("Caf\xe9 Op\xe9rateur"), MM_MODEM_CHARSET_8859_1));
+    cached_time = g_timer_elapsed (timer, NULL);
+
+    g_test_message ("Converting %u ISO8859-1 strings: g_convert() %.3fs, cached converter %.3fs (x%.1f)",
+                    BENCHMARK_SMS_COUNT, iconv_time, cached_time,
+                    cached_time > 0 ? iconv_time / cached_time : 0.0);
+    g_test_minimized_result (cached_time, "ISO8859-1 conversion time: %.3fs", cached_time);
+
+    g_timer_destroy (timer);
+}
+
+static void
+test_benchmark_gsm7 (void *f, gpointer d)
+{
+    static const gchar *text = "Your verification code is 482913. Don't share it with anyone! Reply STOP to opt out of {alerts} [EUR 5]";
+    guint8 *unpacked;
+    guint32 unpacked_len = 0;
+    guint8 *packed;
+    guint32 packed_len = 0;
+    GTimer *timer;
+    gdouble pack_time;
+    gdouble unpack_time;
+    gdouble utf8_time;
+    guint   i;
+
+    if (!g_test_perf ())
+        return;
+
+    unpacked = mm_charset_utf8_to_unpacked_gsm (text, &unpacked_len);
+    packed = gsm_pack (unpacked, unpacked_len, 0, &packed_len);
+
+    timer = g_timer_new ();
+
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_SMS_COUNT; i++) {
+        guint32 len;
+
+        g_free (gsm_pack (unpacked, unpacked_len, 0, &len));
+    }
+    pack_time = g_timer_elapsed (timer, NULL);
+
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_SMS_COUNT; i++) {
+        guint32 len;
+
+        g_free (gsm_unpack (packed, unpacked_len, 0, &len));
+    }
+    unpack_time = g_timer_elapsed (timer, NULL);
+
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_SMS_COUNT; i++) {
+        guint8 *gsm;
+        guint32 len;
+
+        gsm = mm_charset_utf8_to_unpacked_gsm (text, &len);
+        g_free (mm_charset_gsm_unpacked_to_utf8 (gsm, len));
+        g_free (gsm);
+    }
+    utf8_time = g_timer_elapsed (timer, NULL);
+
+    g_test_message ("GSM7 x%u (%u septets): pack %.1f MB/s, unpack %.1f MB/s, UTF-8 round trip %.3fs",
+                    BENCHMARK_SMS_COUNT, unpacked_len,
+                    pack_time > 0 ? (BENCHMARK_SMS_COUNT * (gdouble) unpacked_len) / (pack_time * 1e6) : 0.0,
+                    unpack_time > 0 ? (BENCHMARK_SMS_COUNT * (gdouble) unpacked_len) / (unpack_time * 1e6) : 0.0,
+                    utf8_time);
+    g_test_minimized_result (pack_time + unpack_time, "GSM7 pack and unpack time: %.3fs", pack_time + unpack_time);
+
+    g_timer_destroy (timer);
+    g_free (packed);
+    g_free (unpacked);
+}
+
 void
 _mm_log (const char *loc,
          const char *func,
@@ -410,10 +683,19 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE (test_pack_gsm7_last_septet_alone, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_pack_gsm7_7_chars_offset, NULL));
+    g_test_suite_add (suite, TESTCASE (test_pack_unpack_gsm7_blocks, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_take_convert_ucs2_hex_utf8, NULL));
     g_test_suite_add (suite, TESTCASE (test_take_convert_ucs2_bad_ascii, NULL));
     g_test_suite_add (suite, TESTCASE (test_take_convert_ucs2_bad_ascii2, NULL));
+    g_test_suite_add (suite, TESTCASE (test_take_convert_8859_1_repeated, NULL));
+
+    g_test_suite_add (suite, TESTCASE (test_utf16be_to_utf8, NULL));
+    g_test_suite_add (suite, TESTCASE (test_hex_to_utf8_ucs2, NULL));
+
+    g_test_suite_add (suite, TESTCASE (test_benchmark_ucs2_decode, NULL));
+    g_test_suite_add (suite, TESTCASE (test_benchmark_cached_converters, NULL));
+    g_test_suite_add (suite, TESTCASE (test_benchmark_gsm7, NULL));
 
     result = g_test_run ();
 
@@ -0,0 +1,246 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "mm-gps-stream.h"
+#include "mm-log.h"
+
+#define GGA_TRACE "$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,*76\r\n"
+
+/*****************************************************************************/
+
+static gssize
+read_record (gint fd,
+             guint8 *buffer,
+             gsize buffer_size)
+{
+    gssize n;
+
+    n = recv (fd, buffer, buffer_size, MSG_DONTWAIT);
+    if (n < 0)
+        g_assert (errno == EAGAIN || errno == EWOULDBLOCK);
+    return n;
+}
+
+static guint64
+get_stat (MMGpsStream *stream,
+          const gchar *key)
+{
+    GVariant *stats;
+    GVariant *dict;
+    GVariant *value;
+    guint64 ret;
+
+    stats = mm_gps_stream_get_stats (stream);
+    g_assert_cmpuint (g_variant_n_children (stats), ==, 1);
+    dict = g_variant_get_child_value (stats, 0);
+    value = g_variant_lookup_value (dict, key, NULL);
+    g_assert (value);
+    if (g_variant_is_of_type (value, G_VARIANT_TYPE_UINT32))
+        ret = g_variant_get_uint32 (value);
+    else
+        ret = g_variant_get_uint64 (value);
+    g_variant_unref (value);
+    g_variant_unref (dict);
+    g_variant_unref (stats);
+    return ret;
+}
+
+static void
+test_nmea (void)
+{
+    MMGpsStream *stream;
+    guint8 buffer[256];
+    GError *error = NULL;
+    gssize n;
+    guint id = 0;
+    gint fd;
+
+    stream = mm_gps_stream_new ();
+    fd = mm_gps_stream_add_subscriber (stream, MM_GPS_STREAM_FORMAT_NMEA, 0, &id, &error);
+    g_assert_no_error (error);
+    g_assert_cmpint (fd, >=, 0);
+    g_assert_cmpuint (id, ==, 1);
+
+    /* One packet per trace */
+    mm_gps_stream_push_trace (stream, GGA_TRACE);
+    mm_gps_stream_push_trace (stream, "$GPGSV,3,1,11\r\n");
+
+    n = read_record (fd, buffer, sizeof (buffer));
+    g_assert_cmpint (n, ==, strlen (GGA_TRACE));
+    g_assert (memcmp (buffer, GGA_TRACE, n) == 0);
+    n = read_record (fd, buffer, sizeof (buffer));
+    g_assert_cmpint (n, ==, strlen ("$GPGSV,3,1,11\r\n"));
+    g_assert (memcmp (buffer, "$GPGSV,3,1,11\r\n", n) == 0);
+    g_assert_cmpint (read_record (fd, buffer, sizeof (buffer)), <, 0);
+
+    g_assert_cmpuint (get_stat (stream, "sent-records"), ==, 2);
+    g_assert_cmpuint (get_stat (stream, "dropped-records"), ==, 0);
+
+    close (fd);
+    mm_gps_stream_free (stream);
+}
+
+static void
+test_fix (void)
+{
+    MMGpsStream *stream;
+    guint8 buffer[256];
+    GError *error = NULL;
+    guint32 aux32;
+    guint64 aux64;
+    gdouble latitude;
+    gssize n;
+    gint fd;
+
+    stream = mm_gps_stream_new ();
+    fd = mm_gps_stream_add_subscriber (stream, MM_GPS_STREAM_FORMAT_FIX, 0, NULL, &error);
+    g_assert_no_error (error);
+
+    /* Only GGA traces give fixes */
+    mm_gps_stream_push_trace (stream, "$GPGSV,3,1,11\r\n");
+    mm_gps_stream_push_trace (stream, GGA_TRACE);
+
+    /* GGA traces without position don't repeat the previous one */
+    mm_gps_stream_push_trace (stream, "$GPGGA,092751.000,,,,,0,0,,,M,,M,,*4E\r\n");
+    mm_gps_stream_push_trace (stream, "$GPGGA,092752.000*7E\r\n");
+
+    n = read_record (fd, buffer, sizeof (buffer));
+    g_assert_cmpint (n, ==, MM_GPS_STREAM_FIX_RECORD_SIZE);
+    g_assert_cmpint (read_record (fd, buffer + n, sizeof (buffer) - n), <, 0);
+
+    memcpy (&aux32, &buffer[0], 4);
+    g_assert_cmpuint (GUINT32_FROM_LE (aux32), ==, ((9 * 60 + 27) * 60 + 50) * 1000);
+    memcpy (&aux32, &buffer[4], 4);
+    g_assert_cmpuint (GUINT32_FROM_LE (aux32), ==, 0);
+    memcpy (&aux64, &buffer[8], 8);
+    aux64 = GUINT64_FROM_LE (aux64);
+    memcpy (&latitude, &aux64, 8);
+    g_assert_cmpfloat (latitude, >, 53.3613);
+    g_assert_cmpfloat (latitude, <, 53.3614);
+
+    close (fd);
+    mm_gps_stream_free (stream);
+}
+
+static void
+test_backpressure (void)
+{
+    MMGpsStream *stream;
+    GError *error = NULL;
+    guint8 buffer[256];
+    gchar *last = NULL;
+    gchar *trace;
+    guint64 received = 0;
+    guint n_pushed = 0;
+    gssize n;
+    gint fd;
+
+    stream = mm_gps_stream_new ();
+    fd = mm_gps_stream_add_subscriber (stream, MM_GPS_STREAM_FORMAT_NMEA, 1024, NULL, &error);
+    g_assert_no_error (error);
+
+    /* Push without reading until the socket is full and the queue overflows */
+    while (get_stat (stream, "dropped-records") < 100) {
+        trace = g_strdup_printf ("$GPTXT,%08u,padding-padding-padding-padding\r\n", n_pushed++);
+        mm_gps_stream_push_trace (stream, trace);
+        g_free (trace);
+        g_assert_cmpuint (get_stat (stream, "queued-bytes"), <=, 1024);
+    }
+
+    /* Drain; the queue is flushed as the socket gets writable */
+    while (TRUE) {
+        n = read_record (fd, buffer, sizeof (buffer) - 1);
+        if (n > 0) {
+            buffer[n] = '\0';
+            g_free (last);
+            last = g_strdup ((const gchar *) buffer);
+            received++;
+            continue;
+        }
+        if (!g_main_context_iteration (NULL, FALSE) &&
+            get_stat (stream, "queued-records") == 0)
+            break;
+    }
+
+    /* The newest record always makes it */
+    trace = g_strdup_printf ("$GPTXT,%08u,padding-padding-padding-padding\r\n", n_pushed - 1);
+    g_assert_cmpstr (last, ==, trace);
+    g_free (trace);
+    g_free (last);
+
+    g_assert_cmpuint (received + get_stat (stream, "dropped-records"), ==, n_pushed);
+
+    close (fd);
+    mm_gps_stream_free (stream);
+}
+
+static void
+test_subscriber_gone (void)
+{
+    MMGpsStream *stream;
+    GError *error = NULL;
+    gint fd;
+
+    stream = mm_gps_stream_new ();
+    fd = mm_gps_stream_add_subscriber (stream, MM_GPS_STREAM_FORMAT_NMEA, 0, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (mm_gps_stream_get_n_subscribers (stream), ==, 1);
+
+    close (fd);
+    mm_gps_stream_push_trace (stream, GGA_TRACE);
+    g_assert_cmpuint (mm_gps_stream_get_n_subscribers (stream), ==, 0);
+
+    mm_gps_stream_free (stream);
+}
+
+/*****************************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/gps-stream/nmea",            test_nmea);
+    g_test_add_func ("/ModemManager/gps-stream/fix",             test_fix);
+    g_test_add_func ("/ModemManager/gps-stream/backpressure",    test_backpressure);
+    g_test_add_func ("/ModemManager/gps-stream/subscriber-gone", test_subscriber_gone);
+
+    return g_test_run ();
+}
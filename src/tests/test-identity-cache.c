@@ -0,0 +1,163 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "mm-identity-cache.h"
+#include "mm-log.h"
+#include "test-tmp-dir.h"
+
+/*****************************************************************************/
+
+static void
+test_build_key (void)
+{
+    gchar *key;
+
+    key = mm_identity_cache_build_key ("Generic", 0x1199, 0x68a3, "/sys/devices/pci0000:00/0000:00:1d.0/usb2/2-1");
+    g_assert_cmpstr (key, ==, "Generic:1199:68a3:/sys/devices/pci0000:00/0000:00:1d.0/usb2/2-1");
+    g_free (key);
+
+    /* Brackets aren't allowed in key file group names */
+    key = mm_identity_cache_build_key ("Generic", 0x1199, 0x68a3, "/sys/devices/[weird]");
+    g_assert (key == NULL);
+}
+
+static void
+test_store_lookup (void)
+{
+    MMIdentityCacheEntry  entry = {
+        .manufacturer          = (gchar *) "Sierra Wireless, Incorporated",
+        .model                 = (gchar *) "MC7710",
+        .revision              = (gchar *) "SWI9200X_03.05.10.02AP",
+        .equipment_identifier  = (gchar *) "358178040012345",
+        .device_identifier     = (gchar *) "b4e8a8e5a3b5ff4d6f1bd7ad5f0b1b8d3ea2fa4f",
+        .supported_ip_families = MM_BEARER_IP_FAMILY_IPV4 | MM_BEARER_IP_FAMILY_IPV6,
+    };
+    MMIdentityCacheEntry *loaded;
+    gchar                *dir;
+    gchar                *path;
+    GError               *error = NULL;
+    gboolean              ret;
+
+    dir = test_tmp_dir_new ("mm-identity-cache");
+    path = g_build_filename (dir, "cache", "identity.ini", NULL);
+
+    /* Empty cache */
+    loaded = mm_identity_cache_lookup (path, "Generic:1199:68a3:/sys/a");
+    g_assert (loaded == NULL);
+
+    ret = mm_identity_cache_store (path, "Generic:1199:68a3:/sys/a", &entry, &error);
+    g_assert_no_error (error);
+    g_assert (ret);
+
+    loaded = mm_identity_cache_lookup (path, "Generic:1199:68a3:/sys/a");
+    g_assert (loaded != NULL);
+    g_assert_cmpstr (loaded->manufacturer, ==, entry.manufacturer);
+    g_assert_cmpstr (loaded->model, ==, entry.model);
+    g_assert_cmpstr (loaded->revision, ==, entry.revision);
+    g_assert_cmpstr (loaded->equipment_identifier, ==, entry.equipment_identifier);
+    g_assert_cmpstr (loaded->device_identifier, ==, entry.device_identifier);
+    g_assert_cmpuint (loaded->supported_ip_families, ==, entry.supported_ip_families);
+    mm_identity_cache_entry_free (loaded);
+
+    /* Other devices aren't affected */
+    loaded = mm_identity_cache_lookup (path, "Generic:1199:68a3:/sys/b");
+    g_assert (loaded == NULL);
+
+    /* Overwrite, dropping the equipment identifier */
+    entry.revision = (gchar *) "SWI9200X_03.05.29.03AP";
+    entry.equipment_identifier = NULL;
+    ret = mm_identity_cache_store (path, "Generic:1199:68a3:/sys/a", &entry, &error);
+    g_assert_no_error (error);
+    g_assert (ret);
+
+    loaded = mm_identity_cache_lookup (path, "Generic:1199:68a3:/sys/a");
+    g_assert (loaded != NULL);
+    g_assert_cmpstr (loaded->revision, ==, "SWI9200X_03.05.29.03AP");
+    g_assert (loaded->equipment_identifier == NULL);
+    mm_identity_cache_entry_free (loaded);
+
+    /* Remove */
+    ret = mm_identity_cache_remove (path, "Generic:1199:68a3:/sys/a", &error);
+    g_assert_no_error (error);
+    g_assert (ret);
+    loaded = mm_identity_cache_lookup (path, "Generic:1199:68a3:/sys/a");
+    g_assert (loaded == NULL);
+
+    g_free (path);
+    test_tmp_dir_remove (dir);
+}
+
+static void
+test_incomplete_entry (void)
+{
+    MMIdentityCacheEntry  entry = {
+        .manufacturer = (gchar *) "Generic",
+        .model        = (gchar *) "Modem",
+    };
+    MMIdentityCacheEntry *loaded;
+    gchar                *dir;
+    gchar                *path;
+    GError               *error = NULL;
+    gboolean              ret;
+
+    dir = test_tmp_dir_new ("mm-identity-cache");
+    path = g_build_filename (dir, "cache", "identity.ini", NULL);
+
+    /* Entries without revision cannot be validated, so they are ignored */
+    ret = mm_identity_cache_store (path, "Generic:0000:0000:/sys/a", &entry, &error);
+    g_assert_no_error (error);
+    g_assert (ret);
+    loaded = mm_identity_cache_lookup (path, "Generic:0000:0000:/sys/a");
+    g_assert (loaded == NULL);
+
+    g_free (path);
+    test_tmp_dir_remove (dir);
+}
+
+/*****************************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/identity-cache/build-key",        test_build_key);
+    g_test_add_func ("/ModemManager/identity-cache/store-lookup",     test_store_lookup);
+    g_test_add_func ("/ModemManager/identity-cache/incomplete-entry", test_incomplete_entry);
+
+    return g_test_run ();
+}
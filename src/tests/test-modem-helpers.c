@@ -412,6 +412,68 @@ test_cmgl_response_pantech_multiple (void *f, gpointer d)
     test_cmgl_response (str, expected, G_N_ELEMENTS (expected));
 }
 
+static void
+test_cmgl_response_chunked (void *f, gpointer d)
+{
+    const gchar *str =
+        "\r\n+CMGL: 17,3,35\r\n079100F40D1101000F001000B917118336058F300001954747A0E4ACF41F27298CDCE83C6EF371B0402814020\r\n"
+        "+CMGL: 15,1,,35\r\n079100F40D1101000F001000B917118336058F300001954747A0E4ACF41F27298CDCE83C6EF371B0402814020\r\n"
+        "+CMGL: 13,0,\"alpha\",35\r\n079100F40D1101000F001000B917118336058F300001954747A0E4ACF41F27298CDCE83C6EF371B0402814020\r\n"
+        "\r\nOK\r\n";
+    const gint expected_index[] = { 17, 15, 13 };
+    const gint expected_status[] = { 3, 1, 0 };
+    const gsize chunk_sizes[] = { 1, 7, 16, 64 };
+    guint c;
+
+    /* Feed the response in chunks the way the serial port does, consuming
+     * every complete entry as soon as it matches */
+    for (c = 0; c < G_N_ELEMENTS (chunk_sizes); c++) {
+        GString *buffer;
+        GRegex *r;
+        gsize offset = 0;
+        guint n_found = 0;
+
+        r = mm_3gpp_cmgl_pdu_entry_regex_get ();
+        g_assert (r != NULL);
+        buffer = g_string_new ("");
+
+        while (offset < strlen (str)) {
+            GMatchInfo *match_info = NULL;
+            gsize len;
+
+            len = MIN (chunk_sizes[c], strlen (str) - offset);
+            g_string_append_len (buffer, str + offset, len);
+            offset += len;
+
+            while (g_regex_match (r, buffer->str, 0, &match_info)) {
+                MM3gppPduInfo *info;
+                gint start, end;
+
+                info = mm_3gpp_parse_pdu_cmgl_entry (match_info);
+                g_assert (info != NULL);
+                g_assert_cmpuint (n_found, <, G_N_ELEMENTS (expected_index));
+                g_assert_cmpint (info->index, ==, expected_index[n_found]);
+                g_assert_cmpint (info->status, ==, expected_status[n_found]);
+                g_assert_cmpstr (info->pdu, ==, "079100F40D1101000F001000B917118336058F300001954747A0E4ACF41F27298CDCE83C6EF371B0402814020");
+                mm_3gpp_pdu_info_free (info);
+                n_found++;
+
+                g_assert (g_match_info_fetch_pos (match_info, 0, &start, &end));
+                g_string_erase (buffer, start, end - start);
+                g_match_info_free (match_info);
+                match_info = NULL;
+            }
+            g_match_info_free (match_info);
+        }
+
+        g_assert_cmpuint (n_found, ==, G_N_ELEMENTS (expected_index));
+        g_assert_cmpstr (buffer->str, ==, "\r\n\r\nOK\r\n");
+
+        g_string_free (buffer, TRUE);
+        g_regex_unref (r);
+    }
+}
+
 /*****************************************************************************/
 /* Test CMGR responses */
 
@@ -2478,6 +2540,45 @@ test_cgact_read_response_multiple (void)
     test_cgact_read_results ("multiple", reply, &expected[0], G_N_ELEMENTS (expected));
 }
 
+/*****************************************************************************/
+/* Test +CGEV indications */
+
+typedef struct {
+    const gchar *str;
+    MM3gppCgev   event;
+    guint        cid;
+} CgevTest;
+
+static const CgevTest cgev_tests[] = {
+    { "+CGEV: NW DETACH",                      MM_3GPP_CGEV_NW_DETACH,     0 },
+    { "+CGEV: ME DETACH",                      MM_3GPP_CGEV_ME_DETACH,     0 },
+    { "+CGEV: NW PDN DEACT 1",                 MM_3GPP_CGEV_NW_DEACT_PDN,  1 },
+    { "+CGEV: ME PDN DEACT 3,0",               MM_3GPP_CGEV_ME_DEACT_PDN,  3 },
+    { "+CGEV: NW DEACT 1,2,0",                 MM_3GPP_CGEV_NW_DEACT_PDP,  2 },
+    { "+CGEV: ME DEACT \"IP\",\"10.0.0.1\",4", MM_3GPP_CGEV_ME_DEACT_PDP,  4 },
+    { "+CGEV: NW DEACT \"IP\",\"10.0.0.1\"",   MM_3GPP_CGEV_NW_DEACT_PDP,  0 },
+    { "NW PDN DEACT 5",                        MM_3GPP_CGEV_NW_DEACT_PDN,  5 },
+    { "+CGEV: NW PDN ACT 1",                   MM_3GPP_CGEV_UNKNOWN,       0 },
+    { "+CGEV: NW CLASS \"B\"",                 MM_3GPP_CGEV_UNKNOWN,       0 },
+};
+
+static void
+test_cgev_indication (void)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (cgev_tests); i++) {
+        MM3gppCgev event;
+        guint      cid = G_MAXUINT;
+
+        trace ("\nTesting +CGEV indication '%s'...\n", cgev_tests[i].str);
+
+        event = mm_3gpp_parse_cgev_indication (cgev_tests[i].str, &cid);
+        g_assert_cmpuint (event, ==, cgev_tests[i].event);
+        g_assert_cmpuint (cid, ==, cgev_tests[i].cid);
+    }
+}
+
 /*****************************************************************************/
 /* Test CPMS responses */
 
@@ -3171,6 +3272,93 @@ test_supported_capability_filter (void *f, gpointer d)
     g_array_unref (combinations);
 }
 
+/*****************************************************************************/
+/* Test signal change thresholds */
+
+static MMSignal *
+build_lte_signal (gdouble rssi,
+                  gdouble rsrp,
+                  gdouble rsrq,
+                  gdouble snr)
+{
+    MMSignal *signal;
+
+    signal = mm_signal_new ();
+    mm_signal_set_rssi (signal, rssi);
+    mm_signal_set_rsrp (signal, rsrp);
+    mm_signal_set_rsrq (signal, rsrq);
+    mm_signal_set_snr  (signal, snr);
+    return signal;
+}
+
+static gboolean
+lte_signal_changed (MMSignal *previous,
+                    gdouble rssi,
+                    gdouble rsrp,
+                    gdouble rsrq,
+                    gdouble snr,
+                    guint threshold)
+{
+    MMSignal *current;
+    gboolean changed;
+
+    current = build_lte_signal (rssi, rsrp, rsrq, snr);
+    changed = mm_signal_changed_over_thresholds (previous, current,
+                                                 threshold, threshold, threshold, threshold, threshold);
+    g_object_unref (current);
+    return changed;
+}
+
+static void
+test_signal_thresholds (void *f, gpointer d)
+{
+    MMSignal *previous;
+    MMSignal *current;
+
+    previous = build_lte_signal (-70.0, -100.0, -10.0, 12.0);
+
+    /* Without thresholds any change is reported */
+    g_assert (!lte_signal_changed (previous, -70.0, -100.0, -10.0, 12.0, 0));
+    g_assert (lte_signal_changed (previous, -70.0, -100.1, -10.0, 12.0, 0));
+
+    /* Changes below the threshold are ignored, in both directions */
+    g_assert (!lte_signal_changed (previous, -72.9, -97.1, -10.0, 12.0, 3));
+    g_assert (!lte_signal_changed (previous, -67.1, -102.9, -12.5, 14.9, 3));
+
+    /* Changes reaching the threshold in any of the values are reported */
+    g_assert (lte_signal_changed (previous, -73.0, -100.0, -10.0, 12.0, 3));
+    g_assert (lte_signal_changed (previous, -70.0, -97.0, -10.0, 12.0, 3));
+    g_assert (lte_signal_changed (previous, -70.0, -100.0, -13.0, 12.0, 3));
+    g_assert (lte_signal_changed (previous, -70.0, -100.0, -10.0, 15.0, 3));
+
+    /* Values becoming available or unavailable are always reported */
+    g_assert (lte_signal_changed (previous, -70.0, -100.0, -10.0, MM_SIGNAL_UNKNOWN, 100));
+    current = build_lte_signal (-70.0, -100.0, -10.0, 12.0);
+    mm_signal_set_sinr (current, 10.0);
+    g_assert (mm_signal_changed_over_thresholds (previous, current, 100, 100, 100, 100, 100));
+    g_object_unref (current);
+
+    /* Each threshold applies to its own values only; RSCP and Io follow
+     * the RSSI one */
+    current = build_lte_signal (-70.0, -105.0, -10.0, 12.0);
+    g_assert (!mm_signal_changed_over_thresholds (previous, current, 1, 6, 1, 1, 1));
+    g_assert (mm_signal_changed_over_thresholds (previous, current, 6, 5, 6, 6, 6));
+    g_object_unref (current);
+
+    g_object_unref (previous);
+
+    previous = mm_signal_new ();
+    mm_signal_set_rscp (previous, -90.0);
+    mm_signal_set_io (previous, -60.0);
+    current = mm_signal_new ();
+    mm_signal_set_rscp (current, -94.0);
+    mm_signal_set_io (current, -60.0);
+    g_assert (!mm_signal_changed_over_thresholds (previous, current, 5, 1, 1, 1, 1));
+    g_assert (mm_signal_changed_over_thresholds (previous, current, 4, 10, 10, 10, 10));
+    g_object_unref (current);
+    g_object_unref (previous);
+}
+
 /*****************************************************************************/
 /* Test +CCLK responses */
 
@@ -3249,6 +3437,65 @@ test_cclk_response (void)
     }
 }
 
+/*****************************************************************************/
+/* Test +CTZV/+CTZE messages */
+
+typedef struct {
+    const gchar *str;
+    gboolean ret;
+    gchar *iso8601;
+    gint32 offset;
+    gint32 dst_offset;
+} CtzTest;
+
+static const CtzTest ctz_tests[] = {
+    { "+CTZV: +40", TRUE, NULL, 600, MM_NETWORK_TIMEZONE_OFFSET_UNKNOWN },
+    { "+CTZV: -32", TRUE, NULL, -480, MM_NETWORK_TIMEZONE_OFFSET_UNKNOWN },
+    { "+CTZV: \"+04\"", TRUE, NULL, 60, MM_NETWORK_TIMEZONE_OFFSET_UNKNOWN },
+    { "+CTZV: -32,\"15/02/28,20:30:40\"", TRUE,
+        "2015-02-28T20:30:40-08:00", -480, MM_NETWORK_TIMEZONE_OFFSET_UNKNOWN },
+
+    { "+CTZE: \"+08\",1", TRUE, NULL, 120, 60 },
+    { "+CTZE: +08,1,\"2016/10/18,12:30:00\"", TRUE,
+        "2016-10-18T12:30:00+02:00", 120, 60 },
+    { "+CTZE: -28,0,\"2016/03/01,08:00:05\"", TRUE,
+        "2016-03-01T08:00:05-07:00", -420, 0 },
+
+    { "+CTZV: XX", FALSE, NULL, 0, 0 },
+
+    { NULL, FALSE, NULL, 0, 0 }
+};
+
+static void
+test_ctz_response (void)
+{
+    guint i;
+
+    for (i = 0; ctz_tests[i].str; i++) {
+        GError *error = NULL;
+        gchar *iso8601 = NULL;
+        MMNetworkTimezone *tz = NULL;
+        gboolean ret;
+
+        ret = mm_parse_ctz_response (ctz_tests[i].str, &iso8601, &tz, &error);
+
+        g_assert (ret == ctz_tests[i].ret);
+        g_assert (ret == (error ? FALSE : TRUE));
+
+        g_clear_error (&error);
+
+        if (!ret)
+            continue;
+
+        g_assert_cmpstr (ctz_tests[i].iso8601, ==, iso8601);
+        g_assert_cmpint (mm_network_timezone_get_offset (tz), ==, ctz_tests[i].offset);
+        g_assert_cmpint (mm_network_timezone_get_dst_offset (tz), ==, ctz_tests[i].dst_offset);
+
+        g_free (iso8601);
+        g_object_unref (tz);
+    }
+}
+
 
 /*****************************************************************************/
 /* Test +CRSM responses */
@@ -3691,6 +3938,69 @@ test_parse_uint_list (void)
     }
 }
 
+/*****************************************************************************/
+/* Test compound command responses */
+
+typedef struct {
+    const gchar *response;
+    guint        n_commands;
+    const gchar *expected[5];
+} CompoundResponseTest;
+
+static const CompoundResponseTest compound_response_tests[] = {
+    {
+        "Quectel\r\n\r\nEC25\r\n\r\nRevision: EC25EFAR06A03M4G\r\n\r\n867698040123456", 4,
+        { "Quectel", "EC25", "Revision: EC25EFAR06A03M4G", "867698040123456", NULL }
+    },
+    {
+        "+CGMI: Telit\r\n\r\n+CGMM: LE910\r\nRev 1", 2,
+        { "+CGMI: Telit", "+CGMM: LE910\r\nRev 1", NULL }
+    },
+    {
+        "Sierra Wireless", 1,
+        { "Sierra Wireless", NULL }
+    },
+    /* Missing replies */
+    {
+        "Quectel\r\n\r\nEC25", 3,
+        { NULL }
+    },
+    /* Replies not separated by empty lines */
+    {
+        "Quectel\r\nEC25\r\nREV\r\n123", 4,
+        { NULL }
+    },
+    /* Empty reply */
+    {
+        "Quectel\r\n\r\n\r\n\r\nREV", 3,
+        { NULL }
+    },
+};
+
+static void
+test_compound_response (void)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (compound_response_tests); i++) {
+        gchar **split;
+        guint   j;
+
+        split = mm_split_compound_response (compound_response_tests[i].response,
+                                            compound_response_tests[i].n_commands);
+        if (!compound_response_tests[i].expected[0]) {
+            g_assert (!split);
+            continue;
+        }
+
+        g_assert (split);
+        g_assert_cmpuint (g_strv_length (split), ==, compound_response_tests[i].n_commands);
+        for (j = 0; j < compound_response_tests[i].n_commands; j++)
+            g_assert_cmpstr (split[j], ==, compound_response_tests[i].expected[j]);
+        g_strfreev (split);
+    }
+}
+
 /*****************************************************************************/
 
 void
@@ -3880,6 +4190,8 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE (test_cgact_read_response_single_active, NULL));
     g_test_suite_add (suite, TESTCASE (test_cgact_read_response_multiple, NULL));
 
+    g_test_suite_add (suite, TESTCASE (test_cgev_indication, NULL));
+
     g_test_suite_add (suite, TESTCASE (test_cnum_response_generic, NULL));
     g_test_suite_add (suite, TESTCASE (test_cnum_response_generic_without_detail, NULL));
     g_test_suite_add (suite, TESTCASE (test_cnum_response_generic_detail_unquoted, NULL));
@@ -3896,15 +4208,19 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_generic_multiple, NULL));
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_pantech, NULL));
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_pantech_multiple, NULL));
+    g_test_suite_add (suite, TESTCASE (test_cmgl_response_chunked, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_cmgr_response_generic, NULL));
     g_test_suite_add (suite, TESTCASE (test_cmgr_response_telit, NULL));
 
+
     g_test_suite_add (suite, TESTCASE (test_supported_mode_filter, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_supported_capability_filter, NULL));
+    g_test_suite_add (suite, TESTCASE (test_signal_thresholds, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_cclk_response, NULL));
+    g_test_suite_add (suite, TESTCASE (test_ctz_response, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_crsm_response, NULL));
 
@@ -3918,6 +4234,8 @@ int main (int argc, char **argv)
 
     g_test_suite_add (suite, TESTCASE (test_parse_uint_list, NULL));
 
+    g_test_suite_add (suite, TESTCASE (test_compound_response, NULL));
+
     result = g_test_run ();
 
     reg_test_data_free (reg_data);
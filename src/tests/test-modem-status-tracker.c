@@ -0,0 +1,213 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <glib.h>
+
+#include "mm-modem-status-tracker.h"
+#include "mm-log.h"
+
+#define MODEM_PATH_FORMAT "/org/freedesktop/ModemManager1/Modem/%u"
+
+/*****************************************************************************/
+
+/* Builds a{oa{sv}} with one record per given modem index and state */
+static GVariant *
+build_records (guint n_modems,
+               const guint *modems,
+               const gint *states)
+{
+    GVariantBuilder builder;
+    guint i;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{oa{sv}}"));
+    for (i = 0; i < n_modems; i++) {
+        GVariantBuilder record;
+        gchar *path;
+
+        path = g_strdup_printf (MODEM_PATH_FORMAT, modems[i]);
+        g_variant_builder_init (&record, G_VARIANT_TYPE ("a{sv}"));
+        g_variant_builder_add (&record, "{sv}", "state", g_variant_new_int32 (states[i]));
+        g_variant_builder_add (&builder, "{o@a{sv}}", path, g_variant_builder_end (&record));
+        g_free (path);
+    }
+    return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+static void
+refresh (MMModemStatusTracker *tracker,
+         guint n_modems,
+         const guint *modems,
+         const gint *states)
+{
+    GVariant *records;
+
+    records = build_records (n_modems, modems, states);
+    mm_modem_status_tracker_refresh (tracker, records);
+    g_variant_unref (records);
+}
+
+static void
+assert_changes (MMModemStatusTracker *tracker,
+                guint64 since,
+                gboolean expected_complete,
+                guint expected_n_changed,
+                guint expected_n_removed)
+{
+    GVariant *changes;
+    GVariant *removed = NULL;
+    gboolean complete = FALSE;
+
+    changes = mm_modem_status_tracker_get_changes (tracker, since, &complete, &removed);
+    g_assert_cmpint (complete, ==, expected_complete);
+    g_assert_cmpuint (g_variant_n_children (changes), ==, expected_n_changed);
+    g_assert_cmpuint (g_variant_n_children (removed), ==, expected_n_removed);
+    g_variant_unref (g_variant_ref_sink (changes));
+    g_variant_unref (g_variant_ref_sink (removed));
+}
+
+static void
+test_generations (void)
+{
+    MMModemStatusTracker *tracker;
+    static const guint modems[] = { 0, 1, 2 };
+    gint states[] = { 8, 8, 11 };
+    guint64 generation;
+
+    tracker = mm_modem_status_tracker_new ();
+    g_assert_cmpuint (mm_modem_status_tracker_get_generation (tracker), ==, 0);
+    assert_changes (tracker, 0, TRUE, 0, 0);
+
+    refresh (tracker, 3, modems, states);
+    generation = mm_modem_status_tracker_get_generation (tracker);
+    g_assert_cmpuint (generation, ==, 1);
+    assert_changes (tracker, 0, TRUE, 3, 0);
+    assert_changes (tracker, generation, FALSE, 0, 0);
+
+    /* No changes, no new generation */
+    refresh (tracker, 3, modems, states);
+    g_assert_cmpuint (mm_modem_status_tracker_get_generation (tracker), ==, generation);
+
+    /* One modem changes */
+    states[1] = 11;
+    refresh (tracker, 3, modems, states);
+    g_assert_cmpuint (mm_modem_status_tracker_get_generation (tracker), ==, generation + 1);
+    assert_changes (tracker, generation, FALSE, 1, 0);
+    assert_changes (tracker, generation + 1, FALSE, 0, 0);
+
+    /* One modem goes away */
+    refresh (tracker, 2, modems, states);
+    assert_changes (tracker, generation, FALSE, 1, 1);
+    assert_changes (tracker, generation + 1, FALSE, 0, 1);
+    assert_changes (tracker, 0, TRUE, 2, 0);
+
+    /* Unknown generations give the full list */
+    assert_changes (tracker, 1000, TRUE, 2, 0);
+
+    mm_modem_status_tracker_free (tracker);
+}
+
+static void
+test_record_contents (void)
+{
+    MMModemStatusTracker *tracker;
+    static const guint modems[] = { 7 };
+    static const gint states[] = { 3 };
+    GVariant *changes;
+    GVariant *record;
+    const gchar *path = NULL;
+    guint64 generation = 0;
+    gint32 state = 0;
+
+    tracker = mm_modem_status_tracker_new ();
+    refresh (tracker, 1, modems, states);
+
+    changes = mm_modem_status_tracker_get_changes (tracker, 0, NULL, NULL);
+    g_variant_ref_sink (changes);
+    g_assert_cmpuint (g_variant_n_children (changes), ==, 1);
+    record = g_variant_get_child_value (changes, 0);
+    g_assert (g_variant_lookup (record, "path", "&o", &path));
+    g_assert_cmpstr (path, ==, "/org/freedesktop/ModemManager1/Modem/7");
+    g_assert (g_variant_lookup (record, "generation", "t", &generation));
+    g_assert_cmpuint (generation, ==, 1);
+    g_assert (g_variant_lookup (record, "state", "i", &state));
+    g_assert_cmpint (state, ==, 3);
+    g_variant_unref (record);
+    g_variant_unref (changes);
+
+    mm_modem_status_tracker_free (tracker);
+}
+
+static void
+test_removed_overflow (void)
+{
+    MMModemStatusTracker *tracker;
+    guint modems[100];
+    gint states[100];
+    guint64 generation;
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (modems); i++) {
+        modems[i] = i;
+        states[i] = 8;
+    }
+
+    tracker = mm_modem_status_tracker_new ();
+    refresh (tracker, G_N_ELEMENTS (modems), modems, states);
+    generation = mm_modem_status_tracker_get_generation (tracker);
+
+    /* Remove modems one by one, from the last one */
+    for (i = G_N_ELEMENTS (modems); i > 0; i--)
+        refresh (tracker, i - 1, modems, states);
+
+    /* Too many removals to report them all */
+    assert_changes (tracker, generation, TRUE, 0, 0);
+    /* But the recent ones are still known */
+    assert_changes (tracker, mm_modem_status_tracker_get_generation (tracker) - 10, FALSE, 0, 10);
+
+    mm_modem_status_tracker_free (tracker);
+}
+
+/*****************************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/modem-status-tracker/generations",      test_generations);
+    g_test_add_func ("/ModemManager/modem-status-tracker/record-contents",  test_record_contents);
+    g_test_add_func ("/ModemManager/modem-status-tracker/removed-overflow", test_removed_overflow);
+
+    return g_test_run ();
+}
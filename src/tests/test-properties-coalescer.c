@@ -0,0 +1,382 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include "mm-properties-coalescer.h"
+#include "mm-log.h"
+
+#define OBJECT_PATH   "/org/freedesktop/ModemManager1/Modem/0"
+#define SENTINEL_PATH "/org/freedesktop/ModemManager1/Sentinel"
+
+/*****************************************************************************/
+/* Peer to peer connection over a socket pair; signals emitted in the server
+ * side go through the coalescer, and are received in the client side */
+
+typedef struct {
+    GDBusConnection *server;
+    GDBusConnection *client;
+    guint subscription_id;
+    /* Bodies of the PropertiesChanged signals received */
+    GPtrArray *received;
+    guint n_sentinels;
+} Fixture;
+
+static void
+connection_ready (GObject *source,
+                  GAsyncResult *res,
+                  GDBusConnection **connection)
+{
+    GError *error = NULL;
+
+    *connection = g_dbus_connection_new_finish (res, &error);
+    g_assert_no_error (error);
+    g_assert (*connection);
+}
+
+static GIOStream *
+stream_new (gint fd)
+{
+    GSocket *socket;
+    GSocketConnection *stream;
+    GError *error = NULL;
+
+    socket = g_socket_new_from_fd (fd, &error);
+    g_assert_no_error (error);
+    stream = g_socket_connection_factory_create_connection (socket);
+    g_object_unref (socket);
+    return G_IO_STREAM (stream);
+}
+
+static void
+signal_cb (GDBusConnection *connection,
+           const gchar *sender_name,
+           const gchar *object_path,
+           const gchar *interface_name,
+           const gchar *signal_name,
+           GVariant *parameters,
+           Fixture *fixture)
+{
+    if (g_str_equal (object_path, SENTINEL_PATH)) {
+        fixture->n_sentinels++;
+        return;
+    }
+
+    g_assert_cmpstr (object_path, ==, OBJECT_PATH);
+    g_assert_cmpstr (interface_name, ==, "org.freedesktop.DBus.Properties");
+    g_assert_cmpstr (signal_name, ==, "PropertiesChanged");
+    g_ptr_array_add (fixture->received, g_variant_ref (parameters));
+}
+
+static void
+fixture_init (Fixture *fixture)
+{
+    GIOStream *server_stream;
+    GIOStream *client_stream;
+    gchar *guid;
+    gint fds[2];
+
+    memset (fixture, 0, sizeof (Fixture));
+    fixture->received = g_ptr_array_new_with_free_func ((GDestroyNotify)g_variant_unref);
+
+    g_assert_cmpint (socketpair (AF_UNIX, SOCK_STREAM, 0, fds), ==, 0);
+    server_stream = stream_new (fds[0]);
+    client_stream = stream_new (fds[1]);
+
+    /* Both sides need to run the authentication at the same time */
+    guid = g_dbus_generate_guid ();
+    g_dbus_connection_new (server_stream,
+                           guid,
+                           (G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_SERVER |
+                            G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_ALLOW_ANONYMOUS),
+                           NULL,
+                           NULL,
+                           (GAsyncReadyCallback)connection_ready,
+                           &fixture->server);
+    g_dbus_connection_new (client_stream,
+                           NULL,
+                           G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+                           NULL,
+                           NULL,
+                           (GAsyncReadyCallback)connection_ready,
+                           &fixture->client);
+    while (!fixture->server || !fixture->client)
+        g_main_context_iteration (NULL, TRUE);
+    g_free (guid);
+    g_object_unref (server_stream);
+    g_object_unref (client_stream);
+
+    fixture->subscription_id =
+        g_dbus_connection_signal_subscribe (fixture->client,
+                                            NULL,
+                                            NULL,
+                                            NULL,
+                                            NULL,
+                                            NULL,
+                                            G_DBUS_SIGNAL_FLAGS_NONE,
+                                            (GDBusSignalCallback)signal_cb,
+                                            fixture,
+                                            NULL);
+}
+
+static void
+fixture_clear (Fixture *fixture)
+{
+    g_dbus_connection_signal_unsubscribe (fixture->client, fixture->subscription_id);
+    g_dbus_connection_close_sync (fixture->client, NULL, NULL);
+    g_dbus_connection_close_sync (fixture->server, NULL, NULL);
+    g_object_unref (fixture->client);
+    g_object_unref (fixture->server);
+    g_ptr_array_unref (fixture->received);
+}
+
+/* Signals are received in order, so once the sentinel is received all the
+ * signals emitted before it have gone through the coalescer filter (which
+ * runs in the GDBus worker thread) and have been received if sent */
+static void
+fixture_sync (Fixture *fixture)
+{
+    guint n_sentinels;
+    GError *error = NULL;
+
+    n_sentinels = fixture->n_sentinels + 1;
+    g_dbus_connection_emit_signal (fixture->server,
+                                   NULL,
+                                   SENTINEL_PATH,
+                                   "org.freedesktop.ModemManager1.Test",
+                                   "Sentinel",
+                                   NULL,
+                                   &error);
+    g_assert_no_error (error);
+    while (fixture->n_sentinels < n_sentinels)
+        g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+emit_properties_changed (Fixture *fixture,
+                         const gchar *interface_name,
+                         const gchar *name,
+                         guint value,
+                         const gchar *invalidated)
+{
+    GVariantBuilder changed;
+    GVariantBuilder invalidated_builder;
+    GError *error = NULL;
+
+    g_variant_builder_init (&changed, G_VARIANT_TYPE ("a{sv}"));
+    if (name)
+        g_variant_builder_add (&changed, "{sv}", name, g_variant_new_uint32 (value));
+    g_variant_builder_init (&invalidated_builder, G_VARIANT_TYPE ("as"));
+    if (invalidated)
+        g_variant_builder_add (&invalidated_builder, "s", invalidated);
+
+    g_dbus_connection_emit_signal (fixture->server,
+                                   NULL,
+                                   OBJECT_PATH,
+                                   "org.freedesktop.DBus.Properties",
+                                   "PropertiesChanged",
+                                   g_variant_new ("(sa{sv}as)",
+                                                  interface_name,
+                                                  &changed,
+                                                  &invalidated_builder),
+                                   &error);
+    g_assert_no_error (error);
+}
+
+static GVariant *
+find_received (Fixture *fixture,
+               const gchar *interface_name)
+{
+    guint i;
+
+    for (i = 0; i < fixture->received->len; i++) {
+        GVariant *body;
+        const gchar *aux;
+
+        body = g_ptr_array_index (fixture->received, i);
+        g_variant_get (body, "(&s@a{sv}@as)", &aux, NULL, NULL);
+        if (g_str_equal (aux, interface_name))
+            return body;
+    }
+    g_assert_not_reached ();
+    return NULL;
+}
+
+static void
+assert_changed (GVariant *body,
+                const gchar *name,
+                guint expected)
+{
+    GVariant *changed;
+    guint value = 0;
+
+    changed = g_variant_get_child_value (body, 1);
+    g_assert (g_variant_lookup (changed, name, "u", &value));
+    g_assert_cmpuint (value, ==, expected);
+    g_variant_unref (changed);
+}
+
+/*****************************************************************************/
+
+static void
+test_not_held (void)
+{
+    Fixture fixture;
+    MMPropertiesCoalescer *coalescer;
+    guint n_received = 0;
+    guint n_emitted = 0;
+
+    fixture_init (&fixture);
+    coalescer = mm_properties_coalescer_new (fixture.server, OBJECT_PATH);
+
+    emit_properties_changed (&fixture, "org.freedesktop.ModemManager1.Modem", "State", 1, NULL);
+    emit_properties_changed (&fixture, "org.freedesktop.ModemManager1.Modem", "State", 2, NULL);
+    fixture_sync (&fixture);
+
+    g_assert_cmpuint (fixture.received->len, ==, 2);
+    assert_changed (g_ptr_array_index (fixture.received, 0), "State", 1);
+    assert_changed (g_ptr_array_index (fixture.received, 1), "State", 2);
+
+    mm_properties_coalescer_get_stats (coalescer, &n_received, &n_emitted);
+    g_assert_cmpuint (n_received, ==, 2);
+    g_assert_cmpuint (n_emitted, ==, 2);
+
+    mm_properties_coalescer_free (coalescer);
+    fixture_clear (&fixture);
+}
+
+static void
+test_hold_release (void)
+{
+    Fixture fixture;
+    MMPropertiesCoalescer *coalescer;
+    GVariant *body;
+    const gchar **invalidated;
+    guint n_received = 0;
+    guint n_emitted = 0;
+    guint i;
+
+    fixture_init (&fixture);
+    coalescer = mm_properties_coalescer_new (fixture.server, OBJECT_PATH);
+
+    /* Nested holds; nothing is sent until the last one is released */
+    mm_properties_coalescer_hold (coalescer);
+    mm_properties_coalescer_hold (coalescer);
+    emit_properties_changed (&fixture, "org.freedesktop.ModemManager1.Modem", "State", 1, NULL);
+    emit_properties_changed (&fixture, "org.freedesktop.ModemManager1.Modem3gpp", "RegistrationState", 1, NULL);
+    emit_properties_changed (&fixture, "org.freedesktop.ModemManager1.Modem", "State", 2, NULL);
+    emit_properties_changed (&fixture, "org.freedesktop.ModemManager1.Modem3gpp", NULL, 0, "OperatorName");
+    mm_properties_coalescer_release (coalescer);
+    fixture_sync (&fixture);
+    g_assert_cmpuint (fixture.received->len, ==, 0);
+
+    mm_properties_coalescer_release (coalescer);
+    fixture_sync (&fixture);
+
+    /* One signal per interface, with the last values */
+    g_assert_cmpuint (fixture.received->len, ==, 2);
+    body = find_received (&fixture, "org.freedesktop.ModemManager1.Modem");
+    assert_changed (body, "State", 2);
+    body = find_received (&fixture, "org.freedesktop.ModemManager1.Modem3gpp");
+    assert_changed (body, "RegistrationState", 1);
+    g_variant_get (body, "(&s@a{sv}^a&s)", NULL, NULL, &invalidated);
+    g_assert_cmpuint (g_strv_length ((gchar **)invalidated), ==, 1);
+    g_assert_cmpstr (invalidated[0], ==, "OperatorName");
+    g_free (invalidated);
+
+    mm_properties_coalescer_get_stats (coalescer, &n_received, &n_emitted);
+    g_assert_cmpuint (n_received, ==, 4);
+    g_assert_cmpuint (n_emitted, ==, 2);
+
+    /* The coalescer keeps working after several transactions */
+    for (i = 0; i < 3; i++) {
+        mm_properties_coalescer_hold (coalescer);
+        emit_properties_changed (&fixture, "org.freedesktop.ModemManager1.Modem", "State", 10 + i, NULL);
+        emit_properties_changed (&fixture, "org.freedesktop.ModemManager1.Modem", "State", 20 + i, NULL);
+        fixture_sync (&fixture);
+        mm_properties_coalescer_release (coalescer);
+        fixture_sync (&fixture);
+    }
+
+    g_assert_cmpuint (fixture.received->len, ==, 5);
+    for (i = 0; i < 3; i++)
+        assert_changed (g_ptr_array_index (fixture.received, 2 + i), "State", 20 + i);
+
+    mm_properties_coalescer_free (coalescer);
+    fixture_clear (&fixture);
+}
+
+static void
+test_free_while_held (void)
+{
+    Fixture fixture;
+    MMPropertiesCoalescer *coalescer;
+
+    fixture_init (&fixture);
+    coalescer = mm_properties_coalescer_new (fixture.server, OBJECT_PATH);
+
+    mm_properties_coalescer_hold (coalescer);
+    emit_properties_changed (&fixture, "org.freedesktop.ModemManager1.Modem", "State", 1, NULL);
+    fixture_sync (&fixture);
+    g_assert_cmpuint (fixture.received->len, ==, 0);
+    mm_properties_coalescer_free (coalescer);
+    fixture_sync (&fixture);
+
+    /* Whatever was held is sent when freed */
+    g_assert_cmpuint (fixture.received->len, ==, 1);
+    assert_changed (g_ptr_array_index (fixture.received, 0), "State", 1);
+
+    fixture_clear (&fixture);
+}
+
+/*****************************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+#if !GLIB_CHECK_VERSION (2,36,0)
+    g_type_init ();
+#endif
+
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/properties-coalescer/not-held",        test_not_held);
+    g_test_add_func ("/ModemManager/properties-coalescer/hold-release",    test_hold_release);
+    g_test_add_func ("/ModemManager/properties-coalescer/free-while-held", test_free_while_held);
+
+    return g_test_run ();
+}
@@ -0,0 +1,205 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <glib.h>
+
+#include "mm-signal-history.h"
+#include "mm-log.h"
+
+/*****************************************************************************/
+
+static void
+add_lte_sample (MMSignalHistory *history,
+                guint64 timestamp,
+                gdouble rsrp)
+{
+    MMSignal *signal;
+
+    signal = mm_signal_new ();
+    mm_signal_set_rssi (signal, -70.0);
+    mm_signal_set_rsrp (signal, rsrp);
+    mm_signal_set_rsrq (signal, -9.54);
+    mm_signal_set_snr  (signal, 12.0);
+    mm_signal_history_add (history, timestamp, MM_MODEM_ACCESS_TECHNOLOGY_LTE, signal);
+    g_object_unref (signal);
+}
+
+static void
+assert_n_samples_since (MMSignalHistory *history,
+                        guint64 since,
+                        guint expected)
+{
+    GVariant *samples;
+
+    samples = g_variant_ref_sink (mm_signal_history_get_samples (history, since));
+    g_assert_cmpuint (g_variant_n_children (samples), ==, expected);
+    g_variant_unref (samples);
+}
+
+static void
+test_values (void)
+{
+    MMSignalHistory *history;
+    GVariant *samples;
+    guint64 sequence = 0;
+    guint64 timestamp = 0;
+    guint32 access_technology = 0;
+    gint16 rssi = 0, rsrp = 0, rsrq = 0, snr = 0, ecio = 0;
+
+    history = mm_signal_history_new (4);
+    add_lte_sample (history, 1000, -101.26);
+
+    samples = g_variant_ref_sink (mm_signal_history_get_samples (history, 0));
+    g_assert_cmpuint (g_variant_n_children (samples), ==, 1);
+    g_variant_get_child (samples, 0, "(ttunnnnn)",
+                         &sequence, &timestamp, &access_technology,
+                         &rssi, &rsrp, &rsrq, &snr, &ecio);
+    g_assert_cmpuint (sequence, ==, 1);
+    g_assert_cmpuint (timestamp, ==, 1000);
+    g_assert_cmpuint (access_technology, ==, MM_MODEM_ACCESS_TECHNOLOGY_LTE);
+    g_assert_cmpint (rssi, ==, -700);
+    g_assert_cmpint (rsrp, ==, -1013);
+    g_assert_cmpint (rsrq, ==, -95);
+    g_assert_cmpint (snr, ==, 120);
+    g_assert_cmpint (ecio, ==, MM_SIGNAL_HISTORY_VALUE_UNKNOWN);
+    g_variant_unref (samples);
+
+    mm_signal_history_free (history);
+}
+
+static void
+test_since (void)
+{
+    MMSignalHistory *history;
+    guint i;
+
+    history = mm_signal_history_new (10);
+    assert_n_samples_since (history, 0, 0);
+    assert_n_samples_since (history, 3, 0);
+
+    for (i = 1; i <= 5; i++)
+        add_lte_sample (history, i * 1000, -100.0);
+
+    assert_n_samples_since (history, 0, 5);
+    assert_n_samples_since (history, 1, 4);
+    assert_n_samples_since (history, 3, 2);
+    assert_n_samples_since (history, 5, 0);
+    assert_n_samples_since (history, 6, 0);
+    assert_n_samples_since (history, G_MAXUINT64, 0);
+
+    mm_signal_history_free (history);
+}
+
+static void
+test_wrap (void)
+{
+    MMSignalHistory *history;
+    GVariant *samples;
+    guint64 sequence = 0;
+    guint64 timestamp = 0;
+    guint i;
+
+    history = mm_signal_history_new (3);
+    for (i = 1; i <= 7; i++)
+        add_lte_sample (history, i * 1000, -100.0);
+    g_assert_cmpuint (mm_signal_history_get_n_samples (history), ==, 3);
+
+    /* Only the newest ones are kept, oldest first */
+    samples = g_variant_ref_sink (mm_signal_history_get_samples (history, 0));
+    g_assert_cmpuint (g_variant_n_children (samples), ==, 3);
+    for (i = 0; i < 3; i++) {
+        g_variant_get_child (samples, i, "(ttunnnnn)", &sequence, &timestamp, NULL, NULL, NULL, NULL, NULL, NULL);
+        g_assert_cmpuint (sequence, ==, 5 + i);
+        g_assert_cmpuint (timestamp, ==, (5 + i) * 1000);
+    }
+    g_variant_unref (samples);
+
+    /* Samples already dropped don't count */
+    assert_n_samples_since (history, 2, 3);
+    assert_n_samples_since (history, 4, 3);
+    assert_n_samples_since (history, 5, 2);
+    assert_n_samples_since (history, 6, 1);
+    assert_n_samples_since (history, 7, 0);
+
+    mm_signal_history_free (history);
+}
+
+static void
+test_clock_change (void)
+{
+    MMSignalHistory *history;
+    GVariant *samples;
+    guint64 sequence = 0;
+    guint64 timestamp = 0;
+
+    /* System clock set back between the 2nd and 3rd samples */
+    history = mm_signal_history_new (10);
+    add_lte_sample (history, 10000, -100.0);
+    add_lte_sample (history, 11000, -100.0);
+    add_lte_sample (history, 2000, -100.0);
+    add_lte_sample (history, 3000, -100.0);
+
+    /* Timestamps don't matter when asking for the samples after a given one */
+    assert_n_samples_since (history, 0, 4);
+    assert_n_samples_since (history, 1, 3);
+    assert_n_samples_since (history, 2, 2);
+    assert_n_samples_since (history, 4, 0);
+
+    /* Timestamps are given as they were */
+    samples = g_variant_ref_sink (mm_signal_history_get_samples (history, 2));
+    g_variant_get_child (samples, 0, "(ttunnnnn)", &sequence, &timestamp, NULL, NULL, NULL, NULL, NULL, NULL);
+    g_assert_cmpuint (sequence, ==, 3);
+    g_assert_cmpuint (timestamp, ==, 2000);
+    g_variant_get_child (samples, 1, "(ttunnnnn)", &sequence, &timestamp, NULL, NULL, NULL, NULL, NULL, NULL);
+    g_assert_cmpuint (sequence, ==, 4);
+    g_assert_cmpuint (timestamp, ==, 3000);
+    g_variant_unref (samples);
+
+    mm_signal_history_free (history);
+}
+
+/*****************************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/signal-history/values",       test_values);
+    g_test_add_func ("/ModemManager/signal-history/since",        test_since);
+    g_test_add_func ("/ModemManager/signal-history/wrap",         test_wrap);
+    g_test_add_func ("/ModemManager/signal-history/clock-change", test_clock_change);
+
+    return g_test_run ();
+}
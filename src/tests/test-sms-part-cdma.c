@@ -367,6 +367,80 @@ test_unicode_encoding (void)
         "中國哲學書電子化計劃");
 }
 
+static void
+test_invalid_user_data_length (void)
+{
+    static const guint8 pdu[] = {
+        /* message type */
+        0x00,
+        /* teleservice id */
+        0x00, 0x02,
+        0x10, 0x02,
+        /* originating address */
+        0x02, 0x07,
+        0x02, 0x8C, 0xE9, 0x5D, 0xCC, 0x65, 0x80,
+        /* bearer reply option */
+        0x06, 0x01,
+        0xFC,
+        /* bearer data */
+        0x08, 0x15,
+        0x00, 0x03, 0x16, 0x8D, 0x30,
+        0x01, 0x06, 0x10, 0x34, 0x18, 0x30, 0x60, 0x80, /* user data (wrong num_fields) */
+        0x03, 0x06, 0x10, 0x10, 0x04, 0x04, 0x48, 0x47
+    };
+    MMSmsPart *part;
+    GError *error = NULL;
+
+    /* The user data is ignored, but not the rest of fields */
+    part = mm_sms_part_cdma_new_from_binary_pdu (0, pdu, sizeof (pdu), &error);
+    g_assert_no_error (error);
+    g_assert (part != NULL);
+    g_assert_cmpstr (mm_sms_part_get_number (part), ==, "3305773196");
+    g_assert_cmpuint (mm_sms_part_get_message_reference (part), ==, 63);
+    g_assert (mm_sms_part_get_text (part) == NULL);
+    mm_sms_part_free (part);
+}
+
+static void
+test_decode_throughput (void)
+{
+    static const guint8 pdu[] = {
+        /* message type */
+        0x00,
+        /* teleservice id */
+        0x00, 0x02,
+        0x10, 0x02,
+        /* originating address */
+        0x02, 0x07,
+        0x02, 0x8C, 0xE9, 0x5D, 0xCC, 0x65, 0x80,
+        /* bearer reply option */
+        0x06, 0x01,
+        0xFC,
+        /* bearer data */
+        0x08, 0x15,
+        0x00, 0x03, 0x16, 0x8D, 0x30, 0x01, 0x06,
+        0x10, 0x24, 0x18, 0x30, 0x60, 0x80, 0x03,
+        0x06, 0x10, 0x10, 0x04, 0x04, 0x48, 0x47
+    };
+    guint n_iterations = 100000;
+    guint i;
+    gdouble elapsed;
+
+    g_test_timer_start ();
+    for (i = 0; i < n_iterations; i++) {
+        MMSmsPart *part;
+
+        part = mm_sms_part_cdma_new_from_binary_pdu (0, pdu, sizeof (pdu), NULL);
+        g_assert (part != NULL);
+        mm_sms_part_free (part);
+    }
+    elapsed = g_test_timer_elapsed ();
+
+    g_test_maximized_result (n_iterations / elapsed,
+                             "Decoded %.0f CDMA PDUs/s",
+                             n_iterations / elapsed);
+}
+
 /********************* PDU CREATOR TESTS *********************/
 
 static void
@@ -538,6 +612,9 @@ int main (int argc, char **argv)
     g_test_add_func ("/MM/SMS/CDMA/PDU-Parser/latin-encoding", test_latin_encoding);
     g_test_add_func ("/MM/SMS/CDMA/PDU-Parser/latin-encoding-2", test_latin_encoding_2);
     g_test_add_func ("/MM/SMS/CDMA/PDU-Parser/unicode-encoding", test_unicode_encoding);
+    g_test_add_func ("/MM/SMS/CDMA/PDU-Parser/invalid-user-data-length", test_invalid_user_data_length);
+    if (g_test_perf ())
+        g_test_add_func ("/MM/SMS/CDMA/PDU-Parser/decode-throughput", test_decode_throughput);
 
     g_test_add_func ("/MM/SMS/CDMA/PDU-Creator/ascii-encoding", test_create_pdu_text_ascii_encoding);
     g_test_add_func ("/MM/SMS/CDMA/PDU-Creator/latin-encoding", test_create_pdu_text_latin_encoding);
@@ -0,0 +1,303 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <glib.h>
+
+#include "mm-sms-send-sequence.h"
+#include "mm-log.h"
+
+/*****************************************************************************/
+/* Sends messages and batches the same way MMBaseSms does, logging the AT
+ * commands issued; the commands at the given positions in the log fail. */
+
+typedef struct {
+    GPtrArray *commands;
+    const guint *failures;
+    guint n_failures;
+} FakeModem;
+
+static gboolean
+fake_modem_command (FakeModem *modem,
+                    gchar *command)
+{
+    guint position;
+    guint i;
+
+    position = modem->commands->len;
+    g_ptr_array_add (modem->commands, command);
+    for (i = 0; i < modem->n_failures; i++) {
+        if (modem->failures[i] == position)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean
+fake_modem_step (FakeModem *modem,
+                 MMSmsSendStep step,
+                 const gchar *item_command)
+{
+    switch (step) {
+    case MM_SMS_SEND_STEP_MORE_MESSAGES_ENABLE:
+        return fake_modem_command (modem, g_strdup ("+CMMS=1"));
+    case MM_SMS_SEND_STEP_MORE_MESSAGES_DISABLE:
+        return fake_modem_command (modem, g_strdup ("+CMMS=0"));
+    case MM_SMS_SEND_STEP_ITEM:
+        return fake_modem_command (modem, g_strdup (item_command));
+    case MM_SMS_SEND_STEP_DONE:
+    default:
+        g_assert_not_reached ();
+        return FALSE;
+    }
+}
+
+/* Parts are sent as "+CMGS=<message>.<part>", stopping on the first error */
+static gboolean
+send_message (FakeModem *modem,
+              guint message,
+              guint n_parts,
+              gboolean in_batch)
+{
+    MMSmsSendSequence *sequence;
+    MMSmsSendStep step;
+    guint part = 0;
+    gboolean success;
+
+    sequence = mm_sms_send_sequence_new (n_parts, !in_batch, TRUE);
+    while ((step = mm_sms_send_sequence_next (sequence, &part)) != MM_SMS_SEND_STEP_DONE) {
+        gchar *command;
+
+        command = g_strdup_printf ("+CMGS=%u.%u", message, part);
+        mm_sms_send_sequence_step_done (sequence, fake_modem_step (modem, step, command));
+        g_free (command);
+    }
+    g_assert (!mm_sms_send_sequence_get_link_held (sequence));
+    success = (mm_sms_send_sequence_get_n_failed (sequence) == 0);
+    mm_sms_send_sequence_free (sequence);
+    return success;
+}
+
+/* Messages failing don't stop the batch */
+static guint
+send_batch (FakeModem *modem,
+            const guint *n_parts,
+            guint n_messages)
+{
+    MMSmsSendSequence *sequence;
+    MMSmsSendStep step;
+    guint message = 0;
+    guint n_failed;
+
+    sequence = mm_sms_send_sequence_new (n_messages, TRUE, FALSE);
+    while ((step = mm_sms_send_sequence_next (sequence, &message)) != MM_SMS_SEND_STEP_DONE) {
+        gboolean success;
+
+        if (step == MM_SMS_SEND_STEP_ITEM)
+            success = send_message (modem,
+                                    message,
+                                    n_parts[message],
+                                    mm_sms_send_sequence_get_link_held (sequence));
+        else
+            success = fake_modem_step (modem, step, NULL);
+        mm_sms_send_sequence_step_done (sequence, success);
+    }
+    g_assert (!mm_sms_send_sequence_get_link_held (sequence));
+    n_failed = mm_sms_send_sequence_get_n_failed (sequence);
+    mm_sms_send_sequence_free (sequence);
+    return n_failed;
+}
+
+static void
+fake_modem_init (FakeModem *modem,
+                 const guint *failures,
+                 guint n_failures)
+{
+    modem->commands = g_ptr_array_new_with_free_func (g_free);
+    modem->failures = failures;
+    modem->n_failures = n_failures;
+}
+
+static void
+fake_modem_check (FakeModem *modem,
+                  const gchar *expected)
+{
+    gchar *commands;
+
+    g_ptr_array_add (modem->commands, NULL);
+    commands = g_strjoinv (";", (gchar **)modem->commands->pdata);
+    g_assert_cmpstr (commands, ==, expected);
+    g_free (commands);
+    g_ptr_array_unref (modem->commands);
+}
+
+/*****************************************************************************/
+
+static void
+test_single_part (void)
+{
+    FakeModem modem;
+
+    fake_modem_init (&modem, NULL, 0);
+    g_assert (send_message (&modem, 0, 1, FALSE));
+    fake_modem_check (&modem, "+CMGS=0.0");
+}
+
+static void
+test_multipart (void)
+{
+    FakeModem modem;
+
+    fake_modem_init (&modem, NULL, 0);
+    g_assert (send_message (&modem, 0, 3, FALSE));
+    fake_modem_check (&modem, "+CMMS=1;+CMGS=0.0;+CMGS=0.1;+CMGS=0.2;+CMMS=0");
+}
+
+static void
+test_multipart_error (void)
+{
+    FakeModem modem;
+    static const guint failures[] = { 2 };
+
+    /* No more parts after a failed one, but the link is let go */
+    fake_modem_init (&modem, failures, G_N_ELEMENTS (failures));
+    g_assert (!send_message (&modem, 0, 3, FALSE));
+    fake_modem_check (&modem, "+CMMS=1;+CMGS=0.0;+CMGS=0.1;+CMMS=0");
+}
+
+static void
+test_multipart_no_link_hold (void)
+{
+    FakeModem modem;
+    static const guint failures[] = { 0 };
+
+    /* Parts are sent anyway, and the link isn't let go */
+    fake_modem_init (&modem, failures, G_N_ELEMENTS (failures));
+    g_assert (send_message (&modem, 0, 2, FALSE));
+    fake_modem_check (&modem, "+CMMS=1;+CMGS=0.0;+CMGS=0.1");
+}
+
+static void
+test_batch (void)
+{
+    FakeModem modem;
+    static const guint n_parts[] = { 1, 2, 1 };
+
+    /* The link is held once for the whole batch, multipart messages in it
+     * don't hold it again */
+    fake_modem_init (&modem, NULL, 0);
+    g_assert_cmpuint (send_batch (&modem, n_parts, G_N_ELEMENTS (n_parts)), ==, 0);
+    fake_modem_check (&modem, "+CMMS=1;+CMGS=0.0;+CMGS=1.0;+CMGS=1.1;+CMGS=2.0;+CMMS=0");
+}
+
+static void
+test_batch_single (void)
+{
+    FakeModem modem;
+    static const guint n_parts[] = { 2 };
+
+    /* A single multipart message holds the link on its own */
+    fake_modem_init (&modem, NULL, 0);
+    g_assert_cmpuint (send_batch (&modem, n_parts, G_N_ELEMENTS (n_parts)), ==, 0);
+    fake_modem_check (&modem, "+CMMS=1;+CMGS=0.0;+CMGS=0.1;+CMMS=0");
+}
+
+static void
+test_batch_error (void)
+{
+    FakeModem modem;
+    static const guint n_parts[] = { 1, 2, 1 };
+    static const guint failures[] = { 2 };
+
+    /* A failed message doesn't stop the batch, and the link is let go at
+     * the end */
+    fake_modem_init (&modem, failures, G_N_ELEMENTS (failures));
+    g_assert_cmpuint (send_batch (&modem, n_parts, G_N_ELEMENTS (n_parts)), ==, 1);
+    fake_modem_check (&modem, "+CMMS=1;+CMGS=0.0;+CMGS=1.0;+CMGS=2.0;+CMMS=0");
+}
+
+static void
+test_batch_error_last (void)
+{
+    FakeModem modem;
+    static const guint n_parts[] = { 1, 1 };
+    static const guint failures[] = { 2 };
+
+    fake_modem_init (&modem, failures, G_N_ELEMENTS (failures));
+    g_assert_cmpuint (send_batch (&modem, n_parts, G_N_ELEMENTS (n_parts)), ==, 1);
+    fake_modem_check (&modem, "+CMMS=1;+CMGS=0.0;+CMGS=1.0;+CMMS=0");
+}
+
+static void
+test_batch_no_link_hold (void)
+{
+    FakeModem modem;
+    static const guint n_parts[] = { 1, 2 };
+    static const guint failures[] = { 0 };
+
+    /* If the batch can't hold the link, multipart messages try on their own */
+    fake_modem_init (&modem, failures, G_N_ELEMENTS (failures));
+    g_assert_cmpuint (send_batch (&modem, n_parts, G_N_ELEMENTS (n_parts)), ==, 0);
+    fake_modem_check (&modem, "+CMMS=1;+CMGS=0.0;+CMMS=1;+CMGS=1.0;+CMGS=1.1;+CMMS=0");
+}
+
+static void
+test_batch_empty (void)
+{
+    FakeModem modem;
+
+    fake_modem_init (&modem, NULL, 0);
+    g_assert_cmpuint (send_batch (&modem, NULL, 0), ==, 0);
+    fake_modem_check (&modem, "");
+}
+
+/*****************************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/sms-send-sequence/single-part",          test_single_part);
+    g_test_add_func ("/ModemManager/sms-send-sequence/multipart",            test_multipart);
+    g_test_add_func ("/ModemManager/sms-send-sequence/multipart-error",      test_multipart_error);
+    g_test_add_func ("/ModemManager/sms-send-sequence/multipart-no-link",    test_multipart_no_link_hold);
+    g_test_add_func ("/ModemManager/sms-send-sequence/batch",                test_batch);
+    g_test_add_func ("/ModemManager/sms-send-sequence/batch-single",         test_batch_single);
+    g_test_add_func ("/ModemManager/sms-send-sequence/batch-error",          test_batch_error);
+    g_test_add_func ("/ModemManager/sms-send-sequence/batch-error-last",     test_batch_error_last);
+    g_test_add_func ("/ModemManager/sms-send-sequence/batch-no-link",        test_batch_no_link_hold);
+    g_test_add_func ("/ModemManager/sms-send-sequence/batch-empty",          test_batch_empty);
+
+    return g_test_run ();
+}
@@ -0,0 +1,335 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+#include "mm-sms-store.h"
+#include "mm-log.h"
+#include "test-tmp-dir.h"
+
+/*****************************************************************************/
+
+static MMSmsPart *
+build_part (const gchar *number,
+            const gchar *timestamp,
+            const gchar *text,
+            guint        concat_reference,
+            guint        concat_sequence)
+{
+    MMSmsPart *part;
+
+    part = mm_sms_part_new (3, MM_SMS_PDU_TYPE_DELIVER);
+    mm_sms_part_set_smsc (part, "+34656000311");
+    mm_sms_part_set_number (part, number);
+    mm_sms_part_set_timestamp (part, timestamp);
+    mm_sms_part_set_text (part, text);
+    mm_sms_part_set_encoding (part, MM_SMS_ENCODING_GSM7);
+    mm_sms_part_set_class (part, -1);
+    if (concat_reference) {
+        mm_sms_part_set_concat_reference (part, concat_reference);
+        mm_sms_part_set_concat_max (part, 2);
+        mm_sms_part_set_concat_sequence (part, concat_sequence);
+    }
+    return part;
+}
+
+static void
+collect_part (MMSmsPart  *part,
+              MMSmsState  state,
+              GPtrArray  *parts)
+{
+    g_assert_cmpuint (state, ==, MM_SMS_STATE_RECEIVED);
+    g_ptr_array_add (parts, part);
+}
+
+static void
+test_append_load (void)
+{
+    MMSmsStore *store;
+    MMSmsPart  *parts[3];
+    GPtrArray  *loaded;
+    gchar      *dir;
+    gchar      *path;
+    GError     *error = NULL;
+    guint       i;
+
+    dir = test_tmp_dir_new ("mm-sms-store");
+    path = g_build_filename (dir, "358178040012345", NULL);
+
+    parts[0] = build_part ("+34600000001", "2016-03-01T10:00:00+01:00", "first", 0, 0);
+    parts[1] = build_part ("+34600000002", "2016-03-01T10:05:00+01:00", "second, part 1", 27, 1);
+    parts[2] = build_part ("+34600000002", "2016-03-01T10:05:00+01:00", "second, part 2", 27, 2);
+
+    store = mm_sms_store_open (path, &error);
+    g_assert_no_error (error);
+    g_assert (store != NULL);
+    g_assert_cmpuint (mm_sms_store_get_count (store), ==, 0);
+
+    for (i = 0; i < G_N_ELEMENTS (parts); i++) {
+        g_assert (!mm_sms_store_contains (store, parts[i]));
+        g_assert (mm_sms_store_append (store, parts[i], MM_SMS_STATE_RECEIVED, &error));
+        g_assert_no_error (error);
+        g_assert (mm_sms_store_contains (store, parts[i]));
+    }
+    g_assert_cmpuint (mm_sms_store_get_count (store), ==, 3);
+    mm_sms_store_free (store);
+
+    /* Reopen and load everything back */
+    store = mm_sms_store_open (path, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (mm_sms_store_get_count (store), ==, 3);
+
+    loaded = g_ptr_array_new_with_free_func ((GDestroyNotify)mm_sms_part_free);
+    g_assert_cmpuint (mm_sms_store_foreach (store, (MMSmsStoreForeachFn)collect_part, loaded), ==, 3);
+    g_assert_cmpuint (loaded->len, ==, 3);
+    for (i = 0; i < loaded->len; i++) {
+        MMSmsPart *part = g_ptr_array_index (loaded, i);
+
+        /* Loaded parts are not in any modem storage */
+        g_assert_cmpuint (mm_sms_part_get_index (part), ==, SMS_PART_INVALID_INDEX);
+        g_assert_cmpuint (mm_sms_part_get_pdu_type (part), ==, MM_SMS_PDU_TYPE_DELIVER);
+        g_assert_cmpstr (mm_sms_part_get_smsc (part), ==, mm_sms_part_get_smsc (parts[i]));
+        g_assert_cmpstr (mm_sms_part_get_number (part), ==, mm_sms_part_get_number (parts[i]));
+        g_assert_cmpstr (mm_sms_part_get_timestamp (part), ==, mm_sms_part_get_timestamp (parts[i]));
+        g_assert_cmpstr (mm_sms_part_get_text (part), ==, mm_sms_part_get_text (parts[i]));
+        g_assert_cmpint (mm_sms_part_get_class (part), ==, -1);
+        g_assert_cmpuint (mm_sms_part_get_concat_reference (part), ==, mm_sms_part_get_concat_reference (parts[i]));
+        g_assert_cmpuint (mm_sms_part_get_concat_sequence (part), ==, mm_sms_part_get_concat_sequence (parts[i]));
+    }
+    g_ptr_array_unref (loaded);
+
+    mm_sms_store_free (store);
+    for (i = 0; i < G_N_ELEMENTS (parts); i++)
+        mm_sms_part_free (parts[i]);
+    g_free (path);
+    test_tmp_dir_remove (dir);
+}
+
+static void
+test_remove (void)
+{
+    MMSmsStore  *store;
+    MMSmsPart   *parts[2];
+    GPtrArray   *loaded;
+    gchar       *dir;
+    gchar       *path;
+    gchar       *log_path;
+    GError      *error = NULL;
+    GStatBuf     st;
+    guint        i;
+
+    dir = test_tmp_dir_new ("mm-sms-store");
+    path = g_build_filename (dir, "358178040012345", NULL);
+    log_path = g_build_filename (path, "parts.log", NULL);
+
+    parts[0] = build_part ("+34600000001", "2016-03-01T10:00:00+01:00", "first", 0, 0);
+    parts[1] = build_part ("+34600000001", "2016-03-01T10:00:30+01:00", "second", 0, 0);
+
+    store = mm_sms_store_open (path, &error);
+    g_assert_no_error (error);
+    for (i = 0; i < G_N_ELEMENTS (parts); i++)
+        g_assert (mm_sms_store_append (store, parts[i], MM_SMS_STATE_RECEIVED, &error));
+
+    /* Removing only affects the matching part, and survives a reopen */
+    g_assert (mm_sms_store_remove (store, parts[0]));
+    g_assert (!mm_sms_store_remove (store, parts[0]));
+    g_assert (!mm_sms_store_contains (store, parts[0]));
+    g_assert (mm_sms_store_contains (store, parts[1]));
+    mm_sms_store_free (store);
+
+    store = mm_sms_store_open (path, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (mm_sms_store_get_count (store), ==, 1);
+
+    loaded = g_ptr_array_new_with_free_func ((GDestroyNotify)mm_sms_part_free);
+    mm_sms_store_foreach (store, (MMSmsStoreForeachFn)collect_part, loaded);
+    g_assert_cmpuint (loaded->len, ==, 1);
+    g_assert_cmpstr (mm_sms_part_get_text (g_ptr_array_index (loaded, 0)), ==, "second");
+    g_ptr_array_unref (loaded);
+
+    /* Once empty, the log is truncated */
+    g_assert (mm_sms_store_remove (store, parts[1]));
+    g_assert_cmpuint (mm_sms_store_get_count (store), ==, 0);
+    g_assert_cmpint (g_stat (log_path, &st), ==, 0);
+    g_assert_cmpint (st.st_size, ==, 0);
+
+    /* And it's still usable */
+    g_assert (mm_sms_store_append (store, parts[0], MM_SMS_STATE_RECEIVED, &error));
+    g_assert_no_error (error);
+    g_assert (mm_sms_store_contains (store, parts[0]));
+    mm_sms_store_free (store);
+
+    for (i = 0; i < G_N_ELEMENTS (parts); i++)
+        mm_sms_part_free (parts[i]);
+    g_free (log_path);
+    g_free (path);
+    test_tmp_dir_remove (dir);
+}
+
+static void
+test_same_key (void)
+{
+    MMSmsStore *store;
+    MMSmsPart  *parts[2];
+    MMSmsPart  *other;
+    GPtrArray  *loaded;
+    gchar      *dir;
+    gchar      *path;
+    GError     *error = NULL;
+    guint       i;
+
+    dir = test_tmp_dir_new ("mm-sms-store");
+    path = g_build_filename (dir, "358178040012345", NULL);
+
+    /* Same sender, timestamp and concatenation info, different contents */
+    parts[0] = build_part ("+34600000001", "2016-03-01T10:00:00+01:00", "first", 27, 1);
+    parts[1] = build_part ("+34600000001", "2016-03-01T10:00:00+01:00", "second", 27, 1);
+
+    store = mm_sms_store_open (path, &error);
+    g_assert_no_error (error);
+    g_assert (mm_sms_store_append (store, parts[0], MM_SMS_STATE_RECEIVED, &error));
+    g_assert_no_error (error);
+
+    /* Not taken as already stored */
+    g_assert (!mm_sms_store_contains (store, parts[1]));
+    g_assert (mm_sms_store_append (store, parts[1], MM_SMS_STATE_RECEIVED, &error));
+    g_assert_no_error (error);
+    g_assert_cmpuint (mm_sms_store_get_count (store), ==, 2);
+
+    /* A copy with the same contents is found, whatever the modem index */
+    other = build_part ("+34600000001", "2016-03-01T10:00:00+01:00", "first", 27, 1);
+    mm_sms_part_set_index (other, 7);
+    g_assert (mm_sms_store_contains (store, other));
+    mm_sms_part_free (other);
+
+    /* Removing one leaves the other one */
+    g_assert (mm_sms_store_remove (store, parts[0]));
+    g_assert (!mm_sms_store_contains (store, parts[0]));
+    g_assert (mm_sms_store_contains (store, parts[1]));
+    mm_sms_store_free (store);
+
+    store = mm_sms_store_open (path, &error);
+    g_assert_no_error (error);
+    loaded = g_ptr_array_new_with_free_func ((GDestroyNotify)mm_sms_part_free);
+    g_assert_cmpuint (mm_sms_store_foreach (store, (MMSmsStoreForeachFn)collect_part, loaded), ==, 1);
+    g_assert_cmpstr (mm_sms_part_get_text (g_ptr_array_index (loaded, 0)), ==, "second");
+    g_ptr_array_unref (loaded);
+
+    /* Loaded parts match the records they were loaded from */
+    g_assert (mm_sms_store_contains (store, parts[1]));
+    mm_sms_store_free (store);
+
+    for (i = 0; i < G_N_ELEMENTS (parts); i++)
+        mm_sms_part_free (parts[i]);
+    g_free (path);
+    test_tmp_dir_remove (dir);
+}
+
+static void
+test_remove_single (void)
+{
+    MMSmsStore *store;
+    MMSmsPart  *part;
+    gchar      *dir;
+    gchar      *path;
+    GError     *error = NULL;
+
+    dir = test_tmp_dir_new ("mm-sms-store");
+    path = g_build_filename (dir, "358178040012345", NULL);
+
+    part = build_part ("+34600000001", "2016-03-01T10:00:00+01:00", "twice", 0, 0);
+
+    /* Each removal only takes one of the records with the same contents */
+    store = mm_sms_store_open (path, &error);
+    g_assert_no_error (error);
+    g_assert (mm_sms_store_append (store, part, MM_SMS_STATE_RECEIVED, &error));
+    g_assert (mm_sms_store_append (store, part, MM_SMS_STATE_RECEIVED, &error));
+    g_assert_no_error (error);
+    g_assert_cmpuint (mm_sms_store_get_count (store), ==, 2);
+
+    g_assert (mm_sms_store_remove (store, part));
+    g_assert_cmpuint (mm_sms_store_get_count (store), ==, 1);
+    g_assert (mm_sms_store_contains (store, part));
+    g_assert (mm_sms_store_remove (store, part));
+    g_assert_cmpuint (mm_sms_store_get_count (store), ==, 0);
+    g_assert (!mm_sms_store_remove (store, part));
+    mm_sms_store_free (store);
+
+    mm_sms_part_free (part);
+    g_free (path);
+    test_tmp_dir_remove (dir);
+}
+
+static void
+test_invalid_index (void)
+{
+    MMSmsStore *store;
+    gchar      *dir;
+    gchar      *path;
+    gchar      *index_path;
+    GError     *error = NULL;
+
+    dir = test_tmp_dir_new ("mm-sms-store");
+    path = g_build_filename (dir, "358178040012345", NULL);
+    g_assert_cmpint (g_mkdir_with_parents (path, 0700), ==, 0);
+    index_path = g_build_filename (path, "parts.idx", NULL);
+    g_assert (g_file_set_contents (index_path, "not an index file", -1, NULL));
+
+    store = mm_sms_store_open (path, &error);
+    g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED);
+    g_assert (store == NULL);
+    g_error_free (error);
+
+    g_free (index_path);
+    g_free (path);
+    test_tmp_dir_remove (dir);
+}
+
+/*****************************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ModemManager/sms-store/append-load",   test_append_load);
+    g_test_add_func ("/ModemManager/sms-store/remove",        test_remove);
+    g_test_add_func ("/ModemManager/sms-store/same-key",      test_same_key);
+    g_test_add_func ("/ModemManager/sms-store/remove-single", test_remove_single);
+    g_test_add_func ("/ModemManager/sms-store/invalid-index", test_invalid_index);
+
+    return g_test_run ();
+}
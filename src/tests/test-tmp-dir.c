@@ -0,0 +1,62 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "test-tmp-dir.h"
+
+gchar *
+test_tmp_dir_new (const gchar *prefix)
+{
+    gchar *template;
+    gchar *dir;
+
+    template = g_strdup_printf ("%s-XXXXXX", prefix);
+    dir = g_dir_make_tmp (template, NULL);
+    g_assert (dir);
+    g_free (template);
+    return dir;
+}
+
+static void
+remove_recursive (const gchar *path)
+{
+    GDir *dir;
+    const gchar *name;
+
+    dir = g_dir_open (path, 0, NULL);
+    if (!dir) {
+        g_unlink (path);
+        return;
+    }
+
+    while ((name = g_dir_read_name (dir)) != NULL) {
+        gchar *child;
+
+        child = g_build_filename (path, name, NULL);
+        remove_recursive (child);
+        g_free (child);
+    }
+    g_dir_close (dir);
+    g_rmdir (path);
+}
+
+void
+test_tmp_dir_remove (gchar *dir)
+{
+    remove_recursive (dir);
+    g_free (dir);
+}
@@ -0,0 +1,25 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ */
+
+#ifndef TEST_TMP_DIR_H
+#define TEST_TMP_DIR_H
+
+#include <glib.h>
+
+/* Scratch directories for tests storing files on disk */
+gchar *test_tmp_dir_new    (const gchar *prefix);
+void   test_tmp_dir_remove (gchar *dir);
+
+#endif /* TEST_TMP_DIR_H */